@@ -0,0 +1,174 @@
+/*
+ * adc_control.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Fixed point PID loop from an adc reading to a pwm compare register.
+ *
+ *	The loop runs from a timer interrupt at a fixed rate instead of the main loop, so its latency does not depend on
+ *	what else the application is doing. One run is a handful of 64 bit multiplies and adds with no division, no
+ *	floating point and no branches that depend on data beyond the clamps, so its execution time is bounded. The
+ *	duty_hr to compare value conversion uses the Q32 scale the pwm timer precomputes for its counting period.
+ *	Every run is timed with the DWT cycle counter, Control_Get_Stats returns the last and the worst case.
+ *
+ *	Anti-windup: the integrator is clamped to the output range and stops integrating while the output is saturated
+ *	in the direction of the error (conditional integration).
+*/
+
+/*----------INCLUDES----------*/
+
+#include "adc_control.h"
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Output limits in Q16 duty_hr units
+static void output_limits(Control_PID_st* pid, int64_t* min_q16, int64_t* max_q16) {
+	if ((pid->out_min == 0) && (pid->out_max == 0)) {
+		*min_q16 = 0;
+		*max_q16 = (int64_t)PWM_DUTY_HR_MAX << CONTROL_Q_BITS;
+	}
+	else {
+		*min_q16 = (int64_t)pid->out_min << CONTROL_Q_BITS;
+		*max_q16 = (int64_t)pid->out_max << CONTROL_Q_BITS;
+	}
+}
+
+// Runs the loop from the update interrupt of the loop timer
+static void control_callback(Timer_st* tim, void* context) {
+	(void)tim;
+	Control_Step((Control_Loop_st*)context);
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Control_Init checks the loop, precomputes the compare scaling and preloads the integrator with the current duty
+// so the loop takes over without a bump
+ADC_Ret_et Control_Init(Control_Loop_st* loop) {
+	Control_PID_st* pid = &loop->pid;
+	uint16_t duty_hr;
+	int64_t min_q16;
+	int64_t max_q16;
+
+	if (!loop->tim->__metadata.tim_initialized || !loop->pwm->tim->__metadata.tim_initialized) { return TIMER_UNINIT; }
+	if (loop->feedback == NULL) { return NO_SAMPLES; }
+	if (pid->out_min > pid->out_max) { return INVALID_CONTROL_CONFIG; }
+	// Also checks that the pwm channel is enabled
+	if (PWM_Get_Achieved_Duty_HR(loop->pwm, &duty_hr) != PWM_OK) { return INVALID_CONTROL_CONFIG; }
+
+	// Same compare scale as PWM_Set_Duty_HR, precomputed by the timer for its counting period
+	loop->__scale_q32 = loop->pwm->tim->__metadata.duty_scale_q32;
+	loop->__ccr = &(&loop->pwm->tim->htim->Instance->CCR1)[loop->pwm->chan_num - 1];
+	// Counting down the output is also active while CNT equals the compare, same correction as PWM_Set_Duty_HR
+	loop->__compare_offset = (loop->pwm->tim->count_mode == COUNT_DOWN) ? 1 : 0;
+
+	output_limits(pid, &min_q16, &max_q16);
+	pid->__integral_q16 = (int64_t)duty_hr << CONTROL_Q_BITS;
+	if (pid->__integral_q16 > max_q16) {
+		pid->__integral_q16 = max_q16;
+	}
+	if (pid->__integral_q16 < min_q16) {
+		pid->__integral_q16 = min_q16;
+	}
+	pid->__prev_feedback = *loop->feedback;
+
+	// Cycle counter for the execution time measurement. The M7 DWT is write locked after reset
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	Control_Reset_Stats(loop);
+	loop->__num_runs = 0;
+
+	return ADC_OK;
+}
+
+// Control_Start runs the loop from every update interrupt of loop->tim (Timer_Dispatch_Period_Elapsed), at most
+// MAX_IT_FREQ times per second
+ADC_Ret_et Control_Start(Control_Loop_st* loop) {
+	Control_Reset_Stats(loop);
+
+	if (Timer_Register_Callback(loop->tim, control_callback, loop) != TIM_OK) { return FAIL_CONTROL_START; }
+
+	return ADC_OK;
+}
+
+// Control_Stop stops running the loop, the pwm keeps the last output
+void Control_Stop(Control_Loop_st* loop) {
+	Timer_Unregister_Callback(loop->tim);
+}
+
+// Control_Step runs the loop once. Control_Start calls it from the timer interrupt, faster loops call it from
+// HAL_ADC_ConvCpltCallback to run right after each synchronized conversion
+void Control_Step(Control_Loop_st* loop) {
+	Control_PID_st* pid = &loop->pid;
+	uint32_t start = DWT->CYCCNT;
+	int32_t feedback = *loop->feedback;
+	int32_t error = (int32_t)loop->setpoint - feedback;
+	int64_t integral = pid->__integral_q16 + ((int64_t)pid->ki_q16 * error);
+	int64_t out;
+	int64_t min_q16;
+	int64_t max_q16;
+	uint32_t duty_hr;
+	uint32_t compare;
+	uint32_t cycles;
+
+	output_limits(pid, &min_q16, &max_q16);
+
+	if (integral > max_q16) {
+		integral = max_q16;
+	}
+	if (integral < min_q16) {
+		integral = min_q16;
+	}
+
+	out = ((int64_t)pid->kp_q16 * error) + integral + ((int64_t)pid->kd_q16 * (pid->__prev_feedback - feedback));
+
+	if (out > max_q16) {
+		out = max_q16;
+		// Saturated high, only let the integrator unwind
+		if (integral > pid->__integral_q16) {
+			integral = pid->__integral_q16;
+		}
+	}
+	else if (out < min_q16) {
+		out = min_q16;
+		if (integral < pid->__integral_q16) {
+			integral = pid->__integral_q16;
+		}
+	}
+
+	pid->__integral_q16 = integral;
+	pid->__prev_feedback = feedback;
+
+	// Round to the nearest duty_hr, the clamps keep it in range
+	duty_hr = (uint32_t)((out + ((int64_t)1 << (CONTROL_Q_BITS - 1))) >> CONTROL_Q_BITS);
+	loop->pwm->duty_hr = (uint16_t)duty_hr;
+	if (loop->pwm->is_inverted) {
+		duty_hr = PWM_DUTY_HR_MAX - duty_hr;
+	}
+
+	compare = PWM_DUTY_TO_COMPARE(duty_hr, loop->__scale_q32);
+	// Without a branch: 0 stays 0 when counting down, as in PWM_Set_Duty_HR
+	*loop->__ccr = compare - (loop->__compare_offset & (compare != 0));
+
+	cycles = DWT->CYCCNT - start;
+	loop->__cycles_last = cycles;
+	if (cycles > loop->__cycles_max) {
+		loop->__cycles_max = cycles;
+	}
+	loop->__num_runs++;
+}
+
+// Control_Get_Stats reads the execution time and output of the loop
+void Control_Get_Stats(Control_Loop_st* loop, Control_Stats_st* stats) {
+	stats->cycles_last = loop->__cycles_last;
+	stats->cycles_max = loop->__cycles_max;
+	stats->num_runs = loop->__num_runs;
+	stats->duty_hr = loop->pwm->duty_hr;
+}
+
+// Control_Reset_Stats restarts the worst case execution time measurement
+void Control_Reset_Stats(Control_Loop_st* loop) {
+	loop->__cycles_last = 0;
+	loop->__cycles_max = 0;
+}
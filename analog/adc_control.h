@@ -0,0 +1,102 @@
+/*
+ * adc_control.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_ADC_CONTROL_H_
+#define INC_ADC_CONTROL_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "adc_lib.h"
+#include "timers_pwm.h"
+
+/*----------MACROS------------*/
+
+// Gains are Q16 fixed point: CONTROL_GAIN_ONE is a gain of 1.0
+#define CONTROL_Q_BITS			(16U)
+#define CONTROL_GAIN_ONE		((int32_t)1 << CONTROL_Q_BITS)
+
+/*----------TYPEDEFS----------*/
+
+// Control_PID_st is a PID with output clamping and anti-windup. Gains are in duty_hr units per adc count of error,
+// a zero ki gives a P or PD loop
+typedef struct {
+	// Proportional gain (Q16)
+	int32_t kp_q16;
+	// Integral gain per loop run (Q16)
+	int32_t ki_q16;
+	// Derivative gain per loop run (Q16). Acts on the feedback only so setpoint steps do not kick the output
+	int32_t kd_q16;
+	// Output limits in duty_hr units (0 - PWM_DUTY_HR_MAX). Both 0 uses the full range
+	uint16_t out_min;
+	uint16_t out_max;
+	// DO NOT WRITE. Integrator in Q16 duty_hr units and the previous feedback
+	int64_t __integral_q16;
+	int32_t __prev_feedback;
+}Control_PID_st;
+
+// Control_Loop_st runs a PID at a fixed rate from a timer interrupt, from an adc reading straight to a compare register
+typedef struct {
+	// Timer whose update interrupt runs the loop. Must be initialized with it_config.en_it set, the loop rate is
+	// its interrupt rate. May be the pwm's own timer
+	Timer_st* tim;
+	// Latest raw adc reading of the controlled quantity, e.g. an entry of ADC_Sync_st samples written by DMA
+	const volatile uint16_t* feedback;
+	// PWM driven by the loop. Must be running (PWM_Init) and keep its frequency while the loop runs
+	PWM_st* pwm;
+	// Controller gains and limits
+	Control_PID_st pid;
+	// Target in raw adc counts. May be written at any time
+	volatile uint16_t setpoint;
+	// DO NOT WRITE. Compare register of the pwm and duty_hr to compare value scale (Q32)
+	volatile uint32_t* __ccr;
+	uint64_t __scale_q32;
+	// DO NOT WRITE. Counts taken off non-zero compare values, 1 when the pwm's timer counts down
+	uint32_t __compare_offset;
+	// DO NOT WRITE. Execution time of the last and the longest run in CPU cycles, number of runs
+	uint32_t __cycles_last;
+	uint32_t __cycles_max;
+	volatile uint32_t __num_runs;
+}Control_Loop_st;
+
+// Control_Stats_st is the measured cost of a control loop
+typedef struct {
+	// CPU cycles of the last run
+	uint32_t cycles_last;
+	// CPU cycles of the longest run since Control_Start or Control_Reset_Stats
+	uint32_t cycles_max;
+	// Number of runs
+	uint32_t num_runs;
+	// Last output in duty_hr units
+	uint16_t duty_hr;
+}Control_Stats_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// Control_Init checks the loop, precomputes the compare scaling and preloads the integrator with the current duty
+// so the loop takes over without a bump
+ADC_Ret_et Control_Init(Control_Loop_st* loop);
+
+// Control_Start runs the loop from every update interrupt of loop->tim (Timer_Dispatch_Period_Elapsed), so at most
+// MAX_IT_FREQ (1 kHz) runs per second. Faster loops, e.g. current loops, call Control_Step from the adc conversion
+// complete callback instead
+ADC_Ret_et Control_Start(Control_Loop_st* loop);
+
+// Control_Stop stops running the loop, the pwm keeps the last output
+void Control_Stop(Control_Loop_st* loop);
+
+// Control_Step runs the loop once. Control_Start calls it from the timer interrupt. For loops faster than
+// MAX_IT_FREQ call it from HAL_ADC_ConvCpltCallback instead (without Control_Start), so the loop runs right after
+// each synchronized conversion (ADC_Sync_st) at the pwm rate
+void Control_Step(Control_Loop_st* loop);
+
+// Control_Get_Stats reads the execution time and output of the loop
+void Control_Get_Stats(Control_Loop_st* loop, Control_Stats_st* stats);
+
+// Control_Reset_Stats restarts the worst case execution time measurement
+void Control_Reset_Stats(Control_Loop_st* loop);
+
+#endif /* INC_ADC_CONTROL_H_ */
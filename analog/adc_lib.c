@@ -7,8 +7,16 @@
 
 /*----------INCLUDES----------*/
 
+#include <math.h>
 #include "adc_lib.h"
 
+/*----------PRIVATE VARIABLES----------*/
+
+static const uint32_t hal_channels[ADC_MAX_CHANNEL + 1] = { ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3,
+		ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7, ADC_CHANNEL_8, ADC_CHANNEL_9, ADC_CHANNEL_10,
+		ADC_CHANNEL_11, ADC_CHANNEL_12, ADC_CHANNEL_13, ADC_CHANNEL_14, ADC_CHANNEL_15, ADC_CHANNEL_16, ADC_CHANNEL_17,
+		ADC_CHANNEL_18 };
+
 /*----------PRIVATE FUNCTION DEFINITIONS----------*/
 
 /*
@@ -22,65 +30,7 @@
  */
 static void ADC_Channel_Select(uint8_t channel,
 		ADC_ChannelConfTypeDef *ChanConfig) {
-	switch (channel) {
-	case (0):
-		ChanConfig->Channel = ADC_CHANNEL_0;
-		return;
-	case (1):
-		ChanConfig->Channel = ADC_CHANNEL_1;
-		return;
-	case (2):
-		ChanConfig->Channel = ADC_CHANNEL_2;
-		return;
-	case (3):
-		ChanConfig->Channel = ADC_CHANNEL_3;
-		return;
-	case (4):
-		ChanConfig->Channel = ADC_CHANNEL_4;
-		return;
-	case (5):
-		ChanConfig->Channel = ADC_CHANNEL_5;
-		return;
-	case (6):
-		ChanConfig->Channel = ADC_CHANNEL_6;
-		return;
-	case (7):
-		ChanConfig->Channel = ADC_CHANNEL_7;
-		return;
-	case (8):
-		ChanConfig->Channel = ADC_CHANNEL_8;
-		return;
-	case (9):
-		ChanConfig->Channel = ADC_CHANNEL_9;
-		return;
-	case (10):
-		ChanConfig->Channel = ADC_CHANNEL_10;
-		return;
-	case (11):
-		ChanConfig->Channel = ADC_CHANNEL_11;
-		return;
-	case (12):
-		ChanConfig->Channel = ADC_CHANNEL_12;
-		return;
-	case (13):
-		ChanConfig->Channel = ADC_CHANNEL_13;
-		return;
-	case (14):
-		ChanConfig->Channel = ADC_CHANNEL_14;
-		return;
-	case (15):
-		ChanConfig->Channel = ADC_CHANNEL_15;
-		return;
-	case (16):
-		ChanConfig->Channel = ADC_CHANNEL_16;
-		return;
-	case (17):
-		ChanConfig->Channel = ADC_CHANNEL_17;
-		return;
-	case (18):
-		ChanConfig->Channel = ADC_CHANNEL_18;
-		return;
-	}
+	ADC_Get_Hal_Channel(channel, &ChanConfig->Channel);
 }
 static void ADC_Chan_Config(ADC_HandleTypeDef *hadc, uint8_t channel) {
 	ADC_ChannelConfTypeDef sConfig = { 0 };
@@ -150,6 +100,16 @@ static void adc_default_configs(ADC_HandleTypeDef *hadc) {
 
 /*----------PUBLIC FUNCTION DEFINITIONS----------*/
 
+// ADC_Get_Hal_Channel converts a channel number (0 - ADC_MAX_CHANNEL) to its HAL channel
+ADC_Ret_et ADC_Get_Hal_Channel(uint8_t channel, uint32_t* hal_channel) {
+	if (channel > ADC_MAX_CHANNEL) {
+		return INVALID_CHANNEL_NUMBER;
+	}
+
+	*hal_channel = hal_channels[channel];
+	return ADC_OK;
+}
+
 // ADC_Init initialized an ADC module
 ADC_Ret_et ADC_Init(ADC_st *adc) {
 	ADC_Ret_et ret;
@@ -17,6 +17,7 @@
 
 #define TOTAL_ADC_MODULES 	3
 #define ADC_CHANNELS_PER_MODULE 	16
+#define ADC_MAX_CHANNEL 	18	// Channels 16 - 18 are the internal ones (temperature, vrefint, vbat)
 #define NUM_ADC_BITS 12
 #define MISSING_CONVERTER 0
 
@@ -33,7 +34,20 @@ typedef enum {
 	ADC_TIMEOUT_REACHED,
 	NO_CONVERSION_TYPE,
 	INVALID_CHANNEL_NUMBER,
-	DUPLICATE_CHANNELS
+	DUPLICATE_CHANNELS,
+	CHANNEL_NOT_FOUND,
+	INVALID_BUFFER_LEN,
+	INVALID_FREQUENCY,
+	TIMER_UNINIT,
+	NO_SAMPLES,
+	TRIGGER_UNSUPPORTED,
+	TRIGGER_IN_USE,
+	FAIL_TRIGGER_CONFIG,
+	FAIL_ADC_START,
+	INVALID_CONTROL_CONFIG,
+	FAIL_CONTROL_START,
+	INVALID_THRESHOLD,
+	BREAK_UNSUPPORTED
 }ADC_Ret_et;
 
 typedef enum {
@@ -81,6 +95,8 @@ typedef struct {
 ADC_Ret_et ADC_Init(ADC_st* adc);
 // ADC_Scan starts an ADC scan based on the given configurations
 ADC_Ret_et ADC_Scan(ADC_st* adc);
+// ADC_Get_Hal_Channel converts a channel number (0 - ADC_MAX_CHANNEL) to its HAL channel
+ADC_Ret_et ADC_Get_Hal_Channel(uint8_t channel, uint32_t* hal_channel);
 
 // Get_Single_Chan_Average return an average of the buffers in a channel and returns a uint16_t
 uint16_t Get_Single_Chan_Average(ADC_st* adc, uint8_t channel);
@@ -0,0 +1,238 @@
+/*
+ * adc_power.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	True RMS and real power over whole PWM periods.
+ *
+ *	Every sample pair adds v*v, i*i and v*i to 64 bit integer sums. On the timer update event the
+ *	sums are latched into a completed window and cleared, so each result covers an integer number
+ *	of PWM periods and the switching ripple averages out exactly instead of aliasing.
+ *	The square roots and unit scaling only happen when a result is read, keeping the ISRs short.
+ *	The windows only hold whole PWM periods of evenly spaced samples when the conversions are triggered by the
+ *	timer (ADC_Sync_Start). Buffers of a free running ADC_Scan are integrated as well, but the window edges then
+ *	fall anywhere between two samples.
+ *
+ *	Power_Add_Sample and Power_Period_Elapsed must run at the same interrupt priority. Power_Add_Buffers runs in
+ *	thread context: it sums the buffers on the side and masks the update interrupt only to merge them.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "adc_power.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Fractional bits of the RMS and mean power before unit scaling, so small signals keep their resolution
+#define POWER_FRAC_BITS			(8U)
+#define POWER_FRAC_ONE			(1LL << POWER_FRAC_BITS)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Returns the index of the channel with the given channel number or -1 if it is not part of the adc module
+static int16_t find_channel_index(ADC_st* adc, uint8_t channel) {
+	for (uint8_t i = 0; i < adc->num_channels; i++) {
+		if (adc->channels[i].channel_number == channel) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Integer square root (floor) of a 64 bit value
+static uint32_t isqrt64(uint64_t x) {
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+// Mean of a window sum with 2 * POWER_FRAC_BITS fractional bits. Split in quotient and remainder so the shift
+// cannot overflow however many samples the window holds
+static uint64_t mean_sq_q(uint64_t sum, uint32_t num_samples) {
+	return ((sum / num_samples) << (2 * POWER_FRAC_BITS)) + (((sum % num_samples) << (2 * POWER_FRAC_BITS)) / num_samples);
+}
+
+// Signed mean of a window sum with POWER_FRAC_BITS fractional bits, truncated towards zero
+static int64_t mean_q(int64_t sum, uint32_t num_samples) {
+	return ((sum / (int64_t)num_samples) * POWER_FRAC_ONE) + (((sum % (int64_t)num_samples) * POWER_FRAC_ONE) / (int64_t)num_samples);
+}
+
+// RMS in counts with POWER_FRAC_BITS fractional bits converted to milli units with a gain in micro units per count,
+// rounded
+static uint32_t rms_milli(uint64_t sum_sq, uint32_t num_samples, uint32_t gain_micro) {
+	uint64_t rms_q = isqrt64(mean_sq_q(sum_sq, num_samples));
+
+	return (uint32_t)(((rms_q * gain_micro) + (1000U << (POWER_FRAC_BITS - 1))) / (1000U << POWER_FRAC_BITS));
+}
+
+// Clears the running sums of a pair
+static void clear_accum(power_accum_st* a) {
+	a->sum_vi = 0;
+	a->sum_vv = 0;
+	a->sum_ii = 0;
+	a->num_samples = 0;
+}
+
+// Adds one reading to a set of sums
+static void accumulate(power_accum_st* a, Power_Pair_st* pair, uint16_t v_raw, uint16_t i_raw) {
+	int32_t v = (int32_t)v_raw - pair->v_offset;
+	int32_t i = (int32_t)i_raw - pair->i_offset;
+
+	// 12 bit readings keep each product below 2^24, so 2^39 samples fit before overflow
+	a->sum_vi += v * i;
+	a->sum_vv += (uint32_t)(v * v);
+	a->sum_ii += (uint32_t)(i * i);
+	a->num_samples++;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Power_Init checks the pairs against the adc module and clears all accumulators
+ADC_Ret_et Power_Init(Power_Meter_st* meter) {
+	if (!meter->tim->__metadata.tim_initialized) {
+		return TIMER_UNINIT;
+	}
+
+	for (uint8_t p = 0; p < meter->num_pairs; p++) {
+		Power_Pair_st* pair = &meter->pairs[p];
+
+		if ((find_channel_index(meter->adc, pair->v_channel) < 0) ||
+			(find_channel_index(meter->adc, pair->i_channel) < 0)) {
+			return CHANNEL_NOT_FOUND;
+		}
+
+		clear_accum(&pair->__accum);
+		clear_accum(&pair->__window);
+		pair->__seq = 0;
+	}
+
+	meter->__period_count = 0;
+
+	return ADC_OK;
+}
+
+// Power_Add_Sample integrates one simultaneous voltage / current reading. Safe to call from the ADC ISR
+void Power_Add_Sample(Power_Pair_st* pair, uint16_t v_raw, uint16_t i_raw) {
+	accumulate(&pair->__accum, pair, v_raw, i_raw);
+}
+
+// Power_Add_Buffers integrates the channel buffers filled by ADC_Scan for every pair. Every call adds the whole
+// buffers, so call it once after each ADC_Scan
+ADC_Ret_et Power_Add_Buffers(Power_Meter_st* meter) {
+	TIM_HandleTypeDef* htim = meter->tim->htim;
+
+	for (uint8_t p = 0; p < meter->num_pairs; p++) {
+		Power_Pair_st* pair = &meter->pairs[p];
+		int16_t v_idx = find_channel_index(meter->adc, pair->v_channel);
+		int16_t i_idx = find_channel_index(meter->adc, pair->i_channel);
+		ADC_Channel_st* v_chan;
+		ADC_Channel_st* i_chan;
+		power_accum_st sums;
+		uint32_t update_it;
+		uint16_t len;
+
+		if ((v_idx < 0) || (i_idx < 0)) {
+			return CHANNEL_NOT_FOUND;
+		}
+
+		v_chan = &meter->adc->channels[v_idx];
+		i_chan = &meter->adc->channels[i_idx];
+
+		// ADC_Scan reads the channels round robin, so index k of both buffers belongs to the same scan
+		len = (v_chan->buffer_len < i_chan->buffer_len) ? v_chan->buffer_len : i_chan->buffer_len;
+		clear_accum(&sums);
+		for (uint16_t k = 0; k < len; k++) {
+			accumulate(&sums, pair, v_chan->buffer[k], i_chan->buffer[k]);
+		}
+
+		// The update interrupt latches and clears the running sums, it must not run in the middle of the merge
+		update_it = htim->Instance->DIER & TIM_DIER_UIE;
+		__HAL_TIM_DISABLE_IT(htim, TIM_IT_UPDATE);
+		__DSB();
+		pair->__accum.sum_vi += sums.sum_vi;
+		pair->__accum.sum_vv += sums.sum_vv;
+		pair->__accum.sum_ii += sums.sum_ii;
+		pair->__accum.num_samples += sums.num_samples;
+		if (update_it) {
+			__HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+		}
+	}
+
+	return ADC_OK;
+}
+
+// Power_Period_Elapsed ends one period of meter->tim. Register Power_Callback on the timer (Timer_Register_Callback)
+// rather than calling it directly, it then runs once per interrupt period of the timer's it_config
+void Power_Period_Elapsed(Power_Meter_st* meter, TIM_HandleTypeDef* htim) {
+	if (htim != meter->tim->htim) {
+		return;
+	}
+
+	// Only latch once a whole number of periods has been integrated
+	meter->__period_count++;
+	if (meter->__period_count < meter->periods_per_result) {
+		return;
+	}
+	meter->__period_count = 0;
+
+	for (uint8_t p = 0; p < meter->num_pairs; p++) {
+		Power_Pair_st* pair = &meter->pairs[p];
+
+		// Odd sequence number while the window is being written. The barriers keep the copy between the increments
+		pair->__seq++;
+		__DMB();
+		pair->__window = pair->__accum;
+		__DMB();
+		pair->__seq++;
+
+		clear_accum(&pair->__accum);
+	}
+}
+
+// Power_Callback is Power_Period_Elapsed as a Timer_Callback_ft, context is the Power_Meter_st
+void Power_Callback(Timer_st* tim, void* context) {
+	Power_Period_Elapsed((Power_Meter_st*)context, tim->htim);
+}
+
+// Power_Get_Result converts the last completed window of a pair to physical units
+ADC_Ret_et Power_Get_Result(Power_Pair_st* pair, Power_Result_st* result) {
+	power_accum_st w;
+	uint32_t seq;
+
+	// Retry if the ISR latched a new window while it was being copied
+	do {
+		seq = pair->__seq;
+		__DMB();
+		w = pair->__window;
+		__DMB();
+	} while ((seq & 1U) || (seq != pair->__seq));
+
+	if (w.num_samples == 0) {
+		return NO_SAMPLES;
+	}
+
+	// RMS in counts, then counts -> micro units -> milli units
+	result->v_rms_mv = rms_milli(w.sum_vv, w.num_samples, pair->v_gain_uv);
+	result->i_rms_ma = rms_milli(w.sum_ii, w.num_samples, pair->i_gain_ua);
+	// counts^2 * uV -> mV * counts, then * uA = nW and divide by 1e6 for mW. Dividing in between keeps the product
+	// in 64 bits
+	result->p_avg_mw = ((((mean_q(w.sum_vi, w.num_samples) * (int64_t)pair->v_gain_uv) / 1000LL) *
+			(int64_t)pair->i_gain_ua) / 1000000LL) / POWER_FRAC_ONE;
+	result->num_samples = w.num_samples;
+
+	return ADC_OK;
+}
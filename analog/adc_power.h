@@ -0,0 +1,100 @@
+/*
+ * adc_power.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_ADC_POWER_H_
+#define INC_ADC_POWER_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "adc_lib.h"
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// Power_Result_st holds the measurements of one integration window in physical units
+typedef struct {
+	// True RMS voltage in millivolts
+	uint32_t v_rms_mv;
+	// True RMS current in milliamps
+	uint32_t i_rms_ma;
+	// Average real power (mean of v*i) in milliwatts, negative when power flows back
+	int64_t p_avg_mw;
+	// Number of sample pairs integrated in the window
+	uint32_t num_samples;
+}Power_Result_st;
+
+// Auto-configured: DO NOT WRITE. Integer accumulators for one window
+typedef struct {
+	int64_t sum_vi;
+	uint64_t sum_vv;
+	uint64_t sum_ii;
+	uint32_t num_samples;
+}power_accum_st;
+
+// Power_Pair_st is one voltage / current channel pair (e.g. one motor phase)
+typedef struct {
+	// ADC channel number of the voltage measurement
+	uint8_t v_channel;
+	// ADC channel number of the current measurement
+	uint8_t i_channel;
+	// Raw reading that corresponds to 0 V (e.g. 2048 for a mid-rail biased sensor)
+	uint16_t v_offset;
+	// Raw reading that corresponds to 0 A
+	uint16_t i_offset;
+	// Microvolts per ADC count after the sensor gain
+	uint32_t v_gain_uv;
+	// Microamps per ADC count after the sensor gain
+	uint32_t i_gain_ua;
+	// DO NOT WRITE. Running sums of the current window
+	power_accum_st __accum;
+	// DO NOT WRITE. Sums of the last completed window
+	power_accum_st __window;
+	// DO NOT WRITE. Incremented twice per window latch so readers can detect a torn copy
+	volatile uint32_t __seq;
+}Power_Pair_st;
+
+// Power_Meter_st ties a set of channel pairs to the PWM periods of a timer. Results cover whole PWM periods when the
+// conversions are triggered by the same timer (ADC_Sync_st)
+typedef struct {
+	// ADC module the channels belong to
+	ADC_st* adc;
+	// Timer whose update event marks the end of each PWM period. Needs it_config.en_it for Power_Callback
+	Timer_st* tim;
+	// Array of voltage / current pairs
+	Power_Pair_st* pairs;
+	// Number of pairs in the array
+	uint8_t num_pairs;
+	// Number of whole PWM periods per result (0 or 1 gives a result every period)
+	uint16_t periods_per_result;
+	// DO NOT WRITE. Periods elapsed in the current window
+	uint16_t __period_count;
+}Power_Meter_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// Power_Init checks the pairs against the adc module and clears all accumulators
+ADC_Ret_et Power_Init(Power_Meter_st* meter);
+
+// Power_Add_Sample integrates one simultaneous voltage / current reading. Safe to call from the ADC ISR
+void Power_Add_Sample(Power_Pair_st* pair, uint16_t v_raw, uint16_t i_raw);
+
+// Power_Add_Buffers integrates the channel buffers filled by ADC_Scan for every pair. Every call adds the whole
+// buffers again, so call it exactly once after each ADC_Scan. Call it from thread context, it masks the update
+// interrupt of meter->tim while merging
+ADC_Ret_et Power_Add_Buffers(Power_Meter_st* meter);
+
+// Power_Period_Elapsed ends one period of meter->tim. Register Power_Callback on the timer (Timer_Register_Callback)
+// rather than calling it directly, it then runs once per interrupt period of the timer's it_config
+void Power_Period_Elapsed(Power_Meter_st* meter, TIM_HandleTypeDef* htim);
+
+// Power_Callback is Power_Period_Elapsed as a Timer_Callback_ft, context is the Power_Meter_st
+void Power_Callback(Timer_st* tim, void* context);
+
+// Power_Get_Result converts the last completed window of a pair to physical units
+ADC_Ret_et Power_Get_Result(Power_Pair_st* pair, Power_Result_st* result);
+
+#endif /* INC_ADC_POWER_H_ */
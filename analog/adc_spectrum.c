@@ -0,0 +1,396 @@
+/*
+ * adc_spectrum.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Fixed point spectral analysis of ADC channel buffers.
+ *
+ *	Spectrum_FFT runs an N point real FFT as an N/2 point complex FFT followed by a split step.
+ *	Every butterfly stage halves its outputs so nothing can overflow; the bins come out scaled by 1/N.
+ *	Samples have the buffer mean removed and are shifted up to Q15 before windowing.
+ *
+ *	Spectrum_Goertzel evaluates single frequencies, which is cheaper than a full FFT when only a few
+ *	bins are needed (e.g. inverter switching ripple or a known vibration mode).
+*/
+
+/*----------INCLUDES----------*/
+
+#include <math.h>
+#include "adc_spectrum.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// One full turn of phase in sine table units
+#define PHASE_FULL_TURN		(1024U)
+#define PHASE_QUARTER_TURN	(PHASE_FULL_TURN / 4)
+#define PHASE_MASK			(PHASE_FULL_TURN - 1)
+// 12 bit samples (mean removed) are shifted up to use the Q15 range
+#define SAMPLE_TO_Q15_SHIFT	(15 - NUM_ADC_BITS)
+
+/*----------PRIVATE VARIABLES----------*/
+
+// Quarter wave sine table in Q15, sin(pi/2 * i / 256)
+static const int16_t quarter_sine[PHASE_QUARTER_TURN + 1] = {
+	0, 201, 402, 603, 804, 1005, 1206, 1407,
+	1608, 1809, 2009, 2210, 2410, 2611, 2811, 3012,
+	3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609,
+	4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+	6393, 6590, 6786, 6983, 7179, 7375, 7571, 7767,
+	7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319,
+	9512, 9704, 9896, 10087, 10278, 10469, 10659, 10849,
+	11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+	12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+	14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+	15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673,
+	16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+	18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357,
+	19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+	20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+	22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+	23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143,
+	24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+	25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198,
+	26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+	27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+	28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+	28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534,
+	29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+	30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783,
+	30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+	31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+	31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+	32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382,
+	32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+	32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717,
+	32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+	32767,
+};
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// q15_sin returns sin(2*pi*phase/PHASE_FULL_TURN) in Q15
+static int32_t q15_sin(uint32_t phase) {
+	phase &= PHASE_MASK;
+
+	if (phase <= PHASE_QUARTER_TURN) {
+		return quarter_sine[phase];
+	}
+	else if (phase <= 2 * PHASE_QUARTER_TURN) {
+		return quarter_sine[2 * PHASE_QUARTER_TURN - phase];
+	}
+	else if (phase <= 3 * PHASE_QUARTER_TURN) {
+		return -quarter_sine[phase - 2 * PHASE_QUARTER_TURN];
+	}
+	return -quarter_sine[PHASE_FULL_TURN - phase];
+}
+
+// q15_cos returns cos(2*pi*phase/PHASE_FULL_TURN) in Q15
+static int32_t q15_cos(uint32_t phase) {
+	return q15_sin(phase + PHASE_QUARTER_TURN);
+}
+
+// Clamp a 32 bit intermediate into the int16_t bin range
+static int16_t saturate_q15(int32_t x) {
+	if (x > INT16_MAX) {
+		return INT16_MAX;
+	}
+	if (x < INT16_MIN) {
+		return INT16_MIN;
+	}
+	return (int16_t)x;
+}
+
+// Returns the channel with the given channel number or NULL if it is not part of the adc module
+static ADC_Channel_st* find_channel(ADC_st* adc, uint8_t channel) {
+	for (uint8_t i = 0; i < adc->num_channels; i++) {
+		if (adc->channels[i].channel_number == channel) {
+			return &adc->channels[i];
+		}
+	}
+	return NULL;
+}
+
+// Average of the buffer, removed from every sample so the DC term does not eat the dynamic range
+static int32_t buffer_mean(const uint16_t* buff, uint16_t buff_len) {
+	uint32_t total = 0;
+
+	for (uint16_t i = 0; i < buff_len; i++) {
+		total += buff[i];
+	}
+
+	return (int32_t)(total / buff_len);
+}
+
+// Window coefficient in Q15 for sample n of a buffer of length len
+static int32_t window_coeff(Spectrum_Window_et window, uint32_t n, uint16_t len) {
+	// Phase of 2*pi*n/len in sine table units
+	uint32_t phase = n * (PHASE_FULL_TURN / len);
+
+	switch (window) {
+		case (WINDOW_HANN):
+			// 0.5 - 0.5cos
+			return 16384 - (q15_cos(phase) >> 1);
+		case (WINDOW_HAMMING):
+			// 0.54 - 0.46cos
+			return 17695 - ((15073 * q15_cos(phase)) >> 15);
+		case (WINDOW_BLACKMAN):
+			// 0.42 - 0.5cos + 0.08cos(2x)
+			return 13763 - (q15_cos(phase) >> 1) + ((2621 * q15_cos(2 * phase)) >> 15);
+		case (WINDOW_RECTANGULAR):
+		default:
+			return INT16_MAX;
+	}
+}
+
+// Returns log2(len) if len is a power of two, otherwise 0
+static uint8_t log2_pow2(uint16_t len) {
+	uint8_t bits = 0;
+
+	if ((len == 0) || ((len & (len - 1)) != 0)) {
+		return 0;
+	}
+	while ((1U << bits) < len) {
+		bits++;
+	}
+	return bits;
+}
+
+// In place radix-2 decimation in time FFT of len complex points, scaled by 1/len
+static void complex_fft_q15(Spectrum_Bin_st z[], uint16_t len) {
+	uint8_t bits = log2_pow2(len);
+
+	// Bit reversed reordering
+	for (uint16_t i = 0; i < len; i++) {
+		uint16_t rev = 0;
+		for (uint8_t b = 0; b < bits; b++) {
+			rev |= ((i >> b) & 1U) << (bits - 1 - b);
+		}
+		if (rev > i) {
+			Spectrum_Bin_st tmp = z[i];
+			z[i] = z[rev];
+			z[rev] = tmp;
+		}
+	}
+
+	// Butterflies, each stage scaled by 1/2
+	for (uint16_t span = 2; span <= len; span <<= 1) {
+		uint16_t half = span / 2;
+		uint32_t phase_step = PHASE_FULL_TURN / span;
+
+		for (uint16_t j = 0; j < half; j++) {
+			// Twiddle W = cos - j*sin, shared by every butterfly at this offset
+			int32_t c = q15_cos(j * phase_step);
+			int32_t s = q15_sin(j * phase_step);
+
+			for (uint16_t i = j; i < len; i += span) {
+				Spectrum_Bin_st* a = &z[i];
+				Spectrum_Bin_st* b = &z[i + half];
+				int32_t t_re = (b->re * c + b->im * s) >> 15;
+				int32_t t_im = (b->im * c - b->re * s) >> 15;
+
+				b->re = (int16_t)((a->re - t_re) >> 1);
+				b->im = (int16_t)((a->im - t_im) >> 1);
+				a->re = (int16_t)((a->re + t_re) >> 1);
+				a->im = (int16_t)((a->im + t_im) >> 1);
+			}
+		}
+	}
+}
+
+// Turns the len/2 point complex FFT of the packed real signal into bins 0..len/2 of the real FFT
+static void real_fft_split_q15(Spectrum_Bin_st bins[], uint16_t len) {
+	uint16_t half = len / 2;
+	uint32_t phase_step = PHASE_FULL_TURN / len;
+	Spectrum_Bin_st z0 = bins[0];
+
+	// DC and Nyquist are purely real
+	bins[0].re = saturate_q15((z0.re + z0.im) >> 1);
+	bins[0].im = 0;
+	bins[half].re = saturate_q15((z0.re - z0.im) >> 1);
+	bins[half].im = 0;
+
+	// Bins k and half-k are built from the same pair of inputs, so both are written together
+	for (uint16_t k = 1; k <= half / 2; k++) {
+		Spectrum_Bin_st a = bins[k];
+		Spectrum_Bin_st b = bins[half - k];
+		int32_t c = q15_cos(k * phase_step);
+		int32_t s = q15_sin(k * phase_step);
+
+		// Even and odd sample spectra, each half of (a +/- conj(b))
+		int32_t e_re = (a.re + b.re) >> 1;
+		int32_t e_im = (a.im - b.im) >> 1;
+		int32_t o_re = (a.re - b.re) >> 1;
+		int32_t o_im = (a.im + b.im) >> 1;
+
+		// t = -j * W^k * o
+		int32_t t_re = (c * o_im - s * o_re) >> 15;
+		int32_t t_im = -((c * o_re + s * o_im) >> 15);
+
+		// Final halving takes the scaling from 1/(len/2) to 1/len
+		bins[k].re = saturate_q15((e_re + t_re) >> 1);
+		bins[k].im = saturate_q15((e_im + t_im) >> 1);
+		if (k != half - k) {
+			bins[half - k].re = saturate_q15((e_re - t_re) >> 1);
+			bins[half - k].im = saturate_q15((t_im - e_im) >> 1);
+		}
+	}
+}
+
+// |X|^2 = s1^2 + s2^2 - 2cos(w)s1s2 from the last two Goertzel states. Near DC the states of a long buffer grow to
+// about 2^43 (at most the sample amplitude times the squared length), so both are scaled down to 30 bits to keep
+// the products in 64 bits and the power is scaled back up
+static uint64_t goertzel_power(int64_t coeff, int64_t s1, int64_t s2) {
+	uint64_t magnitude = (uint64_t)((s1 < 0) ? -s1 : s1) | (uint64_t)((s2 < 0) ? -s2 : s2);
+	uint8_t shift = 0;
+	int64_t power;
+
+	while ((magnitude >> shift) >= (1ULL << 30)) {
+		shift++;
+	}
+	s1 >>= shift;
+	s2 >>= shift;
+
+	power = s1 * s1 + s2 * s2 - ((coeff * s1) >> GOERTZEL_COEFF_SHIFT) * s2;
+
+	return (power > 0) ? ((uint64_t)power << (2 * shift)) : 0;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Spectrum_FFT windows a channel buffer and writes SPECTRUM_NUM_BINS(buffer_len) bins to bins[]
+ADC_Ret_et Spectrum_FFT(ADC_st* adc, uint8_t channel, Spectrum_Window_et window, Spectrum_Bin_st bins[], uint16_t num_bins) {
+	ADC_Channel_st* chan = find_channel(adc, channel);
+	uint16_t len;
+	int32_t mean;
+
+	if (chan == NULL) {
+		return CHANNEL_NOT_FOUND;
+	}
+
+	len = chan->buffer_len;
+	// The FFT only supports power of two lengths covered by the twiddle table
+	if ((log2_pow2(len) == 0) || (len < SPECTRUM_MIN_FFT_LEN) || (len > SPECTRUM_MAX_FFT_LEN)) {
+		return INVALID_BUFFER_LEN;
+	}
+	if (num_bins < SPECTRUM_NUM_BINS(len)) {
+		return SCALED_ARRAY_DOES_NOT_MATCH_BUFFER_SIZE;
+	}
+
+	mean = buffer_mean(chan->buffer, len);
+
+	// Pack even samples into the real part and odd samples into the imaginary part
+	for (uint16_t n = 0; n < len; n += 2) {
+		int32_t even = (chan->buffer[n] - mean) << SAMPLE_TO_Q15_SHIFT;
+		int32_t odd = (chan->buffer[n + 1] - mean) << SAMPLE_TO_Q15_SHIFT;
+
+		bins[n / 2].re = saturate_q15((even * window_coeff(window, n, len)) >> 15);
+		bins[n / 2].im = saturate_q15((odd * window_coeff(window, n + 1, len)) >> 15);
+	}
+
+	complex_fft_q15(bins, len / 2);
+	real_fft_split_q15(bins, len);
+
+	return ADC_OK;
+}
+
+// Spectrum_Power_Bins fills power[] with re^2 + im^2 of each bin
+void Spectrum_Power_Bins(const Spectrum_Bin_st bins[], uint32_t power[], uint16_t num_bins) {
+	for (uint16_t k = 0; k < num_bins; k++) {
+		power[k] = (uint32_t)(bins[k].re * bins[k].re) + (uint32_t)(bins[k].im * bins[k].im);
+	}
+}
+
+// Spectrum_Peak returns the index of the strongest bin excluding DC and optionally its frequency
+uint16_t Spectrum_Peak(const Spectrum_Bin_st bins[], uint16_t num_bins, uint32_t sample_rate_hz, uint32_t* peak_hz) {
+	uint16_t peak = 0;
+	uint32_t peak_power = 0;
+	// FFT length the bins were produced from
+	uint32_t len = 2 * ((uint32_t)num_bins - 1);
+
+	for (uint16_t k = 1; k < num_bins; k++) {
+		uint32_t p = (uint32_t)(bins[k].re * bins[k].re) + (uint32_t)(bins[k].im * bins[k].im);
+		if (p > peak_power) {
+			peak_power = p;
+			peak = k;
+		}
+	}
+
+	if ((peak_hz != NULL) && (len != 0)) {
+		*peak_hz = (uint32_t)(((uint64_t)peak * sample_rate_hz) / len);
+	}
+
+	return peak;
+}
+
+// Spectrum_Band_Energy sums the power of all bins between low_hz and high_hz inclusive
+uint64_t Spectrum_Band_Energy(const Spectrum_Bin_st bins[], uint16_t num_bins, uint32_t sample_rate_hz, uint32_t low_hz, uint32_t high_hz) {
+	uint64_t energy = 0;
+	uint32_t len = 2 * ((uint32_t)num_bins - 1);
+	uint64_t k_low;
+	uint64_t k_high;
+
+	if ((sample_rate_hz == 0) || (num_bins < 2) || (low_hz > high_hz)) {
+		return 0;
+	}
+
+	// Bin k sits at k * fs / len, round the band edges inwards
+	k_low = (((uint64_t)low_hz * len) + sample_rate_hz - 1) / sample_rate_hz;
+	k_high = ((uint64_t)high_hz * len) / sample_rate_hz;
+	if (k_high > (uint64_t)(num_bins - 1)) {
+		k_high = num_bins - 1;
+	}
+
+	for (uint64_t k = k_low; k <= k_high; k++) {
+		energy += (uint32_t)(bins[k].re * bins[k].re) + (uint32_t)(bins[k].im * bins[k].im);
+	}
+
+	return energy;
+}
+
+// Goertzel_Init computes the fixed point coefficient for a target frequency
+ADC_Ret_et Goertzel_Init(Goertzel_st* g, uint32_t target_hz, uint32_t sample_rate_hz) {
+	// Target must be below Nyquist
+	if ((sample_rate_hz == 0) || (target_hz == 0) || ((uint64_t)target_hz * 2 > sample_rate_hz)) {
+		return INVALID_FREQUENCY;
+	}
+
+	g->target_hz = target_hz;
+	// Floating point is only used here at init time, the per sample loop is integer only
+	g->coeff = (int32_t)lround(2.0 * cos(2.0 * M_PI * (double)target_hz / (double)sample_rate_hz) * (1 << GOERTZEL_COEFF_SHIFT));
+	g->power = 0;
+
+	return ADC_OK;
+}
+
+// Spectrum_Goertzel evaluates every bin in goertzel[] over a channel buffer
+ADC_Ret_et Spectrum_Goertzel(ADC_st* adc, uint8_t channel, Goertzel_st goertzel[], uint8_t num_goertzel) {
+	ADC_Channel_st* chan = find_channel(adc, channel);
+	int32_t mean;
+
+	if (chan == NULL) {
+		return CHANNEL_NOT_FOUND;
+	}
+	if (chan->buffer_len == 0) {
+		return INVALID_BUFFER_LEN;
+	}
+
+	mean = buffer_mean(chan->buffer, chan->buffer_len);
+
+	for (uint8_t b = 0; b < num_goertzel; b++) {
+		int64_t coeff = goertzel[b].coeff;
+		// 64 bit states: a tone near the target grows them by about the amplitude / sin(w) every sample
+		int64_t s1 = 0;
+		int64_t s2 = 0;
+
+		// s[n] = x[n] + 2cos(w)s[n-1] - s[n-2]
+		for (uint16_t n = 0; n < chan->buffer_len; n++) {
+			int64_t s = (chan->buffer[n] - mean) + ((coeff * s1) >> GOERTZEL_COEFF_SHIFT) - s2;
+			s2 = s1;
+			s1 = s;
+		}
+
+		goertzel[b].power = goertzel_power(coeff, s1, s2);
+	}
+
+	return ADC_OK;
+}
@@ -0,0 +1,71 @@
+/*
+ * adc_spectrum.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_ADC_SPECTRUM_H_
+#define INC_ADC_SPECTRUM_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "adc_lib.h"
+
+/*----------MACROS------------*/
+
+// Largest real FFT supported by the twiddle table (buffer_len must be a power of two <= this)
+#define SPECTRUM_MAX_FFT_LEN 1024
+#define SPECTRUM_MIN_FFT_LEN 4
+// Number of bins written by Spectrum_FFT for a buffer of length N (DC to Nyquist inclusive)
+#define SPECTRUM_NUM_BINS(N) (((N) / 2) + 1)
+// Goertzel coefficients are stored as 2*cos(w) in Q14
+#define GOERTZEL_COEFF_SHIFT 14
+
+/*----------TYPEDEFS----------*/
+
+// Window applied to the samples before the FFT to reduce spectral leakage
+typedef enum {
+	WINDOW_RECTANGULAR = 1,
+	WINDOW_HANN,
+	WINDOW_HAMMING,
+	WINDOW_BLACKMAN,
+}Spectrum_Window_et;
+
+// A single frequency bin in Q15. Bins are scaled by 1/N: a full scale 12 bit sine peaks at about 8192 (rectangular window)
+typedef struct {
+	int16_t re;
+	int16_t im;
+}Spectrum_Bin_st;
+
+// Goertzel_st is a single target frequency evaluated by Spectrum_Goertzel
+typedef struct {
+	// target_hz is the frequency the bin is tuned to
+	uint32_t target_hz;
+	// Auto-configured by Goertzel_Init: 2*cos(2*pi*target/fs) in Q14
+	int32_t coeff;
+	// Result of the last Spectrum_Goertzel call: |X(target)|^2 in raw ADC counts squared
+	uint64_t power;
+}Goertzel_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// Spectrum_FFT windows a channel buffer and writes SPECTRUM_NUM_BINS(buffer_len) bins to bins[]
+ADC_Ret_et Spectrum_FFT(ADC_st* adc, uint8_t channel, Spectrum_Window_et window, Spectrum_Bin_st bins[], uint16_t num_bins);
+
+// Spectrum_Power_Bins fills power[] with re^2 + im^2 of each bin
+void Spectrum_Power_Bins(const Spectrum_Bin_st bins[], uint32_t power[], uint16_t num_bins);
+
+// Spectrum_Peak returns the index of the strongest bin excluding DC and optionally its frequency
+uint16_t Spectrum_Peak(const Spectrum_Bin_st bins[], uint16_t num_bins, uint32_t sample_rate_hz, uint32_t* peak_hz);
+
+// Spectrum_Band_Energy sums the power of all bins between low_hz and high_hz inclusive
+uint64_t Spectrum_Band_Energy(const Spectrum_Bin_st bins[], uint16_t num_bins, uint32_t sample_rate_hz, uint32_t low_hz, uint32_t high_hz);
+
+// Goertzel_Init computes the fixed point coefficient for a target frequency
+ADC_Ret_et Goertzel_Init(Goertzel_st* g, uint32_t target_hz, uint32_t sample_rate_hz);
+
+// Spectrum_Goertzel evaluates every bin in goertzel[] over a channel buffer
+ADC_Ret_et Spectrum_Goertzel(ADC_st* adc, uint8_t channel, Goertzel_st goertzel[], uint8_t num_goertzel);
+
+#endif /* INC_ADC_SPECTRUM_H_ */
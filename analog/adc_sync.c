@@ -0,0 +1,312 @@
+/*
+ * adc_sync.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	ADC conversions synchronized to a pwm period.
+ *
+ *	A spare compare channel of the pwm's timer runs in pwm mode purely as a trigger: its reference rises once per
+ *	period at the sample point and the adc converts its whole sequence on that edge, with DMA moving the results.
+ *	Center aligned counters turn around at the middle of both the high and the low time of every channel, so the
+ *	sample point sits a fixed lead before the bottom or the top of the count whatever the duty. Up counting
+ *	timers sample at the middle of [0, CCR) or [CCR, ARR], which moves with the duty (ADC_Sync_Update).
+ *
+ *	Trigger routing (RM0385, external trigger for regular channels):
+ *		direct compare events	tim1 ch1-3, tim2 ch2, tim3 ch4, tim4 ch4
+ *		TRGO2 (OCxREF)			tim1, tim8
+ *		TRGO (OCxREF)			tim1, tim2, tim4, tim5, tim8
+*/
+
+/*----------INCLUDES----------*/
+
+#include "adc_sync.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NS_PER_S				(1000000000ULL)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// How a timer channel reaches the adc trigger input
+typedef enum {
+	ROUTE_CC = 1,
+	ROUTE_TRGO,
+	ROUTE_TRGO2,
+}trigger_route_et;
+
+typedef struct {
+	uint8_t tim_num;
+	// Channel for ROUTE_CC, 0 for any channel through a trigger output
+	uint8_t chan_num;
+	trigger_route_et route;
+	uint32_t trigger;
+}trigger_entry_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+// In order of preference: direct compare events leave the trigger outputs free for timer synchronization
+static const trigger_entry_st triggers[] = {
+	{ 1, 1, ROUTE_CC, ADC_EXTERNALTRIGCONV_T1_CC1 },
+	{ 1, 2, ROUTE_CC, ADC_EXTERNALTRIGCONV_T1_CC2 },
+	{ 1, 3, ROUTE_CC, ADC_EXTERNALTRIGCONV_T1_CC3 },
+	{ 2, 2, ROUTE_CC, ADC_EXTERNALTRIGCONV_T2_CC2 },
+	{ 3, 4, ROUTE_CC, ADC_EXTERNALTRIGCONV_T3_CC4 },
+	{ 4, 4, ROUTE_CC, ADC_EXTERNALTRIGCONV_T4_CC4 },
+	{ 1, 0, ROUTE_TRGO2, ADC_EXTERNALTRIGCONV_T1_TRGO2 },
+	{ 8, 0, ROUTE_TRGO2, ADC_EXTERNALTRIGCONV_T8_TRGO2 },
+	{ 1, 0, ROUTE_TRGO, ADC_EXTERNALTRIGCONV_T1_TRGO },
+	{ 2, 0, ROUTE_TRGO, ADC_EXTERNALTRIGCONV_T2_TRGO },
+	{ 4, 0, ROUTE_TRGO, ADC_EXTERNALTRIGCONV_T4_TRGO },
+	{ 5, 0, ROUTE_TRGO, ADC_EXTERNALTRIGCONV_T5_TRGO },
+	{ 8, 0, ROUTE_TRGO, ADC_EXTERNALTRIGCONV_T8_TRGO },
+};
+
+static const uint32_t trgo_ocref[4] = { TIM_TRGO_OC1REF, TIM_TRGO_OC2REF, TIM_TRGO_OC3REF, TIM_TRGO_OC4REF };
+static const uint32_t trgo2_ocref[4] = { TIM_TRGO2_OC1REF, TIM_TRGO2_OC2REF, TIM_TRGO2_OC3REF, TIM_TRGO2_OC4REF };
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Finds the adc trigger that a channel of a timer can drive
+static const trigger_entry_st* find_trigger(uint8_t tim_num, uint8_t chan_num) {
+	for (uint8_t i = 0; i < (sizeof(triggers) / sizeof(triggers[0])); i++) {
+		if ((triggers[i].tim_num == tim_num) && ((triggers[i].chan_num == 0) || (triggers[i].chan_num == chan_num))) {
+			return &triggers[i];
+		}
+	}
+	return NULL;
+}
+
+// Compare value of the trigger channel and its pwm mode: the reference rises at the compare value on the way up
+// in pwm mode 2, on the way down in pwm mode 1 (center aligned)
+static uint32_t trigger_compare(ADC_Sync_st* sync, uint32_t* oc_mode) {
+	Timer_st* tim = sync->pwm->tim;
+	TIM_TypeDef* regs = tim->htim->Instance;
+	uint64_t arr = regs->ARR;
+	uint64_t lead = ((uint64_t)sync->lead_ns * Timer_Get_Clock_Freq(tim)) / (((uint64_t)regs->PSC + 1) * NS_PER_S);
+	uint8_t high_low = (Timer_Get_OC_Mode(tim, sync->pwm->chan_num) == TIM_OCMODE_PWM1);
+	int64_t target;
+
+	// Pwm mode 1 is high at the start of the count, pwm mode 2 at the end
+	if (sync->point == SYNC_LOW_CENTER) {
+		high_low = !high_low;
+	}
+
+	if (Timer_Is_Center_Aligned(tim)) {
+		// The middle is the bottom of the count for the start, the top for the end
+		if (high_low) {
+			*oc_mode = TIM_OCMODE_PWM1;
+			target = (int64_t)lead;
+		}
+		else {
+			*oc_mode = TIM_OCMODE_PWM2;
+			target = (int64_t)arr - (int64_t)lead;
+		}
+	}
+	else {
+		uint64_t ccr = __HAL_TIM_GET_COMPARE(tim->htim, TIM_HAL_CHANNEL(sync->pwm->chan_num));
+
+		*oc_mode = TIM_OCMODE_PWM2;
+		target = (int64_t)(high_low ? (ccr / 2) : ((ccr + arr + 1) / 2)) - (int64_t)lead;
+		// Early enough to fall into the previous period
+		if (target < 1) {
+			target += (int64_t)arr + 1;
+		}
+	}
+
+	// A compare value of 0 never produces an edge, nor does ARR on a center aligned counter: it turns around at ARR,
+	// which already counts as the way down, so a pwm mode 2 reference would never rise
+	if (target < 1) {
+		target = 1;
+	}
+	if (Timer_Is_Center_Aligned(tim) && (target > (int64_t)arr - 1)) {
+		target = (int64_t)arr - 1;
+	}
+	if (target > (int64_t)arr) {
+		target = (int64_t)arr;
+	}
+
+	return (uint32_t)target;
+}
+
+// Routes the trigger channel's reference to the adc through a trigger output if it has no direct connection
+static ADC_Ret_et route_trigger(ADC_Sync_st* sync, const trigger_entry_st* entry) {
+	TIM_TypeDef* regs = sync->pwm->tim->htim->Instance;
+	uint8_t c = sync->trigger_chan - 1;
+
+	if (entry->route == ROUTE_TRGO2) {
+		if (((regs->CR2 & TIM_CR2_MMS2) != 0) && ((regs->CR2 & TIM_CR2_MMS2) != trgo2_ocref[c])) { return TRIGGER_IN_USE; }
+		regs->CR2 = (regs->CR2 & ~TIM_CR2_MMS2) | trgo2_ocref[c];
+	}
+	else if (entry->route == ROUTE_TRGO) {
+		// TRGO may already synchronize a timer group
+		if (((regs->CR2 & TIM_CR2_MMS) != 0) && ((regs->CR2 & TIM_CR2_MMS) != trgo_ocref[c])) { return TRIGGER_IN_USE; }
+		regs->CR2 = (regs->CR2 & ~TIM_CR2_MMS) | trgo_ocref[c];
+	}
+
+	return ADC_OK;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// ADC_Sync_Init routes the trigger channel of the pwm's timer to the adc and configures the conversion sequence
+ADC_Ret_et ADC_Sync_Init(ADC_Sync_st* sync) {
+	Timer_st* tim = sync->pwm->tim;
+	ADC_HandleTypeDef* hadc = sync->adc->hadc;
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	ADC_ChannelConfTypeDef sConfig = {0};
+	const trigger_entry_st* entry;
+	uint32_t oc_mode;
+	ADC_Ret_et ret;
+
+	if (!tim->__metadata.tim_initialized) { return TIMER_UNINIT; }
+	if ((tim->count_mode == COUNT_DOWN) || (sync->trigger_chan == 0) || (sync->trigger_chan > tim->__metadata.num_channels) ||
+		(sync->trigger_chan == sync->pwm->chan_num)) {
+		return TRIGGER_UNSUPPORTED;
+	}
+	if ((sync->adc->num_channels == 0) || (sync->adc->num_channels > ADC_CHANNELS_PER_MODULE)) { return INVALID_NUM_CHANNELS; }
+	// Without DMA only one conversion per trigger can be read back
+	if ((hadc->DMA_Handle == NULL) && (sync->adc->num_channels != 1)) { return INVALID_NUM_CHANNELS; }
+	if (sync->samples == NULL) { return INVALID_BUFFER_LEN; }
+	// Every trigger converts the sequence again, the DMA must wrap back to the start of samples
+	if ((hadc->DMA_Handle != NULL) && (hadc->DMA_Handle->Init.Mode != DMA_CIRCULAR)) {
+		hadc->DMA_Handle->Init.Mode = DMA_CIRCULAR;
+		if (HAL_DMA_Init(hadc->DMA_Handle) != HAL_OK) { return FAIL_ADC_INIT; }
+	}
+
+	entry = find_trigger(tim->tim_num, sync->trigger_chan);
+	if (entry == NULL) { return TRIGGER_UNSUPPORTED; }
+
+	if (Timer_Claim_Channel(tim, sync->trigger_chan, sync) != TIM_OK) { return TRIGGER_IN_USE; }
+
+	ret = route_trigger(sync, entry);
+	if (ret != ADC_OK) {
+		Timer_Release_Channel(tim, sync->trigger_chan, sync);
+		return ret;
+	}
+	sync->__trigger = entry->trigger;
+
+	// The trigger channel only drives its internal reference, the pin does not have to be mapped
+	sync->__compare = trigger_compare(sync, &oc_mode);
+	sConfigOC.OCMode = oc_mode;
+	sConfigOC.Pulse = sync->__compare;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	if (HAL_TIM_PWM_ConfigChannel(tim->htim, &sConfigOC, TIM_HAL_CHANNEL(sync->trigger_chan)) != HAL_OK) {
+		Timer_Release_Channel(tim, sync->trigger_chan, sync);
+		return FAIL_TRIGGER_CONFIG;
+	}
+
+	// One sequence of every channel per rising trigger edge
+	hadc->Init.ExternalTrigConv = sync->__trigger;
+	hadc->Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+	hadc->Init.ContinuousConvMode = DISABLE;
+	hadc->Init.DiscontinuousConvMode = DISABLE;
+	hadc->Init.ScanConvMode = (sync->adc->num_channels > 1) ? ENABLE : DISABLE;
+	hadc->Init.NbrOfConversion = sync->adc->num_channels;
+	hadc->Init.DMAContinuousRequests = (hadc->DMA_Handle != NULL) ? ENABLE : DISABLE;
+	hadc->Init.EOCSelection = (hadc->DMA_Handle != NULL) ? ADC_EOC_SEQ_CONV : ADC_EOC_SINGLE_CONV;
+	if (HAL_ADC_Init(hadc) != HAL_OK) {
+		Timer_Release_Channel(tim, sync->trigger_chan, sync);
+		return FAIL_ADC_INIT;
+	}
+
+	for (uint8_t i = 0; i < sync->adc->num_channels; i++) {
+		ADC_Channel_st* channel = &sync->adc->channels[i];
+
+		if (ADC_Get_Hal_Channel(channel->channel_number, &sConfig.Channel) != ADC_OK) {
+			Timer_Release_Channel(tim, sync->trigger_chan, sync);
+			return INVALID_CHANNEL_NUMBER;
+		}
+		sConfig.Rank = i + 1;
+		// ADC_Sample_Time_et starts at ADC_3CYCLES for the first HAL sampling time
+		sConfig.SamplingTime = (channel->sample_time >= ADC_3CYCLES) ? (uint32_t)(channel->sample_time - ADC_3CYCLES) : ADC_SAMPLETIME_28CYCLES;
+		if (HAL_ADC_ConfigChannel(hadc, &sConfig) != HAL_OK) {
+			Timer_Release_Channel(tim, sync->trigger_chan, sync);
+			return FAIL_ADC_INIT;
+		}
+	}
+
+	sync->__index = 0;
+	sync->__num_conversions = 0;
+
+	return ADC_OK;
+}
+
+// ADC_Sync_Start starts the trigger channel and arms the adc, it then converts on every pwm period without the CPU
+ADC_Ret_et ADC_Sync_Start(ADC_Sync_st* sync) {
+	Timer_st* tim = sync->pwm->tim;
+	ADC_HandleTypeDef* hadc = sync->adc->hadc;
+	HAL_StatusTypeDef status;
+
+	// ADC_Sync_Stop gave the trigger channel back
+	if (Timer_Claim_Channel(tim, sync->trigger_chan, sync) != TIM_OK) { return TRIGGER_IN_USE; }
+	if (HAL_TIM_PWM_Start(tim->htim, TIM_HAL_CHANNEL(sync->trigger_chan)) != HAL_OK) { return FAIL_TRIGGER_CONFIG; }
+
+	sync->__index = 0;
+	sync->__num_conversions = 0;
+
+	if (hadc->DMA_Handle != NULL) {
+		status = HAL_ADC_Start_DMA(hadc, (uint32_t*)sync->samples, sync->adc->num_channels);
+	}
+	else {
+		status = HAL_ADC_Start_IT(hadc);
+	}
+
+	return (status == HAL_OK) ? ADC_OK : FAIL_ADC_START;
+}
+
+// ADC_Sync_Stop stops the triggered conversions and the trigger channel, and frees the channel
+ADC_Ret_et ADC_Sync_Stop(ADC_Sync_st* sync) {
+	Timer_st* tim = sync->pwm->tim;
+	ADC_HandleTypeDef* hadc = sync->adc->hadc;
+	HAL_StatusTypeDef status;
+
+	if (hadc->DMA_Handle != NULL) {
+		status = HAL_ADC_Stop_DMA(hadc);
+	}
+	else {
+		status = HAL_ADC_Stop_IT(hadc);
+	}
+	if (status != HAL_OK) { return ADC_READING_FAILED; }
+
+	if (HAL_TIM_PWM_Stop(tim->htim, TIM_HAL_CHANNEL(sync->trigger_chan)) != HAL_OK) { return FAIL_TRIGGER_CONFIG; }
+	Timer_Release_Channel(tim, sync->trigger_chan, sync);
+
+	return ADC_OK;
+}
+
+// ADC_Sync_Update moves the sample point after the pwm duty changed
+void ADC_Sync_Update(ADC_Sync_st* sync) {
+	uint32_t oc_mode;
+
+	sync->__compare = trigger_compare(sync, &oc_mode);
+	__HAL_TIM_SET_COMPARE(sync->pwm->tim->htim, TIM_HAL_CHANNEL(sync->trigger_chan), sync->__compare);
+}
+
+// ADC_Sync_Conversion_Complete must be called from HAL_ADC_ConvCpltCallback
+void ADC_Sync_Conversion_Complete(ADC_Sync_st* sync, ADC_HandleTypeDef* hadc) {
+	if (hadc != sync->adc->hadc) {
+		return;
+	}
+
+	if (hadc->DMA_Handle == NULL) {
+		sync->samples[0] = (uint16_t)HAL_ADC_GetValue(hadc);
+	}
+
+	// Channel buffers are used as rings so the averaging functions always see the latest samples
+	for (uint8_t i = 0; i < sync->adc->num_channels; i++) {
+		ADC_Channel_st* channel = &sync->adc->channels[i];
+
+		if (channel->buffer_len != 0) {
+			channel->buffer[sync->__index % channel->buffer_len] = sync->samples[i];
+		}
+	}
+
+	sync->__index++;
+	sync->__num_conversions++;
+}
+
+// ADC_Sync_Get_Num_Conversions returns the number of conversion sequences completed since ADC_Sync_Start
+uint32_t ADC_Sync_Get_Num_Conversions(ADC_Sync_st* sync) {
+	return sync->__num_conversions;
+}
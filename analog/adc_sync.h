@@ -0,0 +1,72 @@
+/*
+ * adc_sync.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_ADC_SYNC_H_
+#define INC_ADC_SYNC_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "adc_lib.h"
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// Point of the pwm period where the channels are sampled
+typedef enum {
+	// Middle of the time the pwm output is high
+	SYNC_HIGH_CENTER = 1,
+	// Middle of the time the pwm output is low
+	SYNC_LOW_CENTER,
+}ADC_Sync_Point_et;
+
+// ADC_Sync_st starts one conversion of every adc channel at the same point of each pwm period, away from the
+// switching edges
+typedef struct {
+	// ADC module, initialized with ADC_Init. Its channels are converted in order on every trigger
+	ADC_st* adc;
+	// PWM the samples are aligned to. Must be running (PWM_Init)
+	PWM_st* pwm;
+	// Spare channel of the pwm's timer that generates the trigger. It is claimed and cannot drive a pwm
+	uint8_t trigger_chan;
+	// Where in the period to sample
+	ADC_Sync_Point_et point;
+	// Starts the conversion this many nanoseconds early so the sampling window is centered on the sample point
+	uint32_t lead_ns;
+	// Latest reading of every channel, in channel order. Written by the adc DMA when the module has one, so it
+	// must match the DMA memory width (half word)
+	uint16_t* samples;
+	// DO NOT WRITE. Trigger source, trigger compare value and the next index of the channel buffers
+	uint32_t __trigger;
+	uint32_t __compare;
+	uint16_t __index;
+	// DO NOT WRITE. Number of completed conversion sequences
+	volatile uint32_t __num_conversions;
+}ADC_Sync_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// ADC_Sync_Init routes the trigger channel of the pwm's timer to the adc and configures the conversion sequence
+ADC_Ret_et ADC_Sync_Init(ADC_Sync_st* sync);
+
+// ADC_Sync_Start starts the trigger channel and arms the adc, it then converts on every pwm period without the CPU
+ADC_Ret_et ADC_Sync_Start(ADC_Sync_st* sync);
+
+// ADC_Sync_Stop stops the triggered conversions and the trigger channel, and frees the channel
+ADC_Ret_et ADC_Sync_Stop(ADC_Sync_st* sync);
+
+// ADC_Sync_Update moves the sample point after the pwm duty changed (up counting timers only, the center of a
+// center aligned pwm does not depend on the duty)
+void ADC_Sync_Update(ADC_Sync_st* sync);
+
+// ADC_Sync_Conversion_Complete must be called from HAL_ADC_ConvCpltCallback. It copies the readings into the
+// channel buffers so Get_Single_Chan_Average and Power_Add_Buffers work on synchronized samples
+void ADC_Sync_Conversion_Complete(ADC_Sync_st* sync, ADC_HandleTypeDef* hadc);
+
+// ADC_Sync_Get_Num_Conversions returns the number of conversion sequences completed since ADC_Sync_Start
+uint32_t ADC_Sync_Get_Num_Conversions(ADC_Sync_st* sync);
+
+#endif /* INC_ADC_SYNC_H_ */
@@ -0,0 +1,72 @@
+/*
+ * adc_watchdog.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	ADC analog watchdog feeding the break logic of an advanced timer.
+ *
+ *	The watchdog compares every conversion of the channel in hardware, the CPU only runs when the reading leaves the
+ *	window. The interrupt then generates a software break, which takes the outputs to the same safe state as a break
+ *	input and is rearmed the same way (Timer_Break_Rearm).
+ *	The adc watchdog has no internal connection to the timer break inputs on this family, so the reaction time is the
+ *	conversion time plus the interrupt latency. A comparator wired to BKIN / BKIN2 reacts within nanoseconds and
+ *	should be the primary protection, the watchdog a second line or a cheaper option for slower faults.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "adc_watchdog.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define MAX_RAW_READING			((1U << NUM_ADC_BITS) - 1)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Returns a boolean to see if a channel number is part of the adc module
+static uint8_t has_channel(ADC_st* adc, uint8_t channel) {
+	for (uint8_t i = 0; i < adc->num_channels; i++) {
+		if (adc->channels[i].channel_number == channel) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// ADC_Watchdog_Init configures the analog watchdog of the module on the channel with its interrupt enabled
+ADC_Ret_et ADC_Watchdog_Init(ADC_Watchdog_st* wd) {
+	ADC_AnalogWDGConfTypeDef sConfig = {0};
+
+	if (!wd->tim->__metadata.tim_initialized) { return TIMER_UNINIT; }
+	if (wd->tim->__metadata.tim_type != ADVANCED_TIMER) { return BREAK_UNSUPPORTED; }
+	if ((ADC_Get_Hal_Channel(wd->channel, &sConfig.Channel) != ADC_OK) || !has_channel(wd->adc, wd->channel)) {
+		return CHANNEL_NOT_FOUND;
+	}
+	if ((wd->low > wd->high) || (wd->high > MAX_RAW_READING)) { return INVALID_THRESHOLD; }
+
+	// The timer may have no break input, the software break then needs the off state and break interrupt
+	if (Timer_Break_Arm(wd->tim) != TIM_OK) { return BREAK_UNSUPPORTED; }
+
+	sConfig.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
+	sConfig.LowThreshold = wd->low;
+	sConfig.HighThreshold = wd->high;
+	sConfig.ITMode = ENABLE;
+	if (HAL_ADC_AnalogWDGConfig(wd->adc->hadc, &sConfig) != HAL_OK) { return FAIL_ADC_INIT; }
+
+	return ADC_OK;
+}
+
+// ADC_Watchdog_Callback must be called from HAL_ADC_LevelOutOfWindowCallback. The break is counted by
+// Timer_Break_Callback like any other break event
+void ADC_Watchdog_Callback(ADC_Watchdog_st* wd, ADC_HandleTypeDef* hadc) {
+	if (hadc != wd->adc->hadc) {
+		return;
+	}
+
+	// Every conversion out of the window interrupts again, only the first one has outputs left to shut down
+	if (wd->tim->htim->Instance->BDTR & TIM_BDTR_MOE) {
+		Timer_Break_Trigger(wd->tim);
+	}
+}
@@ -0,0 +1,41 @@
+/*
+ * adc_watchdog.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_ADC_WATCHDOG_H_
+#define INC_ADC_WATCHDOG_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "adc_lib.h"
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// ADC_Watchdog_st shuts the pwm outputs of an advanced timer down through its break logic when a channel leaves a
+// window, e.g. on overcurrent
+typedef struct {
+	// ADC module converting the channel, initialized with ADC_Init or ADC_Sync_Init
+	ADC_st* adc;
+	// Channel number guarded by the watchdog
+	uint8_t channel;
+	// Raw readings below low or above high trip the watchdog
+	uint16_t low;
+	uint16_t high;
+	// Advanced timer whose outputs are shut down (Timer_Break_Trigger), armed by ADC_Watchdog_Init (Timer_Break_Arm)
+	Timer_st* tim;
+}ADC_Watchdog_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// ADC_Watchdog_Init configures the analog watchdog of the module on the channel with its interrupt enabled
+ADC_Ret_et ADC_Watchdog_Init(ADC_Watchdog_st* wd);
+
+// ADC_Watchdog_Callback must be called from HAL_ADC_LevelOutOfWindowCallback. The break is counted by
+// Timer_Break_Callback like any other break event
+void ADC_Watchdog_Callback(ADC_Watchdog_st* wd, ADC_HandleTypeDef* hadc);
+
+#endif /* INC_ADC_WATCHDOG_H_ */
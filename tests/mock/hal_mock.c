@@ -0,0 +1,904 @@
+/*
+ * hal_mock.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Host emulation of the STM32F7 HAL functions used by the libraries.
+ *
+ *	The peripheral region is mapped at its real address before main, so the TIMx / ADCx instance pointers of main.h
+ *	are plain memory and register writes done by the libraries (macros, direct accesses) land where the HAL functions
+ *	and the tests read them. The HAL functions write the registers the same way the STM32F7 HAL does: PSC, ARR, RCR
+ *	and the counting mode on init, CCMRx / CCER / CCRx on channel configuration, BDTR on break and dead time
+ *	configuration. Functions without a register effect the libraries depend on only return HAL_OK.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "hal_mock.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PERIPH_SIZE				(0x20000UL)
+// One slot per 1 KB register block of the mapped region
+#define MOCK_TIM_SLOTS			(PERIPH_SIZE >> 10)
+#define CCER_CHANNEL_BITS		(TIM_CCER_CC1E | TIM_CCER_CC1NE)
+#define CCER_ALL_OUTPUTS		(0x5555U)
+// BDTR fields frozen by LOCK level 1 and level 2
+#define BDTR_LOCK1_BITS			(TIM_BDTR_DTG | TIM_BDTR_BKE | TIM_BDTR_BKP | TIM_BDTR_AOE | TIM_BDTR_BKF | \
+								 TIM_BDTR_BK2F | TIM_BDTR_BK2E | TIM_BDTR_BK2P)
+#define BDTR_LOCK2_BITS			(BDTR_LOCK1_BITS | TIM_BDTR_OSSR | TIM_BDTR_OSSI)
+#define BDTR_BKF_Pos			(16U)
+#define BDTR_BK2F_Pos			(20U)
+#define SR_COMIF				(1UL << 5)
+
+/*----------TYPEDEFS----------*/
+
+// Timer state that has no register
+typedef struct {
+	uint32_t rep_count;
+	uint32_t bdtr_writes;
+	// BDTR bits frozen by the first write and their values
+	uint32_t bdtr_frozen;
+	uint32_t bdtr_locked;
+	// An update event happened in the last Mock_Tim_Count (or since, from EGR), pulsing the update trigger output
+	uint8_t updated;
+	// Level of the trigger input at the last Mock_Tim_Slave_Count
+	uint8_t trgi;
+	// Levels of TI1 - TI4 (bits 0 - 3) after the last Mock_Tim_Input_Edge
+	uint8_t ti_levels;
+}mock_tim_st;
+
+/*----------PUBLIC VARIABLES----------*/
+
+uint32_t mock_primask;
+DWT_Type mock_dwt;
+CoreDebug_Type mock_core_debug;
+RCC_TypeDef mock_rcc;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static mock_tim_st tims[MOCK_TIM_SLOTS];
+static uint32_t hclk_hz = MOCK_DEFAULT_HCLK_HZ;
+// HAL calls left until the one that fails, 0 when none fails
+static uint32_t hal_fail_after;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Maps the peripheral region at its real address, before any constructor or test touches a register
+__attribute__((constructor)) static void map_peripherals(void) {
+	void* p = mmap((void*)PERIPH_BASE, PERIPH_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if (p != (void*)PERIPH_BASE) {
+		fprintf(stderr, "hal_mock: cannot map the peripherals at 0x%08lx\n", PERIPH_BASE);
+		abort();
+	}
+	Mock_Reset();
+}
+
+// Status of a HAL call, HAL_ERROR for the call Mock_Hal_Fail_After picked. The call still writes its registers
+static HAL_StatusTypeDef hal_status(void) {
+	if (hal_fail_after == 0) {
+		return HAL_OK;
+	}
+	hal_fail_after--;
+	return (hal_fail_after == 0) ? HAL_ERROR : HAL_OK;
+}
+
+static mock_tim_st* tim_state(TIM_TypeDef* regs) {
+	return &tims[((uintptr_t)regs - PERIPH_BASE) >> 10];
+}
+
+// Encodes an APB prescaler in a PPREx field: 0xx not divided, 100 /2, 101 /4, 110 /8, 111 /16
+static uint32_t ppre_bits(uint32_t div) {
+	uint32_t bits = 0;
+
+	if (div <= 1) {
+		return 0;
+	}
+	while ((2U << bits) < div) {
+		bits++;
+	}
+	return 0x4U | bits;
+}
+
+static uint32_t apb_div(uint32_t ppre) {
+	return (ppre & 0x4U) ? (2U << (ppre & 0x3U)) : 1U;
+}
+
+// Counter value without the UIF copy
+static uint32_t counter(TIM_TypeDef* regs) {
+	return (regs->CR1 & TIM_CR1_UIFREMAP) ? (regs->CNT & ~TIM_CNT_UIFCPY) : regs->CNT;
+}
+
+static void write_counter(TIM_TypeDef* regs, uint32_t cnt) {
+	if ((regs->CR1 & TIM_CR1_UIFREMAP) && (regs->SR & TIM_SR_UIF)) {
+		cnt |= TIM_CNT_UIFCPY;
+	}
+	regs->CNT = cnt;
+}
+
+// Update event: reloads the repetition counter and sets UIF unless update_flag is cleared (UG with URS set)
+static void update_event(TIM_TypeDef* regs, uint8_t update_flag) {
+	if (update_flag) {
+		regs->SR |= TIM_SR_UIF;
+	}
+	tim_state(regs)->updated = 1;
+	tim_state(regs)->rep_count = IS_TIM_REPETITION_COUNTER_INSTANCE(regs) ? regs->RCR : 0;
+}
+
+// CCxS of a channel (1 - 4): 0 for an output, the input selection otherwise
+static uint32_t capture_selection(TIM_TypeDef* regs, uint8_t chan_num) {
+	uint32_t ccmr = (chan_num <= 2) ? regs->CCMR1 : regs->CCMR2;
+
+	return (ccmr >> (((chan_num - 1U) & 1U) * 8U)) & TIM_CCMR1_CC1S;
+}
+
+// Overflow or underflow: an update event once the repetition counter reaches 0
+static void counter_event(TIM_TypeDef* regs) {
+	mock_tim_st* t = tim_state(regs);
+
+	if (regs->CR1 & TIM_CR1_UDIS) {
+		return;
+	}
+	if (t->rep_count != 0) {
+		t->rep_count--;
+		return;
+	}
+
+	update_event(regs, 1);
+	if (regs->CR1 & TIM_CR1_OPM) {
+		regs->CR1 &= ~TIM_CR1_CEN;
+	}
+}
+
+// TIM_Base_SetConfig
+static void base_set_config(TIM_HandleTypeDef* htim) {
+	TIM_TypeDef* regs = htim->Instance;
+
+	regs->CR1 = (regs->CR1 & ~(TIM_CR1_DIR | TIM_CR1_CMS | TIM_CR1_CKD | TIM_CR1_ARPE)) |
+			htim->Init.CounterMode | htim->Init.ClockDivision | htim->Init.AutoReloadPreload;
+	regs->ARR = htim->Init.Period;
+	regs->PSC = htim->Init.Prescaler;
+	if (IS_TIM_REPETITION_COUNTER_INSTANCE(regs)) {
+		regs->RCR = htim->Init.RepetitionCounter;
+	}
+	regs->EGR = TIM_EGR_UG;
+	Mock_Tim_Apply_Events(regs);
+
+	htim->State = HAL_TIM_STATE_READY;
+}
+
+// TIM_OCx_SetConfig
+static void oc_set_config(TIM_TypeDef* regs, const TIM_OC_InitTypeDef* sConfig, uint32_t Channel) {
+	volatile uint32_t* ccmr = &(&regs->CCMR1)[Channel >> 3];
+	uint32_t shift = (Channel & 4U) << 1;
+	uint32_t npolarity = IS_TIM_BREAK_INSTANCE(regs) ? sConfig->OCNPolarity : 0;
+
+	*ccmr = (*ccmr & ~((TIM_CCMR1_OC1M | TIM_CCMR1_CC1S | TIM_CCMR1_OC1FE) << shift)) |
+			((sConfig->OCMode | sConfig->OCFastMode) << shift);
+	regs->CCER = (regs->CCER & ~((TIM_CCER_CC1P | TIM_CCER_CC1NP) << Channel)) |
+			((sConfig->OCPolarity | npolarity) << Channel);
+	(&regs->CCR1)[Channel >> 2] = sConfig->Pulse;
+}
+
+static void channel_start(TIM_HandleTypeDef* htim, uint32_t ccer_bit, uint32_t Channel) {
+	TIM_TypeDef* regs = htim->Instance;
+
+	regs->CCER |= ccer_bit << Channel;
+	if (IS_TIM_BREAK_INSTANCE(regs)) {
+		regs->BDTR |= TIM_BDTR_MOE;
+	}
+	regs->CR1 |= TIM_CR1_CEN;
+}
+
+// The outputs and the counter are only disabled once no channel is left enabled
+static void channel_stop(TIM_HandleTypeDef* htim, uint32_t ccer_bit, uint32_t Channel) {
+	TIM_TypeDef* regs = htim->Instance;
+
+	regs->CCER &= ~(ccer_bit << Channel);
+	if ((regs->CCER & CCER_ALL_OUTPUTS) == 0) {
+		if (IS_TIM_BREAK_INSTANCE(regs)) {
+			regs->BDTR &= ~TIM_BDTR_MOE;
+		}
+		regs->CR1 &= ~TIM_CR1_CEN;
+	}
+}
+
+// One encoder count up or down over the ARR range, with the update event of the wrap. DIR follows the direction
+static void encoder_count(TIM_TypeDef* regs, uint8_t up) {
+	uint32_t cnt = counter(regs);
+	uint32_t arr = regs->ARR;
+
+	if (up) {
+		regs->CR1 &= ~TIM_CR1_DIR;
+		cnt = (cnt >= arr) ? 0 : (cnt + 1);
+	}
+	else {
+		regs->CR1 |= TIM_CR1_DIR;
+		cnt = (cnt == 0) ? arr : (cnt - 1);
+	}
+	if (cnt == (up ? 0 : arr)) {
+		counter_event(regs);
+	}
+	write_counter(regs, cnt);
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Mock_Reset clears every peripheral register and the mock state, and restores the default clock tree
+void Mock_Reset(void) {
+	memset((void*)PERIPH_BASE, 0, PERIPH_SIZE);
+	memset(tims, 0, sizeof(tims));
+	memset(&mock_dwt, 0, sizeof(mock_dwt));
+	memset(&mock_core_debug, 0, sizeof(mock_core_debug));
+	memset(&mock_rcc, 0, sizeof(mock_rcc));
+	mock_primask = 0;
+	hal_fail_after = 0;
+
+	Mock_Set_Clocks(MOCK_DEFAULT_HCLK_HZ, MOCK_DEFAULT_APB1_DIV, MOCK_DEFAULT_APB2_DIV, 0);
+}
+
+// Mock_Set_Clocks sets HCLK, the APB prescalers (1, 2, 4, 8 or 16) and RCC_DCKCFGR1_TIMPRE
+void Mock_Set_Clocks(uint32_t hclk, uint32_t apb1_div, uint32_t apb2_div, uint8_t timpre) {
+	hclk_hz = hclk;
+	RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) |
+			(ppre_bits(apb1_div) << RCC_CFGR_PPRE1_Pos) | (ppre_bits(apb2_div) << RCC_CFGR_PPRE2_Pos);
+	RCC->DCKCFGR1 = timpre ? RCC_DCKCFGR1_TIMPRE : 0;
+}
+
+// Mock_Tim_Apply_Events applies the bits written to EGR (UG, CCxG, BG, B2G, COMG) and clears the register
+void Mock_Tim_Apply_Events(TIM_TypeDef* regs) {
+	uint32_t egr = regs->EGR;
+	mock_tim_st* t = tim_state(regs);
+
+	// Direct writes can not change what the first BDTR write locked
+	if (t->bdtr_writes != 0) {
+		regs->BDTR = (regs->BDTR & ~t->bdtr_frozen) | t->bdtr_locked;
+	}
+	regs->EGR = 0;
+	if (egr & TIM_EGR_UG) {
+		// Edge aligned down counters restart from ARR, everything else from 0
+		uint8_t down = ((regs->CR1 & (TIM_CR1_CMS | TIM_CR1_DIR)) == TIM_CR1_DIR);
+
+		update_event(regs, !(regs->CR1 & TIM_CR1_URS));
+		write_counter(regs, down ? regs->ARR : 0);
+	}
+	// CC1G - CC4G sit at the bits of CC1IF - CC4IF
+	regs->SR |= egr & (0xFUL * TIM_EGR_CC1G);
+	if (egr & (TIM_EGR_BG | TIM_EGR_B2G)) {
+		regs->BDTR &= ~TIM_BDTR_MOE;
+		regs->SR |= ((egr & TIM_EGR_BG) ? TIM_SR_BIF : 0) | ((egr & TIM_EGR_B2G) ? TIM_SR_B2IF : 0);
+	}
+	if (egr & TIM_EGR_COMG) {
+		regs->SR |= SR_COMIF;
+	}
+}
+
+// Mock_Tim_Count advances an enabled counter by one count
+void Mock_Tim_Count(TIM_TypeDef* regs) {
+	uint32_t cnt;
+	uint32_t arr = regs->ARR;
+
+	tim_state(regs)->updated = 0;
+	Mock_Tim_Apply_Events(regs);
+	if (!(regs->CR1 & TIM_CR1_CEN)) {
+		return;
+	}
+
+	cnt = counter(regs);
+	if ((regs->CR1 & TIM_CR1_CMS) == 0) {
+		if (regs->CR1 & TIM_CR1_DIR) {
+			cnt = (cnt == 0) ? arr : (cnt - 1);
+			if (cnt == arr) {
+				counter_event(regs);
+			}
+		}
+		else {
+			cnt = (cnt >= arr) ? 0 : (cnt + 1);
+			if (cnt == 0) {
+				counter_event(regs);
+			}
+		}
+	}
+	else {
+		// Center aligned: 0 up to ARR, overflow, back down to 0, underflow. DIR is set by the hardware
+		if (regs->CR1 & TIM_CR1_DIR) {
+			cnt = (cnt == 0) ? 0 : (cnt - 1);
+			if (cnt == 0) {
+				regs->CR1 &= ~TIM_CR1_DIR;
+				counter_event(regs);
+			}
+		}
+		else {
+			cnt++;
+			if (cnt >= arr) {
+				cnt = arr;
+				regs->CR1 |= TIM_CR1_DIR;
+				counter_event(regs);
+			}
+		}
+	}
+
+	// Input channels (CCxS set) only flag captures
+	for (uint8_t c = 0; c < 4; c++) {
+		if ((cnt == (&regs->CCR1)[c]) && (capture_selection(regs, c + 1U) == 0)) {
+			regs->SR |= TIM_SR_CC1IF << c;
+		}
+	}
+	write_counter(regs, cnt);
+}
+
+// Mock_Tim_OC_Ref returns OCxREF (0 / 1) of a channel (1 - 4) at the current counter value
+uint8_t Mock_Tim_OC_Ref(TIM_TypeDef* regs, uint8_t chan_num) {
+	uint32_t ccmr = (chan_num <= 2) ? regs->CCMR1 : regs->CCMR2;
+	uint32_t shift = ((chan_num - 1U) & 1U) * 8U;
+	uint32_t field = ccmr >> shift;
+	uint32_t mode = ((field & 0x70U) >> 4) | ((field >> 13) & 0x8U);
+	uint32_t cnt = counter(regs);
+	uint32_t ccr = (&regs->CCR1)[chan_num - 1];
+	// Down counting (also the second half of a center aligned period) is active up to and including CCR
+	uint8_t active = (regs->CR1 & TIM_CR1_DIR) ? (cnt <= ccr) : (cnt < ccr);
+
+	switch(mode) {
+		case(4):
+			return 0;
+		case(5):
+			return 1;
+		case(6):
+			return active;
+		case(7):
+			return !active;
+		default:
+			return 0;
+	}
+}
+
+// Mock_Tim_Output returns the level of OCx or OCxN from OCxREF, CCER and MOE
+uint8_t Mock_Tim_Output(TIM_TypeDef* regs, uint8_t chan_num, uint8_t complementary) {
+	uint32_t ccer = regs->CCER >> ((chan_num - 1U) * 4U);
+	uint8_t ref = Mock_Tim_OC_Ref(regs, chan_num);
+
+	if (IS_TIM_BREAK_INSTANCE(regs) && !(regs->BDTR & TIM_BDTR_MOE)) {
+		return 0;
+	}
+
+	if (!complementary) {
+		if (!(ccer & TIM_CCER_CC1E)) {
+			return 0;
+		}
+		return ref ^ ((ccer & TIM_CCER_CC1P) != 0);
+	}
+
+	if (!(ccer & TIM_CCER_CC1NE)) {
+		return 0;
+	}
+	// OCxN is the inverse of OCxREF only while OCx is enabled too
+	if (ccer & TIM_CCER_CC1E) {
+		ref = !ref;
+	}
+	return ref ^ ((ccer & TIM_CCER_CC1NP) != 0);
+}
+
+// Mock_Tim_TRGO returns the trigger output (0 / 1) of a master timer selected by MMS
+uint8_t Mock_Tim_TRGO(TIM_TypeDef* regs) {
+	uint32_t mms = regs->CR2 & TIM_CR2_MMS;
+
+	switch(mms) {
+		case(TIM_TRGO_RESET):
+		case(TIM_TRGO_UPDATE):
+			return tim_state(regs)->updated;
+		case(TIM_TRGO_ENABLE):
+			return (regs->CR1 & TIM_CR1_CEN) ? 1 : 0;
+		case(TIM_TRGO_OC1REF):
+		case(TIM_TRGO_OC2REF):
+		case(TIM_TRGO_OC3REF):
+		case(TIM_TRGO_OC4REF):
+			return Mock_Tim_OC_Ref(regs, (uint8_t)((mms - TIM_TRGO_OC1REF) >> 4) + 1U);
+		default:
+			return 0;
+	}
+}
+
+// Mock_Tim_Slave_Count advances a slave timer by one count with its trigger input at trgi
+void Mock_Tim_Slave_Count(TIM_TypeDef* regs, uint8_t trgi) {
+	mock_tim_st* t = tim_state(regs);
+	uint32_t sms = regs->SMCR & TIM_SMCR_SMS;
+	uint8_t edge = trgi && !t->trgi;
+
+	t->trgi = trgi;
+	switch(sms) {
+		case(TIM_SLAVEMODE_TRIGGER):
+			if (edge) {
+				regs->CR1 |= TIM_CR1_CEN;
+			}
+			break;
+		case(TIM_SLAVEMODE_COMBINED_RESETTRIGGER):
+		case(TIM_SLAVEMODE_RESET):
+			if (!edge) {
+				break;
+			}
+			// The counter restarts instead of counting
+			if (sms == TIM_SLAVEMODE_COMBINED_RESETTRIGGER) {
+				regs->CR1 |= TIM_CR1_CEN;
+			}
+			t->updated = 0;
+			Mock_Tim_Apply_Events(regs);
+			update_event(regs, !(regs->CR1 & TIM_CR1_URS));
+			write_counter(regs, ((regs->CR1 & (TIM_CR1_CMS | TIM_CR1_DIR)) == TIM_CR1_DIR) ? regs->ARR : 0);
+			return;
+		case(TIM_SLAVEMODE_GATED):
+		case(TIM_SLAVEMODE_EXTERNAL1):
+			// Not clocked: only the events are applied
+			if ((sms == TIM_SLAVEMODE_GATED) ? !trgi : !edge) {
+				t->updated = 0;
+				Mock_Tim_Apply_Events(regs);
+				return;
+			}
+			break;
+		default:
+			break;
+	}
+
+	Mock_Tim_Count(regs);
+}
+
+// Mock_Tim_Input_Edge applies one edge of the input TIx (1 - 4) to the capture channels, the encoder and the slave mode
+// controller
+void Mock_Tim_Input_Edge(TIM_TypeDef* regs, uint8_t ti, uint8_t rising) {
+	mock_tim_st* t = tim_state(regs);
+	uint32_t cnt = counter(regs);
+	uint32_t sms = regs->SMCR & TIM_SMCR_SMS;
+	uint32_t ts = regs->SMCR & TIM_SMCR_TS;
+
+	if (rising) {
+		t->ti_levels |= (uint8_t)(1U << (ti - 1U));
+	}
+	else {
+		t->ti_levels &= (uint8_t)~(1U << (ti - 1U));
+	}
+
+	for (uint8_t c = 1; c <= 4; c++) {
+		uint32_t ccer = regs->CCER >> ((c - 1U) * 4U);
+		uint32_t ccs = capture_selection(regs, c);
+		// The channels of a pair (1 - 2, 3 - 4) capture their own input directly or the other one's indirectly
+		uint8_t pair = (uint8_t)(((c - 1U) ^ 1U) + 1U);
+		uint8_t selected = ((ccs == TIM_ICSELECTION_DIRECTTI) && (c == ti)) ||
+				((ccs == TIM_ICSELECTION_INDIRECTTI) && (pair == ti));
+		uint8_t falling = (ccer & TIM_CCER_CC1P) != 0;
+
+		if (!selected || !(ccer & TIM_CCER_CC1E) || (falling == rising)) {
+			continue;
+		}
+
+		(&regs->CCR1)[c - 1] = cnt;
+		// Capturing over a value that was not read yet is an overcapture
+		if (regs->SR & (TIM_SR_CC1IF << (c - 1U))) {
+			regs->SR |= TIM_SR_CC1OF << (c - 1U);
+		}
+		regs->SR |= TIM_SR_CC1IF << (c - 1U);
+	}
+
+	// Encoder mode 1 counts the edges of TI1FP1, mode 2 those of TI2FP2 and mode 3 both. After an edge of TI1FP1 the
+	// counter goes up when the two inputs differ, after an edge of TI2FP2 when they are equal
+	if ((sms >= TIM_ENCODERMODE_TI1) && (sms <= TIM_ENCODERMODE_TI12) && (ti <= 2) && (sms & (1U << (ti - 1U)))) {
+		uint8_t fp1 = ((t->ti_levels & 1U) != 0) ^ ((regs->CCER & TIM_CCER_CC1P) != 0);
+		uint8_t fp2 = ((t->ti_levels & 2U) != 0) ^ (((regs->CCER >> 4) & TIM_CCER_CC1P) != 0);
+
+		if (regs->CR1 & TIM_CR1_CEN) {
+			encoder_count(regs, (ti == 1) ? (fp1 != fp2) : (fp1 == fp2));
+		}
+		return;
+	}
+
+	// TI1FP1 / TI2FP2 trigger on the polarity of the direct channel of their input
+	if (((ts == TIM_TS_TI1FP1) && (ti == 1)) || ((ts == TIM_TS_TI2FP2) && (ti == 2))) {
+		uint8_t falling = ((regs->CCER >> ((ti - 1U) * 4U)) & TIM_CCER_CC1P) != 0;
+
+		if (falling == rising) {
+			return;
+		}
+		if (sms == TIM_SLAVEMODE_RESET) {
+			update_event(regs, !(regs->CR1 & TIM_CR1_URS));
+			write_counter(regs, ((regs->CR1 & (TIM_CR1_CMS | TIM_CR1_DIR)) == TIM_CR1_DIR) ? regs->ARR : 0);
+		}
+		else if (sms == TIM_SLAVEMODE_TRIGGER) {
+			regs->CR1 |= TIM_CR1_CEN;
+		}
+	}
+}
+
+// Mock_Hal_Fail_After makes the calls-th following HAL call that returns a status fail with HAL_ERROR, 0 disables it
+void Mock_Hal_Fail_After(uint32_t calls) {
+	hal_fail_after = calls;
+}
+
+// Mock_Tim_BDTR_Writes returns the number of BDTR writes done by HAL_TIMEx_ConfigBreakDeadTime since the reset
+uint32_t Mock_Tim_BDTR_Writes(TIM_TypeDef* regs) {
+	return tim_state(regs)->bdtr_writes;
+}
+
+/*----------HAL----------*/
+
+uint32_t HAL_RCC_GetSysClockFreq(void) {
+	return hclk_hz;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void) {
+	return hclk_hz;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+	return hclk_hz / apb_div((RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos);
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+	return hclk_hz / apb_div((RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos);
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+	(void)hdma;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma) {
+	(void)hdma;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim) {
+	base_set_config(htim);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_DeInit(TIM_HandleTypeDef* htim) {
+	if ((htim->Instance->CCER & CCER_ALL_OUTPUTS) == 0) {
+		htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	}
+	htim->State = HAL_TIM_STATE_RESET;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim) {
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef* htim) {
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim) {
+	htim->Instance->DIER |= TIM_DIER_UIE;
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim) {
+	htim->Instance->DIER &= ~TIM_DIER_UIE;
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim, TIM_ClockConfigTypeDef* sClockSourceConfig) {
+	(void)htim;
+	(void)sClockSourceConfig;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim, TIM_MasterConfigTypeDef* sMasterConfig) {
+	TIM_TypeDef* regs = htim->Instance;
+	uint32_t mms = TIM_CR2_MMS | (IS_TIM_BREAK_INSTANCE(regs) ? TIM_CR2_MMS2 : 0);
+	uint32_t trgo2 = IS_TIM_BREAK_INSTANCE(regs) ? sMasterConfig->MasterOutputTrigger2 : 0;
+
+	regs->CR2 = (regs->CR2 & ~mms) | sMasterConfig->MasterOutputTrigger | trgo2;
+	regs->SMCR = (regs->SMCR & ~TIM_SMCR_MSM) | sMasterConfig->MasterSlaveMode;
+	return hal_status();
+}
+
+// The LOCK field is written once per reset, later writes keep it and the fields it protects
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef* htim, TIM_BreakDeadTimeConfigTypeDef* sBreakDeadTimeConfig) {
+	TIM_TypeDef* regs = htim->Instance;
+	mock_tim_st* t = tim_state(regs);
+	uint32_t bdtr = sBreakDeadTimeConfig->DeadTime | sBreakDeadTimeConfig->LockLevel |
+			sBreakDeadTimeConfig->OffStateIDLEMode | sBreakDeadTimeConfig->OffStateRunMode |
+			sBreakDeadTimeConfig->BreakState | sBreakDeadTimeConfig->BreakPolarity |
+			sBreakDeadTimeConfig->AutomaticOutput | (sBreakDeadTimeConfig->BreakFilter << BDTR_BKF_Pos) |
+			(sBreakDeadTimeConfig->Break2Filter << BDTR_BK2F_Pos) | sBreakDeadTimeConfig->Break2State |
+			sBreakDeadTimeConfig->Break2Polarity;
+
+	if (t->bdtr_writes == 0) {
+		uint32_t lock = (bdtr & TIM_BDTR_LOCK) >> 8;
+
+		t->bdtr_frozen = TIM_BDTR_LOCK | ((lock >= 2) ? BDTR_LOCK2_BITS : ((lock == 1) ? BDTR_LOCK1_BITS : 0));
+		t->bdtr_locked = bdtr & t->bdtr_frozen;
+	}
+
+	regs->BDTR = (bdtr & ~t->bdtr_frozen) | t->bdtr_locked;
+	t->bdtr_writes++;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIMEx_ConfigCommutEvent(TIM_HandleTypeDef* htim, uint32_t InputTrigger, uint32_t CommutationSource) {
+	htim->Instance->SMCR = (htim->Instance->SMCR & ~TIM_SMCR_TS) | (InputTrigger & TIM_SMCR_TS);
+	htim->Instance->CR2 = (htim->Instance->CR2 & ~TIM_CR2_CCUS) | TIM_CR2_CCPC | CommutationSource;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro(TIM_HandleTypeDef* htim, TIM_SlaveConfigTypeDef* sSlaveConfig) {
+	htim->Instance->SMCR = (htim->Instance->SMCR & ~(TIM_SMCR_SMS | TIM_SMCR_TS)) |
+			sSlaveConfig->SlaveMode | (sSlaveConfig->InputTrigger & TIM_SMCR_TS);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource) {
+	htim->Instance->EGR = EventSource;
+	Mock_Tim_Apply_Events(htim->Instance);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef* htim) {
+	base_set_config(htim);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel) {
+	oc_set_config(htim->Instance, sConfig, Channel);
+	__HAL_TIM_ENABLE_OCxPRELOAD(htim, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_start(htim, TIM_CCER_CC1NE, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_stop(htim, TIM_CCER_CC1NE, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef* htim) {
+	base_set_config(htim);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel) {
+	oc_set_config(htim->Instance, sConfig, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	htim->Instance->DIER |= TIM_IT_CC1 << (Channel >> 2);
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	htim->Instance->DIER &= ~(TIM_IT_CC1 << (Channel >> 2));
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef* htim) {
+	base_set_config(htim);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_IC_InitTypeDef* sConfig, uint32_t Channel) {
+	volatile uint32_t* ccmr = &(&htim->Instance->CCMR1)[Channel >> 3];
+	uint32_t shift = (Channel & 4U) << 1;
+
+	*ccmr = (*ccmr & ~(TIM_CCMR1_CC1S << shift)) | (sConfig->ICSelection << shift);
+	__HAL_TIM_SET_CAPTUREPOLARITY(htim, Channel, sConfig->ICPolarity);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	htim->Instance->DIER |= TIM_IT_CC1 << (Channel >> 2);
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	htim->Instance->DIER &= ~(TIM_IT_CC1 << (Channel >> 2));
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef* htim, uint32_t Channel, uint32_t* pData, uint16_t Length) {
+	(void)pData;
+	(void)Length;
+	channel_start(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	channel_stop(htim, TIM_CCER_CC1E, Channel);
+	return hal_status();
+}
+
+uint32_t HAL_TIM_ReadCapturedValue(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	return (&htim->Instance->CCR1)[Channel >> 2];
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef* htim, TIM_Encoder_InitTypeDef* sConfig) {
+	base_set_config(htim);
+	htim->Instance->SMCR = (htim->Instance->SMCR & ~TIM_SMCR_SMS) | sConfig->EncoderMode;
+	htim->Instance->CCMR1 = (htim->Instance->CCMR1 & ~(TIM_CCMR1_CC1S | TIM_CCMR1_CC2S)) |
+			sConfig->IC1Selection | (sConfig->IC2Selection << 8);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	(void)Channel;
+	htim->Instance->CCER |= TIM_CCER_CC1E | (TIM_CCER_CC1E << TIM_CHANNEL_2);
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	(void)Channel;
+	htim->Instance->CCER &= ~(TIM_CCER_CC1E | (TIM_CCER_CC1E << TIM_CHANNEL_2));
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OnePulse_Init(TIM_HandleTypeDef* htim, uint32_t OnePulseMode) {
+	base_set_config(htim);
+	htim->Instance->CR1 = (htim->Instance->CR1 & ~TIM_CR1_OPM) | OnePulseMode;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OnePulse_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OnePulse_InitTypeDef* sConfig, uint32_t OutputChannel, uint32_t InputChannel) {
+	TIM_OC_InitTypeDef oc = {0};
+	volatile uint32_t* ccmr = &(&htim->Instance->CCMR1)[InputChannel >> 3];
+	uint32_t shift = (InputChannel & 4U) << 1;
+
+	oc.OCMode = sConfig->OCMode;
+	oc.Pulse = sConfig->Pulse;
+	oc.OCPolarity = sConfig->OCPolarity;
+	oc.OCNPolarity = sConfig->OCNPolarity;
+	oc_set_config(htim->Instance, &oc, OutputChannel);
+
+	// The other channel of the pair takes the input, whose edge starts the counter in trigger slave mode
+	if (OutputChannel != InputChannel) {
+		*ccmr = (*ccmr & ~(TIM_CCMR1_CC1S << shift)) | (sConfig->ICSelection << shift);
+		__HAL_TIM_SET_CAPTUREPOLARITY(htim, InputChannel, sConfig->ICPolarity);
+		htim->Instance->SMCR = (htim->Instance->SMCR & ~(TIM_SMCR_TS | TIM_SMCR_SMS)) | TIM_SLAVEMODE_TRIGGER |
+				((InputChannel == TIM_CHANNEL_1) ? TIM_TS_TI1FP1 : TIM_TS_TI2FP2);
+	}
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OnePulse_Start(TIM_HandleTypeDef* htim, uint32_t OutputChannel) {
+	htim->Instance->CCER |= TIM_CCER_CC1E << OutputChannel;
+	if (IS_TIM_BREAK_INSTANCE(htim->Instance)) {
+		htim->Instance->BDTR |= TIM_BDTR_MOE;
+	}
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_OnePulse_Stop(TIM_HandleTypeDef* htim, uint32_t OutputChannel) {
+	channel_stop(htim, TIM_CCER_CC1E, OutputChannel);
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef* htim, uint32_t BurstBaseAddress, uint32_t BurstRequestSrc, uint32_t* BurstBuffer, uint32_t BurstLength, uint32_t DataLength) {
+	if ((BurstBuffer == NULL) || (DataLength == 0) || (DataLength > 0xFFFFU)) {
+		return HAL_ERROR;
+	}
+	htim->Instance->DCR = BurstBaseAddress | BurstLength;
+	htim->Instance->DIER |= BurstRequestSrc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t BurstRequestSrc) {
+	htim->Instance->DIER &= ~BurstRequestSrc;
+	return hal_status();
+}
+
+// Pin configuration generated by CubeMX, nothing to emulate
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim) {
+	(void)htim;
+}
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* sConfig) {
+	(void)hadc;
+	(void)sConfig;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef* hadc, ADC_AnalogWDGConfTypeDef* AnalogWDGConfig) {
+	hadc->Instance->HTR = AnalogWDGConfig->HighThreshold;
+	hadc->Instance->LTR = AnalogWDGConfig->LowThreshold;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_IT(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop_IT(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length) {
+	(void)hadc;
+	(void)pData;
+	(void)Length;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc) {
+	(void)hadc;
+	return hal_status();
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef* hadc, uint32_t Timeout) {
+	(void)hadc;
+	(void)Timeout;
+	return hal_status();
+}
+
+// The conversion result is whatever the test wrote to DR
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc) {
+	return hadc->Instance->DR;
+}
+
+void Error_Handler(void) {
+	fprintf(stderr, "hal_mock: Error_Handler\n");
+	abort();
+}
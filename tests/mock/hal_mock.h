@@ -0,0 +1,73 @@
+/*
+ * hal_mock.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef INC_HAL_MOCK_H_
+#define INC_HAL_MOCK_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "main.h"
+
+/*----------MACROS & DEFINES------------*/
+
+// Clock tree after Mock_Reset: 216 MHz HCLK, APB1 / 4 and APB2 / 2
+#define MOCK_DEFAULT_HCLK_HZ			(216000000U)
+#define MOCK_DEFAULT_APB1_DIV			(4U)
+#define MOCK_DEFAULT_APB2_DIV			(2U)
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+// Mock_Reset clears every peripheral register and the mock state, and restores the default clock tree
+void Mock_Reset(void);
+
+// Mock_Set_Clocks sets HCLK, the APB prescalers (1, 2, 4, 8 or 16) and RCC_DCKCFGR1_TIMPRE
+void Mock_Set_Clocks(uint32_t hclk_hz, uint32_t apb1_div, uint32_t apb2_div, uint8_t timpre);
+
+// Mock_Tim_Count advances an enabled counter by one count (PSC + 1 timer clock ticks). Emulates up, down and center
+// aligned counting, the repetition counter of TIM1 / TIM8, UIF / CCxIF of output channels, one pulse mode and the UIF
+// copy in CNT. Event generation bits written to EGR are applied first. Preload registers are not shadowed, writes to
+// ARR, CCRx and PSC take effect immediately
+void Mock_Tim_Count(TIM_TypeDef* regs);
+
+// Mock_Tim_Apply_Events applies the bits written to EGR (UG, CCxG, BG, B2G, COMG) and clears the register. Direct
+// writes to BDTR fields locked by the first HAL_TIMEx_ConfigBreakDeadTime are undone
+void Mock_Tim_Apply_Events(TIM_TypeDef* regs);
+
+// Mock_Tim_OC_Ref returns OCxREF (0 / 1) of a channel (1 - 4) at the current counter value. Frozen and the
+// one shot compare modes read as 0
+uint8_t Mock_Tim_OC_Ref(TIM_TypeDef* regs, uint8_t chan_num);
+
+// Mock_Tim_Output returns the level of OCx, or OCxN when complementary is set, from OCxREF, CCER and MOE. Disabled
+// outputs and outputs of a timer with MOE cleared read as 0, dead time is not emulated
+uint8_t Mock_Tim_Output(TIM_TypeDef* regs, uint8_t chan_num, uint8_t complementary);
+
+// Mock_Tim_TRGO returns the trigger output (0 / 1) of a master timer after its last Mock_Tim_Count: CEN for the enable
+// trigger, a pulse for an update event (reset and update triggers, from UG too) or OC1REF - OC4REF. Others read 0
+uint8_t Mock_Tim_TRGO(TIM_TypeDef* regs);
+
+// Mock_Tim_Slave_Count advances a slave timer by one count of its master with its trigger input (TRGI) at trgi, in
+// place of Mock_Tim_Count. Which ITRx line SMCR selects is not checked. On a rising edge the trigger mode sets CEN and
+// counts, the reset modes restart the counter with an update event instead of counting (and set CEN when combined
+// with trigger). Gated slaves only count while trgi is high, external clock mode 1 slaves count its rising edges
+void Mock_Tim_Slave_Count(TIM_TypeDef* regs, uint8_t trgi);
+
+// Mock_Tim_Input_Edge applies a rising or falling edge of the input TIx (1 - 4). Enabled capture channels selecting TIx
+// (directly or from the other channel of their pair) with that polarity latch the counter and set CCxIF, or CCxOF
+// too when CCxIF was still set. The reset slave mode on TI1FP1 / TI2FP2 restarts the counter, with an update flag
+// unless URS is set, and the trigger slave mode starts it. The encoder modes count the edges of TI1 / TI2 up or down
+// with the level of the other input, wrapping over ARR. Input filters and prescalers are not emulated
+void Mock_Tim_Input_Edge(TIM_TypeDef* regs, uint8_t ti, uint8_t rising);
+
+// Mock_Tim_BDTR_Writes returns the number of BDTR writes done by HAL_TIMEx_ConfigBreakDeadTime since the reset.
+// The LOCK field is write once like on target: only the first write after a reset sets it, even to 0
+uint32_t Mock_Tim_BDTR_Writes(TIM_TypeDef* regs);
+
+// Mock_Hal_Fail_After makes the calls-th following HAL call that returns a status fail with HAL_ERROR, e.g. 1 for the
+// next one. The failing call still applies its register writes. 0 disables it, as does Mock_Reset
+void Mock_Hal_Fail_After(uint32_t calls);
+
+#endif /* INC_HAL_MOCK_H_ */
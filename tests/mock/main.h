@@ -0,0 +1,757 @@
+/*
+ * main.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Host stand-in for the STM32F7 HAL, used to build and test the libraries on Linux.
+ *
+ *	Only the types, registers, macros and functions the libraries use are declared. Register layouts, bit positions
+ *	and instance addresses follow the STM32F767 headers wherever the libraries depend on them (e.g. the timer
+ *	dispatch hashes instance addresses). hal_mock.c maps the peripheral region at its real address and emulates the
+ *	registers the HAL functions write, see hal_mock.h.
+*/
+
+#ifndef MAIN_H
+#define MAIN_H
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*----------CORE----------*/
+
+#define __IO					volatile
+#define __I						volatile const
+#define __O						volatile
+
+typedef enum {
+	HAL_OK = 0,
+	HAL_ERROR,
+	HAL_BUSY,
+	HAL_TIMEOUT
+}HAL_StatusTypeDef;
+
+typedef enum {
+	RESET = 0,
+	SET = !RESET
+}FlagStatus, ITStatus;
+
+typedef enum {
+	DISABLE = 0,
+	ENABLE = !DISABLE
+}FunctionalState;
+
+// Interrupt mask of the emulated core, 1 while interrupts are disabled
+extern uint32_t mock_primask;
+
+static inline uint32_t __get_PRIMASK(void) { return mock_primask; }
+static inline void __set_PRIMASK(uint32_t primask) { mock_primask = primask; }
+static inline void __disable_irq(void) { mock_primask = 1; }
+static inline void __enable_irq(void) { mock_primask = 0; }
+static inline void __DMB(void) { __sync_synchronize(); }
+static inline void __DSB(void) { __sync_synchronize(); }
+static inline void __ISB(void) { __sync_synchronize(); }
+static inline void __NOP(void) { }
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+	__O uint32_t LAR;
+	__I uint32_t LSR;
+}DWT_Type;
+
+typedef struct {
+	__IO uint32_t DHCSR;
+	__IO uint32_t DCRSR;
+	__IO uint32_t DCRDR;
+	__IO uint32_t DEMCR;
+}CoreDebug_Type;
+
+extern DWT_Type mock_dwt;
+extern CoreDebug_Type mock_core_debug;
+
+#define DWT						(&mock_dwt)
+#define CoreDebug				(&mock_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk			(1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk		(1UL << 24)
+
+/*----------PERIPHERAL REGISTERS----------*/
+
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMCR;
+	__IO uint32_t DIER;
+	__IO uint32_t SR;
+	__IO uint32_t EGR;
+	__IO uint32_t CCMR1;
+	__IO uint32_t CCMR2;
+	__IO uint32_t CCER;
+	__IO uint32_t CNT;
+	__IO uint32_t PSC;
+	__IO uint32_t ARR;
+	__IO uint32_t RCR;
+	__IO uint32_t CCR1;
+	__IO uint32_t CCR2;
+	__IO uint32_t CCR3;
+	__IO uint32_t CCR4;
+	__IO uint32_t BDTR;
+	__IO uint32_t DCR;
+	__IO uint32_t DMAR;
+	__IO uint32_t OR;
+	__IO uint32_t CCMR3;
+	__IO uint32_t CCR5;
+	__IO uint32_t CCR6;
+	__IO uint32_t AF1;
+	__IO uint32_t AF2;
+}TIM_TypeDef;
+
+typedef struct {
+	__IO uint32_t SR;
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMPR1;
+	__IO uint32_t SMPR2;
+	__IO uint32_t JOFR1;
+	__IO uint32_t JOFR2;
+	__IO uint32_t JOFR3;
+	__IO uint32_t JOFR4;
+	__IO uint32_t HTR;
+	__IO uint32_t LTR;
+	__IO uint32_t SQR1;
+	__IO uint32_t SQR2;
+	__IO uint32_t SQR3;
+	__IO uint32_t JSQR;
+	__IO uint32_t JDR1;
+	__IO uint32_t JDR2;
+	__IO uint32_t JDR3;
+	__IO uint32_t JDR4;
+	__IO uint32_t DR;
+}ADC_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR;
+	__IO uint32_t NDTR;
+	__IO uint32_t PAR;
+	__IO uint32_t M0AR;
+	__IO uint32_t M1AR;
+	__IO uint32_t FCR;
+}DMA_Stream_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR;
+	__IO uint32_t PLLCFGR;
+	__IO uint32_t CFGR;
+	__IO uint32_t CIR;
+	__IO uint32_t DCKCFGR1;
+}RCC_TypeDef;
+
+#define PERIPH_BASE				(0x40000000UL)
+#define APB1PERIPH_BASE			PERIPH_BASE
+#define APB2PERIPH_BASE			(PERIPH_BASE + 0x00010000UL)
+
+#define TIM2_BASE				(APB1PERIPH_BASE + 0x0000UL)
+#define TIM3_BASE				(APB1PERIPH_BASE + 0x0400UL)
+#define TIM4_BASE				(APB1PERIPH_BASE + 0x0800UL)
+#define TIM5_BASE				(APB1PERIPH_BASE + 0x0C00UL)
+#define TIM6_BASE				(APB1PERIPH_BASE + 0x1000UL)
+#define TIM7_BASE				(APB1PERIPH_BASE + 0x1400UL)
+#define TIM12_BASE				(APB1PERIPH_BASE + 0x1800UL)
+#define TIM13_BASE				(APB1PERIPH_BASE + 0x1C00UL)
+#define TIM14_BASE				(APB1PERIPH_BASE + 0x2000UL)
+#define TIM1_BASE				(APB2PERIPH_BASE + 0x0000UL)
+#define TIM8_BASE				(APB2PERIPH_BASE + 0x0400UL)
+#define ADC1_BASE				(APB2PERIPH_BASE + 0x2000UL)
+#define ADC2_BASE				(APB2PERIPH_BASE + 0x2100UL)
+#define ADC3_BASE				(APB2PERIPH_BASE + 0x2200UL)
+#define TIM9_BASE				(APB2PERIPH_BASE + 0x4000UL)
+#define TIM10_BASE				(APB2PERIPH_BASE + 0x4400UL)
+#define TIM11_BASE				(APB2PERIPH_BASE + 0x4800UL)
+
+#define TIM1					((TIM_TypeDef*)TIM1_BASE)
+#define TIM2					((TIM_TypeDef*)TIM2_BASE)
+#define TIM3					((TIM_TypeDef*)TIM3_BASE)
+#define TIM4					((TIM_TypeDef*)TIM4_BASE)
+#define TIM5					((TIM_TypeDef*)TIM5_BASE)
+#define TIM6					((TIM_TypeDef*)TIM6_BASE)
+#define TIM7					((TIM_TypeDef*)TIM7_BASE)
+#define TIM8					((TIM_TypeDef*)TIM8_BASE)
+#define TIM9					((TIM_TypeDef*)TIM9_BASE)
+#define TIM10					((TIM_TypeDef*)TIM10_BASE)
+#define TIM11					((TIM_TypeDef*)TIM11_BASE)
+#define TIM12					((TIM_TypeDef*)TIM12_BASE)
+#define TIM13					((TIM_TypeDef*)TIM13_BASE)
+#define TIM14					((TIM_TypeDef*)TIM14_BASE)
+#define ADC1					((ADC_TypeDef*)ADC1_BASE)
+#define ADC2					((ADC_TypeDef*)ADC2_BASE)
+#define ADC3					((ADC_TypeDef*)ADC3_BASE)
+
+extern RCC_TypeDef mock_rcc;
+#define RCC						(&mock_rcc)
+
+#define IS_TIM_32B_COUNTER_INSTANCE(INSTANCE)		(((INSTANCE) == TIM2) || ((INSTANCE) == TIM5))
+#define IS_TIM_REPETITION_COUNTER_INSTANCE(INSTANCE)	(((INSTANCE) == TIM1) || ((INSTANCE) == TIM8))
+#define IS_TIM_BREAK_INSTANCE(INSTANCE)				(((INSTANCE) == TIM1) || ((INSTANCE) == TIM8))
+
+/*----------REGISTER BITS----------*/
+
+#define RCC_CFGR_PPRE1_Pos		(10U)
+#define RCC_CFGR_PPRE1			(0x7UL << RCC_CFGR_PPRE1_Pos)
+#define RCC_CFGR_PPRE2_Pos		(13U)
+#define RCC_CFGR_PPRE2			(0x7UL << RCC_CFGR_PPRE2_Pos)
+#define RCC_DCKCFGR1_TIMPRE		(1UL << 24)
+
+#define TIM_CR1_CEN				(1UL << 0)
+#define TIM_CR1_UDIS			(1UL << 1)
+#define TIM_CR1_URS				(1UL << 2)
+#define TIM_CR1_OPM				(1UL << 3)
+#define TIM_CR1_DIR				(1UL << 4)
+#define TIM_CR1_CMS				(3UL << 5)
+#define TIM_CR1_ARPE			(1UL << 7)
+#define TIM_CR1_CKD				(3UL << 8)
+#define TIM_CR1_UIFREMAP		(1UL << 11)
+#define TIM_CNT_UIFCPY			(1UL << 31)
+#define TIM_CR2_CCPC			(1UL << 0)
+#define TIM_CR2_CCUS			(1UL << 2)
+#define TIM_CR2_MMS				(7UL << 4)
+#define TIM_CR2_MMS2			(15UL << 20)
+#define TIM_SMCR_SMS			(0x10007UL)
+#define TIM_SMCR_TS				(7UL << 4)
+#define TIM_SMCR_MSM			(1UL << 7)
+#define TIM_DIER_UIE			(1UL << 0)
+#define TIM_DIER_CC1IE			(1UL << 1)
+#define TIM_DIER_BIE			(1UL << 7)
+#define TIM_DIER_UDE			(1UL << 8)
+#define TIM_SR_UIF				(1UL << 0)
+#define TIM_SR_CC1IF			(1UL << 1)
+#define TIM_SR_BIF				(1UL << 7)
+#define TIM_SR_B2IF				(1UL << 8)
+#define TIM_SR_CC1OF			(1UL << 9)
+#define TIM_EGR_UG				(1UL << 0)
+#define TIM_EGR_CC1G			(1UL << 1)
+#define TIM_EGR_COMG			(1UL << 5)
+#define TIM_EGR_BG				(1UL << 7)
+#define TIM_EGR_B2G				(1UL << 8)
+#define TIM_CCMR1_CC1S			(3UL << 0)
+#define TIM_CCMR1_OC1FE			(1UL << 2)
+#define TIM_CCMR1_OC1PE			(1UL << 3)
+#define TIM_CCMR1_OC1M			(0x10070UL)
+#define TIM_CCMR1_CC2S			(3UL << 8)
+#define TIM_CCMR1_OC2PE			(1UL << 11)
+#define TIM_CCMR1_OC2M			(0x1007000UL)
+#define TIM_CCMR2_OC3PE			(1UL << 3)
+#define TIM_CCMR2_OC3M			(0x10070UL)
+#define TIM_CCMR2_OC4PE			(1UL << 11)
+#define TIM_CCMR2_OC4M			(0x1007000UL)
+#define TIM_CCER_CC1E			(1UL << 0)
+#define TIM_CCER_CC1P			(1UL << 1)
+#define TIM_CCER_CC1NE			(1UL << 2)
+#define TIM_CCER_CC1NP			(1UL << 3)
+#define TIM_BDTR_DTG			(0xFFUL << 0)
+#define TIM_BDTR_LOCK			(3UL << 8)
+#define TIM_BDTR_OSSI			(1UL << 10)
+#define TIM_BDTR_OSSR			(1UL << 11)
+#define TIM_BDTR_BKE			(1UL << 12)
+#define TIM_BDTR_BKP			(1UL << 13)
+#define TIM_BDTR_AOE			(1UL << 14)
+#define TIM_BDTR_MOE			(1UL << 15)
+#define TIM_BDTR_BKF			(0xFUL << 16)
+#define TIM_BDTR_BK2F			(0xFUL << 20)
+#define TIM_BDTR_BK2E			(1UL << 24)
+#define TIM_BDTR_BK2P			(1UL << 25)
+
+/*----------DMA----------*/
+
+typedef struct {
+	uint32_t Channel;
+	uint32_t Direction;
+	uint32_t PeriphInc;
+	uint32_t MemInc;
+	uint32_t PeriphDataAlignment;
+	uint32_t MemDataAlignment;
+	uint32_t Mode;
+	uint32_t Priority;
+}DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+	DMA_Stream_TypeDef* Instance;
+	DMA_InitTypeDef Init;
+	void* Parent;
+}DMA_HandleTypeDef;
+
+#define DMA_NORMAL				(0x00000000U)
+#define DMA_CIRCULAR			(0x00000100U)
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)		((__HANDLE__)->Instance->NDTR)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma);
+
+/*----------TIM----------*/
+
+typedef enum {
+	HAL_TIM_STATE_RESET = 0,
+	HAL_TIM_STATE_READY,
+	HAL_TIM_STATE_BUSY
+}HAL_TIM_StateTypeDef;
+
+typedef enum {
+	HAL_TIM_ACTIVE_CHANNEL_1 = 0x01,
+	HAL_TIM_ACTIVE_CHANNEL_2 = 0x02,
+	HAL_TIM_ACTIVE_CHANNEL_3 = 0x04,
+	HAL_TIM_ACTIVE_CHANNEL_4 = 0x08,
+	HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00
+}HAL_TIM_ActiveChannel;
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+	uint32_t AutoReloadPreload;
+}TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef* Instance;
+	TIM_Base_InitTypeDef Init;
+	HAL_TIM_ActiveChannel Channel;
+	DMA_HandleTypeDef* hdma[7];
+	HAL_TIM_StateTypeDef State;
+}TIM_HandleTypeDef;
+
+typedef struct {
+	uint32_t ClockSource;
+	uint32_t ClockPolarity;
+	uint32_t ClockPrescaler;
+	uint32_t ClockFilter;
+}TIM_ClockConfigTypeDef;
+
+typedef struct {
+	uint32_t MasterOutputTrigger;
+	uint32_t MasterOutputTrigger2;
+	uint32_t MasterSlaveMode;
+}TIM_MasterConfigTypeDef;
+
+typedef struct {
+	uint32_t OCMode;
+	uint32_t Pulse;
+	uint32_t OCPolarity;
+	uint32_t OCNPolarity;
+	uint32_t OCFastMode;
+	uint32_t OCIdleState;
+	uint32_t OCNIdleState;
+}TIM_OC_InitTypeDef;
+
+typedef struct {
+	uint32_t OCMode;
+	uint32_t Pulse;
+	uint32_t OCPolarity;
+	uint32_t OCNPolarity;
+	uint32_t OCIdleState;
+	uint32_t OCNIdleState;
+	uint32_t ICPolarity;
+	uint32_t ICSelection;
+	uint32_t ICFilter;
+}TIM_OnePulse_InitTypeDef;
+
+typedef struct {
+	uint32_t ICPolarity;
+	uint32_t ICSelection;
+	uint32_t ICPrescaler;
+	uint32_t ICFilter;
+}TIM_IC_InitTypeDef;
+
+typedef struct {
+	uint32_t EncoderMode;
+	uint32_t IC1Polarity;
+	uint32_t IC1Selection;
+	uint32_t IC1Prescaler;
+	uint32_t IC1Filter;
+	uint32_t IC2Polarity;
+	uint32_t IC2Selection;
+	uint32_t IC2Prescaler;
+	uint32_t IC2Filter;
+}TIM_Encoder_InitTypeDef;
+
+typedef struct {
+	uint32_t SlaveMode;
+	uint32_t InputTrigger;
+	uint32_t TriggerPolarity;
+	uint32_t TriggerPrescaler;
+	uint32_t TriggerFilter;
+}TIM_SlaveConfigTypeDef;
+
+typedef struct {
+	uint32_t OffStateRunMode;
+	uint32_t OffStateIDLEMode;
+	uint32_t LockLevel;
+	uint32_t DeadTime;
+	uint32_t BreakState;
+	uint32_t BreakPolarity;
+	uint32_t BreakFilter;
+	uint32_t Break2State;
+	uint32_t Break2Polarity;
+	uint32_t Break2Filter;
+	uint32_t AutomaticOutput;
+}TIM_BreakDeadTimeConfigTypeDef;
+
+#define TIM_COUNTERMODE_UP				(0x00000000U)
+#define TIM_COUNTERMODE_DOWN			TIM_CR1_DIR
+#define TIM_COUNTERMODE_CENTERALIGNED1	(1UL << 5)
+#define TIM_COUNTERMODE_CENTERALIGNED2	(2UL << 5)
+#define TIM_COUNTERMODE_CENTERALIGNED3	TIM_CR1_CMS
+#define TIM_CLOCKDIVISION_DIV1			(0x00000000U)
+#define TIM_CLOCKDIVISION_DIV2			(1UL << 8)
+#define TIM_CLOCKDIVISION_DIV4			(2UL << 8)
+#define TIM_AUTORELOAD_PRELOAD_DISABLE	(0x00000000U)
+#define TIM_AUTORELOAD_PRELOAD_ENABLE	TIM_CR1_ARPE
+#define TIM_CLOCKSOURCE_INTERNAL		(0x00001000U)
+
+#define TIM_TRGO_RESET					(0x00000000U)
+#define TIM_TRGO_ENABLE					(1UL << 4)
+#define TIM_TRGO_UPDATE					(2UL << 4)
+#define TIM_TRGO_OC1					(3UL << 4)
+#define TIM_TRGO_OC1REF					(4UL << 4)
+#define TIM_TRGO_OC2REF					(5UL << 4)
+#define TIM_TRGO_OC3REF					(6UL << 4)
+#define TIM_TRGO_OC4REF					(7UL << 4)
+#define TIM_TRGO2_RESET					(0x00000000U)
+#define TIM_TRGO2_UPDATE				(2UL << 20)
+#define TIM_TRGO2_OC1REF				(4UL << 20)
+#define TIM_TRGO2_OC2REF				(5UL << 20)
+#define TIM_TRGO2_OC3REF				(6UL << 20)
+#define TIM_TRGO2_OC4REF				(7UL << 20)
+#define TIM_TRGO2_OC4REF_RISINGFALLING	(11UL << 20)
+#define TIM_MASTERSLAVEMODE_DISABLE		(0x00000000U)
+#define TIM_MASTERSLAVEMODE_ENABLE		TIM_SMCR_MSM
+
+#define TIM_SLAVEMODE_DISABLE			(0x00000000U)
+#define TIM_SLAVEMODE_RESET				(4U)
+#define TIM_SLAVEMODE_GATED				(5U)
+#define TIM_SLAVEMODE_TRIGGER			(6U)
+#define TIM_SLAVEMODE_EXTERNAL1			(7U)
+#define TIM_SLAVEMODE_COMBINED_RESETTRIGGER	(0x10000U)
+#define TIM_TS_ITR0						(0x00000000U)
+#define TIM_TS_ITR1						(1UL << 4)
+#define TIM_TS_ITR2						(2UL << 4)
+#define TIM_TS_ITR3						(3UL << 4)
+#define TIM_TS_TI1FP1					(5UL << 4)
+#define TIM_TS_TI2FP2					(6UL << 4)
+#define TIM_TS_NONE						(0x0000FFFFU)
+#define TIM_TRIGGERPOLARITY_RISING		(0x00000000U)
+#define TIM_TRIGGERPOLARITY_FALLING		(0x00000002U)
+#define TIM_TRIGGERPOLARITY_NONINVERTED	(0x00000000U)
+#define TIM_TRIGGERPOLARITY_INVERTED	(0x00000002U)
+#define TIM_TRIGGERPRESCALER_DIV1		(0x00000000U)
+
+#define TIM_OCMODE_TIMING				(0x00000000U)
+#define TIM_OCMODE_ACTIVE				(1UL << 4)
+#define TIM_OCMODE_INACTIVE				(2UL << 4)
+#define TIM_OCMODE_TOGGLE				(3UL << 4)
+#define TIM_OCMODE_FORCED_INACTIVE		(4UL << 4)
+#define TIM_OCMODE_FORCED_ACTIVE		(5UL << 4)
+#define TIM_OCMODE_PWM1					(6UL << 4)
+#define TIM_OCMODE_PWM2					(7UL << 4)
+#define TIM_OCMODE_COMBINED_PWM1		(0x00010040U)
+#define TIM_OCMODE_COMBINED_PWM2		(0x00010050U)
+#define TIM_OCMODE_ASSYMETRIC_PWM1		(0x00010060U)
+#define TIM_OCMODE_ASSYMETRIC_PWM2		(0x00010070U)
+#define TIM_OCPOLARITY_HIGH				(0x00000000U)
+#define TIM_OCPOLARITY_LOW				TIM_CCER_CC1P
+#define TIM_OCNPOLARITY_HIGH			(0x00000000U)
+#define TIM_OCNPOLARITY_LOW				TIM_CCER_CC1NP
+#define TIM_OCFAST_DISABLE				(0x00000000U)
+#define TIM_OCFAST_ENABLE				TIM_CCMR1_OC1FE
+#define TIM_OCIDLESTATE_SET				(1UL << 8)
+#define TIM_OCIDLESTATE_RESET			(0x00000000U)
+#define TIM_OCNIDLESTATE_SET			(1UL << 9)
+#define TIM_OCNIDLESTATE_RESET			(0x00000000U)
+
+#define TIM_OSSR_ENABLE					TIM_BDTR_OSSR
+#define TIM_OSSR_DISABLE				(0x00000000U)
+#define TIM_OSSI_ENABLE					TIM_BDTR_OSSI
+#define TIM_OSSI_DISABLE				(0x00000000U)
+#define TIM_LOCKLEVEL_OFF				(0x00000000U)
+#define TIM_LOCKLEVEL_1					(1UL << 8)
+#define TIM_LOCKLEVEL_2					(2UL << 8)
+#define TIM_LOCKLEVEL_3					TIM_BDTR_LOCK
+#define TIM_BREAK_ENABLE				TIM_BDTR_BKE
+#define TIM_BREAK_DISABLE				(0x00000000U)
+#define TIM_BREAKPOLARITY_LOW			(0x00000000U)
+#define TIM_BREAKPOLARITY_HIGH			TIM_BDTR_BKP
+#define TIM_BREAK2_ENABLE				TIM_BDTR_BK2E
+#define TIM_BREAK2_DISABLE				(0x00000000U)
+#define TIM_BREAK2POLARITY_LOW			(0x00000000U)
+#define TIM_BREAK2POLARITY_HIGH			TIM_BDTR_BK2P
+#define TIM_AUTOMATICOUTPUT_ENABLE		TIM_BDTR_AOE
+#define TIM_AUTOMATICOUTPUT_DISABLE		(0x00000000U)
+
+#define TIM_CHANNEL_1					(0x00000000U)
+#define TIM_CHANNEL_2					(0x00000004U)
+#define TIM_CHANNEL_3					(0x00000008U)
+#define TIM_CHANNEL_4					(0x0000000CU)
+#define TIM_CHANNEL_ALL					(0x0000003CU)
+
+#define TIM_ICPOLARITY_RISING			(0x00000000U)
+#define TIM_ICPOLARITY_FALLING			(0x00000002U)
+#define TIM_ICPOLARITY_BOTHEDGE			(0x0000000AU)
+#define TIM_ICSELECTION_DIRECTTI		(0x00000001U)
+#define TIM_ICSELECTION_INDIRECTTI		(0x00000002U)
+#define TIM_ICPSC_DIV1					(0x00000000U)
+#define TIM_ENCODERMODE_TI1				(0x00000001U)
+#define TIM_ENCODERMODE_TI2				(0x00000002U)
+#define TIM_ENCODERMODE_TI12			(0x00000003U)
+#define TIM_OPMODE_SINGLE				TIM_CR1_OPM
+#define TIM_OPMODE_REPETITIVE			(0x00000000U)
+
+#define TIM_EVENTSOURCE_UPDATE			TIM_EGR_UG
+#define TIM_EVENTSOURCE_CC1				(1UL << 1)
+#define TIM_EVENTSOURCE_CC2				(1UL << 2)
+#define TIM_EVENTSOURCE_CC3				(1UL << 3)
+#define TIM_EVENTSOURCE_CC4				(1UL << 4)
+#define TIM_EVENTSOURCE_COM				TIM_EGR_COMG
+#define TIM_EVENTSOURCE_TRIGGER			(1UL << 6)
+#define TIM_EVENTSOURCE_BREAK			TIM_EGR_BG
+#define TIM_COMMUTATION_SOFTWARE		(0x00000000U)
+#define TIM_COMMUTATION_TRGI			TIM_CR2_CCUS
+
+#define TIM_DMABASE_PSC					(0x0000000AU)
+#define TIM_DMABASE_ARR					(0x0000000BU)
+#define TIM_DMABASE_CCR1				(0x0000000DU)
+#define TIM_DMABASE_CCR2				(0x0000000EU)
+#define TIM_DMABASE_CCR3				(0x0000000FU)
+#define TIM_DMABASE_CCR4				(0x00000010U)
+#define TIM_DMABURSTLENGTH_1TRANSFER	(0x00000000U)
+#define TIM_DMABURSTLENGTH_2TRANSFERS	(1UL << 8)
+#define TIM_DMABURSTLENGTH_3TRANSFERS	(2UL << 8)
+#define TIM_DMABURSTLENGTH_4TRANSFERS	(3UL << 8)
+#define TIM_DMABURSTLENGTH_5TRANSFERS	(4UL << 8)
+#define TIM_DMABURSTLENGTH_6TRANSFERS	(5UL << 8)
+#define TIM_DMA_UPDATE					TIM_DIER_UDE
+#define TIM_DMA_CC1						(1UL << 9)
+#define TIM_DMA_ID_UPDATE				((uint16_t)0x0000)
+#define TIM_DMA_ID_CC1					((uint16_t)0x0001)
+#define TIM_DMA_ID_CC2					((uint16_t)0x0002)
+#define TIM_DMA_ID_CC3					((uint16_t)0x0003)
+#define TIM_DMA_ID_CC4					((uint16_t)0x0004)
+
+#define TIM_IT_UPDATE					TIM_DIER_UIE
+#define TIM_IT_CC1						(1UL << 1)
+#define TIM_IT_CC2						(1UL << 2)
+#define TIM_IT_CC3						(1UL << 3)
+#define TIM_IT_CC4						(1UL << 4)
+#define TIM_IT_COM						(1UL << 5)
+#define TIM_IT_BREAK					TIM_DIER_BIE
+#define TIM_FLAG_UPDATE					TIM_SR_UIF
+#define TIM_FLAG_CC1					TIM_SR_CC1IF
+#define TIM_FLAG_CC1OF					TIM_SR_CC1OF
+#define TIM_FLAG_BREAK					TIM_SR_BIF
+#define TIM_FLAG_BREAK2					TIM_SR_B2IF
+
+#define __HAL_TIM_ENABLE(__HANDLE__)				((__HANDLE__)->Instance->CR1 |= TIM_CR1_CEN)
+#define __HAL_TIM_DISABLE(__HANDLE__)				((__HANDLE__)->Instance->CR1 &= ~TIM_CR1_CEN)
+#define __HAL_TIM_MOE_ENABLE(__HANDLE__)			((__HANDLE__)->Instance->BDTR |= TIM_BDTR_MOE)
+#define __HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(__HANDLE__)	((__HANDLE__)->Instance->BDTR &= ~TIM_BDTR_MOE)
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __IT__)		((__HANDLE__)->Instance->DIER |= (__IT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __IT__)	((__HANDLE__)->Instance->DIER &= ~(__IT__))
+#define __HAL_TIM_GET_IT_SOURCE(__HANDLE__, __IT__)	((((__HANDLE__)->Instance->DIER & (__IT__)) == (__IT__)) ? SET : RESET)
+#define __HAL_TIM_GET_FLAG(__HANDLE__, __FLAG__)	(((__HANDLE__)->Instance->SR & (__FLAG__)) == (__FLAG__))
+// SR bits are rc_w0 on target, plain memory needs the read-modify-write to leave the other flags alone
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__)	((__HANDLE__)->Instance->SR &= ~(__FLAG__))
+#define __HAL_TIM_CLEAR_IT(__HANDLE__, __IT__)		((__HANDLE__)->Instance->SR &= ~(__IT__))
+#define __HAL_TIM_URS_ENABLE(__HANDLE__)			((__HANDLE__)->Instance->CR1 |= TIM_CR1_URS)
+#define __HAL_TIM_UIFREMAP_ENABLE(__HANDLE__)		((__HANDLE__)->Instance->CR1 |= TIM_CR1_UIFREMAP)
+#define __HAL_TIM_IS_TIM_COUNTING_DOWN(__HANDLE__)	(((__HANDLE__)->Instance->CR1 & TIM_CR1_DIR) == TIM_CR1_DIR)
+#define __HAL_TIM_SET_PRESCALER(__HANDLE__, __PRESC__)	((__HANDLE__)->Instance->PSC = (__PRESC__))
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__)	((__HANDLE__)->Instance->CNT = (__COUNTER__))
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)			((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)		((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+	do { \
+		(__HANDLE__)->Instance->ARR = (__AUTORELOAD__); \
+		(__HANDLE__)->Init.Period = (__AUTORELOAD__); \
+	} while(0)
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+	((&(__HANDLE__)->Instance->CCR1)[(__CHANNEL__) >> 2U] = (__COMPARE__))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__)	((&(__HANDLE__)->Instance->CCR1)[(__CHANNEL__) >> 2U])
+#define __HAL_TIM_ENABLE_OCxPRELOAD(__HANDLE__, __CHANNEL__) \
+	((&(__HANDLE__)->Instance->CCMR1)[(__CHANNEL__) >> 3U] |= (TIM_CCMR1_OC1PE << (((__CHANNEL__) & 4U) << 1U)))
+#define __HAL_TIM_DISABLE_OCxPRELOAD(__HANDLE__, __CHANNEL__) \
+	((&(__HANDLE__)->Instance->CCMR1)[(__CHANNEL__) >> 3U] &= ~(TIM_CCMR1_OC1PE << (((__CHANNEL__) & 4U) << 1U)))
+#define __HAL_TIM_SET_CAPTUREPOLARITY(__HANDLE__, __CHANNEL__, __POLARITY__) \
+	do { \
+		(__HANDLE__)->Instance->CCER &= ~((TIM_CCER_CC1P | TIM_CCER_CC1NP) << (__CHANNEL__)); \
+		(__HANDLE__)->Instance->CCER |= ((__POLARITY__) << (__CHANNEL__)); \
+	} while(0)
+#define __HAL_TIM_SET_ICPRESCALER(__HANDLE__, __CHANNEL__, __ICPSC__)	((void)(__HANDLE__), (void)(__CHANNEL__), (void)(__ICPSC__))
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_DeInit(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim, TIM_ClockConfigTypeDef* sClockSourceConfig);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim, TIM_MasterConfigTypeDef* sMasterConfig);
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef* htim, TIM_BreakDeadTimeConfigTypeDef* sBreakDeadTimeConfig);
+HAL_StatusTypeDef HAL_TIMEx_ConfigCommutEvent(TIM_HandleTypeDef* htim, uint32_t InputTrigger, uint32_t CommutationSource);
+HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro(TIM_HandleTypeDef* htim, TIM_SlaveConfigTypeDef* sSlaveConfig);
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource);
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_IC_InitTypeDef* sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef* htim, uint32_t Channel, uint32_t* pData, uint16_t Length);
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t Channel);
+uint32_t HAL_TIM_ReadCapturedValue(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef* htim, TIM_Encoder_InitTypeDef* sConfig);
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OnePulse_Init(TIM_HandleTypeDef* htim, uint32_t OnePulseMode);
+HAL_StatusTypeDef HAL_TIM_OnePulse_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OnePulse_InitTypeDef* sConfig, uint32_t OutputChannel, uint32_t InputChannel);
+HAL_StatusTypeDef HAL_TIM_OnePulse_Start(TIM_HandleTypeDef* htim, uint32_t OutputChannel);
+HAL_StatusTypeDef HAL_TIM_OnePulse_Stop(TIM_HandleTypeDef* htim, uint32_t OutputChannel);
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef* htim, uint32_t BurstBaseAddress, uint32_t BurstRequestSrc, uint32_t* BurstBuffer, uint32_t BurstLength, uint32_t DataLength);
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t BurstRequestSrc);
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
+
+/*----------RCC----------*/
+
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+/*----------ADC----------*/
+
+typedef struct {
+	uint32_t ClockPrescaler;
+	uint32_t Resolution;
+	uint32_t DataAlign;
+	uint32_t ScanConvMode;
+	uint32_t EOCSelection;
+	uint32_t ContinuousConvMode;
+	uint32_t NbrOfConversion;
+	uint32_t DiscontinuousConvMode;
+	uint32_t NbrOfDiscConversion;
+	uint32_t ExternalTrigConv;
+	uint32_t ExternalTrigConvEdge;
+	uint32_t DMAContinuousRequests;
+}ADC_InitTypeDef;
+
+typedef struct {
+	ADC_TypeDef* Instance;
+	ADC_InitTypeDef Init;
+	DMA_HandleTypeDef* DMA_Handle;
+	uint32_t State;
+}ADC_HandleTypeDef;
+
+typedef struct {
+	uint32_t Channel;
+	uint32_t Rank;
+	uint32_t SamplingTime;
+	uint32_t Offset;
+}ADC_ChannelConfTypeDef;
+
+typedef struct {
+	uint32_t WatchdogMode;
+	uint32_t HighThreshold;
+	uint32_t LowThreshold;
+	uint32_t Channel;
+	uint32_t ITMode;
+	uint32_t WatchdogNumber;
+}ADC_AnalogWDGConfTypeDef;
+
+#define ADC_CHANNEL_0					(0U)
+#define ADC_CHANNEL_1					(1U)
+#define ADC_CHANNEL_2					(2U)
+#define ADC_CHANNEL_3					(3U)
+#define ADC_CHANNEL_4					(4U)
+#define ADC_CHANNEL_5					(5U)
+#define ADC_CHANNEL_6					(6U)
+#define ADC_CHANNEL_7					(7U)
+#define ADC_CHANNEL_8					(8U)
+#define ADC_CHANNEL_9					(9U)
+#define ADC_CHANNEL_10					(10U)
+#define ADC_CHANNEL_11					(11U)
+#define ADC_CHANNEL_12					(12U)
+#define ADC_CHANNEL_13					(13U)
+#define ADC_CHANNEL_14					(14U)
+#define ADC_CHANNEL_15					(15U)
+#define ADC_CHANNEL_16					(16U)
+#define ADC_CHANNEL_17					(17U)
+#define ADC_CHANNEL_18					(18U)
+#define ADC_REGULAR_RANK_1				(1U)
+
+#define ADC_SAMPLETIME_3CYCLES			(0U)
+#define ADC_SAMPLETIME_15CYCLES			(1U)
+#define ADC_SAMPLETIME_28CYCLES			(2U)
+#define ADC_SAMPLETIME_56CYCLES			(3U)
+#define ADC_SAMPLETIME_84CYCLES			(4U)
+#define ADC_SAMPLETIME_112CYCLES		(5U)
+#define ADC_SAMPLETIME_144CYCLES		(6U)
+#define ADC_SAMPLETIME_480CYCLES		(7U)
+#define ADC_CLOCK_SYNC_PCLK_DIV2		(0U)
+#define ADC_RESOLUTION_12B				(0U)
+#define ADC_DATAALIGN_RIGHT				(0U)
+#define ADC_EOC_SEQ_CONV				(0U)
+#define ADC_EOC_SINGLE_CONV				(1U)
+
+#define ADC_SOFTWARE_START				(0x0F000001U)
+#define ADC_EXTERNALTRIGCONVEDGE_NONE	(0x00000000U)
+#define ADC_EXTERNALTRIGCONVEDGE_RISING	(1UL << 28)
+#define ADC_EXTERNALTRIGCONVEDGE_FALLING	(2UL << 28)
+#define ADC_EXTERNALTRIGCONVEDGE_RISINGFALLING	(3UL << 28)
+#define ADC_EXTERNALTRIGCONV_T1_CC1		(0UL << 24)
+#define ADC_EXTERNALTRIGCONV_T1_CC2		(1UL << 24)
+#define ADC_EXTERNALTRIGCONV_T1_CC3		(2UL << 24)
+#define ADC_EXTERNALTRIGCONV_T2_CC2		(3UL << 24)
+#define ADC_EXTERNALTRIGCONV_T5_TRGO	(4UL << 24)
+#define ADC_EXTERNALTRIGCONV_T4_CC4		(5UL << 24)
+#define ADC_EXTERNALTRIGCONV_T3_CC4		(6UL << 24)
+#define ADC_EXTERNALTRIGCONV_T8_TRGO	(7UL << 24)
+#define ADC_EXTERNALTRIGCONV_T8_TRGO2	(8UL << 24)
+#define ADC_EXTERNALTRIGCONV_T1_TRGO	(9UL << 24)
+#define ADC_EXTERNALTRIGCONV_T1_TRGO2	(10UL << 24)
+#define ADC_EXTERNALTRIGCONV_T2_TRGO	(11UL << 24)
+#define ADC_EXTERNALTRIGCONV_T4_TRGO	(12UL << 24)
+#define ADC_EXTERNALTRIGCONV_T6_TRGO	(13UL << 24)
+#define ADC_EXTERNALTRIGCONV_EXT_IT11	(15UL << 24)
+
+#define ADC_ANALOGWATCHDOG_SINGLE_REG	(1U)
+#define ADC_ANALOGWATCHDOG_ALL_REG		(2U)
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* sConfig);
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef* hadc, ADC_AnalogWDGConfTypeDef* AnalogWDGConfig);
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_Start_IT(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_Stop_IT(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef* hadc, uint32_t Timeout);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc);
+
+/*----------APPLICATION----------*/
+
+void Error_Handler(void);
+
+#endif /* MAIN_H */
@@ -0,0 +1,336 @@
+/*
+ * test_capture.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Input capture on an emulated general timer fed with a square wave.
+ *
+ *	The counter is stepped one count at a time, input edges latch it through Mock_Tim_Input_Edge and the capture and
+ *	update interrupts are delivered after a random latency in the order of the HAL interrupt handler (captures
+ *	first). Checks:
+ *		- CAPTURE_IT measures periods shorter than, equal to and many times longer than the timer period exactly,
+ *		  also with edges right before and after the counter wraps, and never touches the update flag
+ *		- the update events reach the capture through Timer_Capture_Period_Elapsed or a registered callback alike
+ *		- CAPTURE_PWM_INPUT measures period and high time (rising and falling period edges), reads no capture once an
+ *		  overflow cut a period, leaves the update flag to the interrupt and measures again after two period edges
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "tim_capture.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Counting period of 5400 ticks
+#define FAST_FREQ_HZ			(20000U)
+// Highest update interrupt rate for a registered callback
+#define IT_FREQ_HZ				(1000U)
+// Counts between an interrupt flag and its handler, at most
+#define MAX_LATENCY				(300U)
+#define NUM_EDGES				(6U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static Capture_st cap;
+
+// Square wave on TI1: rising edge every in_period counts, high for in_high counts
+static uint8_t input_on;
+static uint32_t in_period;
+static uint32_t in_high;
+static uint64_t now;
+static uint64_t next_rise;
+static uint64_t next_fall;
+
+// Interrupt emulation: counts left before the pending flags are handled (-1 when nothing is pending), updates
+// through the registered callback instead of Timer_Capture_Period_Elapsed, and captures handled so far
+static int32_t irq_wait;
+static uint8_t hold_irq;
+static uint8_t dispatch;
+static uint32_t captures;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Handles the pending capture and update flags as HAL_TIM_IRQHandler does
+static void handle_irq(void) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	if ((regs->SR & TIM_SR_CC1IF) && (regs->DIER & TIM_DIER_CC1IE)) {
+		uint32_t uif = regs->SR & TIM_SR_UIF;
+
+		__HAL_TIM_CLEAR_FLAG(&htim, TIM_FLAG_CC1);
+		htim.Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+		Timer_Capture_Callback(&cap, &htim);
+		htim.Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+		CHECK((regs->SR & TIM_SR_UIF) == uif, "capture callback changed the update flag");
+		captures++;
+	}
+
+	if ((regs->SR & TIM_SR_UIF) && (regs->DIER & TIM_DIER_UIE)) {
+		__HAL_TIM_CLEAR_FLAG(&htim, TIM_FLAG_UPDATE);
+		if (dispatch) {
+			Timer_Dispatch_Period_Elapsed(&htim);
+		}
+		else {
+			Timer_Capture_Period_Elapsed(&cap, &htim);
+		}
+	}
+}
+
+// Starts the latency of newly pending interrupts and handles them once it ran out
+static void poll_irq(void) {
+	TIM_TypeDef* regs = htim.Instance;
+	uint32_t pending = regs->SR & regs->DIER & (TIM_SR_UIF | TIM_SR_CC1IF);
+
+	if ((pending == 0) || hold_irq) {
+		return;
+	}
+	if (irq_wait < 0) {
+		irq_wait = rand() % (MAX_LATENCY + 1);
+	}
+	if (irq_wait > 0) {
+		irq_wait--;
+		return;
+	}
+
+	handle_irq();
+	irq_wait = -1;
+}
+
+// Counts the timer, feeding it the input edges that fall due
+static void advance(uint64_t counts) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	for (uint64_t i = 0; i < counts; i++) {
+		Mock_Tim_Count(regs);
+		now++;
+
+		if (input_on && (now == next_rise)) {
+			Mock_Tim_Input_Edge(regs, 1, 1);
+			next_fall = now + in_high;
+			next_rise = now + in_period;
+		}
+		else if (input_on && (now == next_fall)) {
+			Mock_Tim_Input_Edge(regs, 1, 0);
+		}
+
+		poll_irq();
+	}
+}
+
+// Starts the square wave with its first rising edge delay counts from now
+static void start_input(uint32_t period, uint32_t high, uint64_t delay) {
+	in_period = period;
+	in_high = high;
+	next_rise = now + delay;
+	next_fall = 0;
+	input_on = 1;
+}
+
+// Capture on channel 1 of TIM3
+static void init_capture(uint32_t freq_hz, Capture_Mode_et mode, Capture_Edge_et edge, uint8_t use_dispatch) {
+	Mock_Reset();
+	srand(1);
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = freq_hz;
+	tim.it_config.en_it = use_dispatch;
+	CHECK(Timer_Init(&tim) == TIM_OK, "Timer_Init");
+
+	cap = (Capture_st){ .tim = &tim, .chan_num = 1, .mode = mode, .edge = edge };
+	CHECK(Timer_Capture_Init(&cap) == TIM_OK, "Timer_Capture_Init");
+	if (use_dispatch) {
+		CHECK(Timer_Register_Callback(&tim, Timer_Capture_Update_Callback, &cap) == TIM_OK, "Timer_Register_Callback");
+	}
+
+	now = 0;
+	input_on = 0;
+	irq_wait = -1;
+	hold_irq = 0;
+	dispatch = use_dispatch;
+	captures = 0;
+	CHECK(Timer_Capture_Start(&cap) == TIM_OK, "Timer_Capture_Start");
+	CHECK(htim.Instance->DIER & TIM_DIER_UIE, "update interrupt not enabled");
+}
+
+// CAPTURE_IT: a period of whole counting periods plus delta counts, the first edge at first_cnt. Every period after
+// the first edge must read exactly
+static void check_it_period(uint32_t freq_hz, uint32_t wraps, int32_t delta, uint32_t first_cnt, uint8_t use_dispatch) {
+	uint32_t counting_period;
+	uint32_t period;
+	uint32_t checked = 0;
+
+	init_capture(freq_hz, CAPTURE_IT, CAPTURE_RISING, use_dispatch);
+	counting_period = htim.Instance->ARR + 1;
+	period = (uint32_t)((int64_t)wraps * counting_period + delta);
+
+	// The counter starts at 0 with the capture
+	start_input(period, period / 2, first_cnt + (uint64_t)counting_period);
+
+	while (captures < NUM_EDGES) {
+		uint32_t before = captures;
+		Capture_Result_st result = {0};
+
+		advance(1);
+		if ((captures == before) || (captures < 2)) {
+			continue;
+		}
+
+		checked++;
+		CHECK(Timer_Capture_Get_Result(&cap, &result) == TIM_OK, "%u x %u %+d: no capture after %u edges", wraps,
+				counting_period, delta, captures);
+		CHECK(result.period_ticks == period, "%u x %u %+d: edge %u measured %u, want %u", wraps, counting_period,
+				delta, captures, result.period_ticks, period);
+		CHECK(result.freq_mhz == ((uint64_t)cap.__tick_hz * 1000U) / period, "%u x %u %+d: %llu mHz", wraps,
+				counting_period, delta, (unsigned long long)result.freq_mhz);
+	}
+	CHECK(checked == NUM_EDGES - 1, "%u x %u %+d: %u periods checked", wraps, counting_period, delta, checked);
+
+	CHECK(Timer_Capture_Stop(&cap) == TIM_OK, "Timer_Capture_Stop");
+	CHECK(((htim.Instance->DIER & TIM_DIER_UIE) != 0) == use_dispatch, "update interrupt %s after the stop",
+			use_dispatch ? "disabled" : "left on");
+	Timer_Stop(&tim);
+}
+
+static void check_it(void) {
+	uint32_t arr;
+	int32_t half;
+
+	init_capture(FAST_FREQ_HZ, CAPTURE_IT, CAPTURE_RISING, 0);
+	arr = htim.Instance->ARR;
+	half = (int32_t)(arr / 2);
+	Timer_Stop(&tim);
+
+	// Shorter than, equal to, around and many times the counting period
+	check_it_period(FAST_FREQ_HZ, 0, half / 3, 100, 0);
+	check_it_period(FAST_FREQ_HZ, 1, 0, 100, 0);
+	check_it_period(FAST_FREQ_HZ, 1, half, 100, 0);
+	check_it_period(FAST_FREQ_HZ, 2, 0, arr, 0);
+	check_it_period(FAST_FREQ_HZ, 3, 17, 100, 0);
+	check_it_period(FAST_FREQ_HZ, 40, 5, half, 0);
+
+	// Edges walking over the wrap, one count per period, so they land just before and just after it while the
+	// update is still pending
+	check_it_period(FAST_FREQ_HZ, 2, 1, arr - 2, 0);
+	check_it_period(FAST_FREQ_HZ, 2, -1, 2, 0);
+	check_it_period(FAST_FREQ_HZ, 5, 1, arr - 2, 0);
+	check_it_period(FAST_FREQ_HZ, 5, -1, 2, 0);
+
+	// Updates through Timer_Register_Callback
+	check_it_period(IT_FREQ_HZ, 3, -1, 2, 1);
+}
+
+// Runs the input past its next period edge, until the interrupts of that edge are handled
+static void run_to_period_edge(void) {
+	uint64_t edge_at = next_rise;
+
+	if (cap.edge == CAPTURE_FALLING) {
+		edge_at = (next_fall > now) ? next_fall : (next_rise + in_high);
+	}
+	advance(edge_at - now);
+	advance(MAX_LATENCY + 1);
+}
+
+// Reads the pwm input result, period_ticks of 0 for no capture. The high time is the one of the input
+static void check_pwm_result(const char* name, uint32_t period_ticks) {
+	Capture_Result_st result = {0};
+	TIM_Ret_et ret = Timer_Capture_Get_Result(&cap, &result);
+
+	if (period_ticks == 0) {
+		CHECK(ret == TIM_NO_CAPTURE, "%s: result %u / %u instead of no capture", name, result.period_ticks,
+				result.high_ticks);
+		return;
+	}
+
+	CHECK(ret == TIM_OK, "%s: no capture", name);
+	CHECK(result.period_ticks == period_ticks, "%s: period %u, want %u", name, result.period_ticks, period_ticks);
+	CHECK(result.high_ticks == in_high, "%s: high %u, want %u", name, result.high_ticks, in_high);
+}
+
+static void check_pwm_input(Capture_Edge_et edge) {
+	uint32_t counting_period;
+	uint32_t period;
+
+	init_capture(FAST_FREQ_HZ, CAPTURE_PWM_INPUT, edge, 0);
+	counting_period = htim.Instance->ARR + 1;
+	period = (counting_period * 2) / 3;
+
+	// Only the second period edge after the start gives a whole period
+	start_input(period, period / 4, 1000);
+	advance(1000 + period - 1);
+	check_pwm_result("first period", 0);
+	advance(period + MAX_LATENCY);
+	check_pwm_result("steady", period);
+	for (uint32_t i = 0; i < NUM_EDGES; i++) {
+		run_to_period_edge();
+		check_pwm_result("steady", period);
+	}
+
+	// Input stopped: the update flag is left for the interrupt, which turns the result into no capture
+	input_on = 0;
+	hold_irq = 1;
+	while (!(htim.Instance->SR & TIM_SR_UIF)) {
+		advance(1);
+	}
+	check_pwm_result("overflow pending", period);
+	CHECK(htim.Instance->SR & TIM_SR_UIF, "update flag cleared by Timer_Capture_Get_Result");
+	hold_irq = 0;
+	advance(MAX_LATENCY + 1);
+	check_pwm_result("stopped", 0);
+	advance(3 * counting_period);
+	check_pwm_result("stopped", 0);
+
+	// The first period edge closes a period cut by overflows, the second one a whole period again
+	start_input(period, period / 3, 10);
+	run_to_period_edge();
+	check_pwm_result("restart first edge", 0);
+	run_to_period_edge();
+	check_pwm_result("restart", period);
+
+	// Periods longer than the counting period never read, once the period already under way ended
+	in_period = counting_period + 100;
+	run_to_period_edge();
+	check_pwm_result("last fast period", period);
+	for (uint32_t i = 0; i < NUM_EDGES; i++) {
+		run_to_period_edge();
+		check_pwm_result("too slow", 0);
+	}
+
+	CHECK(Timer_Capture_Stop(&cap) == TIM_OK, "Timer_Capture_Stop");
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_it();
+	check_pwm_input(CAPTURE_RISING);
+	check_pwm_input(CAPTURE_FALLING);
+
+	printf("test_capture: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,301 @@
+/*
+ * test_claims.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Channel claims of the timer users on the emulated timers.
+ *
+ *	Every HAL call of an init is made to fail in turn. After each failure the channels the user claims must be free
+ *	again, after a successful init they must be taken, and after the user's stop free again. Covers pwm, input
+ *	capture (single channel and pwm input), encoder, timer wheel, one pulse (software and hardware trigger) and the
+ *	adc trigger channel.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timers_pwm.h"
+#include "tim_capture.h"
+#include "tim_encoder.h"
+#include "timer_wheel.h"
+#include "pwm_pulse.h"
+#include "adc_sync.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+// More HAL calls than any init makes
+#define MAX_HAL_CALLS			(20U)
+#define CHAN_MASK(CHAN_NUM)		(1U << ((CHAN_NUM) - 1U))
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// One user of timer channels: set up its timer, run its init, start and stop
+typedef struct {
+	const char* name;
+	// Channels the user claims, bit 0 for channel 1
+	uint8_t chan_mask;
+	void (*setup)(void);
+	uint8_t (*init)(void);
+	uint8_t (*start)(void);
+	uint8_t (*stop)(void);
+}user_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+static uint8_t probe;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static PWM_st pwm;
+static Capture_st cap;
+static Encoder_st enc;
+static Timer_Wheel_st wheel;
+static PWM_Pulse_st pulse;
+static ADC_HandleTypeDef hadc;
+static ADC_Channel_st adc_channel;
+static ADC_st adc;
+static ADC_Sync_st sync;
+static uint16_t samples[1];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Returns a boolean to see if every channel in mask can be claimed by another user
+static uint8_t channels_free(uint8_t mask) {
+	uint8_t free = 1;
+
+	for (uint8_t c = 1; c <= 4; c++) {
+		if (!(mask & CHAN_MASK(c))) {
+			continue;
+		}
+		if (Timer_Claim_Channel(&tim, c, &probe) != TIM_OK) {
+			free = 0;
+			continue;
+		}
+		Timer_Release_Channel(&tim, c, &probe);
+	}
+
+	return free;
+}
+
+// Returns a boolean to see if no channel in mask can be claimed by another user
+static uint8_t channels_taken(uint8_t mask) {
+	for (uint8_t c = 1; c <= 4; c++) {
+		if ((mask & CHAN_MASK(c)) && (Timer_Claim_Channel(&tim, c, &probe) == TIM_OK)) {
+			Timer_Release_Channel(&tim, c, &probe);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void init_timer(uint8_t tim_num, uint8_t chan_mask, uint8_t complementary) {
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = FREQ;
+	tim.freq_hz = PWM_FREQ_HZ;
+	tim.channels.en_ch1 = (chan_mask & CHAN_MASK(1)) != 0;
+	tim.channels.en_ch2 = (chan_mask & CHAN_MASK(2)) != 0;
+	tim.channels.en_ch3 = (chan_mask & CHAN_MASK(3)) != 0;
+	tim.channels.en_ch4 = (chan_mask & CHAN_MASK(4)) != 0;
+	tim.complementary.en_complementary = complementary;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+}
+
+static void setup_pwm(void) {
+	init_timer(1, CHAN_MASK(1), 1);
+	pwm = (PWM_st){ .tim = &tim, .chan_num = 1, .duty = 50 };
+}
+
+static uint8_t init_pwm(void) {
+	return PWM_Init(&pwm) == PWM_OK;
+}
+
+// PWM_Init also starts the output
+static uint8_t start_none(void) {
+	return 1;
+}
+
+static uint8_t stop_pwm(void) {
+	return PWM_Stop(&pwm) == PWM_OK;
+}
+
+static void setup_capture(Capture_Mode_et mode) {
+	init_timer(3, 0, 0);
+	cap = (Capture_st){ .tim = &tim, .chan_num = 1, .mode = mode, .edge = CAPTURE_RISING };
+}
+
+static void setup_capture_it(void) {
+	setup_capture(CAPTURE_IT);
+}
+
+static void setup_capture_pwm_input(void) {
+	setup_capture(CAPTURE_PWM_INPUT);
+}
+
+static uint8_t init_capture(void) {
+	return Timer_Capture_Init(&cap) == TIM_OK;
+}
+
+static uint8_t start_capture(void) {
+	return Timer_Capture_Start(&cap) == TIM_OK;
+}
+
+static uint8_t stop_capture(void) {
+	return Timer_Capture_Stop(&cap) == TIM_OK;
+}
+
+static void setup_encoder(void) {
+	init_timer(3, 0, 0);
+	enc = (Encoder_st){ .tim = &tim, .mode = ENCODER_X4, .update_hz = 1000 };
+}
+
+static uint8_t init_encoder(void) {
+	return Timer_Encoder_Init(&enc) == TIM_OK;
+}
+
+static uint8_t start_encoder(void) {
+	return Timer_Encoder_Start(&enc) == TIM_OK;
+}
+
+static uint8_t stop_encoder(void) {
+	return Timer_Encoder_Stop(&enc) == TIM_OK;
+}
+
+static void setup_wheel(void) {
+	init_timer(2, 0, 0);
+	wheel = (Timer_Wheel_st){ .tim = &tim, .chan_num = 1, .tick_hz = 1000000 };
+}
+
+static uint8_t init_wheel(void) {
+	return Timer_Wheel_Init(&wheel) == TIM_OK;
+}
+
+static uint8_t start_wheel(void) {
+	return Timer_Wheel_Start(&wheel) == TIM_OK;
+}
+
+static uint8_t stop_wheel(void) {
+	return Timer_Wheel_Stop(&wheel) == TIM_OK;
+}
+
+static void setup_pulse(uint8_t chan_num, PWM_Pulse_Trigger_et trigger) {
+	init_timer(3, CHAN_MASK(chan_num), 0);
+	pwm = (PWM_st){ .tim = &tim, .chan_num = chan_num };
+	pulse = (PWM_Pulse_st){ .pwm = &pwm, .delay_ns = 1000, .width_ns = 2000, .trigger = trigger };
+}
+
+static void setup_pulse_software(void) {
+	setup_pulse(1, PULSE_TRIGGER_SOFTWARE);
+}
+
+static void setup_pulse_ti1(void) {
+	setup_pulse(2, PULSE_TRIGGER_TI1);
+}
+
+static uint8_t init_pulse(void) {
+	return PWM_Pulse_Init(&pulse) == PWM_OK;
+}
+
+static uint8_t start_pulse(void) {
+	return PWM_Pulse_Arm(&pulse) == PWM_OK;
+}
+
+static uint8_t stop_pulse(void) {
+	return PWM_Pulse_Stop(&pulse) == PWM_OK;
+}
+
+// Pwm on channel 1 of TIM1, the trigger on channel 2
+static void setup_sync(void) {
+	setup_pwm();
+	CHECK(PWM_Init(&pwm) == PWM_OK, "adc sync PWM_Init");
+	hadc = (ADC_HandleTypeDef){ .Instance = ADC1 };
+	adc_channel = (ADC_Channel_st){ .channel_number = 3, .sample_time = ADC_3CYCLES };
+	adc = (ADC_st){ .hadc = &hadc, .adc_num = 1, .num_channels = 1, .channels = &adc_channel };
+	sync = (ADC_Sync_st){ .adc = &adc, .pwm = &pwm, .trigger_chan = 2, .point = SYNC_LOW_CENTER, .samples = samples };
+}
+
+static uint8_t init_sync(void) {
+	return ADC_Sync_Init(&sync) == ADC_OK;
+}
+
+static uint8_t start_sync(void) {
+	return ADC_Sync_Start(&sync) == ADC_OK;
+}
+
+static uint8_t stop_sync(void) {
+	return ADC_Sync_Stop(&sync) == ADC_OK;
+}
+
+// Fails each HAL call of the init in turn, then checks the claims of a working init, its stop and a restart
+static void check_user(const user_st* user) {
+	uint8_t ok = 0;
+
+	for (uint32_t n = 1; (n <= MAX_HAL_CALLS) && !ok; n++) {
+		Mock_Reset();
+		user->setup();
+		Mock_Hal_Fail_After(n);
+		ok = user->init();
+		Mock_Hal_Fail_After(0);
+
+		if (!ok) {
+			CHECK(channels_free(user->chan_mask), "%s: HAL call %u failed, channels still claimed", user->name, n);
+			Timer_Stop(&tim);
+		}
+	}
+	CHECK(ok, "%s: init failed without a failing HAL call", user->name);
+
+	CHECK(channels_taken(user->chan_mask), "%s: channels not claimed after the init", user->name);
+	CHECK(user->start(), "%s: start", user->name);
+	CHECK(user->stop(), "%s: stop", user->name);
+	CHECK(channels_free(user->chan_mask), "%s: channels still claimed after the stop", user->name);
+
+	// A stopped user that is started again takes its channels back
+	if (user->start != start_none) {
+		CHECK(user->start() && channels_taken(user->chan_mask), "%s: channels not claimed after a restart", user->name);
+	}
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const user_st users[] = {
+		{ "pwm", CHAN_MASK(1), setup_pwm, init_pwm, start_none, stop_pwm },
+		{ "capture it", CHAN_MASK(1), setup_capture_it, init_capture, start_capture, stop_capture },
+		{ "capture pwm input", CHAN_MASK(1) | CHAN_MASK(2), setup_capture_pwm_input, init_capture, start_capture, stop_capture },
+		{ "encoder", CHAN_MASK(1) | CHAN_MASK(2), setup_encoder, init_encoder, start_encoder, stop_encoder },
+		{ "timer wheel", CHAN_MASK(1), setup_wheel, init_wheel, start_wheel, stop_wheel },
+		{ "pulse software", CHAN_MASK(1), setup_pulse_software, init_pulse, start_pulse, stop_pulse },
+		{ "pulse ti1", CHAN_MASK(1) | CHAN_MASK(2), setup_pulse_ti1, init_pulse, start_pulse, stop_pulse },
+		{ "adc sync", CHAN_MASK(2), setup_sync, init_sync, start_sync, stop_sync },
+	};
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t u = 0; u < (sizeof(users) / sizeof(users[0])); u++) {
+		check_user(&users[u]);
+	}
+
+	printf("test_claims: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+/*
+ * test_control.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Compare values written by the control loop on the emulated timers.
+ *
+ *	The output of the loop is pinned to one duty by its limits, then the compare register written by Control_Step
+ *	must equal the one PWM_Set_Duty_HR writes for that duty. Covers counting up, down (one count less) and center
+ *	aligned, normal and inverted pwms, on a 16 and a 32 bit counter.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "adc_control.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+// Low enough for a 32 bit period on TIM2
+#define SLOW_FREQ_HZ			(1U)
+#define FEEDBACK				(100U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static const char* mode_name(Tim_Count_Mode_et count_mode) {
+	switch (count_mode) {
+		case COUNT_UP:
+			return "up";
+		case COUNT_DOWN:
+			return "down";
+		default:
+			return "center aligned";
+	}
+}
+
+// Runs the loop with its output pinned to duty_hr and returns the compare value it wrote
+static uint32_t loop_compare(Control_Loop_st* loop, uint16_t duty_hr) {
+	static const volatile uint16_t feedback = FEEDBACK;
+
+	loop->feedback = &feedback;
+	loop->pid = (Control_PID_st){ .kp_q16 = CONTROL_GAIN_ONE, .out_min = duty_hr, .out_max = duty_hr };
+	// Limits of 0 and 0 mean the full range: drive a negative error into a 0 - 1 range instead
+	if (duty_hr == 0) {
+		loop->pid.out_max = 1;
+		loop->setpoint = 0;
+	}
+
+	CHECK(Control_Init(loop) == ADC_OK, "Control_Init");
+	Control_Step(loop);
+	CHECK(loop->pwm->duty_hr == duty_hr, "loop output %u, want %u", loop->pwm->duty_hr, duty_hr);
+
+	return *loop->__ccr;
+}
+
+static void check_compares(uint8_t tim_num, uint32_t freq_hz, Tim_Count_Mode_et count_mode, uint8_t is_inverted) {
+	static const uint16_t duties[] = { 0, 1, 2, 100, 0x7FFF, 0x8000, 0xFFFE, PWM_DUTY_HR_MAX };
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwm = {0};
+	Control_Loop_st loop = {0};
+
+	Mock_Reset();
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = FREQ;
+	tim.freq_hz = freq_hz;
+	tim.count_mode = count_mode;
+	tim.channels.en_ch1 = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim%u %s Timer_Init", tim_num, mode_name(count_mode));
+
+	pwm = (PWM_st){ .tim = &tim, .chan_num = 1, .duty = 50, .is_inverted = is_inverted };
+	CHECK(PWM_Init(&pwm) == PWM_OK, "tim%u %s PWM_Init", tim_num, mode_name(count_mode));
+
+	loop.tim = &tim;
+	loop.pwm = &pwm;
+
+	for (uint8_t i = 0; i < (sizeof(duties) / sizeof(duties[0])); i++) {
+		uint32_t compare = loop_compare(&loop, duties[i]);
+
+		CHECK(PWM_Set_Duty_HR(&pwm, duties[i]) == PWM_OK, "PWM_Set_Duty_HR");
+		CHECK(compare == htim.Instance->CCR1, "tim%u %s%s duty %u: loop compare %u, pwm compare %u (ARR %u)", tim_num,
+				mode_name(count_mode), is_inverted ? " inverted" : "", duties[i], compare,
+				(unsigned)htim.Instance->CCR1, (unsigned)htim.Instance->ARR);
+	}
+
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const Tim_Count_Mode_et modes[] = { COUNT_UP, COUNT_DOWN, COUNT_CENTER_ALIGNED_1 };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t m = 0; m < (sizeof(modes) / sizeof(modes[0])); m++) {
+		for (uint8_t is_inverted = 0; is_inverted <= 1; is_inverted++) {
+			check_compares(3, PWM_FREQ_HZ, modes[m], is_inverted);
+			check_compares(2, SLOW_FREQ_HZ, modes[m], is_inverted);
+		}
+	}
+
+	printf("test_control: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,284 @@
+/*
+ * test_dither.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Duty dithering and spread spectrum on the emulated registers.
+ *
+ *	Checks:
+ *		- the sigma-delta dither only uses the two compare values around the ideal one and its average over 2^16
+ *		  periods is the ideal Q16 compare value, from the interrupt and from a DMA buffer, up and center aligned
+ *		- dithering and spread spectrum reject down counting timers
+ *		- the triangle sweep stays in the band, reaches both edges, moves by its slope and averages to the nominal
+ *		  period, the pseudo random periods cover the band with the nominal mean
+ *		- the compare values follow every spread period so the duty is kept
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "pwm_dither.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Fast enough for counts with a fraction, slow enough for a general timer interrupt
+#define PWM_FREQ_HZ				(1000U)
+#define DITHER_Q				(16U)
+#define DITHER_PERIODS			(1UL << DITHER_Q)
+#define DMA_PERIODS				(256U)
+#define BAND_PERMILLE			(50U)
+#define MOD_PERIODS				(200U)
+// A full cycle of the 16 bit random generator
+#define RANDOM_PERIODS			(0xFFFFU)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static DMA_HandleTypeDef hdma;
+static Timer_st tim;
+static PWM_st pwm;
+static uint32_t buffer[DMA_PERIODS];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static const char* mode_name(Tim_Count_Mode_et count_mode) {
+	switch (count_mode) {
+		case COUNT_UP:
+			return "up";
+		case COUNT_DOWN:
+			return "down";
+		default:
+			return "center aligned";
+	}
+}
+
+// Pwm on channel 1 of TIM3 with the update interrupt and DMA
+static void init_pwm(Tim_Count_Mode_et count_mode, uint16_t duty_hr, uint8_t is_inverted) {
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	hdma = (DMA_HandleTypeDef){0};
+	htim.hdma[TIM_DMA_ID_UPDATE] = &hdma;
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = PWM_FREQ_HZ;
+	tim.count_mode = count_mode;
+	tim.channels.en_ch1 = 1;
+	tim.it_config.en_it = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "%s Timer_Init", mode_name(count_mode));
+
+	pwm = (PWM_st){ .tim = &tim, .chan_num = 1, .is_inverted = is_inverted };
+	CHECK(PWM_Init(&pwm) == PWM_OK, "%s PWM_Init", mode_name(count_mode));
+	CHECK(PWM_Set_Duty_HR(&pwm, duty_hr) == PWM_OK, "%s PWM_Set_Duty_HR", mode_name(count_mode));
+}
+
+// Ideal compare value in Q16 counts, rounded
+static uint64_t ideal_compare_q16(uint16_t duty_hr) {
+	uint16_t duty = pwm.is_inverted ? (uint16_t)(PWM_DUTY_HR_MAX - duty_hr) : duty_hr;
+
+	return (((PWM_Get_Duty_Counts(&tim) * duty) << DITHER_Q) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX;
+}
+
+static void check_dither_it(Tim_Count_Mode_et count_mode, uint16_t duty_hr, uint8_t is_inverted) {
+	const char* name = mode_name(count_mode);
+	PWM_Dither_st dither = { .pwm = &pwm };
+	uint64_t ideal;
+	uint64_t sum = 0;
+
+	init_pwm(count_mode, duty_hr, is_inverted);
+	CHECK(PWM_Dither_Init(&dither) == PWM_OK, "%s PWM_Dither_Init", name);
+	ideal = ideal_compare_q16(duty_hr);
+
+	for (uint32_t i = 0; i < DITHER_PERIODS; i++) {
+		uint32_t compare;
+
+		PWM_Dither_Tick(&dither, &htim);
+		compare = htim.Instance->CCR1;
+		CHECK((compare == (ideal >> DITHER_Q)) || (compare == (ideal >> DITHER_Q) + 1), "%s duty %u: compare %u, ideal %.3f",
+				name, duty_hr, compare, (double)ideal / DITHER_PERIODS);
+		sum += compare;
+	}
+
+	CHECK(sum == ideal, "%s%s duty %u: average %.6f, ideal %.6f", name, is_inverted ? " inverted" : "", duty_hr,
+			(double)sum / DITHER_PERIODS, (double)ideal / DITHER_PERIODS);
+
+	CHECK(PWM_Dither_Stop(&dither) == PWM_OK, "%s PWM_Dither_Stop", name);
+	Timer_Stop(&tim);
+}
+
+// A buffer of 2^8 periods averages to the ideal compare value to 8 fractional bits
+static void check_dither_dma(Tim_Count_Mode_et count_mode, uint16_t duty_hr) {
+	const char* name = mode_name(count_mode);
+	PWM_Dither_st dither = { .pwm = &pwm, .buffer = buffer, .buffer_len = DMA_PERIODS };
+	uint64_t ideal;
+	uint64_t sum = 0;
+
+	init_pwm(count_mode, duty_hr, 0);
+	CHECK(PWM_Dither_Init(&dither) == PWM_OK, "%s dma PWM_Dither_Init", name);
+	CHECK(htim.Instance->DIER & TIM_DMA_UPDATE, "%s dma not started", name);
+	ideal = ideal_compare_q16(duty_hr);
+
+	for (uint32_t i = 0; i < DMA_PERIODS; i++) {
+		sum += buffer[i];
+	}
+
+	CHECK((sum * (DITHER_PERIODS / DMA_PERIODS) <= ideal) && (ideal - (sum * (DITHER_PERIODS / DMA_PERIODS)) < (DITHER_PERIODS / DMA_PERIODS)),
+			"%s dma duty %u: average %.6f, ideal %.6f", name, duty_hr, (double)sum / DMA_PERIODS, (double)ideal / DITHER_PERIODS);
+
+	CHECK(PWM_Dither_Stop(&dither) == PWM_OK, "%s dma PWM_Dither_Stop", name);
+	CHECK(!(htim.Instance->DIER & TIM_DMA_UPDATE), "%s dma not stopped", name);
+	Timer_Stop(&tim);
+}
+
+static void check_down_rejected(void) {
+	PWM_Dither_st dither = { .pwm = &pwm };
+	PWM_st* pwms[1] = { &pwm };
+	PWM_Spread_st spread = { .tim = &tim, .pwms = pwms, .num_pwms = 1, .profile = SPREAD_TRIANGLE,
+			.band_permille = BAND_PERMILLE, .mod_periods = MOD_PERIODS };
+
+	init_pwm(COUNT_DOWN, 0x4000, 0);
+	CHECK(PWM_Dither_Init(&dither) == PWM_DITHER_INVALID, "down counting dither accepted");
+	CHECK(PWM_Spread_Init(&spread) == PWM_DITHER_INVALID, "down counting spread accepted");
+	Timer_Stop(&tim);
+}
+
+// Runs a spread over num_periods from the interrupt, checks the band and the compare of every period
+static void run_spread(PWM_Spread_st* spread, uint32_t num_periods, const char* name, uint32_t* min_arr,
+		uint32_t* max_arr, uint64_t* sum_arr, uint32_t* max_jump) {
+	uint32_t nominal = htim.Init.Period;
+	uint32_t dev = spread->__dev;
+	uint32_t last = nominal;
+
+	*min_arr = UINT32_MAX;
+	*max_arr = 0;
+	*sum_arr = 0;
+	*max_jump = 0;
+
+	for (uint32_t i = 0; i < num_periods; i++) {
+		uint32_t arr;
+		uint32_t want;
+
+		PWM_Spread_Tick(spread, &htim);
+		arr = htim.Instance->ARR;
+		want = (uint32_t)((((uint64_t)arr + 1) * pwm.duty_hr + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+
+		CHECK((arr >= nominal - dev) && (arr <= nominal + dev), "%s: period %u ARR %u outside %u +- %u", name, i, arr,
+				nominal, dev);
+		CHECK(htim.Instance->CCR1 == want, "%s: period %u ARR %u compare %u, want %u", name, i, arr,
+				(unsigned)htim.Instance->CCR1, want);
+
+		*min_arr = (arr < *min_arr) ? arr : *min_arr;
+		*max_arr = (arr > *max_arr) ? arr : *max_arr;
+		*sum_arr += arr;
+		if ((i > 0) && ((uint32_t)abs((int32_t)(arr - last)) > *max_jump)) {
+			*max_jump = (uint32_t)abs((int32_t)(arr - last));
+		}
+		last = arr;
+	}
+}
+
+static void check_spread_triangle(void) {
+	PWM_st* pwms[1] = { &pwm };
+	PWM_Spread_st spread = { .tim = &tim, .pwms = pwms, .num_pwms = 1, .profile = SPREAD_TRIANGLE,
+			.band_permille = BAND_PERMILLE, .mod_periods = MOD_PERIODS };
+	uint32_t nominal;
+	uint32_t step;
+	uint32_t min_arr;
+	uint32_t max_arr;
+	uint64_t sum_arr;
+	uint32_t max_jump;
+
+	init_pwm(COUNT_UP, 0x5555, 0);
+	nominal = htim.Init.Period;
+	CHECK(PWM_Spread_Init(&spread) == PWM_OK, "triangle PWM_Spread_Init");
+	CHECK(spread.__dev == ((nominal + 1) * BAND_PERMILLE) / 1000, "triangle deviation %u", spread.__dev);
+	// Up and down the full band once per modulation cycle
+	step = (4 * spread.__dev) / MOD_PERIODS;
+	CHECK(PWM_Spread_Start(&spread) == PWM_OK, "triangle PWM_Spread_Start");
+
+	// Whole modulation cycles
+	run_spread(&spread, 10 * MOD_PERIODS, "triangle", &min_arr, &max_arr, &sum_arr, &max_jump);
+	CHECK(min_arr <= nominal - spread.__dev + step, "triangle: lowest ARR %u, band edge %u", min_arr, nominal - spread.__dev);
+	CHECK(max_arr >= nominal + spread.__dev - step, "triangle: highest ARR %u, band edge %u", max_arr, nominal + spread.__dev);
+	CHECK(max_jump <= step + 1, "triangle: ARR moved by %u, slope %u", max_jump, step);
+	CHECK(llabs((long long)sum_arr - ((long long)nominal * 10 * MOD_PERIODS)) <= (long long)(10 * MOD_PERIODS),
+			"triangle: mean ARR %.3f, nominal %u", (double)sum_arr / (10 * MOD_PERIODS), nominal);
+
+	CHECK(PWM_Spread_Stop(&spread) == PWM_OK, "triangle PWM_Spread_Stop");
+	CHECK(htim.Instance->ARR == nominal, "triangle: ARR %u after the stop", (unsigned)htim.Instance->ARR);
+	Timer_Stop(&tim);
+}
+
+static void check_spread_random(void) {
+	PWM_st* pwms[1] = { &pwm };
+	PWM_Spread_st spread = { .tim = &tim, .pwms = pwms, .num_pwms = 1, .profile = SPREAD_RANDOM,
+			.band_permille = BAND_PERMILLE };
+	uint32_t nominal;
+	uint32_t min_arr;
+	uint32_t max_arr;
+	uint64_t sum_arr;
+	uint32_t max_jump;
+	// ARR counts per step of the 16 bit generator
+	uint32_t resolution;
+
+	init_pwm(COUNT_UP, 0xC000, 0);
+	nominal = htim.Init.Period;
+	CHECK(PWM_Spread_Init(&spread) == PWM_OK, "random PWM_Spread_Init");
+	resolution = ((2 * spread.__dev) >> 16) + 1;
+	CHECK(PWM_Spread_Start(&spread) == PWM_OK, "random PWM_Spread_Start");
+
+	run_spread(&spread, RANDOM_PERIODS, "random", &min_arr, &max_arr, &sum_arr, &max_jump);
+	CHECK(min_arr <= nominal - spread.__dev + resolution, "random: lowest ARR %u, band edge %u", min_arr,
+			nominal - spread.__dev);
+	CHECK(max_arr >= nominal + spread.__dev - resolution, "random: highest ARR %u, band edge %u", max_arr,
+			nominal + spread.__dev);
+	// Every state of the generator once: the mean is the middle of the band
+	CHECK(llabs((long long)sum_arr - ((long long)nominal * RANDOM_PERIODS)) <= (long long)RANDOM_PERIODS,
+			"random: mean ARR %.3f, nominal %u", (double)sum_arr / RANDOM_PERIODS, nominal);
+	// Consecutive periods are not a sweep
+	CHECK(max_jump > spread.__dev, "random: ARR never moved by more than %u", max_jump);
+
+	CHECK(PWM_Spread_Stop(&spread) == PWM_OK, "random PWM_Spread_Stop");
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const Tim_Count_Mode_et modes[] = { COUNT_UP, COUNT_CENTER_ALIGNED_1 };
+	static const uint16_t duties[] = { 0, 1, 0x1234, 0x8000, 0xABCD, 0xFFFE, PWM_DUTY_HR_MAX };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t m = 0; m < (sizeof(modes) / sizeof(modes[0])); m++) {
+		for (uint8_t d = 0; d < (sizeof(duties) / sizeof(duties[0])); d++) {
+			check_dither_it(modes[m], duties[d], 0);
+			check_dither_dma(modes[m], duties[d]);
+		}
+		check_dither_it(modes[m], 0x1234, 1);
+	}
+	check_down_rejected();
+	check_spread_triangle();
+	check_spread_random();
+
+	printf("test_dither: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
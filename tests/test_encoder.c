@@ -0,0 +1,319 @@
+/*
+ * test_encoder.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Quadrature encoder position and velocity of Timer_Encoder on the emulated timers.
+ *
+ *	The encoder is stepped one edge at a time with Mock_Tim_Input_Edge on TI1 (A) and TI2 (B), A leading B when
+ *	moving forward. Checks, on 16 and 32 bit timers:
+ *		- every mode counts the edges it should, in both directions and inverted, exact to the edge between updates
+ *		- the position is extended past the counter range over many wraps, and across the wrap of a preset counter
+ *		- moves of just under half the counter range between two updates are followed both ways
+ *		- the velocity of a constant speed, including fractional counts per update, over one and several updates
+ *		- Timer_Encoder_Set_Position and a stop / start keep the position
+ *		- timers without an encoder interface, uninitialized timers, a zero update rate and used channels are rejected
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "tim_encoder.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static Encoder_st enc;
+
+// Quadrature phase of the inputs, A and B levels: 0 (0, 0), 1 (1, 0), 2 (1, 1), 3 (0, 1)
+static uint8_t phase;
+// Position the encoder should report
+static int64_t want;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Encoder on a timer with its inputs low and its position at 0
+static void init_encoder(uint8_t tim_num, Encoder_Mode_et mode, uint8_t is_inverted, uint32_t update_hz,
+		uint16_t velocity_updates) {
+	// Frees the timer number of the previous encoder
+	if (tim.htim != NULL) {
+		Timer_Stop(&tim);
+	}
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = FREQ;
+	tim.freq_hz = 1000;
+	tim.count_mode = COUNT_UP;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+
+	enc = (Encoder_st){ .tim = &tim, .mode = mode, .is_inverted = is_inverted, .update_hz = update_hz,
+			.velocity_updates = velocity_updates };
+	CHECK(Timer_Encoder_Init(&enc) == TIM_OK, "tim%u Timer_Encoder_Init", tim_num);
+	CHECK(Timer_Encoder_Start(&enc) == TIM_OK, "tim%u Timer_Encoder_Start", tim_num);
+	phase = 0;
+	want = 0;
+}
+
+// Moves the encoder by num_edges edges, forward when positive, and tracks the expected position
+static void move(int32_t num_edges) {
+	static const uint8_t a_levels[4] = { 0, 1, 1, 0 };
+	static const uint8_t b_levels[4] = { 0, 0, 1, 1 };
+	uint8_t forward = (num_edges > 0);
+	uint32_t n = forward ? (uint32_t)num_edges : (uint32_t)-num_edges;
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint8_t next = (uint8_t)((phase + (forward ? 1U : 3U)) & 3U);
+		// Only one input changes per step
+		uint8_t ti = (a_levels[phase] != a_levels[next]) ? 1U : 2U;
+		uint8_t level = (ti == 1U) ? a_levels[next] : b_levels[next];
+		uint8_t counted = (enc.mode == ENCODER_X4) || ((enc.mode == ENCODER_X2_TI1) == (ti == 1U));
+
+		Mock_Tim_Input_Edge(htim.Instance, ti, level);
+		phase = next;
+		if (counted && (htim.Instance->CR1 & TIM_CR1_CEN)) {
+			want += (forward != enc.is_inverted) ? 1 : -1;
+		}
+	}
+}
+
+// Moves in steps of step_edges, checking the position after every step and updating every update_steps steps
+static void run(const char* name, int32_t num_edges, int32_t step_edges, uint32_t update_steps) {
+	uint32_t num_steps = (uint32_t)(num_edges / step_edges);
+
+	for (uint32_t s = 1; s <= num_steps; s++) {
+		int64_t position;
+
+		move(step_edges);
+		if ((s % update_steps) == 0) {
+			Timer_Encoder_Update(&enc);
+		}
+		position = Timer_Encoder_Get_Position(&enc);
+		CHECK(position == want, "%s: position %lld, want %lld", name, (long long)position, (long long)want);
+		if (failures > 20) {
+			return;
+		}
+	}
+}
+
+// Edges counted by each mode, both ways, on a timer
+static void check_counting(uint8_t tim_num, Encoder_Mode_et mode, uint8_t is_inverted) {
+	// Counts per quadrature cycle of 4 edges
+	int64_t per_cycle = (mode == ENCODER_X4) ? 4 : 2;
+	int64_t sign = is_inverted ? -1 : 1;
+	char name[64];
+
+	snprintf(name, sizeof(name), "tim%u %s%s", tim_num,
+			(mode == ENCODER_X4) ? "x4" : ((mode == ENCODER_X2_TI1) ? "x2 on A" : "x2 on B"), is_inverted ? " inverted" : "");
+	init_encoder(tim_num, mode, is_inverted, 1000, 1);
+
+	run(name, 1000, 1, 100);
+	CHECK(want == sign * per_cycle * 250, "%s: %lld counts for 250 cycles forward", name, (long long)want);
+	run(name, -3000, -1, 100);
+	CHECK(want == -sign * per_cycle * 500, "%s: %lld counts for 500 cycles back", name, (long long)want);
+}
+
+// Many wraps of a 16 bit counter, updated well within half its range
+static void check_wraps(void) {
+	init_encoder(3, ENCODER_X4, 0, 1000, 1);
+
+	run("tim3 wraps", 200000, 100, 200);
+	CHECK(want == 200000, "tim3 wraps: %lld counts forward", (long long)want);
+	run("tim3 wraps", -500000, -100, 200);
+	CHECK(want == -300000, "tim3 wraps: %lld counts back", (long long)want);
+}
+
+// Moves the counter by counts in one go, as a fast encoder does between two updates
+static void jump(int64_t counts) {
+	uint64_t range = (uint64_t)htim.Instance->ARR + 1;
+
+	htim.Instance->CNT = (uint32_t)(((uint64_t)htim.Instance->CNT + range + (uint64_t)(counts % (int64_t)range)) % range);
+	want += counts;
+}
+
+// Just under half the counter range between two updates, both ways
+static void check_half_range(uint8_t tim_num) {
+	int64_t half;
+
+	init_encoder(tim_num, ENCODER_X4, 0, 1000, 1);
+	half = (int64_t)(((uint64_t)htim.Instance->ARR + 1) / 2);
+
+	for (uint8_t i = 0; i < 4; i++) {
+		jump(half - 1);
+		Timer_Encoder_Update(&enc);
+		CHECK(Timer_Encoder_Get_Position(&enc) == want, "tim%u half range: position %lld after +%lld, want %lld", tim_num,
+				(long long)Timer_Encoder_Get_Position(&enc), (long long)(half - 1), (long long)want);
+	}
+	for (uint8_t i = 0; i < 8; i++) {
+		jump(-half);
+		Timer_Encoder_Update(&enc);
+		CHECK(Timer_Encoder_Get_Position(&enc) == want, "tim%u half range: position %lld after -%lld, want %lld", tim_num,
+				(long long)Timer_Encoder_Get_Position(&enc), (long long)half, (long long)want);
+	}
+}
+
+// A counter preset just below its top wraps to 0 without changing the position
+static void check_preset_wrap(uint8_t tim_num) {
+	uint32_t top;
+
+	init_encoder(tim_num, ENCODER_X4, 0, 1000, 1);
+	top = htim.Instance->ARR;
+	CHECK(top == (IS_TIM_32B_COUNTER_INSTANCE(htim.Instance) ? 0xFFFFFFFFU : 0xFFFFU), "tim%u: counter range %u", tim_num,
+			(unsigned)top);
+
+	htim.Instance->CNT = top - 99;
+	Timer_Encoder_Set_Position(&enc, 5);
+	want = 5;
+	run("preset wrap", 1000, 10, 10);
+	CHECK(htim.Instance->CNT == 900, "tim%u: counter at %u after the wrap", tim_num, (unsigned)htim.Instance->CNT);
+	run("preset wrap", -2000, -10, 10);
+	CHECK(want == -995, "tim%u: %lld counts", tim_num, (long long)want);
+}
+
+// Constant speeds forward then back, the velocity measured over velocity_updates updates
+static void check_velocity(uint16_t velocity_updates, uint8_t is_inverted) {
+	uint32_t update_hz = 2000;
+	uint16_t window = (velocity_updates > 1) ? velocity_updates : 1;
+	int64_t sign = is_inverted ? -1 : 1;
+
+	init_encoder(4, ENCODER_X4, is_inverted, update_hz, velocity_updates);
+
+	// 3.5 counts per update forward, then 5 back
+	for (uint32_t u = 1; u <= 64; u++) {
+		int32_t edges = (u <= 32) ? (((u & 1U) != 0) ? 3 : 4) : -5;
+		int32_t velocity;
+		int64_t expected;
+
+		move(edges);
+		Timer_Encoder_Update(&enc);
+		velocity = Timer_Encoder_Get_Velocity(&enc);
+
+		if (u < window) {
+			expected = 0;
+		}
+		else if (u <= 32) {
+			// Windows of one update see 3 or 4 counts, longer (even) ones 3.5 on average
+			expected = (window == 1) ? (edges * (int64_t)update_hz) : (3500 * (int64_t)update_hz / 1000);
+		}
+		else if (u >= 32U + window) {
+			expected = -5 * (int64_t)update_hz;
+		}
+		else {
+			continue;
+		}
+		// The velocity only changes at the end of a window
+		if ((u % window) != 0) {
+			continue;
+		}
+		CHECK(velocity == sign * expected, "velocity over %u updates%s: %d counts/s after %u updates, want %lld", window,
+				is_inverted ? " inverted" : "", velocity, u, (long long)(sign * expected));
+	}
+}
+
+// Setting the position, stopping and restarting
+static void check_set_position(void) {
+	init_encoder(2, ENCODER_X4, 0, 1000, 4);
+
+	move(1234);
+	Timer_Encoder_Update(&enc);
+	Timer_Encoder_Set_Position(&enc, -12345);
+	want = -12345;
+	CHECK(Timer_Encoder_Get_Position(&enc) == want, "set position: %lld", (long long)Timer_Encoder_Get_Position(&enc));
+	CHECK(Timer_Encoder_Get_Velocity(&enc) == 0, "set position: velocity %d", Timer_Encoder_Get_Velocity(&enc));
+	run("set position", 40, 10, 1);
+
+	CHECK(Timer_Encoder_Stop(&enc) == TIM_OK, "Timer_Encoder_Stop");
+	move(100);
+	Timer_Encoder_Update(&enc);
+	CHECK(Timer_Encoder_Get_Position(&enc) == -12305, "stopped: position %lld", (long long)Timer_Encoder_Get_Position(&enc));
+	CHECK(Timer_Encoder_Start(&enc) == TIM_OK, "Timer_Encoder_Start after a stop");
+	run("restarted", 40, 10, 1);
+	CHECK(want == -12265, "restarted: %lld counts", (long long)want);
+	Timer_Encoder_Stop(&enc);
+}
+
+static void check_rejected(void) {
+	TIM_HandleTypeDef other_htim = {0};
+	Timer_st other = { .htim = &other_htim, .tim_num = 9, .timing = FREQ, .freq_hz = 1000, .count_mode = COUNT_UP };
+	PWM_st pwm = { .tim = &tim, .chan_num = 2, .duty = 50 };
+
+	Timer_Stop(&tim);
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){ .htim = &htim, .tim_num = 3, .timing = FREQ, .freq_hz = 1000, .count_mode = COUNT_UP };
+	enc = (Encoder_st){ .tim = &tim, .mode = ENCODER_X4, .update_hz = 1000 };
+	CHECK(Timer_Encoder_Init(&enc) == TIM_UNINIT, "uninitialized timer accepted");
+
+	CHECK(Timer_Init(&other) == TIM_OK, "tim9 Timer_Init");
+	enc.tim = &other;
+	CHECK(Timer_Encoder_Init(&enc) == TIM_ENCODER_UNSUPPORTED, "tim9 accepted");
+	Timer_Stop(&other);
+
+	tim.channels.en_ch2 = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim3 Timer_Init");
+	enc.tim = &tim;
+	enc.update_hz = 0;
+	CHECK(Timer_Encoder_Init(&enc) == TIM_FREQ_ZERO, "zero update rate accepted");
+
+	// Channel B taken by a pwm: channel A is given back
+	enc.update_hz = 1000;
+	CHECK(PWM_Init(&pwm) == PWM_OK, "PWM_Init");
+	CHECK(Timer_Encoder_Init(&enc) == TIM_CH_IN_USE, "encoder over a pwm channel accepted");
+	CHECK(Timer_Claim_Channel(&tim, 1, &pwm) == TIM_OK, "channel A kept by a rejected encoder");
+	Timer_Release_Channel(&tim, 1, &pwm);
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const uint8_t tim_nums[] = { 1, 2, 3, 8 };
+	static const Encoder_Mode_et modes[] = { ENCODER_X2_TI1, ENCODER_X2_TI2, ENCODER_X4 };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t t = 0; t < (sizeof(tim_nums) / sizeof(tim_nums[0])); t++) {
+		for (uint8_t m = 0; m < (sizeof(modes) / sizeof(modes[0])); m++) {
+			check_counting(tim_nums[t], modes[m], 0);
+			check_counting(tim_nums[t], modes[m], 1);
+		}
+	}
+
+	check_wraps();
+	check_half_range(3);
+	check_half_range(2);
+	check_preset_wrap(3);
+	check_preset_wrap(2);
+
+	check_velocity(1, 0);
+	check_velocity(8, 0);
+	check_velocity(8, 1);
+	check_set_position();
+
+	check_rejected();
+
+	printf("test_encoder: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,356 @@
+/*
+ * test_group.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Master / slave timer groups of Timer_Group on the emulated timers.
+ *
+ *	The master is counted with Mock_Tim_Count and its trigger output (Mock_Tim_TRGO) fed to the slaves with
+ *	Mock_Tim_Slave_Count on every count, all timers on the APB1 clock. Checks:
+ *		- every slave selects the ITRx line wired to the master, in the slave mode of the group
+ *		- nothing counts between Timer_Group_Init and Timer_Group_Start, or after Timer_Group_Stop
+ *		- trigger slaves start on the same count as the master and stay locked to it, offset by start_counts
+ *		- reset slaves with a longer period of their own follow the master counter from its first update
+ *		- gated slaves count exactly the high time of the master's channel 1 every period
+ *		- cascaded slaves extend the master: Timer_Group_Read_Cascade is the number of master counts since the
+ *		  start, modulo the range of a 16 bit slave
+ *		- unwired timers, uninitialized timers and a cascade from a master that does not count up are rejected
+ *		  before anything is changed
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timer_group.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define MAX_SLAVES				(3U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef master_htim;
+static Timer_st master;
+static TIM_HandleTypeDef slave_htims[MAX_SLAVES];
+static Timer_st slave_tims[MAX_SLAVES];
+static Timer_st* slaves[MAX_SLAVES];
+static Timer_Group_st group;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static void init_timer(Timer_st* tim, TIM_HandleTypeDef* htim, uint8_t tim_num, uint32_t freq_hz,
+		Tim_Count_Mode_et count_mode, uint8_t en_ch1) {
+	*htim = (TIM_HandleTypeDef){0};
+	*tim = (Timer_st){0};
+	tim->htim = htim;
+	tim->tim_num = tim_num;
+	tim->timing = FREQ;
+	tim->freq_hz = freq_hz;
+	tim->count_mode = count_mode;
+	tim->channels.en_ch1 = en_ch1;
+	CHECK(Timer_Init(tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+}
+
+// Master with channel 1 and num_slaves slaves (slave_nums), not yet grouped
+static void init_group(uint8_t master_num, uint32_t master_hz, const uint8_t slave_nums[], uint32_t slave_hz,
+		uint8_t num_slaves, Tim_Slave_Mode_et mode) {
+	Mock_Reset();
+	init_timer(&master, &master_htim, master_num, master_hz, COUNT_UP, 1);
+	for (uint8_t i = 0; i < num_slaves; i++) {
+		init_timer(&slave_tims[i], &slave_htims[i], slave_nums[i], slave_hz, COUNT_UP, 0);
+		slaves[i] = &slave_tims[i];
+	}
+	group = (Timer_Group_st){ .master = &master, .slaves = slaves, .num_slaves = num_slaves, .mode = mode };
+}
+
+// Frees the timers of the group for the next one
+static void release(void) {
+	Timer_Stop(&master);
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		Timer_Stop(&slave_tims[i]);
+	}
+}
+
+// Timer_Group_Start writes UG and then loads the counter. The mock applies EGR at the next count, so the events are
+// applied here keeping the loaded counters
+static void settle(void) {
+	TIM_TypeDef* regs = master_htim.Instance;
+	uint32_t cnt = regs->CNT;
+
+	Mock_Tim_Apply_Events(regs);
+	regs->CNT = cnt;
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		regs = slave_htims[i].Instance;
+		cnt = regs->CNT;
+		Mock_Tim_Apply_Events(regs);
+		regs->CNT = cnt;
+	}
+}
+
+// One count of the master, its trigger output applied to every slave
+static void tick(void) {
+	uint8_t trgo;
+
+	Mock_Tim_Count(master_htim.Instance);
+	trgo = Mock_Tim_TRGO(master_htim.Instance);
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		Mock_Tim_Slave_Count(slave_htims[i].Instance, trgo);
+	}
+}
+
+// Master trigger output and slave mode of every slave, on the ITRx line wired to the master
+static void check_connections(const char* name, uint32_t trgo, uint32_t sms, const uint32_t itr[]) {
+	CHECK((master_htim.Instance->CR2 & TIM_CR2_MMS) == trgo, "%s: master trigger output 0x%x", name,
+			(unsigned)(master_htim.Instance->CR2 & TIM_CR2_MMS));
+	CHECK(master_htim.Instance->SMCR & TIM_SMCR_MSM, "%s: master / slave mode off", name);
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		TIM_TypeDef* regs = slave_htims[i].Instance;
+
+		CHECK((regs->SMCR & TIM_SMCR_SMS) == sms, "%s: tim%u slave mode 0x%x", name, slaves[i]->tim_num,
+				(unsigned)(regs->SMCR & TIM_SMCR_SMS));
+		CHECK((regs->SMCR & TIM_SMCR_TS) == itr[i], "%s: tim%u trigger 0x%x, want 0x%x", name, slaves[i]->tim_num,
+				(unsigned)(regs->SMCR & TIM_SMCR_TS), (unsigned)itr[i]);
+	}
+}
+
+// No counter moves
+static void check_idle(const char* name) {
+	uint32_t master_cnt = master_htim.Instance->CNT;
+	uint32_t slave_cnts[MAX_SLAVES];
+
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		slave_cnts[i] = slave_htims[i].Instance->CNT;
+	}
+	for (uint32_t t = 0; t < 1000; t++) {
+		tick();
+	}
+
+	CHECK(master_htim.Instance->CNT == master_cnt, "%s: master counting", name);
+	for (uint8_t i = 0; i < group.num_slaves; i++) {
+		CHECK(slave_htims[i].Instance->CNT == slave_cnts[i], "%s: tim%u counting", name, slaves[i]->tim_num);
+	}
+}
+
+// Slaves started by the master's enable, with phase offsets
+static void check_trigger(void) {
+	static const uint8_t slave_nums[] = { 3, 4, 5 };
+	static const uint32_t itr[] = { TIM_TS_ITR1, TIM_TS_ITR1, TIM_TS_ITR0 };
+	static const uint32_t start_counts[] = { 0, 1000, 5000 };
+	uint32_t counts;
+
+	init_group(2, 20000, slave_nums, 20000, 3, SLAVE_TRIGGER);
+	group.start_counts = start_counts;
+	CHECK(Timer_Group_Init(&group) == TIM_OK, "trigger: Timer_Group_Init");
+	check_connections("trigger", TIM_TRGO_ENABLE, TIM_SLAVEMODE_TRIGGER, itr);
+	check_idle("trigger before the start");
+
+	counts = master_htim.Instance->ARR + 1;
+	for (uint8_t run = 0; run < 2; run++) {
+		CHECK(Timer_Group_Start(&group) == TIM_OK, "trigger: Timer_Group_Start");
+		settle();
+		for (uint8_t i = 0; i < group.num_slaves; i++) {
+			CHECK(slave_htims[i].Instance->PSC == master_htim.Instance->PSC, "trigger: tim%u prescaler", slaves[i]->tim_num);
+			CHECK(slave_htims[i].Instance->CNT == start_counts[i], "trigger run %u: tim%u loaded with %u", run,
+					slaves[i]->tim_num, (unsigned)slave_htims[i].Instance->CNT);
+		}
+
+		for (uint32_t t = 1; t <= 3 * counts; t++) {
+			tick();
+			CHECK(master_htim.Instance->CNT == (t % counts), "trigger run %u: master at %u after %u counts", run,
+					(unsigned)master_htim.Instance->CNT, t);
+			for (uint8_t i = 0; i < group.num_slaves; i++) {
+				uint32_t want = (master_htim.Instance->CNT + start_counts[i]) % counts;
+
+				CHECK(slave_htims[i].Instance->CNT == want, "trigger run %u: tim%u at %u, want %u after %u counts", run,
+						slaves[i]->tim_num, (unsigned)slave_htims[i].Instance->CNT, want, t);
+			}
+		}
+
+		CHECK(Timer_Group_Stop(&group) == TIM_OK, "trigger: Timer_Group_Stop");
+		check_idle("trigger after the stop");
+	}
+	release();
+}
+
+// A slave slower than the master, reset at every master update
+static void check_reset(void) {
+	static const uint8_t slave_nums[] = { 3 };
+	static const uint32_t itr[] = { TIM_TS_ITR1 };
+	TIM_TypeDef* slave;
+	uint32_t counts;
+	uint32_t t = 0;
+
+	init_group(2, 10000, slave_nums, 9000, 1, SLAVE_RESET);
+	slave = slave_htims[0].Instance;
+	CHECK(Timer_Group_Init(&group) == TIM_OK, "reset: Timer_Group_Init");
+	check_connections("reset", TIM_TRGO_UPDATE, TIM_SLAVEMODE_COMBINED_RESETTRIGGER, itr);
+	check_idle("reset before the start");
+
+	CHECK(Timer_Group_Start(&group) == TIM_OK, "reset: Timer_Group_Start");
+	settle();
+	counts = master_htim.Instance->ARR + 1;
+	CHECK(slave->ARR + 1 > counts, "reset: slave period %u not longer than the master's %u", (unsigned)slave->ARR + 1, counts);
+
+	// The start update is consumed by settle, the first master update starts the slave
+	do {
+		tick();
+		t++;
+	} while ((master_htim.Instance->CNT != 0) && (t <= counts));
+
+	for (t = 0; t < 5 * counts; t++) {
+		tick();
+		CHECK(slave->CNT == master_htim.Instance->CNT, "reset: slave at %u, master at %u", (unsigned)slave->CNT,
+				(unsigned)master_htim.Instance->CNT);
+	}
+
+	Timer_Group_Stop(&group);
+	check_idle("reset after the stop");
+	release();
+}
+
+// A slave counting while the master's channel 1 is high
+static void check_gated(void) {
+	static const uint8_t slave_nums[] = { 3 };
+	static const uint32_t itr[] = { TIM_TS_ITR1 };
+	static const uint32_t start_counts[] = { 500 };
+	PWM_st pwm = {0};
+	TIM_TypeDef* slave;
+	uint32_t counts;
+	uint32_t high;
+
+	init_group(2, 10000, slave_nums, 1000, 1, SLAVE_GATED);
+	slave = slave_htims[0].Instance;
+	group.start_counts = start_counts;
+	pwm.tim = &master;
+	pwm.chan_num = 1;
+	pwm.duty = 25;
+	CHECK(PWM_Init(&pwm) == PWM_OK, "gated: PWM_Init");
+	CHECK(Timer_Group_Init(&group) == TIM_OK, "gated: Timer_Group_Init");
+	check_connections("gated", TIM_TRGO_OC1REF, TIM_SLAVEMODE_GATED, itr);
+	check_idle("gated before the start");
+
+	CHECK(Timer_Group_Start(&group) == TIM_OK, "gated: Timer_Group_Start");
+	settle();
+	counts = master_htim.Instance->ARR + 1;
+	high = master_htim.Instance->CCR1;
+
+	for (uint32_t period = 1; period <= 3; period++) {
+		for (uint32_t t = 0; t < counts; t++) {
+			tick();
+		}
+		CHECK(slave->CNT == start_counts[0] + (period * high), "gated: slave at %u after %u periods of %u high counts",
+				(unsigned)slave->CNT, period, high);
+	}
+
+	Timer_Group_Stop(&group);
+	check_idle("gated after the stop");
+	release();
+}
+
+// 32 and 16 bit slaves counting updates of a fast master
+static void check_cascade(void) {
+	static const uint8_t slave_nums[] = { 2, 4 };
+	static const uint32_t itr[] = { TIM_TS_ITR2, TIM_TS_ITR2 };
+	uint64_t counts;
+	uint64_t range;
+	uint64_t t;
+
+	// 100 counts per master period
+	init_group(3, 1080000, slave_nums, 1000, 2, SLAVE_CASCADE);
+	CHECK(Timer_Group_Init(&group) == TIM_OK, "cascade: Timer_Group_Init");
+	check_connections("cascade", TIM_TRGO_UPDATE, TIM_SLAVEMODE_EXTERNAL1, itr);
+	CHECK((slave_htims[0].Instance->PSC == 0) && (slave_htims[0].Instance->ARR == 0xFFFFFFFFU), "cascade: tim2 not on its full range");
+	CHECK((slave_htims[1].Instance->PSC == 0) && (slave_htims[1].Instance->ARR == 0xFFFFU), "cascade: tim4 not on its full range");
+	check_idle("cascade before the start");
+
+	CHECK(Timer_Group_Start(&group) == TIM_OK, "cascade: Timer_Group_Start");
+	settle();
+	counts = (uint64_t)master_htim.Instance->ARR + 1;
+	range = MAX_COUNTING_PERIOD_16BIT * counts;
+
+	// Past the wrap of the 16 bit slave
+	for (t = 1; t <= range + (3 * counts) + 7; t++) {
+		uint64_t wide;
+		uint64_t narrow;
+
+		tick();
+		wide = Timer_Group_Read_Cascade(&group, 0);
+		narrow = Timer_Group_Read_Cascade(&group, 1);
+		CHECK(wide == t, "cascade: tim2 reads %llu after %llu counts", (unsigned long long)wide, (unsigned long long)t);
+		CHECK(narrow == (t % range), "cascade: tim4 reads %llu after %llu counts", (unsigned long long)narrow,
+				(unsigned long long)t);
+		if (failures > 20) {
+			break;
+		}
+	}
+
+	Timer_Group_Stop(&group);
+	check_idle("cascade after the stop");
+	release();
+}
+
+// Groups that cannot be wired leave the slaves alone
+static void check_rejected(void) {
+	static const uint8_t unwired[] = { 3, 5 };
+	static const uint8_t basic[] = { 6 };
+	static const uint8_t slave_nums[] = { 4 };
+
+	// tim5 has no trigger from tim1
+	init_group(1, 10000, unwired, 10000, 2, SLAVE_TRIGGER);
+	CHECK(Timer_Group_Init(&group) == TIM_SYNC_UNSUPPORTED, "tim1 -> tim5 accepted");
+	CHECK((slave_htims[0].Instance->SMCR & TIM_SMCR_SMS) == 0, "tim3 changed by a rejected group");
+	release();
+
+	init_group(2, 10000, basic, 10000, 1, SLAVE_TRIGGER);
+	CHECK(Timer_Group_Init(&group) == TIM_SYNC_UNSUPPORTED, "basic timer slave accepted");
+	release();
+
+	init_group(2, 10000, slave_nums, 10000, 1, SLAVE_TRIGGER);
+	Timer_Stop(&slave_tims[0]);
+	CHECK(Timer_Group_Init(&group) == TIM_UNINIT, "stopped slave accepted");
+	Timer_Stop(&master);
+	CHECK(Timer_Group_Init(&group) == TIM_UNINIT, "stopped master accepted");
+	CHECK(Timer_Group_Start(&group) == TIM_UNINIT, "group of a stopped master started");
+	release();
+
+	Mock_Reset();
+	init_timer(&master, &master_htim, 2, 10000, COUNT_CENTER_ALIGNED_1, 1);
+	init_timer(&slave_tims[0], &slave_htims[0], 4, 10000, COUNT_UP, 0);
+	slaves[0] = &slave_tims[0];
+	group = (Timer_Group_st){ .master = &master, .slaves = slaves, .num_slaves = 1, .mode = SLAVE_CASCADE };
+	CHECK(Timer_Group_Init(&group) == TIM_COUNT_MODE_UNSUPPORTED, "cascade from a center aligned master accepted");
+	CHECK((slave_htims[0].Instance->SMCR & TIM_SMCR_SMS) == 0, "tim4 changed by a rejected cascade");
+	release();
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_trigger();
+	check_reset();
+	check_gated();
+	check_cascade();
+	check_rejected();
+
+	printf("test_group: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,273 @@
+/*
+ * test_interleave.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Phase offsets of PWM_Interleave on chained emulated timers.
+ *
+ *	The timer of phase 0 is counted with Mock_Tim_Count and drives the other timers of the group through its trigger
+ *	output (Mock_Tim_Slave_Count), while the output of every phase is recorded. Checks, edge and center aligned:
+ *		- phase k lags phase 0 by k / N of a period, to one count: rising edges counting up, pulse centers center aligned
+ *		- two phases on one center aligned timer (pwm modes 1 and 2) and phases on separate timers
+ *		- every phase keeps the requested duty, and its offset when the duty changes
+ *		- phases that cannot be placed, timers that differ and uninitialized timers are rejected
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "pwm_interleave.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+#define MAX_PHASES				(4U)
+#define MAX_TIMERS				(4U)
+// Periods recorded per check
+#define NUM_PERIODS				(3U)
+// Longest recording: NUM_PERIODS periods of an APB1 timer at PWM_FREQ_HZ
+#define MAX_TICKS				(NUM_PERIODS * 5400U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// Timer (index in the timers array) and channel of a phase
+typedef struct {
+	uint8_t timer;
+	uint8_t chan_num;
+}phase_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htims[MAX_TIMERS];
+static Timer_st tims[MAX_TIMERS];
+static uint8_t num_tims;
+static PWM_st pwms[MAX_PHASES];
+static PWM_st* phases[MAX_PHASES];
+static PWM_Interleave_st il;
+
+// Output of every phase after every count
+static uint8_t level[MAX_PHASES][MAX_TICKS];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Timers 2 - 5, all on APB1, at PWM_FREQ_HZ and the pwms of the phases at duty percent
+static void init_phases(const uint8_t tim_nums[], uint8_t num_timers, Tim_Count_Mode_et count_mode,
+		const phase_st phase_list[], uint8_t num_phases, uint8_t duty) {
+	for (uint8_t i = 0; i < num_tims; i++) {
+		Timer_Stop(&tims[i]);
+	}
+	Mock_Reset();
+
+	num_tims = num_timers;
+	for (uint8_t i = 0; i < num_timers; i++) {
+		htims[i] = (TIM_HandleTypeDef){0};
+		tims[i] = (Timer_st){ .htim = &htims[i], .tim_num = tim_nums[i], .timing = FREQ, .freq_hz = PWM_FREQ_HZ,
+				.count_mode = count_mode };
+		for (uint8_t k = 0; k < num_phases; k++) {
+			if (phase_list[k].timer == i) {
+				tims[i].channels.en_ch1 |= (phase_list[k].chan_num == 1);
+				tims[i].channels.en_ch2 |= (phase_list[k].chan_num == 2);
+			}
+		}
+		CHECK(Timer_Init(&tims[i]) == TIM_OK, "tim%u Timer_Init", tim_nums[i]);
+	}
+
+	for (uint8_t k = 0; k < num_phases; k++) {
+		pwms[k] = (PWM_st){ .tim = &tims[phase_list[k].timer], .chan_num = phase_list[k].chan_num, .duty = duty };
+		CHECK(PWM_Init(&pwms[k]) == PWM_OK, "phase %u PWM_Init", k);
+		phases[k] = &pwms[k];
+	}
+	il = (PWM_Interleave_st){ .phases = phases, .num_phases = num_phases };
+}
+
+// Timer_Group_Start writes UG and then loads the counters. The mock applies EGR at the next count, so the events are
+// applied here keeping the loaded counters
+static void settle(void) {
+	for (uint8_t i = 0; i < num_tims; i++) {
+		uint32_t cnt = htims[i].Instance->CNT;
+
+		Mock_Tim_Apply_Events(htims[i].Instance);
+		htims[i].Instance->CNT = cnt;
+	}
+}
+
+// Pwm period in counts
+static uint32_t period_ticks(void) {
+	TIM_TypeDef* regs = htims[0].Instance;
+
+	return Timer_Is_Center_Aligned(&tims[0]) ? (2 * regs->ARR) : (regs->ARR + 1);
+}
+
+// Counts the group over NUM_PERIODS periods, recording the output of every phase
+static uint32_t record(void) {
+	uint32_t num_ticks = NUM_PERIODS * period_ticks();
+
+	for (uint32_t t = 0; t < num_ticks; t++) {
+		uint8_t trgo;
+
+		Mock_Tim_Count(htims[0].Instance);
+		trgo = Mock_Tim_TRGO(htims[0].Instance);
+		for (uint8_t i = 1; i < num_tims; i++) {
+			Mock_Tim_Slave_Count(htims[i].Instance, trgo);
+		}
+		for (uint8_t k = 0; k < il.num_phases; k++) {
+			level[k][t] = Mock_Tim_Output(phases[k]->tim->htim->Instance, phases[k]->chan_num, 0);
+		}
+	}
+
+	return num_ticks;
+}
+
+// Position of the first pulse of a phase starting from the second period, twice its center when center aligned or
+// twice its rising edge counting up. Sets the high time of the pulse, 0 when there is no whole pulse
+static uint32_t pulse_position(uint8_t k, uint8_t center, uint32_t num_ticks, uint32_t* high) {
+	uint32_t rise = period_ticks();
+	uint32_t fall;
+
+	*high = 0;
+	while ((rise < num_ticks) && (level[k][rise - 1] || !level[k][rise])) {
+		rise++;
+	}
+	fall = rise;
+	while ((fall < num_ticks) && level[k][fall]) {
+		fall++;
+	}
+	if (fall >= num_ticks) {
+		return 0;
+	}
+
+	*high = fall - rise;
+	return center ? (rise + fall - 1) : (2 * rise);
+}
+
+// Phase lags and duties of a running group
+static void check_offsets(const char* name, uint16_t duty_hr) {
+	uint8_t center = Timer_Is_Center_Aligned(&tims[0]);
+	uint32_t period = period_ticks();
+	uint32_t want_high = (uint32_t)(((uint64_t)duty_hr * period + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+	uint32_t num_ticks = record();
+	uint32_t high;
+	uint32_t first;
+
+	first = pulse_position(0, center, num_ticks, &high);
+
+	for (uint8_t k = 0; k < il.num_phases; k++) {
+		uint32_t pos = pulse_position(k, center, num_ticks, &high);
+		// Doubled lag behind phase 0 and its wanted value
+		uint32_t lag = (pos + (2 * period) - first) % (2 * period);
+		uint32_t want = (uint32_t)((2 * (((uint64_t)k * period) + (il.num_phases / 2))) / il.num_phases);
+		uint32_t diff = (lag > want) ? (lag - want) : (want - lag);
+
+		CHECK(((diff <= 2) || ((2 * period) - diff <= 2)), "%s: phase %u lags %.1f counts, want %.1f of %u", name, k,
+				lag / 2.0, want / 2.0, period);
+		CHECK((high + 1 >= want_high) && (high <= want_high + 1), "%s: phase %u high for %u counts, want %u", name, k, high,
+				want_high);
+	}
+}
+
+static void check_interleave(const char* name, const uint8_t tim_nums[], uint8_t num_timers, Tim_Count_Mode_et count_mode,
+		const phase_st phase_list[], uint8_t num_phases) {
+	char step[96];
+	PWM_Ret_et ret;
+
+	init_phases(tim_nums, num_timers, count_mode, phase_list, num_phases, 30);
+	ret = PWM_Interleave_Init(&il);
+	CHECK(ret == PWM_OK, "%s: PWM_Interleave_Init", name);
+	// A group that failed to init has nothing to start
+	if (ret != PWM_OK) {
+		return;
+	}
+	CHECK(PWM_Interleave_Start(&il) == PWM_OK, "%s: PWM_Interleave_Start", name);
+	settle();
+	check_offsets(name, pwms[0].duty_hr);
+
+	// Offsets hold across duty changes
+	CHECK(PWM_Interleave_Set_Duty_HR(&il, PWM_DUTY_HR_MAX / 8) == PWM_OK, "%s: PWM_Interleave_Set_Duty_HR", name);
+	snprintf(step, sizeof(step), "%s at 12.5%%", name);
+	check_offsets(step, PWM_DUTY_HR_MAX / 8);
+	CHECK(PWM_Interleave_Set_Duty_HR(&il, 45000) == PWM_OK, "%s: PWM_Interleave_Set_Duty_HR", name);
+	snprintf(step, sizeof(step), "%s at 45000", name);
+	check_offsets(step, 45000);
+
+	CHECK(PWM_Interleave_Stop(&il) == PWM_OK, "%s: PWM_Interleave_Stop", name);
+	for (uint8_t i = 0; i < num_timers; i++) {
+		CHECK(!(htims[i].Instance->CR1 & TIM_CR1_CEN), "%s: tim%u still counting", name, tim_nums[i]);
+	}
+}
+
+static void check_rejected(void) {
+	static const uint8_t two[] = { 2, 3 };
+	static const uint8_t one[] = { 2 };
+	static const phase_st shared[] = { { 0, 1 }, { 0, 2 } };
+	static const phase_st separate[] = { { 0, 1 }, { 1, 1 } };
+	static const phase_st three_shared[] = { { 0, 1 }, { 0, 2 }, { 1, 1 } };
+
+	// Edge aligned phases can not share a timer
+	init_phases(one, 1, COUNT_UP, shared, 2, 30);
+	CHECK(PWM_Interleave_Init(&il) == PWM_INTERLEAVE_UNSUPPORTED, "two edge aligned phases on one timer accepted");
+
+	// Center aligned phases sharing a timer must be half a period apart
+	init_phases(two, 2, COUNT_CENTER_ALIGNED_1, three_shared, 3, 30);
+	CHECK(PWM_Interleave_Init(&il) == PWM_INTERLEAVE_UNSUPPORTED, "phases a third of a period apart on one timer accepted");
+
+	init_phases(two, 2, COUNT_UP, separate, 2, 30);
+	tims[1].freq_hz = PWM_FREQ_HZ / 2;
+	CHECK(Timer_Init(&tims[1]) == TIM_OK, "tim3 Timer_Init");
+	CHECK(PWM_Interleave_Init(&il) == PWM_TIM_MISMATCH, "timers at different frequencies accepted");
+
+	init_phases(two, 2, COUNT_UP, separate, 2, 30);
+	Timer_Stop(&tims[1]);
+	CHECK(PWM_Interleave_Init(&il) == PWM_TIM_UNINIT, "stopped timer accepted");
+	CHECK((htims[0].Instance->SMCR & TIM_SMCR_MSM) == 0, "tim2 changed by a rejected group");
+
+	init_phases(two, 2, COUNT_UP, separate, 2, 30);
+	il.num_phases = 0;
+	CHECK(PWM_Interleave_Init(&il) == PWM_INVALID_LEN, "empty group accepted");
+
+	init_phases(two, 2, COUNT_DOWN, separate, 2, 30);
+	CHECK(PWM_Interleave_Init(&il) == PWM_INTERLEAVE_UNSUPPORTED, "down counting timers accepted");
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const uint8_t three_timers[] = { 2, 3, 4 };
+	static const uint8_t four_timers[] = { 2, 3, 4, 5 };
+	static const uint8_t two_timers[] = { 2, 3 };
+	static const phase_st three_separate[] = { { 0, 1 }, { 1, 1 }, { 2, 1 } };
+	static const phase_st four_separate[] = { { 0, 1 }, { 1, 1 }, { 2, 1 }, { 3, 1 } };
+	// Phases 0 and 2, 1 and 3 half a period apart on the same timer
+	static const phase_st four_paired[] = { { 0, 1 }, { 1, 1 }, { 0, 2 }, { 1, 2 } };
+	static const phase_st two_shared[] = { { 0, 1 }, { 0, 2 } };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_interleave("edge aligned 3 phases", three_timers, 3, COUNT_UP, three_separate, 3);
+	check_interleave("edge aligned 4 phases", four_timers, 4, COUNT_UP, four_separate, 4);
+	check_interleave("center aligned 3 phases", three_timers, 3, COUNT_CENTER_ALIGNED_1, three_separate, 3);
+	check_interleave("center aligned 4 phases", four_timers, 4, COUNT_CENTER_ALIGNED_1, four_separate, 4);
+	check_interleave("center aligned 4 phases on 2 timers", two_timers, 2, COUNT_CENTER_ALIGNED_1, four_paired, 4);
+	check_interleave("center aligned 2 phases on 1 timer", two_timers, 1, COUNT_CENTER_ALIGNED_1, two_shared, 2);
+
+	check_rejected();
+
+	printf("test_interleave: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,201 @@
+/*
+ * test_outputs.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Output stage of the advanced timers on the emulated registers.
+ *
+ *	Checks the level of every CHx / CHxN over a full pwm period for each commutation phase, that the break and dead
+ *	time register is written once with its lock level, and the software break path with and without break inputs.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timers_pwm.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// Counts of one period each output of a channel was high
+typedef struct {
+	uint32_t high;
+	uint32_t high_n;
+	uint32_t counts;
+}levels_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Initializes an advanced timer with complementary outputs on channels 1 to 3. The break configuration is kept
+static void init_advanced(Timer_st* tim, TIM_HandleTypeDef* htim, PWM_st pwms[3]) {
+	TIM_Ret_et ret;
+
+	Mock_Reset();
+	*htim = (TIM_HandleTypeDef){0};
+	tim->htim = htim;
+	tim->tim_num = 1;
+	tim->timing = FREQ;
+	tim->freq_hz = PWM_FREQ_HZ;
+	tim->channels.en_ch1 = 1;
+	tim->channels.en_ch2 = 1;
+	tim->channels.en_ch3 = 1;
+	tim->complementary.en_complementary = 1;
+	tim->complementary.dead_time_ns = 200;
+	ret = Timer_Init(tim);
+	CHECK(ret == TIM_OK, "tim1 Timer_Init (%d)", ret);
+
+	for (uint8_t c = 0; c < 3; c++) {
+		pwms[c].tim = tim;
+		pwms[c].chan_num = c + 1;
+		pwms[c].duty = 50;
+		CHECK(PWM_Init(&pwms[c]) == PWM_OK, "ch%u PWM_Init", c + 1);
+	}
+}
+
+// Runs one period from the update event and records the outputs of every channel
+static void measure(TIM_TypeDef* regs, levels_st levels[3]) {
+	uint32_t counts = regs->ARR + 1;
+
+	// Events written by the code under test are still pending in the mock
+	regs->EGR |= TIM_EGR_UG;
+	Mock_Tim_Apply_Events(regs);
+	for (uint8_t c = 0; c < 3; c++) {
+		levels[c] = (levels_st){ 0, 0, counts };
+	}
+
+	for (uint32_t n = 0; n < counts; n++) {
+		Mock_Tim_Count(regs);
+		for (uint8_t c = 0; c < 3; c++) {
+			levels[c].high += Mock_Tim_Output(regs, c + 1, 0);
+			levels[c].high_n += Mock_Tim_Output(regs, c + 1, 1);
+		}
+	}
+}
+
+static void check_commutation(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwms[3] = {0};
+	PWM_Commutation_Step_st step = { { PHASE_PWM, PHASE_LOW_ON, PHASE_OFF, PHASE_OFF }, PWM_DUTY_HR_MAX / 4 };
+	levels_st levels[3];
+
+	init_advanced(&tim, &htim, pwms);
+	CHECK(PWM_Commutation_Init(&tim, TIM_TS_NONE) == PWM_OK, "PWM_Commutation_Init");
+
+	// Phase PWM on 1, low side on 2, 3 off
+	CHECK(PWM_Commutate(&tim, &step, COMMIT_NOW) == PWM_OK, "PWM_Commutate");
+	measure(htim.Instance, levels);
+	CHECK((levels[0].high == (levels[0].counts / 4)) && (levels[0].high_n == (levels[0].counts - levels[0].high)),
+			"PHASE_PWM: CH1 %u, CH1N %u of %u", levels[0].high, levels[0].high_n, levels[0].counts);
+	CHECK((levels[1].high == 0) && (levels[1].high_n == levels[1].counts),
+			"PHASE_LOW_ON: CH2 %u, CH2N %u of %u", levels[1].high, levels[1].high_n, levels[1].counts);
+	CHECK((levels[2].high == 0) && (levels[2].high_n == 0), "PHASE_OFF: CH3 %u, CH3N %u", levels[2].high, levels[2].high_n);
+
+	// Next step: high side pwm on 3, low side on 1, 2 off
+	step = (PWM_Commutation_Step_st){ { PHASE_LOW_ON, PHASE_OFF, PHASE_HIGH_PWM, PHASE_OFF }, PWM_DUTY_HR_MAX / 2 };
+	CHECK(PWM_Commutate(&tim, &step, COMMIT_NOW) == PWM_OK, "PWM_Commutate");
+	measure(htim.Instance, levels);
+	CHECK((levels[0].high == 0) && (levels[0].high_n == levels[0].counts),
+			"PHASE_LOW_ON: CH1 %u, CH1N %u of %u", levels[0].high, levels[0].high_n, levels[0].counts);
+	CHECK((levels[1].high == 0) && (levels[1].high_n == 0), "PHASE_OFF: CH2 %u, CH2N %u", levels[1].high, levels[1].high_n);
+	CHECK((levels[2].high == (levels[2].counts / 2)) && (levels[2].high_n == 0),
+			"PHASE_HIGH_PWM: CH3 %u, CH3N %u of %u", levels[2].high, levels[2].high_n, levels[2].counts);
+
+	Timer_Release(&tim);
+}
+
+// The lock level goes in the one and only write of BDTR, later direct writes would be ignored on target
+static void check_lock(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwms[3] = {0};
+	levels_st levels[3];
+
+	for (uint8_t level = 0; level <= MAX_LOCK_LEVEL; level++) {
+		tim = (Timer_st){0};
+		tim.break_config.brk.en = 1;
+		tim.break_config.lock_level = level;
+		init_advanced(&tim, &htim, pwms);
+
+		// Counting applies the lock to any direct write
+		measure(htim.Instance, levels);
+		CHECK(Mock_Tim_BDTR_Writes(htim.Instance) == 1, "lock %u: %u BDTR writes", level, Mock_Tim_BDTR_Writes(htim.Instance));
+		CHECK(((htim.Instance->BDTR & TIM_BDTR_LOCK) >> 8) == level, "lock %u: LOCK field %u", level,
+				(unsigned)((htim.Instance->BDTR & TIM_BDTR_LOCK) >> 8));
+		CHECK((htim.Instance->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_BKE)) == (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_BKE),
+				"lock %u: break and off state bits", level);
+		CHECK(htim.Instance->DIER & TIM_DIER_BIE, "lock %u: break interrupt", level);
+		CHECK((levels[0].high != 0) && (levels[0].high_n != 0), "lock %u: outputs running", level);
+		Timer_Release(&tim);
+	}
+}
+
+// Without break inputs a software break (e.g. an adc watchdog) still drives the outputs to idle and is counted
+static void check_software_break(uint8_t arm) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwms[3] = {0};
+	Tim_Break_Status_st status;
+	levels_st levels[3];
+
+	init_advanced(&tim, &htim, pwms);
+	CHECK(!(htim.Instance->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI)) && !(htim.Instance->DIER & TIM_DIER_BIE),
+			"no break configured: off state or break interrupt set");
+
+	// Timer_Break_Trigger arms the timer itself when Timer_Break_Arm was not called
+	if (arm) {
+		CHECK(Timer_Break_Arm(&tim) == TIM_OK, "Timer_Break_Arm");
+	}
+	CHECK(Timer_Break_Trigger(&tim) == TIM_OK, "Timer_Break_Trigger");
+	CHECK((htim.Instance->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI)) == (TIM_BDTR_OSSR | TIM_BDTR_OSSI), "arm %u: off state", arm);
+	CHECK(htim.Instance->DIER & TIM_DIER_BIE, "arm %u: break interrupt", arm);
+
+	measure(htim.Instance, levels);
+	CHECK((levels[0].high == 0) && (levels[0].high_n == 0), "arm %u: outputs on after the break", arm);
+	Timer_Break_Callback(&tim, &htim);
+	CHECK((Timer_Break_Get_Status(&tim, &status) == TIM_OK) && status.tripped && status.brk_flag && (status.num_faults == 1),
+			"arm %u: break status", arm);
+
+	CHECK(Timer_Break_Rearm(&tim) == TIM_OK, "arm %u: Timer_Break_Rearm", arm);
+	CHECK(htim.Instance->DIER & TIM_DIER_BIE, "arm %u: break interrupt after rearm", arm);
+	measure(htim.Instance, levels);
+	CHECK((levels[0].high != 0) && (levels[0].high_n != 0), "arm %u: outputs off after the rearm", arm);
+
+	Timer_Release(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_commutation();
+	check_lock();
+	check_software_break(0);
+	check_software_break(1);
+
+	printf("test_outputs: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+/*
+ * test_power.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Power meter results against the exact values of the integrated samples.
+ *
+ *	Sine voltage and current pairs of a few counts are integrated over whole periods of the update interrupt and
+ *	the results compared with the RMS and mean power of the same integer samples in floating point. Checks:
+ *		- RMS and power of small signals keep the resolution below one count (error under 1 mV / 1 mA / 1 mW)
+ *		- a current in antiphase gives negative power
+ *		- a window latches only after periods_per_result periods and holds every sample of them
+ *		- buffers added once after each scan give the same result as the samples one by one
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "hal_mock.h"
+#include "adc_power.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define IT_FREQ_HZ				(1000U)
+#define SAMPLES_PER_PERIOD		(64U)
+#define PERIODS_PER_RESULT		(4U)
+#define OFFSET					(2048U)
+#define V_CHANNEL				(3U)
+#define I_CHANNEL				(4U)
+#define PI						(3.14159265358979323846)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// Exact sums of the samples fed to the meter
+typedef struct {
+	double sum_vv;
+	double sum_ii;
+	double sum_vi;
+	uint32_t num_samples;
+}reference_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static ADC_HandleTypeDef hadc;
+static uint16_t v_buffer[SAMPLES_PER_PERIOD];
+static uint16_t i_buffer[SAMPLES_PER_PERIOD];
+static ADC_Channel_st channels[2];
+static ADC_st adc;
+static Power_Pair_st pair;
+static Power_Meter_st meter;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Meter with one pair on TIM3, Power_Callback on its update interrupt
+static void init_meter(uint32_t v_gain_uv, uint32_t i_gain_ua) {
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = IT_FREQ_HZ;
+	tim.it_config.en_it = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "Timer_Init");
+
+	hadc = (ADC_HandleTypeDef){ .Instance = ADC1 };
+	channels[0] = (ADC_Channel_st){ .channel_number = V_CHANNEL, .buffer_len = SAMPLES_PER_PERIOD, .buffer = v_buffer };
+	channels[1] = (ADC_Channel_st){ .channel_number = I_CHANNEL, .buffer_len = SAMPLES_PER_PERIOD, .buffer = i_buffer };
+	adc = (ADC_st){ .hadc = &hadc, .adc_num = 1, .num_channels = 2, .channels = channels };
+
+	pair = (Power_Pair_st){ .v_channel = V_CHANNEL, .i_channel = I_CHANNEL, .v_offset = OFFSET, .i_offset = OFFSET,
+			.v_gain_uv = v_gain_uv, .i_gain_ua = i_gain_ua };
+	meter = (Power_Meter_st){ .adc = &adc, .tim = &tim, .pairs = &pair, .num_pairs = 1,
+			.periods_per_result = PERIODS_PER_RESULT };
+	CHECK(Power_Init(&meter) == ADC_OK, "Power_Init");
+	CHECK(Timer_Register_Callback(&tim, Power_Callback, &meter) == TIM_OK, "Timer_Register_Callback");
+}
+
+// Raw reading of a sine of amplitude counts around the offset
+static uint16_t sine_raw(double amplitude, uint32_t k, double phase) {
+	return (uint16_t)lround(OFFSET + (amplitude * sin(((2 * PI * k) / SAMPLES_PER_PERIOD) + phase)));
+}
+
+// Fills the scan buffers with one period of voltage and current
+static void fill_period(double v_amplitude, double i_amplitude, double phase, reference_st* ref) {
+	for (uint32_t k = 0; k < SAMPLES_PER_PERIOD; k++) {
+		int32_t v;
+		int32_t i;
+
+		v_buffer[k] = sine_raw(v_amplitude, k, 0);
+		i_buffer[k] = sine_raw(i_amplitude, k, phase);
+		v = (int32_t)v_buffer[k] - OFFSET;
+		i = (int32_t)i_buffer[k] - OFFSET;
+		ref->sum_vv += (double)v * v;
+		ref->sum_ii += (double)i * i;
+		ref->sum_vi += (double)v * i;
+		ref->num_samples++;
+	}
+}
+
+// Compares the last window of the pair with the exact values of the samples
+static void check_result(const reference_st* ref, const char* name) {
+	Power_Result_st result;
+	double v_rms_mv = sqrt(ref->sum_vv / ref->num_samples) * pair.v_gain_uv / 1000.0;
+	double i_rms_ma = sqrt(ref->sum_ii / ref->num_samples) * pair.i_gain_ua / 1000.0;
+	double p_avg_mw = (ref->sum_vi / ref->num_samples) * pair.v_gain_uv * pair.i_gain_ua / 1e9;
+
+	CHECK(Power_Get_Result(&pair, &result) == ADC_OK, "%s: Power_Get_Result", name);
+	CHECK(result.num_samples == ref->num_samples, "%s: %u samples, want %u", name, result.num_samples, ref->num_samples);
+	CHECK(fabs(result.v_rms_mv - v_rms_mv) <= 1.0, "%s: %u mV RMS, want %.3f", name, result.v_rms_mv, v_rms_mv);
+	CHECK(fabs(result.i_rms_ma - i_rms_ma) <= 1.0, "%s: %u mA RMS, want %.3f", name, result.i_rms_ma, i_rms_ma);
+	CHECK(fabs((double)result.p_avg_mw - p_avg_mw) <= 1.0, "%s: %lld mW, want %.3f", name, (long long)result.p_avg_mw,
+			p_avg_mw);
+}
+
+// Samples one by one over a window, amplitudes of a few counts with gains large enough that a count is 100 units
+static void check_small_signal(double phase, const char* name) {
+	reference_st ref = {0};
+
+	init_meter(100000, 100000);
+
+	for (uint32_t period = 0; period < PERIODS_PER_RESULT; period++) {
+		fill_period(7.3, 4.6, phase, &ref);
+		for (uint32_t k = 0; k < SAMPLES_PER_PERIOD; k++) {
+			Power_Add_Sample(&pair, v_buffer[k], i_buffer[k]);
+		}
+
+		// Nothing is latched before the last period of the window
+		if (period < PERIODS_PER_RESULT - 1) {
+			Power_Result_st result;
+
+			Timer_Dispatch_Period_Elapsed(&htim);
+			CHECK(Power_Get_Result(&pair, &result) == NO_SAMPLES, "%s: result after %u periods", name, period + 1);
+		}
+	}
+	Timer_Dispatch_Period_Elapsed(&htim);
+
+	check_result(&ref, name);
+	Timer_Stop(&tim);
+}
+
+// Buffers of a scan added once per scan, a window of PERIODS_PER_RESULT scans
+static void check_buffers(void) {
+	reference_st ref = {0};
+
+	init_meter(805, 12207);
+
+	for (uint32_t period = 0; period < PERIODS_PER_RESULT; period++) {
+		fill_period(1500.0, 37.5, PI / 3, &ref);
+		CHECK(Power_Add_Buffers(&meter) == ADC_OK, "Power_Add_Buffers");
+		Timer_Dispatch_Period_Elapsed(&htim);
+	}
+
+	check_result(&ref, "buffers");
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_small_signal(0.4, "small signal");
+	check_small_signal(PI, "antiphase");
+	check_buffers();
+
+	printf("test_power: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
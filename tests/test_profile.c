@@ -0,0 +1,178 @@
+/*
+ * test_profile.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Interrupt latency profiler on an emulated center aligned counter.
+ *
+ *	The hardware event is found by stepping the counter (update flag, or the rising edge of the trigger reference)
+ *	and the profile entry is run a known number of counts later. Checks that the latency is that number of counts
+ *	whatever the pass of the counter, including latencies longer than the time to the other crossing of the event
+ *	count, for:
+ *		- the update event of an advanced timer with an odd repetition counter (bottom of the count)
+ *		- a compare in pwm mode 1 (rising counting down) and pwm mode 2 (rising counting up)
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "tim_profile.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+#define IT_FREQ_HZ				(1000U)
+#define NS_PER_S				(1000000000ULL)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Center aligned advanced timer with a pwm on channel 2, running from the bottom of the count
+static void init_timer(Timer_st* tim, TIM_HandleTypeDef* htim, PWM_st* pwm, uint32_t oc_mode) {
+	TIM_TypeDef* regs;
+
+	Mock_Reset();
+	tim->htim = htim;
+	tim->tim_num = 1;
+	tim->timing = FREQ;
+	tim->freq_hz = PWM_FREQ_HZ;
+	tim->count_mode = COUNT_CENTER_ALIGNED_1;
+	tim->channels.en_ch2 = 1;
+	tim->it_config.en_it = 1;
+	tim->it_config.freq_hz = IT_FREQ_HZ;
+	CHECK(Timer_Init(tim) == TIM_OK, "Timer_Init");
+
+	pwm->tim = tim;
+	pwm->chan_num = 2;
+	pwm->duty = 25;
+	CHECK(PWM_Init(pwm) == PWM_OK, "PWM_Init");
+	Timer_Set_OC_Mode(tim, 2, oc_mode);
+
+	regs = htim->Instance;
+	regs->EGR |= TIM_EGR_UG;
+	Mock_Tim_Apply_Events(regs);
+	regs->SR = 0;
+	regs->CR1 |= TIM_CR1_CEN;
+}
+
+// Steps to the next hardware event: the update flag, or the rising edge of the reference of event_chan
+static void run_to_event(TIM_TypeDef* regs, uint8_t event_chan) {
+	uint8_t ref = (event_chan != 0) ? Mock_Tim_OC_Ref(regs, event_chan) : 0;
+
+	regs->SR = 0;
+	for (uint32_t n = 0; n < (4U * (regs->RCR + 1) * (regs->ARR + 1)); n++) {
+		Mock_Tim_Count(regs);
+		if (event_chan == 0) {
+			if (regs->SR & TIM_SR_UIF) {
+				return;
+			}
+		}
+		else {
+			uint8_t now = Mock_Tim_OC_Ref(regs, event_chan);
+
+			if (now && !ref) {
+				return;
+			}
+			ref = now;
+		}
+	}
+	CHECK(0, "no event on channel %u", event_chan);
+}
+
+// Runs the profile entry delays[i] counts after each event and checks the recorded latency
+static void check_latencies(Timer_st* tim, Tim_Profile_st* profile, uint8_t event_chan, const char* what) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	uint64_t ns_per_count_num = ((uint64_t)regs->PSC + 1) * NS_PER_S;
+	uint32_t clk_hz = Timer_Get_Clock_Freq(tim);
+	// Up to almost a whole pwm period, past the other crossing of the event count
+	uint32_t delays[] = { 0, 1, regs->ARR / 4, (regs->ARR * 3) / 5, regs->ARR + (regs->ARR / 2), (2 * regs->ARR) - 2 };
+	Tim_Profile_Stats_st stats;
+
+	for (uint8_t i = 0; i < (sizeof(delays) / sizeof(delays[0])); i++) {
+		uint64_t want = (delays[i] * ns_per_count_num) / clk_hz;
+
+		run_to_event(regs, event_chan);
+		for (uint32_t n = 0; n < delays[i]; n++) {
+			Mock_Tim_Count(regs);
+		}
+
+		Timer_Profile_Reset(profile);
+		Timer_Profile_Entry(profile);
+		Timer_Profile_Get_Stats(profile, &stats);
+		CHECK((stats.max_latency_ns + 1 >= want) && (stats.max_latency_ns <= want + 1),
+				"%s: %u counts after the event, latency %u ns, want %llu ns", what, delays[i], stats.max_latency_ns,
+				(unsigned long long)want);
+	}
+}
+
+static void check_update(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwm = {0};
+	Tim_Profile_Config_st config = {0};
+	Tim_Profile_st* profile;
+
+	init_timer(&tim, &htim, &pwm, TIM_OCMODE_PWM1);
+	CHECK(htim.Instance->RCR & 1U, "RCR %u is even", (unsigned)htim.Instance->RCR);
+
+	config.tim = &tim;
+	config.source = &tim;
+	config.bin_ns = 1000;
+	CHECK(Timer_Profile_Attach(&config, &profile) == TIM_OK, "Timer_Profile_Attach");
+	check_latencies(&tim, profile, 0, "update");
+
+	Timer_Profile_Detach(profile);
+	Timer_Release(&tim);
+}
+
+static void check_compare(uint32_t oc_mode) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwm = {0};
+	Tim_Profile_Config_st config = {0};
+	Tim_Profile_st* profile;
+
+	init_timer(&tim, &htim, &pwm, oc_mode);
+
+	config.tim = &tim;
+	config.source = &pwm;
+	config.event_count = htim.Instance->CCR2;
+	config.event_chan = 2;
+	config.bin_ns = 1000;
+	CHECK(Timer_Profile_Attach(&config, &profile) == TIM_OK, "Timer_Profile_Attach");
+	check_latencies(&tim, profile, 2, (oc_mode == TIM_OCMODE_PWM1) ? "pwm mode 1" : "pwm mode 2");
+
+	Timer_Profile_Detach(profile);
+	Timer_Release(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_update();
+	check_compare(TIM_OCMODE_PWM1);
+	check_compare(TIM_OCMODE_PWM2);
+
+	printf("test_profile: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,326 @@
+/*
+ * test_pulse.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	One pulse mode of PWM_Pulse on the emulated timers.
+ *
+ *	Each pulse is started by PWM_Pulse_Fire or an input edge and the counter stepped until it stops by itself, while
+ *	the output is recorded. Checks:
+ *		- the measured delay and width are the requests rounded to the nearest tick of the chosen prescaler
+ *		  (the delay at least one tick), and __delay_ns / __width_ns are what the counter produces
+ *		- the prescaler is the smallest one whose rounded delay + width fits the counter, also when rounding
+ *		  spills over a prescaler the estimate allowed
+ *		- requests that round to no width and bad trigger pairings are rejected
+ *		- a pulse repeats on every trigger, firing during a pulse does not restart it, and only the configured
+ *		  input edge starts one
+ *		- PWM_Pulse_Stop turns the output off and frees the channels
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "pwm_pulse.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NS_PER_S				(1000000000ULL)
+#define INIT_FREQ_HZ			(1000U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// A pulse request on a timer
+typedef struct {
+	uint8_t tim_num;
+	uint32_t delay_ns;
+	uint32_t width_ns;
+	// Prescaler (PSC + 1) it must get
+	uint32_t prescaler;
+}pulse_case_st;
+
+// Counts from the start of a pulse to the output going active, and how long it stays active
+typedef struct {
+	uint64_t delay;
+	uint64_t width;
+	// The counter stopped by itself with the output back at its idle level
+	uint8_t stopped;
+}measured_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static PWM_st pwm;
+static PWM_Pulse_st pulse;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Timer with channels 1 and 2 enabled, the pulse on chan_num
+static void init_pulse(uint8_t tim_num, uint8_t chan_num, PWM_Pulse_Trigger_et trigger, uint32_t delay_ns,
+		uint32_t width_ns) {
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = FREQ;
+	tim.freq_hz = INIT_FREQ_HZ;
+	tim.channels.en_ch1 = 1;
+	tim.channels.en_ch2 = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+
+	pwm = (PWM_st){ .tim = &tim, .chan_num = chan_num };
+	pulse = (PWM_Pulse_st){ .pwm = &pwm, .delay_ns = delay_ns, .width_ns = width_ns, .trigger = trigger };
+}
+
+// Nearest tick of the prescaled clock, halves rounded up
+static uint64_t nearest_ticks(uint64_t ns, uint32_t clk_hz, uint64_t prescaler) {
+	return ((ns * clk_hz) + ((NS_PER_S * prescaler) / 2)) / (NS_PER_S * prescaler);
+}
+
+// Steps a started pulse until the counter stops, at most limit counts
+static measured_st measure(uint64_t limit) {
+	TIM_TypeDef* regs = htim.Instance;
+	uint8_t idle = pwm.is_inverted;
+	measured_st m = {0};
+	uint8_t active = 0;
+
+	for (uint64_t step = 1; step <= limit; step++) {
+		uint8_t out;
+
+		Mock_Tim_Count(regs);
+		out = Mock_Tim_Output(regs, pwm.chan_num, 0);
+		if ((out != idle) && !active) {
+			m.delay = step;
+		}
+		active = (out != idle);
+		m.width += active;
+		if (!(regs->CR1 & TIM_CR1_CEN)) {
+			m.stopped = !active;
+			break;
+		}
+	}
+
+	return m;
+}
+
+// Initializes a request, fires it twice and compares the pulses with the rounded request
+static void check_case(const pulse_case_st* c) {
+	TIM_TypeDef* regs;
+	uint32_t clk_hz;
+	uint64_t max_count;
+	uint64_t prescaler;
+	uint64_t delay_ticks;
+	uint64_t width_ticks;
+
+	init_pulse(c->tim_num, 1, PULSE_TRIGGER_SOFTWARE, c->delay_ns, c->width_ns);
+	regs = htim.Instance;
+	clk_hz = Timer_Get_Clock_Freq(&tim);
+	max_count = IS_TIM_32B_COUNTER_INSTANCE(regs) ? MAX_COUNTING_PERIOD_32BIT : MAX_COUNTING_PERIOD_16BIT;
+
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_OK, "tim%u %u + %u ns: PWM_Pulse_Init", c->tim_num, c->delay_ns, c->width_ns);
+	prescaler = (uint64_t)regs->PSC + 1;
+	CHECK(prescaler == c->prescaler, "tim%u %u + %u ns: prescaler %llu, want %u", c->tim_num, c->delay_ns, c->width_ns,
+			(unsigned long long)prescaler, c->prescaler);
+
+	// Every finer prescaler overflows the counter once both times are rounded
+	for (uint64_t p = 1; p < prescaler; p++) {
+		uint64_t d = nearest_ticks(c->delay_ns, clk_hz, p);
+
+		d = (d == 0) ? 1 : d;
+		CHECK(d + nearest_ticks(c->width_ns, clk_hz, p) > max_count, "tim%u %u + %u ns: prescaler %llu fits, took %llu",
+				c->tim_num, c->delay_ns, c->width_ns, (unsigned long long)p, (unsigned long long)prescaler);
+	}
+
+	// The delay is at least one tick so the output is not active while the counter is stopped
+	delay_ticks = nearest_ticks(c->delay_ns, clk_hz, prescaler);
+	delay_ticks = (delay_ticks == 0) ? 1 : delay_ticks;
+	width_ticks = nearest_ticks(c->width_ns, clk_hz, prescaler);
+
+	CHECK(PWM_Pulse_Arm(&pulse) == PWM_OK, "tim%u PWM_Pulse_Arm", c->tim_num);
+	CHECK(Mock_Tim_Output(regs, 1, 0) == 0, "tim%u %u + %u ns: output active before firing", c->tim_num, c->delay_ns,
+			c->width_ns);
+	CHECK(!PWM_Pulse_Is_Busy(&pulse), "tim%u busy before firing", c->tim_num);
+
+	for (uint8_t shot = 0; shot < 2; shot++) {
+		measured_st m;
+
+		CHECK(PWM_Pulse_Fire(&pulse) == PWM_OK, "tim%u PWM_Pulse_Fire", c->tim_num);
+		CHECK(PWM_Pulse_Is_Busy(&pulse), "tim%u not busy after firing", c->tim_num);
+		m = measure(max_count + 1);
+		CHECK(m.stopped && !PWM_Pulse_Is_Busy(&pulse), "tim%u %u + %u ns: counter still running", c->tim_num, c->delay_ns,
+				c->width_ns);
+		CHECK((m.delay == delay_ticks) && (m.width == width_ticks),
+				"tim%u %u + %u ns shot %u: %llu + %llu ticks, want %llu + %llu", c->tim_num, c->delay_ns, c->width_ns, shot,
+				(unsigned long long)m.delay, (unsigned long long)m.width, (unsigned long long)delay_ticks,
+				(unsigned long long)width_ticks);
+	}
+
+	// The achieved times are the measured ticks, truncated to whole ns
+	CHECK(pulse.__delay_ns == (uint32_t)((delay_ticks * prescaler * NS_PER_S) / clk_hz), "tim%u __delay_ns %u for %llu ticks",
+			c->tim_num, pulse.__delay_ns, (unsigned long long)delay_ticks);
+	CHECK(pulse.__width_ns == (uint32_t)((width_ticks * prescaler * NS_PER_S) / clk_hz), "tim%u __width_ns %u for %llu ticks",
+			c->tim_num, pulse.__width_ns, (unsigned long long)width_ticks);
+
+	CHECK(PWM_Pulse_Stop(&pulse) == PWM_OK, "tim%u PWM_Pulse_Stop", c->tim_num);
+	Timer_Stop(&tim);
+}
+
+// Firing again during a pulse does not restart it
+static void check_refire(void) {
+	TIM_TypeDef* regs;
+	measured_st m;
+
+	init_pulse(3, 2, PULSE_TRIGGER_SOFTWARE, 1000, 2000);
+	regs = htim.Instance;
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_OK, "refire PWM_Pulse_Init");
+	CHECK(PWM_Pulse_Arm(&pulse) == PWM_OK, "refire PWM_Pulse_Arm");
+	CHECK(PWM_Pulse_Fire(&pulse) == PWM_OK, "refire PWM_Pulse_Fire");
+	for (uint8_t i = 0; i < 50; i++) {
+		Mock_Tim_Count(regs);
+	}
+	CHECK(PWM_Pulse_Fire(&pulse) == PWM_OK, "refire PWM_Pulse_Fire during the delay");
+	CHECK(regs->CNT == 50, "refire: counter at %u after firing during the pulse", (unsigned)regs->CNT);
+
+	// 108 ticks of delay and 216 of width at 108 MHz, 50 already counted
+	m = measure(1000);
+	CHECK(m.stopped && (m.delay == 108 - 50) && (m.width == 216), "refire: %llu + %llu ticks after the second fire",
+			(unsigned long long)m.delay, (unsigned long long)m.width);
+	CHECK(PWM_Pulse_Stop(&pulse) == PWM_OK, "refire PWM_Pulse_Stop");
+	Timer_Stop(&tim);
+}
+
+// Input edges start pulses in hardware, only on the configured edge. The output is inverted
+static void check_hardware_trigger(uint8_t tim_num, PWM_Pulse_Trigger_et trigger, uint8_t falling) {
+	uint8_t chan_num = (trigger == PULSE_TRIGGER_TI1) ? 2 : 1;
+	uint8_t ti = (trigger == PULSE_TRIGGER_TI1) ? 1 : 2;
+	TIM_TypeDef* regs;
+	measured_st m;
+
+	init_pulse(tim_num, chan_num, trigger, 500, 1500);
+	regs = htim.Instance;
+	pwm.is_inverted = 1;
+	pulse.trigger_falling = falling;
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_OK, "tim%u TI%u PWM_Pulse_Init", tim_num, ti);
+	CHECK(PWM_Pulse_Arm(&pulse) == PWM_OK, "tim%u TI%u PWM_Pulse_Arm", tim_num, ti);
+	CHECK(Mock_Tim_Output(regs, chan_num, 0) == 1, "tim%u TI%u: inverted output low before the trigger", tim_num, ti);
+
+	for (uint8_t shot = 0; shot < 3; shot++) {
+		uint32_t clk_hz = Timer_Get_Clock_Freq(&tim);
+
+		// The other edge does nothing
+		Mock_Tim_Input_Edge(regs, ti, falling);
+		for (uint8_t i = 0; i < 10; i++) {
+			Mock_Tim_Count(regs);
+		}
+		CHECK(!PWM_Pulse_Is_Busy(&pulse) && (regs->CNT == 0), "tim%u TI%u shot %u: started on the wrong edge", tim_num, ti,
+				shot);
+
+		Mock_Tim_Input_Edge(regs, ti, !falling);
+		CHECK(PWM_Pulse_Is_Busy(&pulse), "tim%u TI%u shot %u: edge did not start the pulse", tim_num, ti, shot);
+		m = measure(10000);
+		CHECK(m.stopped && (m.delay == nearest_ticks(500, clk_hz, 1)) && (m.width == nearest_ticks(1500, clk_hz, 1)),
+				"tim%u TI%u shot %u: %llu + %llu ticks", tim_num, ti, shot, (unsigned long long)m.delay,
+				(unsigned long long)m.width);
+	}
+
+	CHECK(PWM_Pulse_Stop(&pulse) == PWM_OK, "tim%u TI%u PWM_Pulse_Stop", tim_num, ti);
+	Timer_Stop(&tim);
+}
+
+// Requests and pairings that cannot be produced
+static void check_rejected(void) {
+	uint8_t owner;
+
+	init_pulse(3, 1, PULSE_TRIGGER_SOFTWARE, 1000, 1);
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_PULSE_INVALID, "1 ns width at 108 MHz accepted");
+	Timer_Stop(&tim);
+
+	init_pulse(3, 1, PULSE_TRIGGER_TI1, 1000, 1000);
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_CH_UNSUPPORTED, "TI1 trigger on channel 1 accepted");
+	Timer_Stop(&tim);
+
+	init_pulse(3, 2, PULSE_TRIGGER_TI2, 1000, 1000);
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_CH_UNSUPPORTED, "TI2 trigger on channel 2 accepted");
+	Timer_Stop(&tim);
+
+	init_pulse(3, 1, PULSE_TRIGGER_SOFTWARE, 1000, 1000);
+	Timer_Stop(&tim);
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_TIM_UNINIT, "pulse on a stopped timer accepted");
+
+	// Both channels of a hardware trigger are taken until PWM_Pulse_Stop
+	init_pulse(3, 2, PULSE_TRIGGER_TI1, 1000, 1000);
+	CHECK(PWM_Pulse_Init(&pulse) == PWM_OK, "TI1 PWM_Pulse_Init");
+	CHECK(Timer_Claim_Channel(&tim, 1, &owner) == TIM_CH_IN_USE, "trigger input claimed by another owner");
+	CHECK(Timer_Claim_Channel(&tim, 2, &owner) == TIM_CH_IN_USE, "pulse output claimed by another owner");
+	CHECK(PWM_Pulse_Stop(&pulse) == PWM_OK, "TI1 PWM_Pulse_Stop");
+	CHECK(Mock_Tim_Output(htim.Instance, 2, 0) == 0, "output still enabled after PWM_Pulse_Stop");
+	CHECK(Timer_Claim_Channel(&tim, 1, &owner) == TIM_OK, "trigger input not freed by PWM_Pulse_Stop");
+	CHECK(Timer_Claim_Channel(&tim, 2, &owner) == TIM_OK, "pulse output not freed by PWM_Pulse_Stop");
+	Timer_Release_Channel(&tim, 1, &owner);
+	Timer_Release_Channel(&tim, 2, &owner);
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	// Default clock tree: TIM2 / TIM3 at 108 MHz, TIM1 at 216 MHz
+	static const pulse_case_st cases[] = {
+		{ 3, 1000, 5000, 1 },
+		{ 3, 4, 5, 1 },
+		{ 3, 0, 20, 1 },
+		{ 3, 600000, 100000, 2 },
+		{ 3, 4294967295U, 4294967295U, 14156 },
+		{ 1, 123456, 7890, 1 },
+		{ 1, 50000000, 1000, 165 },
+		{ 2, 30000000, 10000000, 1 },
+	};
+	// TIM3 at 100 MHz, 10 ns ticks: requests at the edge of the 16 bit counter
+	static const pulse_case_st edge_cases[] = {
+		// 32767 + 32768 and 32768 + 32768 ticks fit
+		{ 3, 327670, 327680, 1 },
+		{ 3, 327675, 327675, 1 },
+		// 32768 + 32769 after rounding the halves up, though the exact 65536 ticks fit
+		{ 3, 327675, 327685, 2 },
+		// The delay of one tick on top of a full counter
+		{ 3, 0, 655360, 2 },
+	};
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	Mock_Reset();
+	for (uint8_t i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+		check_case(&cases[i]);
+	}
+	check_refire();
+	check_hardware_trigger(1, PULSE_TRIGGER_TI1, 0);
+	check_hardware_trigger(1, PULSE_TRIGGER_TI1, 1);
+	check_hardware_trigger(3, PULSE_TRIGGER_TI2, 0);
+	check_rejected();
+
+	Mock_Reset();
+	Mock_Set_Clocks(200000000, 4, 2, 0);
+	for (uint8_t i = 0; i < (sizeof(edge_cases) / sizeof(edge_cases[0])); i++) {
+		check_case(&edge_cases[i]);
+	}
+
+	printf("test_pulse: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+/*
+ * test_ramp.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Pwm ramps on an emulated general timer, driven by PWM_Ramp_Callback through the update interrupt dispatch.
+ *
+ *	The counter is stepped one count at a time and every update interrupt is delivered. Checks, edge and center
+ *	aligned (two update events per period):
+ *		- a linear ramp moves by its rate once per period and lands on the target in the expected number of periods
+ *		- an s-curve ramp never changes its step by more than one acceleration step, stays under the full rate,
+ *		  starts and ends slowly and lands on the target without overshooting it
+ *		- an s-curve ramp turned around halfway reaches the new target
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "pwm_ramp.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// One ramp tick per millisecond
+#define PWM_FREQ_HZ				(1000U)
+#define MAX_RAMPS				(2U)
+// Ramps give up after this many periods
+#define MAX_PERIODS				(1000U)
+#define RAMP_Q					(16U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static PWM_st pwm;
+static PWM_Ramp_st* active[MAX_RAMPS];
+static PWM_Ramp_Engine_st engine;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static const char* mode_name(Tim_Count_Mode_et count_mode) {
+	return (count_mode == COUNT_UP) ? "edge aligned" : "center aligned";
+}
+
+// Runs the update interrupt if it is enabled and pending, as the HAL does
+static void deliver_update_it(void) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	if ((regs->SR & TIM_SR_UIF) && (regs->DIER & TIM_DIER_UIE)) {
+		__HAL_TIM_CLEAR_FLAG(&htim, TIM_FLAG_UPDATE);
+		Timer_Dispatch_Period_Elapsed(&htim);
+	}
+}
+
+// Counts one pwm period, delivering every update interrupt
+static void run_period(void) {
+	TIM_TypeDef* regs = htim.Instance;
+	uint32_t counts = Timer_Is_Center_Aligned(&tim) ? (2 * regs->ARR) : (regs->ARR + 1);
+
+	for (uint32_t i = 0; i < counts; i++) {
+		Mock_Tim_Count(regs);
+		deliver_update_it();
+	}
+}
+
+// Pwm on channel 1 of TIM3 at 0% and a ramp engine on its update interrupt
+static void init_engine(Tim_Count_Mode_et count_mode) {
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = PWM_FREQ_HZ;
+	tim.count_mode = count_mode;
+	tim.channels.en_ch1 = 1;
+	tim.it_config.en_it = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "%s: Timer_Init", mode_name(count_mode));
+
+	pwm = (PWM_st){ .tim = &tim, .chan_num = 1, .duty = 0 };
+	CHECK(PWM_Init(&pwm) == PWM_OK, "%s: PWM_Init", mode_name(count_mode));
+
+	engine = (PWM_Ramp_Engine_st){ .tim = &tim, .active = active, .max_active = MAX_RAMPS };
+	CHECK(PWM_Ramp_Engine_Init(&engine) == PWM_OK, "%s: PWM_Ramp_Engine_Init", mode_name(count_mode));
+	CHECK(engine.__tick_us == 1000, "%s: tick %u us", mode_name(count_mode), engine.__tick_us);
+	CHECK(Timer_Register_Callback(&tim, PWM_Ramp_Callback, &engine) == TIM_OK, "%s: Timer_Register_Callback",
+			mode_name(count_mode));
+
+	// The update flag left by the init, before any ramp is moving
+	deliver_update_it();
+}
+
+// Linear ramp from 0% to 50% at 10% per ms: 5 periods, whatever the number of update events per period
+static void check_linear(Tim_Count_Mode_et count_mode) {
+	const char* name = mode_name(count_mode);
+	uint32_t rate = PWM_RAMP_PERCENT_PER_MS(10);
+	PWM_Ramp_st ramp = { .pwm = &pwm, .profile = RAMP_LINEAR, .rate_hr_per_ms = rate };
+	// Five whole steps, 50% give or take the rounding of the rate
+	uint16_t target = (uint16_t)(5 * rate);
+
+	init_engine(count_mode);
+	CHECK(PWM_Ramp_Init(&engine, &ramp) == PWM_OK, "%s: PWM_Ramp_Init", name);
+	CHECK(PWM_Ramp_Update_Target_HR(&engine, &ramp, target) == PWM_OK, "%s: PWM_Ramp_Update_Target_HR", name);
+
+	for (uint32_t period = 1; period <= 5; period++) {
+		run_period();
+		CHECK(pwm.duty_hr == period * rate, "%s: period %u duty %u, want %u", name, period, pwm.duty_hr, period * rate);
+		CHECK(PWM_Ramp_Is_Active(&ramp) == (period < 5), "%s: period %u active %u", name, period,
+				PWM_Ramp_Is_Active(&ramp));
+	}
+	CHECK(pwm.duty_hr == target, "%s: ends at %u, want %u", name, pwm.duty_hr, target);
+	CHECK(pwm.duty == 50, "%s: percent duty %u", name, pwm.duty);
+
+	// Nothing moves once the ramp is done
+	run_period();
+	CHECK(pwm.duty_hr == target, "%s: moved to %u after the end", name, pwm.duty_hr);
+
+	Timer_Stop(&tim);
+}
+
+// Runs an s-curve ramp to its target and checks every step. Returns the number of periods it took
+static uint32_t run_s_curve(PWM_Ramp_st* ramp, const char* name) {
+	int64_t target = ramp->__target;
+	int64_t last_vel = ramp->__vel;
+	int64_t last_pos = ramp->__pos;
+	uint32_t periods = 0;
+
+	while (PWM_Ramp_Is_Active(ramp) && (periods < MAX_PERIODS)) {
+		int64_t vel;
+
+		run_period();
+		periods++;
+		vel = ramp->__pos - last_pos;
+
+		CHECK(llabs(vel - last_vel) <= ramp->__accel, "%s: period %u step %lld after %lld, acceleration %lld", name,
+				periods, (long long)vel, (long long)last_vel, (long long)ramp->__accel);
+		CHECK(llabs(vel) <= ramp->__max_step, "%s: period %u step %lld over the rate %lld", name, periods,
+				(long long)vel, (long long)ramp->__max_step);
+		// Once heading to the target the ramp never passes it
+		CHECK((last_pos == target) || ((ramp->__pos - target > 0) == (last_pos - target > 0)) || (ramp->__pos == target),
+				"%s: period %u overshoots to %lld, target %lld", name, periods, (long long)ramp->__pos, (long long)target);
+
+		last_vel = (ramp->__pos == target) ? 0 : vel;
+		last_pos = ramp->__pos;
+	}
+
+	CHECK(!PWM_Ramp_Is_Active(ramp), "%s: still ramping after %u periods", name, periods);
+	CHECK(pwm.duty_hr == (uint16_t)(target >> RAMP_Q), "%s: ends at %u, want %u", name, pwm.duty_hr,
+			(unsigned)(target >> RAMP_Q));
+
+	return periods;
+}
+
+// S-curve from 0% to 100% at 2% per ms reaching full rate in 10 ms. A linear ramp takes 50 periods, the s-curve
+// about one acceleration time more
+static void check_s_curve(Tim_Count_Mode_et count_mode) {
+	const char* name = mode_name(count_mode);
+	PWM_Ramp_st ramp = { .pwm = &pwm, .profile = RAMP_S_CURVE, .rate_hr_per_ms = PWM_RAMP_PERCENT_PER_MS(2),
+			.accel_ms = 10 };
+	uint32_t periods;
+
+	init_engine(count_mode);
+	CHECK(PWM_Ramp_Init(&engine, &ramp) == PWM_OK, "%s: PWM_Ramp_Init", name);
+	CHECK(ramp.__accel == ramp.__max_step / 10, "%s: acceleration %lld for a step of %lld", name,
+			(long long)ramp.__accel, (long long)ramp.__max_step);
+
+	CHECK(PWM_Ramp_Update_Target(&engine, &ramp, 100) == PWM_OK, "%s: PWM_Ramp_Update_Target", name);
+	run_period();
+	CHECK((ramp.__pos > 0) && (ramp.__pos <= ramp.__accel), "%s: first step %lld, acceleration %lld", name,
+			(long long)ramp.__pos, (long long)ramp.__accel);
+
+	periods = run_s_curve(&ramp, name) + 1;
+	CHECK((periods >= 58) && (periods <= 62), "%s: 0%% to 100%% in %u periods", name, periods);
+
+	Timer_Stop(&tim);
+}
+
+// S-curve sent back to 0% while it climbs to 100%: it brakes, turns around and stops at 0%
+static void check_s_curve_reverse(Tim_Count_Mode_et count_mode) {
+	const char* name = mode_name(count_mode);
+	PWM_Ramp_st ramp = { .pwm = &pwm, .profile = RAMP_S_CURVE, .rate_hr_per_ms = PWM_RAMP_PERCENT_PER_MS(2),
+			.accel_ms = 10 };
+
+	init_engine(count_mode);
+	CHECK(PWM_Ramp_Init(&engine, &ramp) == PWM_OK, "%s: PWM_Ramp_Init", name);
+	CHECK(PWM_Ramp_Update_Target(&engine, &ramp, 100) == PWM_OK, "%s: PWM_Ramp_Update_Target", name);
+	for (uint32_t i = 0; i < 25; i++) {
+		run_period();
+	}
+	CHECK(PWM_Ramp_Is_Active(&ramp) && (pwm.duty > 30) && (pwm.duty < 70), "%s: %u%% halfway", name, pwm.duty);
+
+	CHECK(PWM_Ramp_Update_Target(&engine, &ramp, 0) == PWM_OK, "%s: PWM_Ramp_Update_Target back", name);
+	run_s_curve(&ramp, name);
+	CHECK(pwm.duty_hr == 0, "%s: ends at %u", name, pwm.duty_hr);
+
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const Tim_Count_Mode_et modes[] = { COUNT_UP, COUNT_CENTER_ALIGNED_1 };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t m = 0; m < (sizeof(modes) / sizeof(modes[0])); m++) {
+		check_linear(modes[m]);
+		check_s_curve(modes[m]);
+		check_s_curve_reverse(modes[m]);
+	}
+
+	printf("test_ramp: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
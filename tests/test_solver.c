@@ -0,0 +1,232 @@
+/*
+ * test_solver.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Sweep of Timer_Solve_Freq / Timer_Solve_Period against an exhaustive search.
+ *
+ *	For every clock tree, timer, counting mode, minimum counting period and requested frequency or period:
+ *		- PSC and ARR fit their registers and leave at least the minimum counting period
+ *		- a request is only rejected when no PSC / ARR pair fits it
+ *		- error_ppm and achieved_mhz match the exact ratio of the solution
+ *		- no other prescaler gets closer to the request (checked by trying all of them on a subset)
+ *	Timer_Build_Timing_Table / Timer_Lookup_Timing are checked on a table of the swept frequencies.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timers_pwm.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Every n-th case is also searched exhaustively, all 65536 prescalers each
+#define EXHAUSTIVE_EVERY		(7U)
+#define TABLE_LEN				(64U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+typedef struct {
+	uint32_t hclk_hz;
+	uint32_t apb1_div;
+	uint32_t apb2_div;
+	uint8_t timpre;
+}clock_tree_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const clock_tree_st clock_trees[] = {
+	{ 216000000U, 4, 2, 0 },
+	{ 216000000U, 4, 2, 1 },
+	{ 180000000U, 4, 2, 0 },
+	{ 16000000U, 1, 1, 0 },
+};
+
+static const uint8_t tim_nums[] = { 1, 2, 4, 5, 7, 12 };
+static const Tim_Count_Mode_et count_modes[] = { COUNT_UP, COUNT_CENTER_ALIGNED_2 };
+static const uint32_t min_counts[] = { 0, 1000, 50000 };
+static const uint32_t periods_ms[] = { 1, 3, 9, 17, 100, 333, 1000, 4321, 10000, 65535, 600000, 3600000 };
+
+static uint32_t failures;
+static uint32_t cases;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static uint8_t is_center(Tim_Count_Mode_et mode) {
+	return (mode == COUNT_CENTER_ALIGNED_1) || (mode == COUNT_CENTER_ALIGNED_2) || (mode == COUNT_CENTER_ALIGNED_3);
+}
+
+// Distance of psc * count from num / den, in units of 1 / den ticks
+static uint64_t distance(uint64_t num, uint64_t den, uint64_t psc, uint64_t count) {
+	uint64_t ticks = psc * count * den;
+
+	return (ticks > num) ? (ticks - num) : (num - ticks);
+}
+
+// A prescaler fits when the exact count for it is within [min_count, max_count]
+static uint8_t prescaler_fits(uint64_t num, uint64_t den, uint64_t psc, uint64_t min_count, uint64_t max_count) {
+	return (num >= (den * psc * min_count)) && (num <= (den * psc * max_count));
+}
+
+// Smallest distance any fitting prescaler reaches with a count in [min_count, max_count]. UINT64_MAX when none fits
+static uint64_t exhaustive_best(uint64_t num, uint64_t den, uint64_t min_count, uint64_t max_count) {
+	uint64_t best = UINT64_MAX;
+
+	for (uint64_t psc = 1; psc <= MAX_PRESCALER; psc++) {
+		uint64_t lo = num / (den * psc);
+		uint64_t hi = lo + 1;
+
+		if (!prescaler_fits(num, den, psc, min_count, max_count)) {
+			continue;
+		}
+		// Both neighbours of the exact count, clamped to the allowed range
+		lo = (lo < min_count) ? min_count : ((lo > max_count) ? max_count : lo);
+		hi = (hi < min_count) ? min_count : ((hi > max_count) ? max_count : hi);
+		if (distance(num, den, psc, lo) < best) { best = distance(num, den, psc, lo); }
+		if (distance(num, den, psc, hi) < best) { best = distance(num, den, psc, hi); }
+	}
+
+	return best;
+}
+
+// Error of the exact ratio num / den - 1 in ppm
+static double exact_ppm(uint64_t num, uint64_t den) {
+	return (((long double)num / (long double)den) - 1.0L) * 1e6L;
+}
+
+static void check_solution(Timer_st* tim, uint64_t num, uint64_t den, uint32_t min_count, TIM_Ret_et ret,
+		Tim_Timing_st* timing, const char* what, uint32_t value) {
+	uint8_t center = is_center(tim->count_mode);
+	uint64_t max_count = IS_TIM_32B_COUNTER_INSTANCE(tim->htim->Instance) ? MAX_COUNTING_PERIOD_32BIT : MAX_COUNTING_PERIOD_16BIT;
+	uint64_t low_count = (min_count < MIN_COUNTING_PERIOD) ? MIN_COUNTING_PERIOD : min_count;
+	uint64_t psc;
+	uint64_t count;
+	double ppm;
+
+	cases++;
+	if (center) {
+		// The solver works on half periods of ARR counts
+		den *= 2;
+		max_count -= 1;
+	}
+
+	// Smallest prescaler that keeps the count within max_count
+	psc = (num + (den * max_count) - 1) / (den * max_count);
+	if (psc == 0) {
+		psc = 1;
+	}
+	if (ret != TIM_OK) {
+		// Rejected: no prescaler fits a count in range
+		CHECK((psc > MAX_PRESCALER) || !prescaler_fits(num, den, psc, low_count, max_count),
+				"tim%u mode %d min %u %s %u rejected (%d)", tim->tim_num, tim->count_mode, min_count, what, value, ret);
+		return;
+	}
+
+	psc = (uint64_t)timing->prescaler + 1;
+	count = (uint64_t)timing->period + 1 - center;
+	CHECK(psc <= MAX_PRESCALER, "tim%u %s %u: psc %u", tim->tim_num, what, value, timing->prescaler);
+	CHECK((count >= low_count) && (count <= max_count), "tim%u mode %d min %u %s %u: %llu counts", tim->tim_num,
+			tim->count_mode, min_count, what, value, (unsigned long long)count);
+	CHECK(timing->clk_hz == Timer_Get_Clock_Freq(tim), "tim%u clk_hz", tim->tim_num);
+	CHECK(timing->achieved_mhz == (((uint64_t)timing->clk_hz * 1000U) / (psc * count * (center ? 2 : 1))),
+			"tim%u %s %u: achieved_mhz", tim->tim_num, what, value);
+
+	ppm = exact_ppm(num, psc * count * den);
+	CHECK((timing->error_ppm >= (ppm - 0.5)) && (timing->error_ppm <= (ppm + 0.5)),
+			"tim%u mode %d %s %u: error_ppm %d, exact %.3f", tim->tim_num, tim->count_mode, what, value, (int)timing->error_ppm, ppm);
+
+	if ((cases % EXHAUSTIVE_EVERY) == 0) {
+		uint64_t best = exhaustive_best(num, den, low_count, max_count);
+
+		CHECK(distance(num, den, psc, count) <= best, "tim%u mode %d min %u %s %u: psc %llu count %llu is not the closest",
+				tim->tim_num, tim->count_mode, min_count, what, value, (unsigned long long)psc, (unsigned long long)count);
+	}
+}
+
+static void check_table(Timer_st* tim) {
+	uint32_t freqs_hz[TABLE_LEN];
+	Tim_Timing_st timings[TABLE_LEN];
+	Tim_Timing_Table_st table = { freqs_hz, timings, TABLE_LEN };
+	Tim_Timing_st* found;
+	Tim_Timing_st direct;
+
+	for (uint16_t i = 0; i < TABLE_LEN; i++) {
+		freqs_hz[i] = 1000U + (i * 500U);
+	}
+	CHECK(Timer_Build_Timing_Table(tim, &table, 0) == TIM_OK, "tim%u Timer_Build_Timing_Table", tim->tim_num);
+
+	for (uint16_t i = 0; i < TABLE_LEN; i++) {
+		CHECK((Timer_Lookup_Timing(&table, freqs_hz[i], &found) == TIM_OK) && (found == &timings[i]),
+				"tim%u lookup %u Hz", tim->tim_num, freqs_hz[i]);
+		CHECK(Timer_Solve_Freq(tim, freqs_hz[i], 0, &direct) == TIM_OK, "tim%u solve %u Hz", tim->tim_num, freqs_hz[i]);
+		CHECK((direct.prescaler == timings[i].prescaler) && (direct.period == timings[i].period),
+				"tim%u table entry %u Hz", tim->tim_num, freqs_hz[i]);
+	}
+
+	// Unsorted tables are rejected
+	freqs_hz[1] = freqs_hz[0];
+	CHECK(Timer_Build_Timing_Table(tim, &table, 0) == TIM_FREQ_INVALID, "tim%u unsorted table", tim->tim_num);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	for (uint8_t c = 0; c < (sizeof(clock_trees) / sizeof(clock_trees[0])); c++) {
+		Mock_Reset();
+		Mock_Set_Clocks(clock_trees[c].hclk_hz, clock_trees[c].apb1_div, clock_trees[c].apb2_div, clock_trees[c].timpre);
+
+		for (uint8_t t = 0; t < sizeof(tim_nums); t++) {
+			for (uint8_t m = 0; m < (sizeof(count_modes) / sizeof(count_modes[0])); m++) {
+				TIM_HandleTypeDef htim = {0};
+				Timer_st tim = {0};
+				Tim_Timing_st timing;
+
+				// Only timers 1-5 and 8 count center aligned
+				if (is_center(count_modes[m]) && (tim_nums[t] > 8)) {
+					continue;
+				}
+				tim.htim = &htim;
+				tim.tim_num = tim_nums[t];
+				tim.count_mode = count_modes[m];
+
+				for (uint8_t n = 0; n < (sizeof(min_counts) / sizeof(min_counts[0])); n++) {
+					for (uint64_t f = 1; f <= 10000000U; f = (f * 3) + (f / 7) + 1) {
+						TIM_Ret_et ret = Timer_Solve_Freq(&tim, (uint32_t)f, min_counts[n], &timing);
+
+						check_solution(&tim, Timer_Get_Clock_Freq(&tim), f, min_counts[n], ret, &timing, "freq", (uint32_t)f);
+					}
+					for (uint8_t p = 0; p < (sizeof(periods_ms) / sizeof(periods_ms[0])); p++) {
+						TIM_Ret_et ret = Timer_Solve_Period(&tim, periods_ms[p], min_counts[n], &timing);
+
+						check_solution(&tim, (uint64_t)Timer_Get_Clock_Freq(&tim) * periods_ms[p], 1000U, min_counts[n], ret,
+								&timing, "period", periods_ms[p]);
+					}
+				}
+
+				CHECK(Timer_Solve_Freq(&tim, 0, 0, &timing) == TIM_FREQ_ZERO, "tim%u zero freq", tim.tim_num);
+				CHECK(Timer_Solve_Period(&tim, 0, 0, &timing) == TIM_PERIOD_ZERO, "tim%u zero period", tim.tim_num);
+				check_table(&tim);
+			}
+		}
+	}
+
+	printf("test_solver: %u cases, %u failures\n", cases, failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+/*
+ * test_spectrum.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Spectrum_FFT and Spectrum_Goertzel on buffers holding known tones.
+ *
+ *	Sines of a known amplitude are written to a channel buffer around mid scale. Checks:
+ *		- the FFT peak sits on the tone bin at the right frequency, with the magnitude of the window coherent gain
+ *		- bins away from the tone stay near zero with the rectangular window
+ *		- Spectrum_Band_Energy separates two tones
+ *		- Goertzel powers match a floating point Goertzel of the same samples and coefficient
+ *		- on a long buffer near DC, where the states pass 32 bits, and at full scale
+ *		- on an exact bin the power is (amplitude * N / 2)^2, and a tone away from the target is rejected
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "adc_spectrum.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define CHANNEL					(3U)
+#define OFFSET					(2048.0)
+#define MAX_BUFFER_LEN			(60000U)
+#define PI						(3.14159265358979323846)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// Window and its coherent gain (mean of the window samples)
+typedef struct {
+	Spectrum_Window_et window;
+	const char* name;
+	double gain;
+}window_gain_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static uint16_t buffer[MAX_BUFFER_LEN];
+static ADC_Channel_st adc_channel;
+static ADC_st adc;
+static Spectrum_Bin_st bins[SPECTRUM_NUM_BINS(SPECTRUM_MAX_FFT_LEN)];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static void init_channel(uint16_t len) {
+	adc_channel = (ADC_Channel_st){ .channel_number = CHANNEL, .buffer_len = len, .buffer = buffer };
+	adc = (ADC_st){ .adc_num = 1, .num_channels = 1, .channels = &adc_channel };
+}
+
+// Fills the buffer with up to two tones, w in radians per sample, amplitudes in counts
+static void fill_tones(uint16_t len, double w1, double amplitude1, double w2, double amplitude2) {
+	init_channel(len);
+
+	for (uint32_t n = 0; n < len; n++) {
+		double x = OFFSET + (amplitude1 * sin(w1 * n)) + (amplitude2 * sin(w2 * n));
+
+		buffer[n] = (uint16_t)lround(fmin(fmax(x, 0.0), 4095.0));
+	}
+}
+
+static double bin_magnitude(uint16_t k) {
+	return sqrt(((double)bins[k].re * bins[k].re) + ((double)bins[k].im * bins[k].im));
+}
+
+// A tone on bin k of an N point FFT, every window
+static void check_fft_tone(uint16_t len, uint16_t k, double amplitude) {
+	static const window_gain_st windows[] = {
+		{ WINDOW_RECTANGULAR, "rectangular", 1.0 },
+		{ WINDOW_HANN, "hann", 0.5 },
+		{ WINDOW_HAMMING, "hamming", 0.54 },
+		{ WINDOW_BLACKMAN, "blackman", 0.42 },
+	};
+	// 100 Hz per bin
+	uint32_t sample_rate_hz = 100U * len;
+	uint16_t num_bins = SPECTRUM_NUM_BINS(len);
+
+	fill_tones(len, (2 * PI * k) / len, amplitude, 0, 0);
+
+	for (uint8_t i = 0; i < (sizeof(windows) / sizeof(windows[0])); i++) {
+		// Half the amplitude in Q15 (amplitude << 3) times the coherent gain of the window
+		double want = (amplitude * 4.0) * windows[i].gain;
+		uint32_t peak_hz = 0;
+		uint16_t peak;
+
+		CHECK(Spectrum_FFT(&adc, CHANNEL, windows[i].window, bins, num_bins) == ADC_OK, "%u point %s: Spectrum_FFT", len,
+				windows[i].name);
+		peak = Spectrum_Peak(bins, num_bins, sample_rate_hz, &peak_hz);
+		CHECK(peak == k, "%u point %s: peak on bin %u, want %u", len, windows[i].name, peak, k);
+		CHECK(peak_hz == 100U * k, "%u point %s: peak at %u Hz, want %u", len, windows[i].name, peak_hz, 100U * k);
+		CHECK(fabs(bin_magnitude(k) - want) <= (want * 0.03) + 2.0, "%u point %s: bin %u magnitude %.1f, want %.1f", len,
+				windows[i].name, k, bin_magnitude(k), want);
+
+		if (windows[i].window != WINDOW_RECTANGULAR) {
+			continue;
+		}
+		// Only rounding of the samples and the butterflies leaks out of an exact bin
+		for (uint16_t b = 0; b < num_bins; b++) {
+			if (b != k) {
+				CHECK(bin_magnitude(b) <= 4.0, "%u point: bin %u magnitude %.1f with the tone on bin %u", len, b,
+						bin_magnitude(b), k);
+			}
+		}
+	}
+}
+
+// Two tones on separate bins measured by band
+static void check_band_energy(void) {
+	uint16_t len = 256;
+	uint32_t sample_rate_hz = 25600;
+	uint16_t num_bins = SPECTRUM_NUM_BINS(len);
+	double want_low = 1000.0 * 4.0;
+	double want_high = 500.0 * 4.0;
+	uint64_t low;
+	uint64_t high;
+	uint64_t all;
+
+	fill_tones(len, (2 * PI * 10) / len, 1000.0, (2 * PI * 40) / len, 500.0);
+	CHECK(Spectrum_FFT(&adc, CHANNEL, WINDOW_RECTANGULAR, bins, num_bins) == ADC_OK, "bands: Spectrum_FFT");
+
+	low = Spectrum_Band_Energy(bins, num_bins, sample_rate_hz, 900, 1100);
+	high = Spectrum_Band_Energy(bins, num_bins, sample_rate_hz, 3900, 4100);
+	all = Spectrum_Band_Energy(bins, num_bins, sample_rate_hz, 0, sample_rate_hz / 2);
+	CHECK(fabs((double)low - (want_low * want_low)) <= want_low * want_low * 0.03, "bands: %llu around 1 kHz, want %.0f",
+			(unsigned long long)low, want_low * want_low);
+	CHECK(fabs((double)high - (want_high * want_high)) <= want_high * want_high * 0.03, "bands: %llu around 4 kHz, want %.0f",
+			(unsigned long long)high, want_high * want_high);
+	CHECK((double)all - (double)(low + high) <= 2000.0, "bands: %llu outside the two tones",
+			(unsigned long long)(all - low - high));
+}
+
+// Floating point Goertzel of the buffer with the fixed point coefficient of g
+static double reference_power(const Goertzel_st* g, uint16_t len) {
+	double coeff = (double)g->coeff / (1 << GOERTZEL_COEFF_SHIFT);
+	double mean = 0;
+	double s1 = 0;
+	double s2 = 0;
+
+	for (uint32_t n = 0; n < len; n++) {
+		mean += buffer[n];
+	}
+	// Spectrum_Goertzel removes the integer mean
+	mean = floor(mean / len);
+
+	for (uint32_t n = 0; n < len; n++) {
+		double s = (buffer[n] - mean) + (coeff * s1) - s2;
+
+		s2 = s1;
+		s1 = s;
+	}
+
+	return (s1 * s1) + (s2 * s2) - (coeff * s1 * s2);
+}
+
+// A tone exactly on the frequency the coefficient of g resonates at, compared with the floating point Goertzel
+static void check_goertzel_resonance(uint32_t target_hz, uint32_t sample_rate_hz, uint16_t len, double amplitude) {
+	Goertzel_st g;
+	double w;
+	double want;
+
+	CHECK(Goertzel_Init(&g, target_hz, sample_rate_hz) == ADC_OK, "%u Hz: Goertzel_Init", target_hz);
+	w = acos((double)g.coeff / (2 << GOERTZEL_COEFF_SHIFT));
+	fill_tones(len, w, amplitude, 0, 0);
+
+	want = reference_power(&g, len);
+	CHECK(Spectrum_Goertzel(&adc, CHANNEL, &g, 1) == ADC_OK, "%u Hz: Spectrum_Goertzel", target_hz);
+	CHECK(fabs((double)g.power - want) <= want * 1e-3, "%u Hz over %u samples: power %.4g, want %.4g", target_hz, len,
+			(double)g.power, want);
+	// Close to the whole tone, whatever fraction of a cycle the buffer ends on
+	CHECK((double)g.power >= pow(amplitude * len / 2, 2) * 0.5, "%u Hz over %u samples: power %.4g, tone %.4g", target_hz,
+			len, (double)g.power, pow(amplitude * len / 2, 2));
+}
+
+// Exact bins: the power of the target tone and the rejection of another bin
+static void check_goertzel_bins(void) {
+	uint32_t sample_rate_hz = 8000;
+	uint16_t len = 800;
+	double amplitude = 1500.0;
+	double tone = pow(amplitude * len / 2, 2);
+	Goertzel_st g[2];
+
+	CHECK(Goertzel_Init(&g[0], 1000, sample_rate_hz) == ADC_OK, "bins: Goertzel_Init");
+	CHECK(Goertzel_Init(&g[1], 2000, sample_rate_hz) == ADC_OK, "bins: Goertzel_Init");
+	fill_tones(len, (2 * PI * 1000) / sample_rate_hz, amplitude, 0, 0);
+
+	CHECK(Spectrum_Goertzel(&adc, CHANNEL, g, 2) == ADC_OK, "bins: Spectrum_Goertzel");
+	CHECK(fabs((double)g[0].power - tone) <= tone * 0.01, "bins: 1 kHz power %.4g, want %.4g", (double)g[0].power, tone);
+	CHECK((double)g[1].power <= tone * 1e-4, "bins: 2 kHz power %.4g with the tone at 1 kHz", (double)g[1].power);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_fft_tone(16, 3, 1000.0);
+	check_fft_tone(256, 10, 1000.0);
+	check_fft_tone(1024, 100, 2000.0);
+	check_fft_tone(1024, 500, 500.0);
+	check_band_energy();
+
+	check_goertzel_bins();
+	check_goertzel_resonance(1000, 8000, 800, 1500.0);
+	// Full scale over a long buffer: states of about 10^8
+	check_goertzel_resonance(1000, 6000, MAX_BUFFER_LEN, 2047.0);
+	// Near DC the coefficient rounds to 2 - 2^-14 and the states grow past 10^10
+	check_goertzel_resonance(10, 10000, MAX_BUFFER_LEN, 2000.0);
+	check_goertzel_resonance(50, 10000, MAX_BUFFER_LEN, 2000.0);
+
+	printf("test_spectrum: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
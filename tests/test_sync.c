@@ -0,0 +1,237 @@
+/*
+ * test_sync.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Placement of the adc trigger compare of ADC_Sync on the emulated timers.
+ *
+ *	The counter is stepped over whole pwm periods while the level of the pwm output and the reference of the trigger
+ *	channel (Mock_Tim_OC_Ref) are recorded. Checks, edge and center aligned, normal, inverted and pwm mode 2 outputs:
+ *		- the trigger reference rises exactly once per period
+ *		- that edge plus the lead falls in the middle of the high or low time of the pwm output, to one count
+ *		- ADC_Sync_Update follows duty changes
+ *		- the trigger routes: direct compare event (TIM1), TRGO (TIM5) and TRGO2 (TIM8)
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "adc_sync.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define PWM_FREQ_HZ				(20000U)
+#define PWM_CHAN				(1U)
+#define TRIGGER_CHAN			(2U)
+// Periods recorded per placement
+#define NUM_PERIODS				(3U)
+// Longest recording: NUM_PERIODS center aligned periods of TIM1 / TIM8 at PWM_FREQ_HZ, plus one sample
+#define MAX_TICKS				(NUM_PERIODS * 2U * 10800U + 1U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// How the pwm output is driven
+typedef enum {
+	OUTPUT_NORMAL = 1,
+	OUTPUT_INVERTED,
+	// Pwm mode 2 written over the pwm mode 1 of PWM_Init
+	OUTPUT_PWM2,
+}output_et;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static PWM_st pwm;
+static ADC_HandleTypeDef hadc;
+static ADC_Channel_st adc_channel;
+static ADC_st adc;
+static ADC_Sync_st sync;
+static uint16_t samples[1];
+
+// Pwm output level and trigger reference after every count
+static uint8_t level[MAX_TICKS];
+static uint8_t ref[MAX_TICKS];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static uint32_t period_ticks(void) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	return Timer_Is_Center_Aligned(&tim) ? (2 * regs->ARR) : (regs->ARR + 1);
+}
+
+// Counts the timer over NUM_PERIODS periods, recording the output and the trigger reference
+static uint32_t record(void) {
+	TIM_TypeDef* regs = htim.Instance;
+	uint32_t num_ticks = NUM_PERIODS * period_ticks() + 1;
+
+	for (uint32_t i = 0; i < num_ticks; i++) {
+		Mock_Tim_Count(regs);
+		level[i] = Mock_Tim_Output(regs, PWM_CHAN, 0);
+		ref[i] = Mock_Tim_OC_Ref(regs, TRIGGER_CHAN);
+	}
+
+	return num_ticks;
+}
+
+// Lead of the sync in counts of the timer
+static uint32_t lead_counts(void) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	return (uint32_t)(((uint64_t)sync.lead_ns * Timer_Get_Clock_Freq(&tim)) / (((uint64_t)regs->PSC + 1) * 1000000000ULL));
+}
+
+// Checks one placement: a trigger edge per period, in the middle of the wanted output level
+static void check_placement(const char* name, uint8_t duty) {
+	uint8_t want = (sync.point == SYNC_HIGH_CENTER);
+	uint32_t num_ticks = record();
+	uint32_t lead = lead_counts();
+	uint32_t num_edges = 0;
+
+	for (uint32_t i = 1; i < num_ticks; i++) {
+		uint32_t sample;
+		uint32_t first;
+		uint32_t last;
+
+		if (ref[i - 1] || !ref[i]) {
+			continue;
+		}
+		num_edges++;
+
+		// Edges too close to the ends of the recording to see the whole output level around them
+		sample = i + lead;
+		if ((i < period_ticks()) || (sample + period_ticks() >= num_ticks)) {
+			continue;
+		}
+
+		CHECK(level[sample] == want, "%s %u%%: sampling while the output is %s", name, duty, level[sample] ? "high" : "low");
+		first = sample;
+		while (level[first - 1] == level[sample]) {
+			first--;
+		}
+		last = sample;
+		while (level[last + 1] == level[sample]) {
+			last++;
+		}
+		CHECK(((2 * sample) + 2 >= first + last) && ((2 * sample) <= first + last + 2),
+				"%s %u%%: sample at %u, output %s from %u to %u", name, duty, sample, want ? "high" : "low", first, last);
+	}
+
+	CHECK(num_edges == NUM_PERIODS, "%s %u%%: %u trigger edges in %u periods", name, duty, num_edges, NUM_PERIODS);
+}
+
+// Pwm on channel 1 and the trigger on channel 2 of a timer, one adc channel without DMA
+static void init_sync(uint8_t tim_num, Tim_Count_Mode_et count_mode, output_et output, ADC_Sync_Point_et point,
+		uint32_t lead_ns) {
+	Mock_Reset();
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = FREQ;
+	tim.freq_hz = PWM_FREQ_HZ;
+	tim.count_mode = count_mode;
+	tim.channels.en_ch1 = 1;
+	CHECK(Timer_Init(&tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+
+	pwm = (PWM_st){ .tim = &tim, .chan_num = PWM_CHAN, .duty = 50, .is_inverted = (output == OUTPUT_INVERTED) };
+	CHECK(PWM_Init(&pwm) == PWM_OK, "tim%u PWM_Init", tim_num);
+	if (output == OUTPUT_PWM2) {
+		Timer_Set_OC_Mode(&tim, PWM_CHAN, TIM_OCMODE_PWM2);
+	}
+
+	hadc = (ADC_HandleTypeDef){ .Instance = ADC1 };
+	adc_channel = (ADC_Channel_st){ .channel_number = 3, .sample_time = ADC_3CYCLES };
+	adc = (ADC_st){ .hadc = &hadc, .adc_num = 1, .num_channels = 1, .channels = &adc_channel };
+	sync = (ADC_Sync_st){ .adc = &adc, .pwm = &pwm, .trigger_chan = TRIGGER_CHAN, .point = point, .lead_ns = lead_ns,
+			.samples = samples };
+	CHECK(ADC_Sync_Init(&sync) == ADC_OK, "tim%u ADC_Sync_Init", tim_num);
+	CHECK(ADC_Sync_Start(&sync) == ADC_OK, "tim%u ADC_Sync_Start", tim_num);
+}
+
+static void check_sync(uint8_t tim_num, Tim_Count_Mode_et count_mode, output_et output, ADC_Sync_Point_et point,
+		uint32_t lead_ns) {
+	static const uint8_t duties[] = { 10, 25, 50, 90 };
+	char name[80];
+
+	snprintf(name, sizeof(name), "tim%u %s %s %s center lead %u ns", tim_num,
+			(count_mode == COUNT_UP) ? "edge aligned" : "center aligned",
+			(output == OUTPUT_NORMAL) ? "normal" : ((output == OUTPUT_INVERTED) ? "inverted" : "pwm mode 2"),
+			(point == SYNC_HIGH_CENTER) ? "high" : "low", lead_ns);
+
+	init_sync(tim_num, count_mode, output, point, lead_ns);
+
+	for (uint8_t i = 0; i < (sizeof(duties) / sizeof(duties[0])); i++) {
+		CHECK(PWM_Set_Duty(&pwm, duties[i]) == PWM_OK, "%s: PWM_Set_Duty", name);
+		ADC_Sync_Update(&sync);
+		check_placement(name, duties[i]);
+	}
+
+	CHECK(ADC_Sync_Stop(&sync) == ADC_OK, "%s: ADC_Sync_Stop", name);
+	Timer_Stop(&tim);
+}
+
+// The trigger of each route reaches the adc
+static void check_routes(void) {
+	init_sync(1, COUNT_UP, OUTPUT_NORMAL, SYNC_HIGH_CENTER, 0);
+	CHECK(hadc.Init.ExternalTrigConv == ADC_EXTERNALTRIGCONV_T1_CC2, "tim1 trigger %u", (unsigned)hadc.Init.ExternalTrigConv);
+	CHECK(hadc.Init.ExternalTrigConvEdge == ADC_EXTERNALTRIGCONVEDGE_RISING, "tim1 trigger edge");
+	Timer_Stop(&tim);
+
+	init_sync(5, COUNT_UP, OUTPUT_NORMAL, SYNC_HIGH_CENTER, 0);
+	CHECK(hadc.Init.ExternalTrigConv == ADC_EXTERNALTRIGCONV_T5_TRGO, "tim5 trigger %u", (unsigned)hadc.Init.ExternalTrigConv);
+	CHECK((htim.Instance->CR2 & TIM_CR2_MMS) == TIM_TRGO_OC2REF, "tim5 TRGO is not OC2REF");
+	Timer_Stop(&tim);
+
+	init_sync(8, COUNT_UP, OUTPUT_NORMAL, SYNC_HIGH_CENTER, 0);
+	CHECK(hadc.Init.ExternalTrigConv == ADC_EXTERNALTRIGCONV_T8_TRGO2, "tim8 trigger %u", (unsigned)hadc.Init.ExternalTrigConv);
+	CHECK((htim.Instance->CR2 & TIM_CR2_MMS2) == TIM_TRGO2_OC2REF, "tim8 TRGO2 is not OC2REF");
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	static const uint8_t tim_nums[] = { 1, 5, 8 };
+	static const Tim_Count_Mode_et modes[] = { COUNT_UP, COUNT_CENTER_ALIGNED_1 };
+	static const output_et outputs[] = { OUTPUT_NORMAL, OUTPUT_INVERTED, OUTPUT_PWM2 };
+	static const ADC_Sync_Point_et points[] = { SYNC_HIGH_CENTER, SYNC_LOW_CENTER };
+	static const uint32_t leads_ns[] = { 0, 500 };
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_routes();
+
+	for (uint8_t t = 0; t < (sizeof(tim_nums) / sizeof(tim_nums[0])); t++) {
+		for (uint8_t m = 0; m < (sizeof(modes) / sizeof(modes[0])); m++) {
+			for (uint8_t o = 0; o < (sizeof(outputs) / sizeof(outputs[0])); o++) {
+				for (uint8_t p = 0; p < (sizeof(points) / sizeof(points[0])); p++) {
+					for (uint8_t l = 0; l < (sizeof(leads_ns) / sizeof(leads_ns[0])); l++) {
+						check_sync(tim_nums[t], modes[m], outputs[o], points[p], leads_ns[l]);
+					}
+				}
+			}
+		}
+	}
+
+	printf("test_sync: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
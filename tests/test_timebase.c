@@ -0,0 +1,155 @@
+/*
+ * test_timebase.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Timebase on an emulated counter.
+ *
+ *	The counter is stepped one count at a time and the update interrupt is delivered late by a varying number of
+ *	counts, as when interrupts are masked or the reader runs at the timer priority. Checks:
+ *		- Timebase_Now_Ticks equals the number of counts since Timebase_Start and never goes backwards
+ *		- the update flag left by the init does not count a wrap
+ *		- a 32 bit timer carries into the wrap count at bit 31
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timebase.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define WRAPS_16BIT				(40U)
+#define WRAPS_32BIT				(6U)
+// Counts run past the top of a 32 bit counter, starting this close to it
+#define LEAD_IN_32BIT			(5000U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Runs the interrupt if it is enabled and pending: the HAL clears UIF, then calls the period elapsed callback which
+// goes through the dispatch table
+static void deliver_update_it(Timebase_st* tb) {
+	TIM_TypeDef* regs = tb->tim->htim->Instance;
+
+	if ((regs->SR & TIM_SR_UIF) && (regs->DIER & TIM_DIER_UIE)) {
+		__HAL_TIM_CLEAR_FLAG(tb->tim->htim, TIM_FLAG_UPDATE);
+		// The UIF copy in CNT is live on target, the mock only updates it when counting
+		regs->CNT &= ~TIM_CNT_UIFCPY;
+		Timer_Dispatch_Period_Elapsed(tb->tim->htim);
+	}
+}
+
+static void init_timebase(Timebase_st* tb, Timer_st* tim, TIM_HandleTypeDef* htim, uint8_t tim_num) {
+	Mock_Reset();
+	tim->htim = htim;
+	tim->tim_num = tim_num;
+	tim->timing = FREQ;
+	tim->freq_hz = 1000;
+	tim->it_config.en_it = 1;
+	CHECK(Timer_Init(tim) == TIM_OK, "tim%u Timer_Init", tim_num);
+
+	tb->tim = tim;
+	tb->tick_hz = 0;
+	CHECK(Timebase_Init(tb) == TIM_OK, "tim%u Timebase_Init", tim_num);
+	CHECK(Timer_Register_Callback(tim, Timebase_Callback, tb) == TIM_OK, "tim%u Timer_Register_Callback", tim_num);
+	CHECK(Timebase_Start(tb) == TIM_OK, "tim%u Timebase_Start", tim_num);
+
+	deliver_update_it(tb);
+	CHECK(Timebase_Now_Ticks(tb) == 0, "tim%u starts at %llu", tim_num, (unsigned long long)Timebase_Now_Ticks(tb));
+}
+
+// Steps the counter and checks every reading. The interrupt is held off for 0 to 299 counts after each wrap
+static void run(Timebase_st* tb, uint64_t start, uint64_t num_counts) {
+	TIM_TypeDef* regs = tb->tim->htim->Instance;
+	uint64_t truth = start;
+	uint64_t last = start;
+	uint32_t delay = 0;
+	uint32_t pending_for = 0;
+
+	for (uint64_t i = 0; i < num_counts; i++) {
+		uint64_t now;
+
+		Mock_Tim_Count(regs);
+		truth++;
+
+		if (regs->SR & TIM_SR_UIF) {
+			if (pending_for == 0) {
+				delay = (uint32_t)((truth * 7919U) % 300U);
+			}
+			if (pending_for++ >= delay) {
+				deliver_update_it(tb);
+				pending_for = 0;
+			}
+		}
+
+		now = Timebase_Now_Ticks(tb);
+		CHECK(now == truth, "tim%u count %llu: read %llu", tb->tim->tim_num, (unsigned long long)truth, (unsigned long long)now);
+		CHECK(now >= last, "tim%u went backwards at %llu", tb->tim->tim_num, (unsigned long long)truth);
+		last = now;
+	}
+
+	// Late interrupt of the last wrap
+	deliver_update_it(tb);
+	CHECK(Timebase_Now_Ticks(tb) == truth, "tim%u after the last interrupt", tb->tim->tim_num);
+	CHECK(Timebase_Now_Us(tb) == (truth / tb->__ticks_per_us), "tim%u Timebase_Now_Us", tb->tim->tim_num);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	Timebase_st tb = {0};
+	uint32_t top;
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	// 16 bit: every wrap is counted
+	init_timebase(&tb, &tim, &htim, 3);
+	CHECK(tb.__bits == 16, "tim3 bits %u", tb.__bits);
+	run(&tb, 0, (uint64_t)WRAPS_16BIT << 16);
+	CHECK(tb.__wraps == WRAPS_16BIT, "tim3 %llu wraps", (unsigned long long)tb.__wraps);
+
+	// 32 bit: start just below the UIF copy bit and run through several wraps
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	init_timebase(&tb, &tim, &htim, 2);
+	CHECK(tb.__bits == 31, "tim2 bits %u", tb.__bits);
+	top = (uint32_t)((1ULL << 31) - LEAD_IN_32BIT);
+	for (uint32_t w = 0; w < WRAPS_32BIT; w++) {
+		uint64_t start = ((uint64_t)w << 31) + top;
+
+		htim.Instance->CNT = top;
+		run(&tb, start, 2 * LEAD_IN_32BIT);
+	}
+	CHECK(tb.__wraps == WRAPS_32BIT, "tim2 %llu wraps", (unsigned long long)tb.__wraps);
+
+	// Unsupported tick rates
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	init_timebase(&tb, &tim, &htim, 5);
+	tb.tick_hz = 1500000U;
+	CHECK(Timebase_Init(&tb) == TIM_FREQ_INVALID, "tim5 1.5 MHz tick");
+
+	printf("test_timebase: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,562 @@
+/*
+ * test_timing.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Timing sweep and benchmark of Timer_Init / PWM_Init on the emulated timers.
+ *
+ *	Every combination of clock tree, timer, counting mode and requested frequency or period is initialized, then the
+ *	emulated counter is run to measure what the registers produce. Checks:
+ *		- the measured counter period matches Timer_Get_Achieved, and its error_ppm matches the exact ratio
+ *		- the error is within half a counter step of the request, the best any PSC / ARR pair can do
+ *		- requests are only rejected when no PSC / ARR pair fits them
+ *		- pwm high time is within one count of the requested duty, and PWM_Get_Achieved_Duty_HR matches it
+ *		- compare values are the exactly rounded duty_hr * counts / PWM_DUTY_HR_MAX
+ *		- the repetition counter spaces the update interrupts by it_config (doubled in center aligned mode), and
+ *		  interrupt periods that are not a multiple of the timer period are rejected
+ *		- retuning a running timer reloads the repetition counter, keeps the exact duty and records the request
+ *	The mean Timer_Init time must stay below BENCH_MAX_INIT_NS.
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "hal_mock.h"
+#include "timers_pwm.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Generous bound for a host build, a regression in the solver shows up as orders of magnitude
+#ifndef BENCH_MAX_INIT_NS
+#define BENCH_MAX_INIT_NS		(200000U)
+#endif
+
+// Periods longer than this are checked from the registers only, emulating them count by count is too slow
+#define MAX_EMULATED_COUNTS		(1UL << 17)
+#define MAX_DUTY_EMULATED_COUNTS	(1UL << 14)
+#define MAX_PRESCALER_COUNT		(65536ULL)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+typedef struct {
+	uint32_t hclk_hz;
+	uint32_t apb1_div;
+	uint32_t apb2_div;
+	uint8_t timpre;
+}clock_tree_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const clock_tree_st clock_trees[] = {
+	{ 216000000U, 4, 2, 0 },
+	{ 216000000U, 2, 1, 0 },
+	{ 216000000U, 4, 2, 1 },
+	{ 100000000U, 2, 1, 0 },
+	{ 16000000U, 1, 1, 0 },
+};
+
+static const uint8_t tim_nums[] = { 1, 2, 3, 6, 9, 10 };
+static const Tim_Count_Mode_et count_modes[] = { COUNT_UP, COUNT_DOWN, COUNT_CENTER_ALIGNED_1 };
+static const uint32_t periods_ms[] = { 1, 2, 3, 7, 10, 33, 100, 250, 1000, 1234, 5000, 30000, 60000 };
+static const uint16_t duties_hr[] = { 0, 1, 655, 21845, 32768, 49151, 65534, PWM_DUTY_HR_MAX };
+
+static const clock_tree_st* tree;
+static uint32_t failures;
+static uint32_t cases;
+static int32_t worst_ppm;
+static uint64_t init_ns;
+static uint32_t num_inits;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint8_t is_center(Tim_Count_Mode_et mode) {
+	return (mode == COUNT_CENTER_ALIGNED_1) || (mode == COUNT_CENTER_ALIGNED_2) || (mode == COUNT_CENTER_ALIGNED_3);
+}
+
+// Restarts the counter with an update event, as the hardware does after UG
+static void restart(TIM_TypeDef* regs) {
+	regs->EGR = TIM_EGR_UG;
+	Mock_Tim_Apply_Events(regs);
+	regs->SR = 0;
+}
+
+// Counts until the counter is back at the same value in the same direction
+static uint64_t emulate_period_counts(TIM_TypeDef* regs) {
+	uint32_t start = regs->CNT;
+	uint32_t dir = regs->CR1 & TIM_CR1_DIR;
+	uint64_t n = 0;
+
+	do {
+		Mock_Tim_Count(regs);
+		n++;
+	} while (((regs->CNT != start) || ((regs->CR1 & TIM_CR1_DIR) != dir)) && (n <= (2 * MAX_EMULATED_COUNTS)));
+
+	return n;
+}
+
+// Counts of one period with channel 1 high
+static uint64_t emulate_high_counts(TIM_TypeDef* regs, uint64_t period_counts) {
+	uint64_t high = 0;
+
+	for (uint64_t n = 0; n < period_counts; n++) {
+		Mock_Tim_Count(regs);
+		high += Mock_Tim_Output(regs, 1, 0);
+	}
+	return high;
+}
+
+// Counts between two update flags
+static uint64_t emulate_update_counts(TIM_TypeDef* regs) {
+	uint64_t n = 0;
+
+	restart(regs);
+	do {
+		Mock_Tim_Count(regs);
+		n++;
+	} while (!(regs->SR & TIM_SR_UIF) && (n <= (64 * MAX_EMULATED_COUNTS)));
+
+	return n;
+}
+
+// Error of the exact ratio num / den - 1 in ppm
+static double exact_ppm(uint64_t num, uint64_t den) {
+	return (((long double)num / (long double)den) - 1.0L) * 1e6L;
+}
+
+static void check_duty(Timer_st* tim, uint64_t period_counts) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	PWM_st pwm = {0};
+
+	pwm.tim = tim;
+	pwm.chan_num = 1;
+	CHECK(PWM_Init(&pwm) == PWM_OK, "tim%u PWM_Init", tim->tim_num);
+
+	for (uint8_t d = 0; d < (sizeof(duties_hr) / sizeof(duties_hr[0])); d++) {
+		uint64_t high;
+		uint16_t achieved_hr;
+		double want;
+
+		CHECK(PWM_Set_Duty_HR(&pwm, duties_hr[d]) == PWM_OK, "tim%u PWM_Set_Duty_HR", tim->tim_num);
+		restart(regs);
+		high = emulate_high_counts(regs, period_counts);
+		want = ((double)duties_hr[d] * (double)period_counts) / PWM_DUTY_HR_MAX;
+		CHECK(((double)high >= (want - 1.0)) && ((double)high <= (want + 1.0)),
+				"tim%u mode %d arr %u duty %u: %llu of %llu counts high", tim->tim_num, tim->count_mode,
+				(unsigned)regs->ARR, duties_hr[d], (unsigned long long)high, (unsigned long long)period_counts);
+
+		CHECK(PWM_Get_Achieved_Duty_HR(&pwm, &achieved_hr) == PWM_OK, "tim%u PWM_Get_Achieved_Duty_HR", tim->tim_num);
+		want = ((double)high * PWM_DUTY_HR_MAX) / (double)period_counts;
+		CHECK(((double)achieved_hr >= (want - 1.0)) && ((double)achieved_hr <= (want + 1.0)),
+				"tim%u duty %u: readback %u, emulated %.1f", tim->tim_num, duties_hr[d], achieved_hr, want);
+	}
+
+	// The precomputed compare scale rounds exactly like duty_hr * counts / PWM_DUTY_HR_MAX
+	for (uint32_t duty_hr = 0; duty_hr <= PWM_DUTY_HR_MAX; duty_hr++) {
+		uint64_t exact = ((duty_hr * PWM_Get_Duty_Counts(tim)) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX;
+
+		if ((tim->count_mode == COUNT_DOWN) && (exact != 0)) {
+			exact--;
+		}
+		PWM_Set_Duty_HR(&pwm, (uint16_t)duty_hr);
+		CHECK(regs->CCR1 == exact, "tim%u arr %u duty %u: compare %u, want %llu", tim->tim_num, (unsigned)regs->ARR, duty_hr,
+				(unsigned)regs->CCR1, (unsigned long long)exact);
+	}
+
+	PWM_Stop(&pwm);
+}
+
+// Initializes one timer with a request and checks what it produces
+static void check_request(uint8_t tim_num, Tim_Count_Mode_et mode, Timing_Model_et timing, uint32_t value) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	Tim_Achieved_st achieved;
+	TIM_TypeDef* regs;
+	uint64_t start;
+	uint64_t max_ticks;
+	uint32_t clk;
+	uint64_t step;
+	uint64_t counts;
+	uint64_t num;
+	uint64_t den;
+	double ppm;
+	TIM_Ret_et ret;
+
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = timing;
+	tim.freq_hz = (timing == FREQ) ? value : 0;
+	tim.period_ms = (timing == PERIOD) ? value : 0;
+	tim.count_mode = mode;
+	tim.channels.en_ch1 = (Timer_Get_Capability(tim_num)->num_channels != 0);
+	clk = Timer_Get_Clock_Freq(&tim);
+
+	start = now_ns();
+	ret = Timer_Init(&tim);
+	init_ns += now_ns() - start;
+	num_inits++;
+	cases++;
+
+	// Requested counter period in ticks is num / den, half of it when center aligned as the counter runs up and down
+	num = (timing == FREQ) ? clk : ((uint64_t)clk * value);
+	den = (timing == FREQ) ? value : 1000U;
+	if (is_center(mode)) {
+		den *= 2;
+	}
+	max_ticks = MAX_PRESCALER_COUNT * (IS_TIM_32B_COUNTER_INSTANCE(htim.Instance) ? (1ULL << 32) : (1ULL << 16));
+
+	if (ret != TIM_OK) {
+		// Only requests outside of what any PSC / ARR pair reaches may fail
+		CHECK((num > (den * (max_ticks - MAX_PRESCALER_COUNT))) || (num < (den * (MIN_COUNTING_PERIOD + 1))),
+				"tim%u mode %d %s %u rejected (%d)", tim_num, mode, (timing == FREQ) ? "freq" : "period", value, ret);
+		return;
+	}
+
+	regs = htim.Instance;
+	CHECK(Timer_Get_Achieved(&tim, &achieved) == TIM_OK, "tim%u Timer_Get_Achieved", tim_num);
+
+	// Reported against the exact ratio of achieved to requested frequency
+	ppm = exact_ppm((timing == FREQ) ? clk : ((uint64_t)clk * value), achieved.ticks * ((timing == FREQ) ? value : 1000U));
+	CHECK((achieved.error_ppm >= (ppm - 1.0)) && (achieved.error_ppm <= (ppm + 1.0)),
+			"tim%u mode %d %u: error_ppm %d, exact %.2f", tim_num, mode, value, (int)achieved.error_ppm, ppm);
+	CHECK(achieved.freq_mhz == (((uint64_t)clk * 1000U) / achieved.ticks), "tim%u freq_mhz", tim_num);
+
+	// Best possible: half a counter step of the chosen prescaler
+	step = ((uint64_t)regs->PSC + 1) * (is_center(mode) ? 2 : 1);
+	CHECK((ppm <= ((1e6 * step) / (2.0 * achieved.ticks)) + 1.0) && (ppm >= -((1e6 * step) / (2.0 * achieved.ticks)) - 1.0),
+			"tim%u mode %d %u: %.2f ppm off with psc %u arr %u", tim_num, mode, value, ppm, (unsigned)regs->PSC, (unsigned)regs->ARR);
+	if (((ppm < 0) ? -ppm : ppm) > worst_ppm) {
+		worst_ppm = (int32_t)((ppm < 0) ? -ppm : ppm);
+	}
+
+	// The emulated counter must agree with the registers the readback used
+	counts = achieved.ticks / ((uint64_t)regs->PSC + 1);
+	if (counts <= MAX_EMULATED_COUNTS) {
+		restart(regs);
+		regs->CR1 |= TIM_CR1_CEN;
+		CHECK(emulate_period_counts(regs) == counts, "tim%u mode %d %u: emulated period", tim_num, mode, value);
+
+		if (tim.channels.en_ch1 && (counts <= MAX_DUTY_EMULATED_COUNTS)) {
+			check_duty(&tim, counts);
+		}
+	}
+
+	Timer_Stop(&tim);
+}
+
+// The repetition counter spaces update interrupts by it_config, twice as many counter events when center aligned.
+// value is the timer frequency or period, the interrupt comes every ratio timer periods
+static void check_repetition(uint8_t tim_num, Tim_Count_Mode_et mode, Timing_Model_et timing, uint32_t value, uint16_t ratio) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	Tim_Achieved_st achieved;
+	uint64_t counts;
+
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim.htim = &htim;
+	tim.tim_num = tim_num;
+	tim.timing = timing;
+	tim.count_mode = mode;
+	tim.channels.en_ch1 = 1;
+	tim.it_config.en_it = 1;
+	if (timing == FREQ) {
+		tim.freq_hz = value;
+		tim.it_config.freq_hz = (uint16_t)(value / ratio);
+	} else {
+		tim.period_ms = value;
+		tim.it_config.period_ms = value * ratio;
+	}
+	cases++;
+
+	if (Timer_Init(&tim) != TIM_OK) {
+		CHECK(0, "tim%u %u %s it every %u periods", tim_num, value, (timing == FREQ) ? "Hz" : "ms", ratio);
+		return;
+	}
+	CHECK(Timer_Get_Achieved(&tim, &achieved) == TIM_OK, "tim%u Timer_Get_Achieved", tim_num);
+
+	counts = achieved.ticks / ((uint64_t)htim.Instance->PSC + 1);
+	CHECK(emulate_update_counts(htim.Instance) == (counts * ratio),
+			"tim%u mode %d %u %s it every %u periods: interrupt spacing", tim_num, mode, value, (timing == FREQ) ? "Hz" : "ms", ratio);
+	CHECK(achieved.it_freq_mhz == (((uint64_t)Timer_Get_Clock_Freq(&tim) * 1000U) / (achieved.ticks * ratio)),
+			"tim%u it_freq_mhz", tim_num);
+
+	Timer_Stop(&tim);
+}
+
+// Interrupt periods shorter than the timer period or not a multiple of it have no repetition count
+static void check_it_period_rejected(void) {
+	static const uint32_t it_periods_ms[] = { 2, 6, 10 };
+
+	tree = &clock_trees[0];
+	for (uint8_t i = 0; i < (sizeof(it_periods_ms) / sizeof(it_periods_ms[0])); i++) {
+		TIM_HandleTypeDef htim = {0};
+		Timer_st tim = {0};
+		TIM_Ret_et ret;
+
+		Mock_Reset();
+		Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+		tim.htim = &htim;
+		tim.tim_num = 1;
+		tim.timing = PERIOD;
+		tim.period_ms = 4;
+		tim.it_config.en_it = 1;
+		tim.it_config.period_ms = it_periods_ms[i];
+		cases++;
+
+		ret = Timer_Init(&tim);
+		CHECK(ret == TIM_IT_INVALID_PERIOD, "tim1 4 ms it %u ms: returned %d", it_periods_ms[i], ret);
+		if (ret == TIM_OK) {
+			Timer_Stop(&tim);
+		}
+	}
+}
+
+// A failed Timer_Init leaves the timer free for another Timer_st, a running one keeps it
+static void check_owner_release(void) {
+	TIM_HandleTypeDef htim_a = {0};
+	TIM_HandleTypeDef htim_b = {0};
+	Timer_st tim_a = {0};
+	Timer_st tim_b = {0};
+	TIM_Ret_et ret;
+
+	tree = &clock_trees[0];
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim_a.htim = &htim_a;
+	tim_a.tim_num = 2;
+	tim_a.timing = FREQ;
+	tim_a.freq_hz = 0;
+	tim_b = tim_a;
+	tim_b.htim = &htim_b;
+	tim_b.freq_hz = 1000;
+	cases++;
+
+	ret = Timer_Init(&tim_a);
+	CHECK(ret == TIM_FREQ_ZERO, "tim2 0 Hz: returned %d", ret);
+	ret = Timer_Init(&tim_b);
+	CHECK(ret == TIM_OK, "tim2 after a failed init: returned %d", ret);
+
+	// tim_b owns the timer even through a failed re-init
+	tim_b.freq_hz = 0;
+	CHECK(Timer_Init(&tim_b) == TIM_FREQ_ZERO, "tim2 0 Hz re-init");
+	tim_a.freq_hz = 1000;
+	ret = Timer_Init(&tim_a);
+	CHECK(ret == TIM_IN_USE, "tim2 owned by another Timer_st: returned %d", ret);
+
+	Timer_Stop(&tim_b);
+	ret = Timer_Init(&tim_a);
+	CHECK(ret == TIM_OK, "tim2 after Timer_Stop: returned %d", ret);
+	Timer_Stop(&tim_a);
+}
+
+// Interrupts further apart than MAX_REP_COUNTER + 1 timer periods have no repetition count, at init and on a retune
+static void check_repetition_overflow(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	TIM_Ret_et ret;
+
+	tree = &clock_trees[0];
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim.htim = &htim;
+	tim.tim_num = 1;
+	tim.timing = FREQ;
+	tim.freq_hz = 100000;
+	tim.it_config.en_it = 1;
+	tim.it_config.freq_hz = 1;
+	cases++;
+
+	ret = Timer_Init(&tim);
+	CHECK(ret == TIM_RC_OVERFLOW, "tim1 100 kHz it 1 Hz: returned %d", ret);
+
+	// The last repetition count that fits
+	tim.freq_hz = MAX_REP_COUNTER + 1;
+	ret = Timer_Init(&tim);
+	CHECK(ret == TIM_OK, "tim1 %u Hz it 1 Hz: returned %d", MAX_REP_COUNTER + 1, ret);
+	CHECK(htim.Instance->RCR == MAX_REP_COUNTER, "tim1 %u Hz it 1 Hz: RCR %u", MAX_REP_COUNTER + 1, (unsigned)htim.Instance->RCR);
+
+	ret = Timer_Set_Freq(&tim, 100000, COMMIT_NOW);
+	CHECK(ret == TIM_RC_OVERFLOW, "tim1 Timer_Set_Freq 100 kHz it 1 Hz: returned %d", ret);
+	CHECK((htim.Instance->RCR == MAX_REP_COUNTER) && (tim.freq_hz == (MAX_REP_COUNTER + 1)), "tim1 rejected retune loaded");
+
+	Timer_Stop(&tim);
+}
+
+// Retunes a running advanced timer with a slower interrupt back and forth
+static void check_retune(void) {
+	static const uint32_t freqs_hz[] = { 20000, 13000, 10000 };
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwm = {0};
+	Tim_Timing_st timing;
+	Tim_Achieved_st achieved;
+	uint32_t compare;
+	uint32_t arr;
+	TIM_Ret_et ret;
+
+	tree = &clock_trees[0];
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim.htim = &htim;
+	tim.tim_num = 1;
+	tim.timing = FREQ;
+	tim.freq_hz = freqs_hz[0];
+	tim.channels.en_ch1 = 1;
+	tim.it_config.en_it = 1;
+	tim.it_config.freq_hz = 1000;
+	cases++;
+	ret = Timer_Init(&tim);
+	if (ret != TIM_OK) {
+		CHECK(0, "tim1 retune Timer_Init (%d)", ret);
+		return;
+	}
+	pwm.tim = &tim;
+	pwm.chan_num = 1;
+	CHECK(PWM_Init(&pwm) == PWM_OK, "tim1 retune PWM_Init");
+	CHECK(PWM_Set_Duty_HR(&pwm, 12345) == PWM_OK, "tim1 retune PWM_Set_Duty_HR");
+	restart(htim.Instance);
+	compare = htim.Instance->CCR1;
+
+	// The compare comes from duty_hr each time, so it never drifts away from the one PWM_Set_Duty_HR wrote
+	for (uint8_t i = 0; i < 50; i++) {
+		uint32_t freq_hz = freqs_hz[(i % 2) + 1];
+
+		CHECK(Timer_Set_Freq(&tim, freq_hz, COMMIT_NOW) == TIM_OK, "tim1 Timer_Set_Freq %u Hz", freq_hz);
+		CHECK(htim.Instance->RCR == ((freq_hz / 1000) - 1), "tim1 %u Hz: RCR %u", freq_hz, (unsigned)htim.Instance->RCR);
+		CHECK(Timer_Set_Freq(&tim, freqs_hz[0], COMMIT_NOW) == TIM_OK, "tim1 Timer_Set_Freq %u Hz", freqs_hz[0]);
+		restart(htim.Instance);
+		CHECK(htim.Instance->CCR1 == compare, "tim1 retune %u: compare %u, was %u", i, (unsigned)htim.Instance->CCR1, compare);
+	}
+	CHECK(tim.freq_hz == freqs_hz[0], "tim1 freq_hz %u", tim.freq_hz);
+
+	// The interrupt must still divide the new frequency, nothing is loaded otherwise
+	arr = htim.Instance->ARR;
+	CHECK(Timer_Set_Freq(&tim, 1500, COMMIT_NOW) == TIM_IT_INVALID_FREQ, "tim1 1500 Hz with a 1 kHz interrupt");
+	CHECK((htim.Instance->ARR == arr) && (htim.Init.Period == arr) && (tim.freq_hz == freqs_hz[0]), "tim1 rejected retune loaded");
+
+	// A precomputed solution updates the request and the interrupt spacing too
+	CHECK(Timer_Solve_Freq(&tim, freqs_hz[2], 0, &timing) == TIM_OK, "tim1 Timer_Solve_Freq");
+	CHECK(Timer_Set_Timing(&tim, &timing, COMMIT_NOW) == TIM_OK, "tim1 Timer_Set_Timing");
+	CHECK((tim.timing == FREQ) && (tim.freq_hz == freqs_hz[2]), "tim1 Timer_Set_Timing request %u Hz", tim.freq_hz);
+	CHECK(Timer_Get_Achieved(&tim, &achieved) == TIM_OK, "tim1 Timer_Get_Achieved");
+	CHECK(emulate_update_counts(htim.Instance) == ((achieved.ticks / ((uint64_t)htim.Instance->PSC + 1)) * (freqs_hz[2] / 1000)),
+			"tim1 Timer_Set_Timing interrupt spacing");
+
+	PWM_Stop(&pwm);
+	Timer_Stop(&tim);
+}
+
+// Counting periods where rounding the compare scale down is enough to lose a count near 100%, each loaded by
+// Timer_Set_Timing so the scale also follows a retune
+static void check_compare_scale(void) {
+	TIM_HandleTypeDef htim = {0};
+	Timer_st tim = {0};
+	PWM_st pwm = {0};
+
+	tree = &clock_trees[0];
+	Mock_Reset();
+	Mock_Set_Clocks(tree->hclk_hz, tree->apb1_div, tree->apb2_div, tree->timpre);
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = 1000;
+	tim.channels.en_ch1 = 1;
+	cases++;
+	if (Timer_Init(&tim) != TIM_OK) {
+		CHECK(0, "tim3 compare scale Timer_Init");
+		return;
+	}
+	pwm.tim = &tim;
+	pwm.chan_num = 1;
+	CHECK(PWM_Init(&pwm) == PWM_OK, "tim3 compare scale PWM_Init");
+
+	for (uint32_t counts = 33200; counts < 34000; counts++) {
+		uint32_t clk_hz = Timer_Get_Clock_Freq(&tim);
+		Tim_Timing_st timing = { .prescaler = 0, .period = counts - 1, .clk_hz = clk_hz, .timing = FREQ,
+				.value = clk_hz / counts };
+
+		CHECK(Timer_Set_Timing(&tim, &timing, COMMIT_NOW) == TIM_OK, "tim3 Timer_Set_Timing %u counts", counts);
+		for (uint32_t duty_hr = 60000; duty_hr <= PWM_DUTY_HR_MAX; duty_hr++) {
+			uint32_t exact = ((duty_hr * counts) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX;
+
+			PWM_Set_Duty_HR(&pwm, (uint16_t)duty_hr);
+			CHECK(htim.Instance->CCR1 == exact, "tim3 %u counts duty %u: compare %u, want %u", counts, duty_hr,
+					(unsigned)htim.Instance->CCR1, exact);
+		}
+	}
+
+	PWM_Stop(&pwm);
+	Timer_Stop(&tim);
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+	static const uint16_t it_ratios[] = { 1, 2, 5, 10 };
+
+	for (uint8_t c = 0; c < (sizeof(clock_trees) / sizeof(clock_trees[0])); c++) {
+		tree = &clock_trees[c];
+
+		for (uint8_t t = 0; t < sizeof(tim_nums); t++) {
+			const Tim_Capability_st* cap = Timer_Get_Capability(tim_nums[t]);
+
+			for (uint8_t m = 0; m < (sizeof(count_modes) / sizeof(count_modes[0])); m++) {
+				// Only timers 1-5 and 8 count down or center aligned
+				if ((count_modes[m] != COUNT_UP) && ((cap->tim_type == BASIC_TIMER) || (tim_nums[t] > 8))) {
+					continue;
+				}
+
+				for (uint64_t f = 1; f <= 2000000U; f = (f * 2) + (f / 3) + 1) {
+					check_request(tim_nums[t], count_modes[m], FREQ, (uint32_t)f);
+				}
+				for (uint8_t p = 0; p < (sizeof(periods_ms) / sizeof(periods_ms[0])); p++) {
+					check_request(tim_nums[t], count_modes[m], PERIOD, periods_ms[p]);
+				}
+			}
+		}
+	}
+
+	tree = &clock_trees[0];
+	for (uint8_t r = 0; r < (sizeof(it_ratios) / sizeof(it_ratios[0])); r++) {
+		check_repetition(1, COUNT_UP, FREQ, MAX_IT_FREQ, it_ratios[r]);
+		check_repetition(8, COUNT_CENTER_ALIGNED_1, FREQ, MAX_IT_FREQ, it_ratios[r]);
+		check_repetition(1, COUNT_CENTER_ALIGNED_3, FREQ, 500, it_ratios[r]);
+		check_repetition(1, COUNT_UP, PERIOD, 2, it_ratios[r]);
+		check_repetition(8, COUNT_CENTER_ALIGNED_1, PERIOD, 3, it_ratios[r]);
+	}
+	check_it_period_rejected();
+	check_repetition_overflow();
+	check_owner_release();
+	check_retune();
+	check_compare_scale();
+
+	printf("test_timing: %u cases, %u failures, worst error %d ppm, mean Timer_Init %llu ns\n", cases, failures,
+			(int)worst_ppm, (unsigned long long)(init_ns / num_inits));
+	CHECK((init_ns / num_inits) <= BENCH_MAX_INIT_NS, "mean Timer_Init above %u ns", BENCH_MAX_INIT_NS);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
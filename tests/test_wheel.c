@@ -0,0 +1,348 @@
+/*
+ * test_wheel.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *	Timer wheel on the emulated 16 bit TIM3 at 1 MHz, the counter wrapping every 65536 ticks.
+ *
+ *	The counter is stepped one tick at a time and the compare interrupt is delivered after a random latency. Every
+ *	event keeps the tick it is due at, and each callback checks it runs for that tick, at most the latency late.
+ *	Checks:
+ *		- one-shot events on both sides of every level boundary, longer than the counter range and than the wheel span
+ *		- periodic events from every tick to many counter periods, without drift
+ *		- cancels from callbacks: another event due on the same tick, one pending on a higher level, a periodic
+ *		  event cancelling itself, and events re-added from their callback
+ *		- a random mix of adds, reschedules and cancels from the thread
+ *		- lone events of whole counter ranges and an idle wheel keep the time over the wraps
+ *		- the wheel time follows the counter and nothing is left overdue
+*/
+
+/*----------INCLUDES----------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_mock.h"
+#include "timer_wheel.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define TICK_HZ					(1000000U)
+// Ticks between the compare flag and its interrupt, at most
+#define MAX_LATENCY				(50U)
+// How late a callback may run: the latency, and the tick a compare event raised through EGR waits for
+#define MAX_LATE				(MAX_LATENCY + 2U)
+#define NOT_DUE					(UINT64_MAX)
+#define MAX_EVENTS				(64U)
+#define NUM_RANDOM_ACTIONS		(400U)
+// Ticks between two checks of Timer_Wheel_Now
+#define NOW_CHECK_TICKS			(997U)
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			failures++; \
+			if (failures <= 20) { \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while(0)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// One wheel event and what the test expects of it
+typedef struct test_event_st {
+	Timer_Wheel_Event_st ev;
+	// Tick the event is due at, NOT_DUE while it is not pending
+	uint64_t due;
+	uint32_t fires;
+	// Cancelled by the first expiry of this event
+	struct test_event_st* cancel;
+	// Periodic events cancel themselves after this many expiries (0 never)
+	uint32_t stop_after;
+	// Re-added from the callback with chain_delay, chain_count times
+	uint32_t chain_delay;
+	uint32_t chain_count;
+}test_event_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static uint32_t failures;
+
+static TIM_HandleTypeDef htim;
+static Timer_st tim;
+static Timer_Wheel_st wheel;
+static test_event_st events[MAX_EVENTS];
+
+// Ticks counted since Timer_Wheel_Start, and the interrupt latency left (-1 when nothing is pending)
+static uint64_t sim_now;
+static int32_t irq_wait;
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+static uint32_t index_of(const test_event_st* e) {
+	return (uint32_t)(e - events);
+}
+
+// Timer_Wheel_Callback_ft of every event
+static void on_expire(void* context) {
+	test_event_st* e = (test_event_st*)context;
+	uint64_t now = Timer_Wheel_Now(&wheel);
+
+	CHECK(e->due != NOT_DUE, "event %u expired at %llu while not pending", index_of(e), (unsigned long long)now);
+	CHECK((e->due == NOT_DUE) || (now == e->due), "event %u expired at %llu, due at %llu", index_of(e),
+			(unsigned long long)now, (unsigned long long)e->due);
+	CHECK((sim_now >= now) && ((sim_now - now) <= MAX_LATE), "event %u due at %llu ran at %llu", index_of(e),
+			(unsigned long long)now, (unsigned long long)sim_now);
+
+	e->fires++;
+	e->due = (e->ev.period_ticks != 0) ? (now + e->ev.period_ticks) : NOT_DUE;
+
+	if (e->cancel != NULL) {
+		Timer_Wheel_Cancel(&wheel, &e->cancel->ev);
+		e->cancel->due = NOT_DUE;
+		e->cancel = NULL;
+	}
+	if ((e->stop_after != 0) && (e->fires == e->stop_after)) {
+		Timer_Wheel_Cancel(&wheel, &e->ev);
+		e->due = NOT_DUE;
+	}
+	if (e->chain_count != 0) {
+		e->chain_count--;
+		Timer_Wheel_Add(&wheel, &e->ev, e->chain_delay);
+		e->due = now + e->chain_delay;
+	}
+}
+
+// Delivers the compare interrupt after its latency, as HAL_TIM_IRQHandler does
+static void poll_irq(void) {
+	TIM_TypeDef* regs = htim.Instance;
+
+	if (!(regs->SR & regs->DIER & TIM_SR_CC1IF)) {
+		return;
+	}
+	if (irq_wait < 0) {
+		irq_wait = rand() % (MAX_LATENCY + 1);
+	}
+	if (irq_wait > 0) {
+		irq_wait--;
+		return;
+	}
+
+	irq_wait = -1;
+	__HAL_TIM_CLEAR_FLAG(&htim, TIM_FLAG_CC1);
+	htim.Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+	Timer_Wheel_Callback(&wheel, &htim);
+	htim.Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+}
+
+// Counts the timer, checking the wheel time from the thread now and then
+static void run(uint64_t ticks) {
+	for (uint64_t i = 0; i < ticks; i++) {
+		Mock_Tim_Count(htim.Instance);
+		sim_now++;
+		poll_irq();
+
+		if ((sim_now % NOW_CHECK_TICKS) == 0) {
+			uint64_t now = Timer_Wheel_Now(&wheel);
+
+			CHECK(now == sim_now, "wheel time %llu at tick %llu", (unsigned long long)now, (unsigned long long)sim_now);
+		}
+	}
+}
+
+// Adds or reschedules an event from the thread
+static void add(test_event_st* e, uint32_t delay_ticks, uint32_t period_ticks) {
+	if (!Timer_Wheel_Is_Pending(&e->ev)) {
+		e->ev.callback = on_expire;
+		e->ev.context = e;
+	}
+	e->ev.period_ticks = period_ticks;
+	Timer_Wheel_Add(&wheel, &e->ev, delay_ticks);
+	e->due = sim_now + ((delay_ticks == 0) ? 1 : delay_ticks);
+}
+
+static void init_wheel(void) {
+	Mock_Reset();
+	srand(1);
+	htim = (TIM_HandleTypeDef){0};
+	tim = (Timer_st){0};
+	tim.htim = &htim;
+	tim.tim_num = 3;
+	tim.timing = FREQ;
+	tim.freq_hz = 1000;
+	CHECK(Timer_Init(&tim) == TIM_OK, "Timer_Init");
+
+	wheel = (Timer_Wheel_st){ .tim = &tim, .chan_num = 1, .tick_hz = TICK_HZ };
+	CHECK(Timer_Wheel_Init(&wheel) == TIM_OK, "Timer_Wheel_Init");
+	CHECK(wheel.__tick_hz == TICK_HZ, "tick rate %u Hz", wheel.__tick_hz);
+	CHECK(htim.Instance->ARR == 0xFFFF, "counter range %u", (unsigned)htim.Instance->ARR + 1);
+
+	for (uint32_t i = 0; i < MAX_EVENTS; i++) {
+		events[i] = (test_event_st){ .due = NOT_DUE };
+	}
+	sim_now = 0;
+	irq_wait = -1;
+	CHECK(Timer_Wheel_Start(&wheel) == TIM_OK, "Timer_Wheel_Start");
+}
+
+// Nothing pending is overdue and the wheel agrees on what is pending
+static void check_nothing_missed(const char* name) {
+	for (uint32_t i = 0; i < MAX_EVENTS; i++) {
+		test_event_st* e = &events[i];
+
+		CHECK((e->due == NOT_DUE) || (e->due + MAX_LATE >= sim_now), "%s: event %u due at %llu missed, now %llu", name,
+				i, (unsigned long long)e->due, (unsigned long long)sim_now);
+		CHECK(Timer_Wheel_Is_Pending(&e->ev) == (e->due != NOT_DUE), "%s: event %u pending %u", name, i,
+				Timer_Wheel_Is_Pending(&e->ev));
+	}
+}
+
+static void stop_wheel(void) {
+	for (uint32_t i = 0; i < MAX_EVENTS; i++) {
+		Timer_Wheel_Cancel(&wheel, &events[i].ev);
+	}
+	CHECK(Timer_Wheel_Stop(&wheel) == TIM_OK, "Timer_Wheel_Stop");
+	Timer_Stop(&tim);
+}
+
+// Events on both sides of the level boundaries (64, 4096 and 262144 ticks), past the counter range and the wheel span
+static void check_levels(void) {
+	static const uint32_t delays[] = {
+		1, 2, 63, 64, 65, 4095, 4096, 4097, 65535, 65536, 262143, 262144, 262145, 300001, 5000000,
+		(1U << 24) - 1, (1U << 24), (1U << 24) + 1000
+	};
+	static const uint32_t periods[] = { 1, 64, 4099, 100000 };
+	const uint32_t num_delays = sizeof(delays) / sizeof(delays[0]);
+	const uint32_t num_periods = sizeof(periods) / sizeof(periods[0]);
+	test_event_st* periodic = &events[num_delays];
+	test_event_st* cancels = &events[num_delays + num_periods];
+	test_event_st* last = &cancels[6];
+
+	init_wheel();
+	// Away from tick 0 so the slots are not aligned to the start
+	run(12345);
+
+	for (uint32_t i = 0; i < num_delays; i++) {
+		add(&events[i], delays[i], 0);
+	}
+	for (uint32_t i = 0; i < num_periods; i++) {
+		add(&periodic[i], periods[i], periods[i]);
+	}
+	// Every tick for a while only
+	periodic[0].stop_after = 1000;
+
+	// cancels[1] fires first on the same tick (added last, head of the slot) and cancels cancels[0]
+	add(&cancels[0], 5000, 0);
+	cancels[1].cancel = &cancels[0];
+	add(&cancels[1], 5000, 0);
+	// Cancels an event waiting on level 2
+	cancels[2].cancel = &cancels[3];
+	add(&cancels[2], 6000, 0);
+	add(&cancels[3], 200000, 0);
+	// Periodic event cancelling itself, an event re-added from its callback
+	cancels[4].stop_after = 5;
+	add(&cancels[4], 777, 777);
+	cancels[5].chain_delay = 333;
+	cancels[5].chain_count = 10;
+	add(&cancels[5], 50, 0);
+	// Cancelled from the thread before it is due
+	add(&cancels[6], 70000, 0);
+	run(1000);
+	Timer_Wheel_Cancel(&wheel, &cancels[6].ev);
+	cancels[6].due = NOT_DUE;
+
+	run(delays[num_delays - 1] + MAX_LATE);
+
+	for (uint32_t i = 0; i < num_delays; i++) {
+		CHECK(events[i].fires == 1, "delay %u: %u expiries", delays[i], events[i].fires);
+	}
+	CHECK(periodic[0].fires == 1000, "period 1: %u expiries", periodic[0].fires);
+	for (uint32_t i = 1; i < num_periods; i++) {
+		uint64_t want = (sim_now - 12345) / periods[i];
+
+		CHECK((periodic[i].fires == want) || (periodic[i].fires + 1 == want), "period %u: %u expiries, want %llu",
+				periods[i], periodic[i].fires, (unsigned long long)want);
+	}
+	CHECK((cancels[0].fires == 0) && (cancels[1].fires == 1), "same tick cancel: %u and %u expiries", cancels[0].fires,
+			cancels[1].fires);
+	CHECK(cancels[3].fires == 0, "level 2 event expired after its cancel");
+	CHECK(cancels[4].fires == 5, "self cancelling periodic: %u expiries", cancels[4].fires);
+	CHECK(cancels[5].fires == 11, "re-added event: %u expiries", cancels[5].fires);
+	CHECK(last->fires == 0, "event cancelled from the thread expired");
+	check_nothing_missed("levels");
+
+	stop_wheel();
+}
+
+// One event at a time, nothing else to wake the wheel: deadlines of whole counter ranges and an idle wheel must not
+// lose any wrap of the counter
+static void check_wraps(void) {
+	static const uint32_t delays[] = { 32767, 32768, 32769, 65535, 65536, 65537, 3 * 65536, 10 * 65536 + 7 };
+
+	init_wheel();
+
+	for (uint32_t i = 0; i < (sizeof(delays) / sizeof(delays[0])); i++) {
+		add(&events[i], delays[i], 0);
+		run(delays[i] + MAX_LATE);
+		CHECK(events[i].fires == 1, "alone %u ticks: %u expiries", delays[i], events[i].fires);
+
+		// Idle for a few counter periods
+		run(3 * 65536 + 11);
+	}
+	check_nothing_missed("wraps");
+
+	stop_wheel();
+}
+
+// Random delay spread over every level: log uniform from 1 to 2^22 ticks
+static uint32_t random_delay(void) {
+	uint32_t bits = (uint32_t)(rand() % 23);
+
+	return 1U + (uint32_t)(rand() % (1 << bits));
+}
+
+// Random adds, reschedules and cancels from the thread at random times, some events cancelling others
+static void check_random(void) {
+	init_wheel();
+
+	for (uint32_t action = 0; action < NUM_RANDOM_ACTIONS; action++) {
+		test_event_st* e = &events[rand() % MAX_EVENTS];
+
+		run(1 + (rand() % 20000));
+
+		if (Timer_Wheel_Is_Pending(&e->ev) && ((rand() % 4) == 0)) {
+			Timer_Wheel_Cancel(&wheel, &e->ev);
+			e->due = NOT_DUE;
+			continue;
+		}
+
+		e->stop_after = 0;
+		e->cancel = ((rand() % 8) == 0) ? &events[rand() % MAX_EVENTS] : NULL;
+		if (e->cancel == e) {
+			e->cancel = NULL;
+		}
+		// Periods of at least 16 ticks, one event in five
+		add(e, random_delay(), ((rand() % 5) == 0) ? (16U + (uint32_t)(rand() % (1 << (rand() % 18)))) : 0);
+	}
+
+	run(MAX_LATE);
+	check_nothing_missed("random");
+
+	stop_wheel();
+}
+
+/*----------MAIN----------*/
+
+int main(void) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	check_levels();
+	check_wraps();
+	check_random();
+
+	printf("test_wheel: %u failures\n", failures);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
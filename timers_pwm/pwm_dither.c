@@ -0,0 +1,351 @@
+/*
+ * pwm_dither.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Duty dithering and spread spectrum pwm.
+ *
+ *	Dithering keeps the ideal compare value in Q16 counts. Every period the fraction is added to an accumulator and
+ *	the carry bumps the compare value by one count, so over 2^n periods the average duty is exact to n fractional
+ *	bits while each period only ever uses one of the two neighbouring compare values.
+ *	Spread spectrum moves ARR around its nominal value every period (triangle sweep or pseudo random) and rescales
+ *	the compare values with it, spreading the switching harmonics over a band at the same average frequency and duty.
+ *
+ *	Both either precompute a circular buffer that the update DMA streams into the preload registers (no CPU after
+ *	the start) or compute the next period from the update interrupt with a few adds.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "pwm_dither.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define DITHER_Q				(16U)
+#define DITHER_FRAC_MASK		((1UL << DITHER_Q) - 1)
+#define SPREAD_HALF				(1LL << (DITHER_Q - 1))
+#define SPREAD_LFSR_SEED		(0xACE1U)
+// Taps of a maximal length 16 bit Galois LFSR (x^16 + x^14 + x^13 + x^11 + 1)
+#define SPREAD_LFSR_TAPS		(0xB400U)
+#define PERMILLE				(1000U)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const uint32_t burst_len[6] = { TIM_DMABURSTLENGTH_1TRANSFER, TIM_DMABURSTLENGTH_2TRANSFERS,
+		TIM_DMABURSTLENGTH_3TRANSFERS, TIM_DMABURSTLENGTH_4TRANSFERS, TIM_DMABURSTLENGTH_5TRANSFERS,
+		TIM_DMABURSTLENGTH_6TRANSFERS };
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Duty actually output by the compare register, taking inversion into account
+static uint16_t output_duty(PWM_st* pwm, uint16_t duty_hr) {
+	return pwm->is_inverted ? (uint16_t)(PWM_DUTY_HR_MAX - duty_hr) : duty_hr;
+}
+
+// Compare value rounded to the nearest count for a period of counts
+static uint32_t compare_for(PWM_st* pwm, uint64_t counts) {
+	return (uint32_t)(((counts * output_duty(pwm, pwm->duty_hr)) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+}
+
+// Compare value of the next period: the integer part plus the sigma-delta carry
+static uint32_t dither_next(PWM_Dither_st* dither) {
+	uint32_t carry;
+
+	dither->__acc += (uint32_t)(dither->__compare_q16 & DITHER_FRAC_MASK);
+	carry = dither->__acc >> DITHER_Q;
+	dither->__acc &= DITHER_FRAC_MASK;
+
+	return (uint32_t)(dither->__compare_q16 >> DITHER_Q) + carry;
+}
+
+// The dither state is shared with the update interrupt, mask it while it changes
+static void dither_lock(PWM_Dither_st* dither) {
+	__HAL_TIM_DISABLE_IT(dither->pwm->tim->htim, TIM_IT_UPDATE);
+}
+
+static void dither_unlock(PWM_Dither_st* dither) {
+	__HAL_TIM_ENABLE_IT(dither->pwm->tim->htim, TIM_IT_UPDATE);
+}
+
+// ARR of the next period
+static uint32_t spread_next(PWM_Spread_st* spread) {
+	int64_t edge = (int64_t)spread->__dev << DITHER_Q;
+	int64_t offset;
+
+	if (spread->profile == SPREAD_RANDOM) {
+		uint16_t lsb = spread->__lfsr & 1U;
+
+		spread->__lfsr >>= 1;
+		if (lsb) {
+			spread->__lfsr ^= SPREAD_LFSR_TAPS;
+		}
+		// Scale the 16 bit state to 0 - 2 * dev
+		return spread->__arr - spread->__dev + (uint32_t)(((uint64_t)spread->__lfsr * ((2 * (uint64_t)spread->__dev) + 1)) >> 16);
+	}
+
+	// Triangle, reflect at the edges of the band
+	spread->__offset_q16 += spread->__step_q16;
+	if (spread->__offset_q16 > edge) {
+		spread->__offset_q16 = (2 * edge) - spread->__offset_q16;
+		spread->__step_q16 = -spread->__step_q16;
+	}
+	else if (spread->__offset_q16 < -edge) {
+		spread->__offset_q16 = (-2 * edge) - spread->__offset_q16;
+		spread->__step_q16 = -spread->__step_q16;
+	}
+
+	offset = (spread->__offset_q16 >= 0) ? ((spread->__offset_q16 + SPREAD_HALF) >> DITHER_Q) :
+			-((-spread->__offset_q16 + SPREAD_HALF) >> DITHER_Q);
+
+	return (uint32_t)((int64_t)spread->__arr + offset);
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// PWM_Dither_Init starts dithering the pwm at its current duty. Without a buffer the timer must be initialized with
+// it_config.en_it set and PWM_Dither_Callback registered on it (Timer_Register_Callback)
+PWM_Ret_et PWM_Dither_Init(PWM_Dither_st* dither) {
+	PWM_st* pwm = dither->pwm;
+
+	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	// Counting down the compare needs one count off (PWM_Set_Duty_HR), which the dithered values do not take
+	if (pwm->tim->count_mode == COUNT_DOWN) { return PWM_DITHER_INVALID; }
+	if ((pwm->chan_num == 0) || (pwm->chan_num > pwm->tim->__metadata.num_channels)) { return PWM_INVALID_CH_NUM; }
+	if ((dither->buffer != NULL) && (dither->buffer_len == 0)) { return PWM_INVALID_LEN; }
+	if ((dither->buffer == NULL) && !pwm->tim->it_config.en_it) { return PWM_DITHER_INVALID; }
+
+	dither->__acc = 0;
+	dither->__running = 0;
+
+	return PWM_Dither_Set_Duty_HR(dither, pwm->duty_hr);
+}
+
+// PWM_Dither_Set_Duty_HR sets the average duty. In DMA mode the buffer is refilled in place, so for at most one
+// pass of the buffer the periods mix the old and new duty
+PWM_Ret_et PWM_Dither_Set_Duty_HR(PWM_Dither_st* dither, uint16_t duty_hr) {
+	PWM_st* pwm = dither->pwm;
+	uint64_t product = PWM_Get_Duty_Counts(pwm->tim) * output_duty(pwm, duty_hr);
+	// Split so the Q16 shift cannot overflow on 32 bit counters
+	uint64_t compare_q16 = ((product / PWM_DUTY_HR_MAX) << DITHER_Q) +
+			((((product % PWM_DUTY_HR_MAX) << DITHER_Q) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+	PWM_Ret_et ret;
+
+	pwm->duty_hr = duty_hr;
+	pwm->duty = (uint8_t)((((uint32_t)duty_hr * MAX_DUTY_CYCLE) + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+
+	if (dither->buffer == NULL) {
+		dither_lock(dither);
+		dither->__compare_q16 = compare_q16;
+		dither->__running = 1;
+		dither_unlock(dither);
+
+		return PWM_OK;
+	}
+
+	dither->__compare_q16 = compare_q16;
+	dither->__acc = 0;
+	for (uint16_t i = 0; i < dither->buffer_len; i++) {
+		dither->buffer[i] = dither_next(dither);
+	}
+
+	if (!dither->__running) {
+		ret = PWM_Waveform_Start(pwm, dither->buffer, dither->buffer_len, WAVEFORM_CIRCULAR);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+		dither->__running = 1;
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Dither_Tick loads the compare value of the next period. Called from the update interrupt of the pwm's timer
+void PWM_Dither_Tick(PWM_Dither_st* dither, TIM_HandleTypeDef* htim) {
+	if ((htim != dither->pwm->tim->htim) || !dither->__running || (dither->buffer != NULL)) {
+		return;
+	}
+
+	__HAL_TIM_SET_COMPARE(htim, TIM_HAL_CHANNEL(dither->pwm->chan_num), dither_next(dither));
+}
+
+// PWM_Dither_Callback is PWM_Dither_Tick as a Timer_Callback_ft, context is the PWM_Dither_st
+void PWM_Dither_Callback(Timer_st* tim, void* context) {
+	PWM_Dither_Tick((PWM_Dither_st*)context, tim->htim);
+}
+
+// PWM_Dither_Stop stops dithering and leaves the pwm at the nearest whole compare value
+PWM_Ret_et PWM_Dither_Stop(PWM_Dither_st* dither) {
+	PWM_Ret_et ret;
+
+	if (dither->__running && (dither->buffer != NULL)) {
+		ret = PWM_Waveform_Stop(dither->pwm->tim);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+	dither->__running = 0;
+
+	return PWM_Set_Duty_HR(dither->pwm, dither->pwm->duty_hr);
+}
+
+// PWM_Spread_Init checks the band and switches the timer to preloaded auto-reload. The period stays nominal until
+// PWM_Spread_Start
+PWM_Ret_et PWM_Spread_Init(PWM_Spread_st* spread) {
+	Timer_st* tim = spread->tim;
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+	uint64_t max_arr;
+	uint64_t counts;
+	uint8_t max_chan = 0;
+
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	if (tim->count_mode == COUNT_DOWN) { return PWM_DITHER_INVALID; }
+	if ((spread->band_permille == 0) || (spread->band_permille >= PERMILLE)) { return PWM_DITHER_INVALID; }
+	if ((spread->profile == SPREAD_TRIANGLE) && (spread->mod_periods < 2)) { return PWM_DITHER_INVALID; }
+	if ((spread->profile != SPREAD_TRIANGLE) && (spread->profile != SPREAD_RANDOM)) { return PWM_DITHER_INVALID; }
+	if ((spread->buffer != NULL) && (spread->buffer_periods == 0)) { return PWM_INVALID_LEN; }
+	if ((spread->buffer == NULL) && !tim->it_config.en_it) { return PWM_DITHER_INVALID; }
+
+	for (uint8_t i = 0; i < spread->num_pwms; i++) {
+		if (spread->pwms[i]->tim != tim) { return PWM_TIM_MISMATCH; }
+		if ((spread->pwms[i]->chan_num == 0) || (spread->pwms[i]->chan_num > tim->__metadata.num_channels)) { return PWM_INVALID_CH_NUM; }
+		if (spread->pwms[i]->chan_num > max_chan) {
+			max_chan = spread->pwms[i]->chan_num;
+		}
+	}
+
+	// The whole buffer is one DMA transfer
+	if ((spread->buffer != NULL) && (((uint32_t)spread->buffer_periods * PWM_SPREAD_WORDS_PER_PERIOD(max_chan)) > MAX_DMA_TRANSFERS)) {
+		return PWM_INVALID_LEN;
+	}
+
+	spread->__arr = tim->htim->Init.Period;
+	counts = PWM_Get_Duty_Counts(tim);
+	spread->__count_extra = (uint8_t)(counts - spread->__arr);
+	spread->__dev = (uint32_t)((counts * spread->band_permille) / PERMILLE);
+
+	// The band has to fit between the minimum counting period and the counter width
+	max_arr = (cap->counter_bits == 32) ? (MAX_COUNTING_PERIOD_32BIT - 1) : (MAX_COUNTING_PERIOD_16BIT - 1);
+	if ((spread->__dev == 0) ||
+		((counts - spread->__dev) < MIN_COUNTING_PERIOD) ||
+		(((uint64_t)spread->__arr + spread->__dev) > max_arr)) {
+		return PWM_DITHER_INVALID;
+	}
+
+	// Full band twice per modulation cycle
+	spread->__offset_q16 = 0;
+	spread->__step_q16 = (spread->profile == SPREAD_TRIANGLE) ? ((((int64_t)spread->__dev << DITHER_Q) * 4) / spread->mod_periods) : 0;
+	spread->__lfsr = SPREAD_LFSR_SEED;
+	spread->__words = (uint8_t)PWM_SPREAD_WORDS_PER_PERIOD(max_chan);
+	spread->__running = 0;
+
+	// A shorter period must not strand the counter past ARR
+	tim->htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+	tim->htim->Instance->CR1 |= TIM_CR1_ARPE;
+
+	return PWM_OK;
+}
+
+// PWM_Spread_Fill computes the next buffer_periods periods into the DMA buffer. Call it again after changing the
+// duty of a pwm, the buffer is refilled in place while it streams
+PWM_Ret_et PWM_Spread_Fill(PWM_Spread_st* spread) {
+	TIM_TypeDef* regs = spread->tim->htim->Instance;
+
+	if (spread->buffer == NULL) { return PWM_INVALID_LEN; }
+
+	for (uint16_t p = 0; p < spread->buffer_periods; p++) {
+		uint32_t* words = &spread->buffer[(uint32_t)p * spread->__words];
+		uint32_t arr = spread_next(spread);
+
+		// ARR, RCR (ignored by timers without one), then CCR1 onwards
+		words[0] = arr;
+		words[1] = regs->RCR;
+		for (uint8_t c = 1; c <= (spread->__words - 2); c++) {
+			words[1 + c] = __HAL_TIM_GET_COMPARE(spread->tim->htim, TIM_HAL_CHANNEL(c));
+		}
+		for (uint8_t i = 0; i < spread->num_pwms; i++) {
+			words[1 + spread->pwms[i]->chan_num] = compare_for(spread->pwms[i], (uint64_t)arr + spread->__count_extra);
+		}
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Spread_Start starts the modulation. In DMA mode the update DMA then writes ARR and the compare values every
+// period, otherwise PWM_Spread_Callback must be registered on spread->tim (Timer_Register_Callback)
+PWM_Ret_et PWM_Spread_Start(PWM_Spread_st* spread) {
+	TIM_HandleTypeDef* htim = spread->tim->htim;
+	DMA_HandleTypeDef* hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+
+	if (spread->__running) {
+		return PWM_OK;
+	}
+
+	if (spread->buffer == NULL) {
+		spread->__running = 1;
+		return PWM_OK;
+	}
+
+	if (hdma == NULL) { return PWM_NO_DMA; }
+
+	PWM_Spread_Fill(spread);
+
+	if (hdma->Init.Mode != DMA_CIRCULAR) {
+		hdma->Init.Mode = DMA_CIRCULAR;
+		if (HAL_DMA_Init(hdma) != HAL_OK) { return PWM_DMA_START_FAIL; }
+	}
+
+	if (HAL_TIM_DMABurst_MultiWriteStart(htim, TIM_DMABASE_ARR, TIM_DMA_UPDATE, spread->buffer,
+			burst_len[spread->__words - 1], (uint32_t)spread->buffer_periods * spread->__words) != HAL_OK) {
+		return PWM_DMA_START_FAIL;
+	}
+	spread->__running = 1;
+
+	return PWM_OK;
+}
+
+// PWM_Spread_Tick loads the period and compare values of the next period. Called from the update interrupt of spread->tim
+void PWM_Spread_Tick(PWM_Spread_st* spread, TIM_HandleTypeDef* htim) {
+	uint32_t arr;
+
+	if ((htim != spread->tim->htim) || !spread->__running || (spread->buffer != NULL)) {
+		return;
+	}
+
+	arr = spread_next(spread);
+
+	// Written to the register only, Init.Period keeps the nominal period for the rest of the library
+	htim->Instance->ARR = arr;
+	for (uint8_t i = 0; i < spread->num_pwms; i++) {
+		PWM_st* pwm = spread->pwms[i];
+
+		__HAL_TIM_SET_COMPARE(htim, TIM_HAL_CHANNEL(pwm->chan_num), compare_for(pwm, (uint64_t)arr + spread->__count_extra));
+	}
+}
+
+// PWM_Spread_Callback is PWM_Spread_Tick as a Timer_Callback_ft, context is the PWM_Spread_st
+void PWM_Spread_Callback(Timer_st* tim, void* context) {
+	PWM_Spread_Tick((PWM_Spread_st*)context, tim->htim);
+}
+
+// PWM_Spread_Stop returns the timer to its nominal period and the pwms to their duty
+PWM_Ret_et PWM_Spread_Stop(PWM_Spread_st* spread) {
+	PWM_Ret_et ret;
+
+	if (spread->__running && (spread->buffer != NULL)) {
+		ret = PWM_Waveform_Stop(spread->tim);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+	spread->__running = 0;
+
+	spread->tim->htim->Instance->ARR = spread->__arr;
+	for (uint8_t i = 0; i < spread->num_pwms; i++) {
+		ret = PWM_Set_Duty_HR(spread->pwms[i], spread->pwms[i]->duty_hr);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+
+	return PWM_OK;
+}
@@ -0,0 +1,94 @@
+/*
+ * pwm_dither.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_PWM_DITHER_H_
+#define INC_PWM_DITHER_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------MACROS & DEFINES------------*/
+
+// Words per period in a spread spectrum DMA buffer: ARR, RCR and the compare values up to the highest channel
+#define PWM_SPREAD_WORDS_PER_PERIOD(MAX_CHAN)	(2U + (MAX_CHAN))
+
+/*----------TYPEDEFS----------*/
+
+// PWM_Dither_st moves the compare value of a pwm by one count from period to period (first order sigma-delta) so
+// the average duty has 16 fractional bits below the timer's count resolution
+typedef struct {
+	// PWM being dithered. Must be running (PWM_Init) on a timer counting up or center aligned
+	PWM_st* pwm;
+	// Optional circular buffer of compare values streamed by the update DMA, one per period. NULL runs the dither
+	// from the update interrupt (PWM_Dither_Callback) instead
+	uint32_t* buffer;
+	// Number of periods in the buffer. A power of two makes the average exact
+	uint16_t buffer_len;
+	// DO NOT WRITE. Compare value in Q16 counts and the sigma-delta accumulator
+	uint64_t __compare_q16;
+	uint32_t __acc;
+	// DO NOT WRITE. Set between PWM_Dither_Init and PWM_Dither_Stop
+	uint8_t __running;
+}PWM_Dither_st;
+
+// How the switching period moves within the spread band
+typedef enum {
+	// Sweeps linearly from one edge of the band to the other and back
+	SPREAD_TRIANGLE = 1,
+	// Pseudo random period every cycle, uniformly distributed over the band
+	SPREAD_RANDOM,
+}PWM_Spread_Profile_et;
+
+// PWM_Spread_st modulates the auto-reload value of a timer every period so the switching noise spreads over a band
+// instead of one frequency. The compare values of the listed pwms are rescaled each period to keep their duty
+typedef struct {
+	// Timer being modulated. Must be initialized (Timer_Init), counting up or center aligned
+	Timer_st* tim;
+	// PWMs on tim whose duty is kept
+	PWM_st** pwms;
+	// Number of pwms in the array
+	uint8_t num_pwms;
+	// Shape of the modulation
+	PWM_Spread_Profile_et profile;
+	// Peak deviation of the period from nominal in tenths of a percent (e.g. 50 spreads over +-5%)
+	uint16_t band_permille;
+	// Triangle only: pwm periods in one modulation cycle
+	uint16_t mod_periods;
+	// Optional circular DMA buffer of PWM_SPREAD_WORDS_PER_PERIOD(highest channel) words per period. NULL runs the
+	// modulation from the update interrupt (PWM_Spread_Callback) instead
+	uint32_t* buffer;
+	// Number of periods in the buffer, at most MAX_DMA_TRANSFERS words in total
+	uint16_t buffer_periods;
+	// DO NOT WRITE. Nominal ARR, peak deviation in counts and counts added to ARR to get the duty counts
+	uint32_t __arr;
+	uint32_t __dev;
+	uint8_t __count_extra;
+	// DO NOT WRITE. Triangle position and slope in Q16 counts, random generator state
+	int64_t __offset_q16;
+	int64_t __step_q16;
+	uint16_t __lfsr;
+	// DO NOT WRITE. Words per period in the buffer, set between PWM_Spread_Start and PWM_Spread_Stop
+	uint8_t __words;
+	uint8_t __running;
+}PWM_Spread_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+PWM_Ret_et PWM_Dither_Init(PWM_Dither_st* dither);
+PWM_Ret_et PWM_Dither_Set_Duty_HR(PWM_Dither_st* dither, uint16_t duty_hr);
+void PWM_Dither_Tick(PWM_Dither_st* dither, TIM_HandleTypeDef* htim);
+void PWM_Dither_Callback(Timer_st* tim, void* context);
+PWM_Ret_et PWM_Dither_Stop(PWM_Dither_st* dither);
+PWM_Ret_et PWM_Spread_Init(PWM_Spread_st* spread);
+PWM_Ret_et PWM_Spread_Start(PWM_Spread_st* spread);
+PWM_Ret_et PWM_Spread_Fill(PWM_Spread_st* spread);
+void PWM_Spread_Tick(PWM_Spread_st* spread, TIM_HandleTypeDef* htim);
+void PWM_Spread_Callback(Timer_st* tim, void* context);
+PWM_Ret_et PWM_Spread_Stop(PWM_Spread_st* spread);
+
+#endif /* INC_PWM_DITHER_H_ */
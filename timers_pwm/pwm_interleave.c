@@ -0,0 +1,182 @@
+/*
+ * pwm_interleave.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Phase shifted (interleaved) pwm for multi-phase converters.
+ *
+ *	Phase k sits at position k * P / N of the pwm period P (ARR + 1 counts counting up, 2 * ARR center aligned).
+ *	Across timers the shift comes from the counter: every timer is chained to the timer of phase 0 in trigger mode
+ *	and starts from its own count, so the offsets are fixed in hardware and never drift.
+ *	Within one center aligned timer a second phase half a period away comes from pwm mode 2, whose pulse is centered
+ *	on the top of the count instead of the bottom. That channel's is_inverted is flipped so the compare values
+ *	written by PWM_Set_Duty still give the requested duty.
+ *	Both offsets anchor the pulse centers (or rising edges counting up), so changing a duty never moves a phase.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "pwm_interleave.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NO_TIMER				(0xFFU)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Index of a timer in the group (0 for the timer of phase 0, slave index + 1 for the others) or NO_TIMER
+static uint8_t find_timer(PWM_Interleave_st* il, Timer_st* tim) {
+	if (tim == il->phases[0]->tim) {
+		return 0;
+	}
+
+	for (uint8_t i = 0; i < il->__group.num_slaves; i++) {
+		if (il->__slaves[i] == tim) {
+			return i + 1;
+		}
+	}
+
+	return NO_TIMER;
+}
+
+// Picks the start count of the phase's timer and whether the channel runs pwm mode 2. A timer seen for the first time
+// joins the group with that start count, a known timer must already start at a count that fits the phase
+static PWM_Ret_et place_phase(PWM_Interleave_st* il, uint8_t k, uint8_t* mode_2) {
+	Timer_st* tim = il->phases[k]->tim;
+	uint64_t arr = tim->htim->Init.Period;
+	uint64_t period = Timer_Is_Center_Aligned(tim) ? (2 * arr) : (arr + 1);
+	uint64_t pos = (((uint64_t)k * period) + (il->num_phases / 2)) / il->num_phases;
+	uint32_t count[2];
+	uint8_t mode[2];
+	uint8_t num_options = 0;
+	uint8_t t = find_timer(il, tim);
+
+	if (!Timer_Is_Center_Aligned(tim)) {
+		// Counting up the pulse starts at count 0, which is reached P - pos counts after the start
+		count[num_options] = (uint32_t)((period - pos) % period);
+		mode[num_options++] = 0;
+	}
+	else {
+		// Pwm mode 2 centers the pulse on ARR, reached ARR - pos counts after the start (counters start counting up)
+		if (pos <= arr) {
+			count[num_options] = (uint32_t)(arr - pos);
+			mode[num_options++] = 1;
+		}
+		// Pwm mode 1 centers the pulse on 0, reached 2 * ARR - pos counts after the start
+		if ((pos == 0) || (pos >= arr)) {
+			count[num_options] = (uint32_t)((period - pos) % period);
+			mode[num_options++] = 0;
+		}
+	}
+
+	for (uint8_t o = 0; o < num_options; o++) {
+		if (t == NO_TIMER) {
+			if (il->__group.num_slaves >= (PWM_INTERLEAVE_MAX_TIMERS - 1)) { return PWM_INTERLEAVE_UNSUPPORTED; }
+
+			il->__slaves[il->__group.num_slaves] = tim;
+			il->__start_counts[il->__group.num_slaves] = count[o];
+			il->__group.num_slaves++;
+			*mode_2 = mode[o];
+			return PWM_OK;
+		}
+
+		// The timer of phase 0 always starts at 0
+		if (count[o] == ((t == 0) ? 0 : il->__start_counts[t - 1])) {
+			*mode_2 = mode[o];
+			return PWM_OK;
+		}
+	}
+
+	return PWM_INTERLEAVE_UNSUPPORTED;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// PWM_Interleave_Init places every phase and chains the timers. The outputs are stopped until PWM_Interleave_Start
+PWM_Ret_et PWM_Interleave_Init(PWM_Interleave_st* il) {
+	Timer_st* first;
+	uint8_t mode_2;
+	PWM_Ret_et ret;
+
+	if ((il->num_phases == 0) || (il->phases == NULL)) { return PWM_INVALID_LEN; }
+
+	first = il->phases[0]->tim;
+
+	// Check everything before anything is changed
+	for (uint8_t k = 0; k < il->num_phases; k++) {
+		Timer_st* tim = il->phases[k]->tim;
+
+		if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+		if ((il->phases[k]->chan_num == 0) || (il->phases[k]->chan_num > tim->__metadata.num_channels)) { return PWM_INVALID_CH_NUM; }
+		if ((tim->htim->Init.Prescaler != first->htim->Init.Prescaler) ||
+			(tim->htim->Init.Period != first->htim->Init.Period) ||
+			(Timer_Is_Center_Aligned(tim) != Timer_Is_Center_Aligned(first))) {
+			return PWM_TIM_MISMATCH;
+		}
+		if (tim->count_mode == COUNT_DOWN) { return PWM_INTERLEAVE_UNSUPPORTED; }
+	}
+
+	il->__group.num_slaves = 0;
+	for (uint8_t k = 0; k < il->num_phases; k++) {
+		ret = place_phase(il, k, &mode_2);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+
+	il->__group.master = first;
+	il->__group.slaves = il->__slaves;
+	il->__group.mode = SLAVE_TRIGGER;
+	il->__group.start_counts = il->__start_counts;
+	if (Timer_Group_Init(&il->__group) != TIM_OK) { return PWM_SYNC_FAIL; }
+
+	// The timers are stopped now, switch the channels that need it to the other pwm mode
+	for (uint8_t k = 0; k < il->num_phases; k++) {
+		PWM_st* pwm = il->phases[k];
+		uint32_t mode;
+
+		place_phase(il, k, &mode_2);
+		mode = mode_2 ? TIM_OCMODE_PWM2 : TIM_OCMODE_PWM1;
+
+		if (Timer_Get_OC_Mode(pwm->tim, pwm->chan_num) != mode) {
+			Timer_Set_OC_Mode(pwm->tim, pwm->chan_num, mode);
+			pwm->is_inverted = !pwm->is_inverted;
+		}
+
+		ret = PWM_Set_Duty_HR(pwm, pwm->duty_hr);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Interleave_Start starts every timer of the group from its phase offset on the same timer clock cycle
+PWM_Ret_et PWM_Interleave_Start(PWM_Interleave_st* il) {
+	if (Timer_Group_Start(&il->__group) != TIM_OK) { return PWM_TIM_UNINIT; }
+
+	return PWM_OK;
+}
+
+// PWM_Interleave_Stop stops the counters of every timer in the group. Outputs keep their current level
+PWM_Ret_et PWM_Interleave_Stop(PWM_Interleave_st* il) {
+	Timer_Group_Stop(&il->__group);
+
+	return PWM_OK;
+}
+
+// PWM_Interleave_Set_Duty_HR gives every phase the same duty. Phases keep their offsets, single phases can also be
+// trimmed with PWM_Set_Duty_HR (e.g. for current balancing)
+PWM_Ret_et PWM_Interleave_Set_Duty_HR(PWM_Interleave_st* il, uint16_t duty_hr) {
+	PWM_Ret_et ret;
+
+	for (uint8_t k = 0; k < il->num_phases; k++) {
+		ret = PWM_Set_Duty_HR(il->phases[k], duty_hr);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+
+	return PWM_OK;
+}
@@ -0,0 +1,45 @@
+/*
+ * pwm_interleave.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_PWM_INTERLEAVE_H_
+#define INC_PWM_INTERLEAVE_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+#include "timer_group.h"
+
+/*----------MACROS & DEFINES------------*/
+
+// Most timers one group can span: the master plus the timers wired to its trigger output
+#define PWM_INTERLEAVE_MAX_TIMERS			(5U)
+
+/*----------TYPEDEFS----------*/
+
+// PWM_Interleave_st spreads the pwms of a multi-phase converter evenly over one period. Phase k lags phase 0 by
+// k / num_phases of a period
+typedef struct {
+	// One pwm per phase, in phase order. Must be initialized (PWM_Init) on timers with the same frequency and the
+	// same counting mode (up or center aligned). A timer can only carry more than one phase when it counts center
+	// aligned and its phases are half a period apart
+	PWM_st** phases;
+	// Number of pwms in the phases array
+	uint8_t num_phases;
+	// DO NOT WRITE. Timers other than the one of phase 0, their start counts and the group chaining them
+	Timer_st* __slaves[PWM_INTERLEAVE_MAX_TIMERS - 1];
+	uint32_t __start_counts[PWM_INTERLEAVE_MAX_TIMERS - 1];
+	Timer_Group_st __group;
+}PWM_Interleave_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+PWM_Ret_et PWM_Interleave_Init(PWM_Interleave_st* il);
+PWM_Ret_et PWM_Interleave_Start(PWM_Interleave_st* il);
+PWM_Ret_et PWM_Interleave_Stop(PWM_Interleave_st* il);
+PWM_Ret_et PWM_Interleave_Set_Duty_HR(PWM_Interleave_st* il, uint16_t duty_hr);
+
+#endif /* INC_PWM_INTERLEAVE_H_ */
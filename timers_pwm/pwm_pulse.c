@@ -0,0 +1,231 @@
+/*
+ * pwm_pulse.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	One pulse mode.
+ *
+ *	The counter runs once from 0 to ARR and stops by itself. The channel is in PWM mode 2, so the output goes
+ *	active when the counter reaches CCR (the delay) and back inactive at the update that stops the counter
+ *	(delay + width). Once armed, the only jitter left is the synchronization of the trigger, a couple of timer
+ *	clocks, whether the pulse is started by an input edge or by software.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "pwm_pulse.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NS_PER_S				(1000000000ULL)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Nanoseconds to ticks of the prescaled clock, rounded to the nearest tick
+static uint64_t ns_to_ticks(uint64_t ns, uint32_t clk_hz, uint32_t prescaler) {
+	uint64_t den = NS_PER_S * prescaler;
+
+	return ((ns * clk_hz) + (den / 2)) / den;
+}
+
+static uint32_t ticks_to_ns(uint64_t ticks, uint32_t clk_hz, uint32_t prescaler) {
+	return (uint32_t)((ticks * prescaler * NS_PER_S) / clk_hz);
+}
+
+// Checks the channel pairing needed by the hardware trigger
+static PWM_Ret_et check_trigger(PWM_Pulse_st* pulse) {
+	switch(pulse->trigger) {
+		case(PULSE_TRIGGER_SOFTWARE):
+			return PWM_OK;
+		case(PULSE_TRIGGER_TI1):
+			return (pulse->pwm->chan_num == 2) ? PWM_OK : PWM_CH_UNSUPPORTED;
+		case(PULSE_TRIGGER_TI2):
+			return (pulse->pwm->chan_num == 1) ? PWM_OK : PWM_CH_UNSUPPORTED;
+		default:
+			return PWM_ERROR;
+	}
+}
+
+// Input channel of a hardware trigger, the other channel of the pair
+static uint8_t input_chan(PWM_Pulse_st* pulse) {
+	return (pulse->pwm->chan_num == 1) ? 2 : 1;
+}
+
+// Claims the output, the pwm's channel. A hardware trigger also takes the other channel of the pair as input
+static TIM_Ret_et claim_channels(PWM_Pulse_st* pulse) {
+	Timer_st* tim = pulse->pwm->tim;
+
+	if (Timer_Claim_Channel(tim, pulse->pwm->chan_num, pulse->pwm) != TIM_OK) { return TIM_CH_IN_USE; }
+	if ((pulse->trigger != PULSE_TRIGGER_SOFTWARE) && (Timer_Claim_Channel(tim, input_chan(pulse), pulse) != TIM_OK)) {
+		Timer_Release_Channel(tim, pulse->pwm->chan_num, pulse->pwm);
+		return TIM_CH_IN_USE;
+	}
+
+	return TIM_OK;
+}
+
+// Frees the channels taken by claim_channels
+static void release_channels(PWM_Pulse_st* pulse) {
+	Timer_Release_Channel(pulse->pwm->tim, pulse->pwm->chan_num, pulse->pwm);
+	if (pulse->trigger != PULSE_TRIGGER_SOFTWARE) {
+		Timer_Release_Channel(pulse->pwm->tim, input_chan(pulse), pulse);
+	}
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// PWM_Pulse_Init picks the finest prescaler that fits delay + width in the counter and sets up one pulse mode
+PWM_Ret_et PWM_Pulse_Init(PWM_Pulse_st* pulse) {
+	TIM_OnePulse_InitTypeDef sConfig = {0};
+	Timer_st* tim = pulse->pwm->tim;
+	TIM_HandleTypeDef* htim = tim->htim;
+	uint64_t max_count = IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? MAX_COUNTING_PERIOD_32BIT : MAX_COUNTING_PERIOD_16BIT;
+	uint64_t total_ns = (uint64_t)pulse->delay_ns + pulse->width_ns;
+	uint32_t clk_hz;
+	uint64_t prescaler;
+	uint64_t delay_ticks;
+	uint64_t width_ticks;
+	uint32_t chan;
+	PWM_Ret_et ret;
+
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	if ((pulse->pwm->chan_num == 0) || (pulse->pwm->chan_num > tim->__metadata.num_channels)) { return PWM_INVALID_CH_NUM; }
+
+	ret = check_trigger(pulse);
+	if (ret != PWM_OK) {
+		return ret;
+	}
+
+	clk_hz = Timer_Get_Clock_Freq(tim);
+
+	// Smallest prescaler whose counter range covers the whole pulse, one more if rounding spills over
+	prescaler = ((total_ns * clk_hz) + (NS_PER_S * max_count) - 1) / (NS_PER_S * max_count);
+	if (prescaler == 0) {
+		prescaler = 1;
+	}
+	for (;;) {
+		if (prescaler > MAX_PRESCALER) { return PWM_PULSE_INVALID; }
+
+		delay_ticks = ns_to_ticks(pulse->delay_ns, clk_hz, (uint32_t)prescaler);
+		width_ticks = ns_to_ticks(pulse->width_ns, clk_hz, (uint32_t)prescaler);
+		// With a compare of 0 the output would already be active while the counter is stopped
+		if (delay_ticks == 0) {
+			delay_ticks = 1;
+		}
+		if ((delay_ticks + width_ticks) <= max_count) {
+			break;
+		}
+		prescaler++;
+	}
+	if (width_ticks == 0) { return PWM_PULSE_INVALID; }
+
+	if (claim_channels(pulse) != TIM_OK) { return PWM_CH_IN_USE; }
+
+	htim->Init.Prescaler = (uint32_t)prescaler - 1;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim->Init.Period = (uint32_t)(delay_ticks + width_ticks - 1);
+	htim->Init.RepetitionCounter = 0;
+	if (HAL_TIM_OnePulse_Init(htim, TIM_OPMODE_SINGLE) != HAL_OK) {
+		release_channels(pulse);
+		return PWM_PULSE_CONFIG_FAIL;
+	}
+
+	// Inactive below the compare, active from the compare until the counter stops
+	sConfig.OCMode = TIM_OCMODE_PWM2;
+	sConfig.Pulse = (uint32_t)delay_ticks;
+	sConfig.OCPolarity = pulse->pwm->is_inverted ? TIM_OCPOLARITY_LOW : TIM_OCPOLARITY_HIGH;
+	sConfig.OCNPolarity = TIM_OCNPOLARITY_HIGH;
+	sConfig.OCIdleState = TIM_OCIDLESTATE_RESET;
+	sConfig.OCNIdleState = TIM_OCNIDLESTATE_RESET;
+	sConfig.ICPolarity = pulse->trigger_falling ? TIM_ICPOLARITY_FALLING : TIM_ICPOLARITY_RISING;
+	sConfig.ICSelection = TIM_ICSELECTION_DIRECTTI;
+	sConfig.ICFilter = 0;
+
+	chan = TIM_HAL_CHANNEL(pulse->pwm->chan_num);
+	if (pulse->trigger == PULSE_TRIGGER_SOFTWARE) {
+		TIM_OC_InitTypeDef sConfigOC = {0};
+
+		sConfigOC.OCMode = sConfig.OCMode;
+		sConfigOC.Pulse = sConfig.Pulse;
+		sConfigOC.OCPolarity = sConfig.OCPolarity;
+		sConfigOC.OCNPolarity = sConfig.OCNPolarity;
+		sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+		sConfigOC.OCIdleState = sConfig.OCIdleState;
+		sConfigOC.OCNIdleState = sConfig.OCNIdleState;
+		if (HAL_TIM_PWM_ConfigChannel(htim, &sConfigOC, chan) != HAL_OK) {
+			release_channels(pulse);
+			return PWM_PULSE_CONFIG_FAIL;
+		}
+	}
+	else {
+		// Also puts the timer in trigger slave mode on the input channel
+		uint32_t input = (pulse->trigger == PULSE_TRIGGER_TI1) ? TIM_CHANNEL_1 : TIM_CHANNEL_2;
+
+		if (HAL_TIM_OnePulse_ConfigChannel(htim, &sConfig, chan, input) != HAL_OK) {
+			release_channels(pulse);
+			return PWM_PULSE_CONFIG_FAIL;
+		}
+	}
+
+	pulse->__delay_ns = ticks_to_ns(delay_ticks, clk_hz, (uint32_t)prescaler);
+	pulse->__width_ns = ticks_to_ns(width_ticks, clk_hz, (uint32_t)prescaler);
+
+	return PWM_OK;
+}
+
+// PWM_Pulse_Arm enables the output. With a hardware trigger every following input edge produces a pulse
+PWM_Ret_et PWM_Pulse_Arm(PWM_Pulse_st* pulse) {
+	TIM_HandleTypeDef* htim = pulse->pwm->tim->htim;
+
+	// PWM_Pulse_Stop gave the channels back
+	if (claim_channels(pulse) != TIM_OK) { return PWM_CH_IN_USE; }
+
+	if (pulse->trigger != PULSE_TRIGGER_SOFTWARE) {
+		if (HAL_TIM_OnePulse_Start(htim, TIM_HAL_CHANNEL(pulse->pwm->chan_num)) != HAL_OK) { return PWM_START_FAIL; }
+		return PWM_OK;
+	}
+
+	// Only enable the output, the counter must stay stopped until PWM_Pulse_Fire
+	htim->Instance->CCER |= TIM_CCER_CC1E << TIM_HAL_CHANNEL(pulse->pwm->chan_num);
+	if (pulse->pwm->tim->__metadata.tim_type == ADVANCED_TIMER) {
+		__HAL_TIM_MOE_ENABLE(htim);
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Pulse_Fire starts one pulse now (software trigger). Ignored while a pulse is still running
+PWM_Ret_et PWM_Pulse_Fire(PWM_Pulse_st* pulse) {
+	TIM_TypeDef* regs = pulse->pwm->tim->htim->Instance;
+
+	if (pulse->trigger != PULSE_TRIGGER_SOFTWARE) { return PWM_ERROR; }
+
+	if (!(regs->CR1 & TIM_CR1_CEN)) {
+		regs->CNT = 0;
+		regs->CR1 |= TIM_CR1_CEN;
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Pulse_Is_Busy returns a boolean to see if a pulse (or its delay) is still running
+uint8_t PWM_Pulse_Is_Busy(PWM_Pulse_st* pulse) {
+	return (pulse->pwm->tim->htim->Instance->CR1 & TIM_CR1_CEN) ? 1 : 0;
+}
+
+// PWM_Pulse_Stop turns the output off, stops a running pulse and frees the channels for other users
+PWM_Ret_et PWM_Pulse_Stop(PWM_Pulse_st* pulse) {
+	TIM_HandleTypeDef* htim = pulse->pwm->tim->htim;
+
+	if (pulse->trigger != PULSE_TRIGGER_SOFTWARE) {
+		if (HAL_TIM_OnePulse_Stop(htim, TIM_HAL_CHANNEL(pulse->pwm->chan_num)) != HAL_OK) { return PWM_STOP_FAIL; }
+	}
+	else {
+		htim->Instance->CCER &= ~(TIM_CCER_CC1E << TIM_HAL_CHANNEL(pulse->pwm->chan_num));
+		htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	}
+
+	release_channels(pulse);
+
+	return PWM_OK;
+}
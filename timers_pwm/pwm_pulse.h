@@ -0,0 +1,53 @@
+/*
+ * pwm_pulse.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_PWM_PULSE_H_
+#define INC_PWM_PULSE_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// What starts a pulse
+typedef enum {
+	// PWM_Pulse_Fire starts the pulse
+	PULSE_TRIGGER_SOFTWARE = 1,
+	// An edge on the channel 1 input pin starts the pulse in hardware. The pulse must be on channel 2
+	PULSE_TRIGGER_TI1,
+	// An edge on the channel 2 input pin starts the pulse in hardware. The pulse must be on channel 1
+	PULSE_TRIGGER_TI2,
+}PWM_Pulse_Trigger_et;
+
+// PWM_Pulse_st produces a single pulse of a set width after a set delay, timed by the counter alone
+typedef struct {
+	// Output channel. Its timer must be initialized (Timer_Init) with the channel enabled, the pulse takes over
+	// the prescaler and period of the whole timer
+	PWM_st* pwm;
+	// Time from the trigger to the start of the pulse in nanoseconds. At least one timer tick
+	uint32_t delay_ns;
+	// Length of the pulse in nanoseconds
+	uint32_t width_ns;
+	// What starts a pulse
+	PWM_Pulse_Trigger_et trigger;
+	// Hardware trigger only: start on the falling edge of the input instead of the rising edge
+	uint8_t trigger_falling;
+	// DO NOT WRITE. Delay and width actually produced after rounding to timer ticks
+	uint32_t __delay_ns;
+	uint32_t __width_ns;
+}PWM_Pulse_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+PWM_Ret_et PWM_Pulse_Init(PWM_Pulse_st* pulse);
+PWM_Ret_et PWM_Pulse_Arm(PWM_Pulse_st* pulse);
+PWM_Ret_et PWM_Pulse_Fire(PWM_Pulse_st* pulse);
+uint8_t PWM_Pulse_Is_Busy(PWM_Pulse_st* pulse);
+PWM_Ret_et PWM_Pulse_Stop(PWM_Pulse_st* pulse);
+
+#endif /* INC_PWM_PULSE_H_ */
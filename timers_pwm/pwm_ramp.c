@@ -0,0 +1,248 @@
+/*
+ * pwm_ramp.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Interrupt driven pwm ramps.
+ *
+ *	PWM_Ramp_Tick runs once per interrupt period of one timer (PWM_Ramp_Callback registered with
+ *	Timer_Register_Callback) and steps every ramp that has not reached its target yet. Ramps enter the active list when their target changes and leave it when they arrive, so the
+ *	cost of a tick only depends on the number of ramps that are moving.
+ *	Rates are converted to Q16 duty steps per tick once, so the tick itself is integer adds and compares.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "pwm_ramp.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Ramp positions are high resolution duty cycles in Q16
+#define RAMP_Q					(16U)
+#define RAMP_HALF				(1LL << (RAMP_Q - 1))
+#define US_PER_MS				(1000U)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Interrupt period of the engine timer: the interrupt period / frequency if set, otherwise the timer's own
+static uint32_t interrupt_period_us(Timer_st* tim) {
+	uint32_t period_ms;
+	uint32_t freq_hz;
+
+	if (tim->timing == PERIOD) {
+		period_ms = (tim->it_config.period_ms != DEFAULT_IT_PERIOD) ? tim->it_config.period_ms : tim->period_ms;
+		return period_ms * US_PER_MS;
+	}
+
+	freq_hz = (tim->it_config.freq_hz != DEFAULT_IT_FREQ) ? tim->it_config.freq_hz : tim->freq_hz;
+	return (freq_hz != 0) ? (1000000U / freq_hz) : 0;
+}
+
+// The active list and ramp state are shared with the update interrupt, mask it while they change
+static void engine_lock(PWM_Ramp_Engine_st* engine) {
+	__HAL_TIM_DISABLE_IT(engine->tim->htim, TIM_IT_UPDATE);
+}
+
+static void engine_unlock(PWM_Ramp_Engine_st* engine) {
+	__HAL_TIM_ENABLE_IT(engine->tim->htim, TIM_IT_UPDATE);
+}
+
+// Returns a boolean to see if a ramp stepping speed this tick can still stop within remaining, slowing by accel on
+// each following tick: speed + (speed - accel) + ... while the steps are positive
+static uint8_t can_stop(int64_t speed, int64_t remaining, int64_t accel) {
+	int64_t steps = (speed + accel - 1) / accel;
+
+	// The steps average at least half the speed, this also keeps the sum below from overflowing
+	if (steps > (((2 * remaining) / speed) + 1)) {
+		return 0;
+	}
+
+	return ((steps * speed) - ((accel * steps * (steps - 1)) / 2)) <= remaining;
+}
+
+// Moves a ramp by one tick. Returns 1 once the target has been reached
+static uint8_t ramp_step(PWM_Ramp_st* ramp) {
+	int64_t dist = ramp->__target - ramp->__pos;
+	int64_t dir = (dist > 0) ? 1 : -1;
+	int64_t remaining = dist * dir;
+	int64_t speed;
+	int64_t faster;
+
+	if (dist == 0) {
+		ramp->__vel = 0;
+		return 1;
+	}
+
+	if (ramp->profile == RAMP_S_CURVE) {
+		// Speed towards the target, negative if the target moved behind the ramp
+		speed = ramp->__vel * dir;
+		faster = (speed + ramp->__accel < ramp->__max_step) ? (speed + ramp->__accel) : ramp->__max_step;
+
+		if (speed < 0) {
+			speed += ramp->__accel;
+		}
+		// Fastest of speeding up, holding or slowing down that still stops on the target
+		else if (can_stop(faster, remaining, ramp->__accel)) {
+			speed = faster;
+		}
+		else if ((speed == 0) || !can_stop(speed, remaining, ramp->__accel)) {
+			speed -= ramp->__accel;
+			// Keep creeping so the target is always reached
+			if (speed < ramp->__accel) {
+				speed = ramp->__accel;
+			}
+		}
+	}
+	else {
+		speed = ramp->__max_step;
+	}
+
+	// Do not overshoot
+	if ((speed > 0) && (speed >= remaining)) {
+		ramp->__pos = ramp->__target;
+		ramp->__vel = 0;
+		return 1;
+	}
+
+	ramp->__pos += speed * dir;
+	ramp->__vel = speed * dir;
+
+	return 0;
+}
+
+// Writes the ramp position to the pwm compare register
+static void ramp_output(PWM_Ramp_st* ramp) {
+	int64_t duty = (ramp->__pos + RAMP_HALF) >> RAMP_Q;
+
+	if (duty < 0) {
+		duty = 0;
+	}
+	else if (duty > PWM_DUTY_HR_MAX) {
+		duty = PWM_DUTY_HR_MAX;
+	}
+
+	if ((uint16_t)duty != ramp->pwm->duty_hr) {
+		PWM_Set_Duty_HR(ramp->pwm, (uint16_t)duty);
+	}
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// PWM_Ramp_Engine_Init prepares an engine driven by the update interrupt of engine->tim. Register PWM_Ramp_Callback
+// on the timer afterwards (Timer_Register_Callback)
+PWM_Ret_et PWM_Ramp_Engine_Init(PWM_Ramp_Engine_st* engine) {
+	if (!engine->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	engine->__tick_us = interrupt_period_us(engine->tim);
+	if (engine->__tick_us == 0) { return PWM_INVALID_RATE; }
+
+	engine->__num_active = 0;
+
+	return PWM_OK;
+}
+
+// PWM_Ramp_Init converts the ramp rates to steps per engine tick and starts the ramp at the current duty
+PWM_Ret_et PWM_Ramp_Init(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp) {
+	uint64_t accel_ticks;
+
+	if (ramp->rate_hr_per_ms == 0) { return PWM_INVALID_RATE; }
+	if (engine->__tick_us == 0) { return PWM_INVALID_RATE; }
+
+	// Q16 duty units moved in one tick at full rate
+	ramp->__max_step = (int64_t)((((uint64_t)ramp->rate_hr_per_ms << RAMP_Q) * engine->__tick_us) / US_PER_MS);
+	if (ramp->__max_step == 0) {
+		ramp->__max_step = 1;
+	}
+
+	// Rate gained per tick so full rate is reached after accel_ms
+	accel_ticks = ((uint64_t)ramp->accel_ms * US_PER_MS) / engine->__tick_us;
+	ramp->__accel = (accel_ticks != 0) ? (int64_t)(ramp->__max_step / (int64_t)accel_ticks) : ramp->__max_step;
+	if (ramp->__accel == 0) {
+		ramp->__accel = 1;
+	}
+
+	ramp->__pos = (int64_t)ramp->pwm->duty_hr << RAMP_Q;
+	ramp->__target = ramp->__pos;
+	ramp->__vel = 0;
+	ramp->__active = 0;
+
+	return PWM_OK;
+}
+
+// PWM_Ramp_Update_Target sets a new target duty in percent and lets the engine ramp towards it
+PWM_Ret_et PWM_Ramp_Update_Target(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp, uint8_t new_target) {
+	PWM_Ret_et ret;
+
+	ret = PWM_Update_Target(ramp->pwm, new_target);
+	if (ret != PWM_OK) {
+		return ret;
+	}
+
+	return PWM_Ramp_Update_Target_HR(engine, ramp, (uint16_t)(((uint32_t)new_target * PWM_DUTY_HR_MAX) / MAX_DUTY_CYCLE));
+}
+
+// PWM_Ramp_Update_Target_HR sets a new high resolution target duty and lets the engine ramp towards it
+PWM_Ret_et PWM_Ramp_Update_Target_HR(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp, uint16_t new_target_hr) {
+	PWM_Ret_et ret = PWM_OK;
+
+	engine_lock(engine);
+
+	if (!ramp->__active) {
+		// Pick up any duty written directly since the ramp last stopped
+		ramp->__pos = (int64_t)ramp->pwm->duty_hr << RAMP_Q;
+		ramp->__vel = 0;
+
+		if (engine->__num_active >= engine->max_active) {
+			ret = PWM_RAMP_FULL;
+		}
+		else {
+			engine->active[engine->__num_active++] = ramp;
+			ramp->__active = 1;
+		}
+	}
+
+	if (ret == PWM_OK) {
+		ramp->__target = (int64_t)new_target_hr << RAMP_Q;
+	}
+
+	engine_unlock(engine);
+
+	return ret;
+}
+
+// PWM_Ramp_Is_Active returns a boolean to see if a ramp is still moving
+uint8_t PWM_Ramp_Is_Active(PWM_Ramp_st* ramp) {
+	return ramp->__active;
+}
+
+// PWM_Ramp_Tick steps every active ramp and must run once per interrupt period. Called straight from
+// HAL_TIM_PeriodElapsedCallback it runs on every update event, twice per period on center aligned general timers,
+// and the ramps move at double rate: use PWM_Ramp_Callback instead
+void PWM_Ramp_Tick(PWM_Ramp_Engine_st* engine, TIM_HandleTypeDef* htim) {
+	uint8_t i = 0;
+
+	if (htim != engine->tim->htim) {
+		return;
+	}
+
+	while (i < engine->__num_active) {
+		PWM_Ramp_st* ramp = engine->active[i];
+		uint8_t done = ramp_step(ramp);
+
+		ramp_output(ramp);
+
+		if (done) {
+			// Swap the last active ramp into this slot
+			ramp->__active = 0;
+			engine->active[i] = engine->active[--engine->__num_active];
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+// PWM_Ramp_Callback is PWM_Ramp_Tick as a Timer_Callback_ft, context is the PWM_Ramp_Engine_st
+void PWM_Ramp_Callback(Timer_st* tim, void* context) {
+	PWM_Ramp_Tick((PWM_Ramp_Engine_st*)context, tim->htim);
+}
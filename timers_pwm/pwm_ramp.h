@@ -0,0 +1,75 @@
+/*
+ * pwm_ramp.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_PWM_RAMP_H_
+#define INC_PWM_RAMP_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------MACROS & DEFINES------------*/
+
+// Converts a rate in percent per millisecond to high resolution duty units per millisecond
+#define PWM_RAMP_PERCENT_PER_MS(PERCENT)	(((uint32_t)(PERCENT) * PWM_DUTY_HR_MAX) / MAX_DUTY_CYCLE)
+
+/*----------TYPEDEFS----------*/
+
+// Shape of the duty cycle over time while ramping
+typedef enum {
+	// Constant rate until the target is reached
+	RAMP_LINEAR = 1,
+	// Rate rises and falls linearly (trapezoidal rate), so the duty follows an S shape without steps in slope
+	RAMP_S_CURVE,
+}PWM_Ramp_Profile_et;
+
+// PWM_Ramp_st moves one pwm towards its target from the ramp engine interrupt
+typedef struct {
+	// PWM being ramped. Must be running (PWM_Init)
+	PWM_st* pwm;
+	// Shape of the ramp
+	PWM_Ramp_Profile_et profile;
+	// Maximum rate of change in high resolution duty units per millisecond (see PWM_RAMP_PERCENT_PER_MS)
+	uint32_t rate_hr_per_ms;
+	// S-curve only: time in milliseconds to go from standstill to the full rate
+	uint16_t accel_ms;
+	// DO NOT WRITE. Duty, rate and target in Q16 high resolution units per engine tick
+	int64_t __pos;
+	int64_t __vel;
+	int64_t __target;
+	int64_t __max_step;
+	int64_t __accel;
+	// DO NOT WRITE. Set while the ramp is in the engine's active list
+	uint8_t __active;
+}PWM_Ramp_st;
+
+// PWM_Ramp_Engine_st steps every active ramp on each update interrupt of a timer
+typedef struct {
+	// Timer whose update interrupt drives the engine. Must be initialized with it_config.en_it set and have
+	// PWM_Ramp_Callback registered (Timer_Register_Callback) with the engine as context
+	Timer_st* tim;
+	// Storage for pointers to the active ramps
+	PWM_Ramp_st** active;
+	// Number of entries in the active array
+	uint8_t max_active;
+	// DO NOT WRITE. Interrupt period in microseconds
+	uint32_t __tick_us;
+	// DO NOT WRITE. Number of ramps currently moving
+	uint8_t __num_active;
+}PWM_Ramp_Engine_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+PWM_Ret_et PWM_Ramp_Engine_Init(PWM_Ramp_Engine_st* engine);
+PWM_Ret_et PWM_Ramp_Init(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp);
+PWM_Ret_et PWM_Ramp_Update_Target(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp, uint8_t new_target);
+PWM_Ret_et PWM_Ramp_Update_Target_HR(PWM_Ramp_Engine_st* engine, PWM_Ramp_st* ramp, uint16_t new_target_hr);
+uint8_t PWM_Ramp_Is_Active(PWM_Ramp_st* ramp);
+void PWM_Ramp_Tick(PWM_Ramp_Engine_st* engine, TIM_HandleTypeDef* htim);
+void PWM_Ramp_Callback(Timer_st* tim, void* context);
+
+#endif /* INC_PWM_RAMP_H_ */
@@ -0,0 +1,389 @@
+/*
+ * tim_capture.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Input capture frequency and duty measurement.
+ *
+ *	The timer latches its counter on the input edge in hardware, so every timestamp is exact to one timer tick no
+ *	matter how late the cpu gets to it. CAPTURE_IT and CAPTURE_PWM_INPUT also count the update events of the timer
+ *	(Timer_Capture_Period_Elapsed): CAPTURE_IT adds the counter periods between two edges so inputs slower than the
+ *	timer period are measured, CAPTURE_PWM_INPUT drops periods an overflow cut through. CAPTURE_DMA takes periods
+ *	modulo the counting period, which only holds while the input is faster than the timer period.
+ *
+ *	CAPTURE_PWM_INPUT costs no interrupts at all, CAPTURE_DMA costs one DMA transfer per edge and CAPTURE_IT one
+ *	short interrupt per edge.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "tim_capture.h"
+
+/*----------PRIVATE MACROS----------*/
+
+// Written to the DMA buffer before starting so entries that were never captured can be recognized
+#define CAPTURE_EMPTY			(0xFFFFFFFFU)
+#define MAX_IC_FILTER			(0xFU)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const uint8_t dma_ids[4] = { TIM_DMA_ID_CC1, TIM_DMA_ID_CC2, TIM_DMA_ID_CC3, TIM_DMA_ID_CC4 };
+static const HAL_TIM_ActiveChannel active_channels[4] = {
+	HAL_TIM_ACTIVE_CHANNEL_1, HAL_TIM_ACTIVE_CHANNEL_2, HAL_TIM_ACTIVE_CHANNEL_3, HAL_TIM_ACTIVE_CHANNEL_4
+};
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Ticks from one capture to the next, the counter may have wrapped once in between
+static uint32_t ticks_between(Capture_st* cap, uint32_t from, uint32_t to) {
+	uint64_t counting_period = (uint64_t)cap->tim->htim->Instance->ARR + 1;
+
+	if (to >= from) {
+		return to - from;
+	}
+	return (uint32_t)(counting_period - from + to);
+}
+
+// Ticks from one capture to the next with wraps counter overflows in between. Without any counted overflow this is
+// ticks_between, which already accounts for one wrap when to is below from
+static uint64_t ticks_spanning(Capture_st* cap, uint32_t from, uint32_t to, uint32_t wraps) {
+	uint64_t counting_period = (uint64_t)cap->tim->htim->Instance->ARR + 1;
+
+	if ((to < from) && (wraps > 0)) {
+		wraps--;
+	}
+	return ticks_between(cap, from, to) + (wraps * counting_period);
+}
+
+// Second channel of a pwm input capture, the other channel of the pair
+static uint8_t other_chan(Capture_st* cap) {
+	return (cap->chan_num == 1) ? 2 : 1;
+}
+
+// Claims the capture channel, and the second channel of a pwm input capture
+static TIM_Ret_et claim_channels(Capture_st* cap) {
+	if (Timer_Claim_Channel(cap->tim, cap->chan_num, cap) != TIM_OK) { return TIM_CH_IN_USE; }
+	if ((cap->mode == CAPTURE_PWM_INPUT) && (Timer_Claim_Channel(cap->tim, other_chan(cap), cap) != TIM_OK)) {
+		Timer_Release_Channel(cap->tim, cap->chan_num, cap);
+		return TIM_CH_IN_USE;
+	}
+
+	return TIM_OK;
+}
+
+// Frees the channels taken by claim_channels
+static void release_channels(Capture_st* cap) {
+	Timer_Release_Channel(cap->tim, cap->chan_num, cap);
+	if (cap->mode == CAPTURE_PWM_INPUT) {
+		Timer_Release_Channel(cap->tim, other_chan(cap), cap);
+	}
+}
+
+// Period and high time inputs need a pair of channels (1 and 2) and a slave mode controller
+static uint8_t pwm_input_supported(Capture_st* cap) {
+	uint8_t n = cap->tim->tim_num;
+
+	if ((cap->chan_num != 1) && (cap->chan_num != 2)) {
+		return 0;
+	}
+	return (n <= 5) || (n == 8) || (n == 9) || (n == 12);
+}
+
+static uint32_t ic_polarity(Capture_Edge_et edge) {
+	return (edge == CAPTURE_FALLING) ? TIM_ICPOLARITY_FALLING : TIM_ICPOLARITY_RISING;
+}
+
+// Fills in frequency and duty from the tick counts
+static void fill_result(Capture_st* cap, Capture_Result_st* result, uint32_t period_ticks, uint32_t high_ticks) {
+	result->period_ticks = period_ticks;
+	result->high_ticks = high_ticks;
+	result->freq_mhz = ((uint64_t)cap->__tick_hz * 1000U) / period_ticks;
+	result->duty_hr = (uint16_t)(((uint64_t)high_ticks * PWM_DUTY_HR_MAX) / period_ticks);
+}
+
+// PWM input: the direct channel captures the period, the indirect one the high time, both from the same pin
+static TIM_Ret_et pwm_input_result(Capture_st* cap, Capture_Result_st* result) {
+	uint8_t other = other_chan(cap);
+	uint32_t wraps = cap->__wraps;
+	uint32_t period_ticks;
+	uint32_t high_ticks;
+
+	// The period edge after an overflow captures a period cut by it. The update interrupt cleared the capture flags,
+	// so an overcapture is the second period edge since: only then is the captured period a whole one. Reading the
+	// captures clears the capture flag on target, so they are not read before
+	if (wraps != cap->__wraps_seen) {
+		if (!__HAL_TIM_GET_FLAG(cap->tim->htim, TIM_FLAG_CC1OF << (cap->chan_num - 1))) {
+			return TIM_NO_CAPTURE;
+		}
+		cap->__wraps_seen = wraps;
+	}
+
+	period_ticks = HAL_TIM_ReadCapturedValue(cap->tim->htim, TIM_HAL_CHANNEL(cap->chan_num));
+	high_ticks = HAL_TIM_ReadCapturedValue(cap->tim->htim, TIM_HAL_CHANNEL(other));
+	if (period_ticks == 0) {
+		return TIM_NO_CAPTURE;
+	}
+
+	// On a falling period edge the indirect channel measured the low time
+	if (cap->edge == CAPTURE_FALLING) {
+		high_ticks = period_ticks - high_ticks;
+	}
+
+	fill_result(cap, result, period_ticks, high_ticks);
+
+	return TIM_OK;
+}
+
+// DMA: averages the last avg_periods periods that ended at the newest buffer entry
+static TIM_Ret_et dma_result(Capture_st* cap, Capture_Result_st* result) {
+	DMA_HandleTypeDef* hdma = cap->tim->htim->hdma[dma_ids[cap->chan_num - 1]];
+	uint16_t num_periods = (cap->avg_periods > 1) ? cap->avg_periods : 1;
+	uint16_t newest = (uint16_t)((cap->buffer_len - __HAL_DMA_GET_COUNTER(hdma) + cap->buffer_len - 1) % cap->buffer_len);
+	uint16_t i = newest;
+	uint64_t sum = 0;
+
+	for (uint16_t p = 0; p < num_periods; p++) {
+		uint16_t prev = (i == 0) ? (cap->buffer_len - 1) : (i - 1);
+
+		if ((cap->buffer[i] == CAPTURE_EMPTY) || (cap->buffer[prev] == CAPTURE_EMPTY)) {
+			return TIM_NO_CAPTURE;
+		}
+		sum += ticks_between(cap, cap->buffer[prev], cap->buffer[i]);
+		i = prev;
+	}
+
+	if (sum == 0) {
+		return TIM_NO_CAPTURE;
+	}
+
+	// Keep the fractional tick of the average in the frequency
+	result->period_ticks = (uint32_t)(sum / num_periods);
+	result->high_ticks = 0;
+	result->freq_mhz = ((uint64_t)cap->__tick_hz * 1000U * num_periods) / sum;
+	result->duty_hr = 0;
+
+	return TIM_OK;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timer_Capture_Init configures the capture channel(s). The timer keeps the prescaler / period from Timer_Init
+TIM_Ret_et Timer_Capture_Init(Capture_st* cap) {
+	TIM_IC_InitTypeDef sConfigIC = {0};
+	TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+	TIM_HandleTypeDef* htim = cap->tim->htim;
+
+	if (!cap->tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if ((cap->chan_num == 0) || (cap->chan_num > cap->tim->__metadata.num_channels)) { return TIM_CH_INVALID; }
+	if ((cap->mode == CAPTURE_PWM_INPUT) && !pwm_input_supported(cap)) { return TIM_CH_INVALID; }
+	if ((cap->mode == CAPTURE_DMA) && ((cap->buffer == NULL) || (cap->buffer_len < 2) || (cap->avg_periods >= cap->buffer_len))) {
+		return TIM_INVALID_BUFFER;
+	}
+
+	if (claim_channels(cap) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	cap->__tick_hz = Timer_Get_Clock_Freq(cap->tim) / (htim->Init.Prescaler + 1);
+	cap->__num_edges = 0;
+	cap->__period_ticks = 0;
+
+	if (HAL_TIM_IC_Init(htim) != HAL_OK) {
+		release_channels(cap);
+		return TIM_CAPTURE_CONFIG_FAIL;
+	}
+
+	sConfigIC.ICPolarity = ic_polarity(cap->edge);
+	sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+	sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+	sConfigIC.ICFilter = cap->filter & MAX_IC_FILTER;
+	if (HAL_TIM_IC_ConfigChannel(htim, &sConfigIC, TIM_HAL_CHANNEL(cap->chan_num)) != HAL_OK) {
+		release_channels(cap);
+		return TIM_CAPTURE_CONFIG_FAIL;
+	}
+
+	if (cap->mode == CAPTURE_PWM_INPUT) {
+		uint8_t other = other_chan(cap);
+
+		// Second channel watches the same pin for the opposite edge
+		sConfigIC.ICPolarity = ic_polarity((cap->edge == CAPTURE_FALLING) ? CAPTURE_RISING : CAPTURE_FALLING);
+		sConfigIC.ICSelection = TIM_ICSELECTION_INDIRECTTI;
+		if (HAL_TIM_IC_ConfigChannel(htim, &sConfigIC, TIM_HAL_CHANNEL(other)) != HAL_OK) {
+			release_channels(cap);
+			return TIM_CAPTURE_CONFIG_FAIL;
+		}
+
+		// Every period edge restarts the counter, so the captures are the period and high time directly
+		sSlaveConfig.SlaveMode = TIM_SLAVEMODE_RESET;
+		sSlaveConfig.InputTrigger = (cap->chan_num == 1) ? TIM_TS_TI1FP1 : TIM_TS_TI2FP2;
+		sSlaveConfig.TriggerPolarity = ic_polarity(cap->edge);
+		sSlaveConfig.TriggerPrescaler = TIM_ICPSC_DIV1;
+		sSlaveConfig.TriggerFilter = cap->filter & MAX_IC_FILTER;
+		if (HAL_TIM_SlaveConfigSynchro(htim, &sSlaveConfig) != HAL_OK) {
+			release_channels(cap);
+			return TIM_SLAVE_CONFIG_FAIL;
+		}
+
+		// Only a real overflow sets the update flag, not the resets from the input
+		__HAL_TIM_URS_ENABLE(htim);
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Capture_Start starts capturing
+TIM_Ret_et Timer_Capture_Start(Capture_st* cap) {
+	TIM_HandleTypeDef* htim = cap->tim->htim;
+	uint32_t chan = TIM_HAL_CHANNEL(cap->chan_num);
+	HAL_StatusTypeDef status = HAL_ERROR;
+
+	// Timer_Capture_Stop gave the channels back
+	if (claim_channels(cap) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	switch(cap->mode) {
+		case(CAPTURE_IT):
+			cap->__num_edges = 0;
+			cap->__wraps = 0;
+			cap->__wrap_early = 0;
+			__HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+			status = HAL_TIM_IC_Start_IT(htim, chan);
+			break;
+		case(CAPTURE_PWM_INPUT):
+			// Nothing is measured until two period edges followed the start
+			cap->__wraps = 1;
+			cap->__wraps_seen = 0;
+			__HAL_TIM_CLEAR_FLAG(htim, (TIM_FLAG_CC1 | TIM_FLAG_CC1OF) << (cap->chan_num - 1));
+			__HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+			status = HAL_TIM_IC_Start(htim, TIM_CHANNEL_1);
+			if (status == HAL_OK) {
+				status = HAL_TIM_IC_Start(htim, TIM_CHANNEL_2);
+			}
+			break;
+		case(CAPTURE_DMA):
+			if (htim->hdma[dma_ids[cap->chan_num - 1]] == NULL) { return TIM_NO_DMA; }
+
+			for (uint16_t i = 0; i < cap->buffer_len; i++) {
+				cap->buffer[i] = CAPTURE_EMPTY;
+			}
+			status = HAL_TIM_IC_Start_DMA(htim, chan, cap->buffer, cap->buffer_len);
+			break;
+	}
+
+	if (status != HAL_OK) { return TIM_CAPTURE_START_FAIL; }
+
+	return TIM_OK;
+}
+
+// Timer_Capture_Stop stops capturing and frees the channels, the last result stays readable
+TIM_Ret_et Timer_Capture_Stop(Capture_st* cap) {
+	TIM_HandleTypeDef* htim = cap->tim->htim;
+	uint32_t chan = TIM_HAL_CHANNEL(cap->chan_num);
+	HAL_StatusTypeDef status = HAL_ERROR;
+
+	switch(cap->mode) {
+		case(CAPTURE_IT):
+			status = HAL_TIM_IC_Stop_IT(htim, chan);
+			break;
+		case(CAPTURE_PWM_INPUT):
+			status = HAL_TIM_IC_Stop(htim, TIM_CHANNEL_1);
+			if (status == HAL_OK) {
+				status = HAL_TIM_IC_Stop(htim, TIM_CHANNEL_2);
+			}
+			break;
+		case(CAPTURE_DMA):
+			status = HAL_TIM_IC_Stop_DMA(htim, chan);
+			break;
+	}
+
+	if (status != HAL_OK) { return TIM_CAPTURE_STOP_FAIL; }
+
+	// The update interrupt stays on for a timer that had it before the capture
+	if ((cap->mode != CAPTURE_DMA) && !cap->tim->it_config.en_it) {
+		__HAL_TIM_DISABLE_IT(htim, TIM_IT_UPDATE);
+	}
+
+	release_channels(cap);
+
+	return TIM_OK;
+}
+
+// Timer_Capture_Callback records one edge in CAPTURE_IT mode. Call it from HAL_TIM_IC_CaptureCallback
+void Timer_Capture_Callback(Capture_st* cap, TIM_HandleTypeDef* htim) {
+	uint32_t now;
+	uint32_t wraps;
+
+	if ((htim != cap->tim->htim) || (htim->Channel != active_channels[cap->chan_num - 1])) {
+		return;
+	}
+
+	now = HAL_TIM_ReadCapturedValue(htim, TIM_HAL_CHANNEL(cap->chan_num));
+	wraps = cap->__wraps;
+
+	// The HAL handles captures before updates of the same interrupt (TIM1 / TIM8 update on their own vector). An
+	// update still pending with a capture in the lower half of the count happened before the edge: count it here and
+	// skip it in Timer_Capture_Period_Elapsed. The flag is only read, clearing it is left to the update interrupt
+	if (__HAL_TIM_GET_FLAG(htim, TIM_FLAG_UPDATE) && !cap->__wrap_early && (now < (htim->Instance->ARR / 2))) {
+		wraps++;
+		cap->__wrap_early = 1;
+	}
+
+	if (cap->__num_edges > 0) {
+		uint64_t period_ticks = ticks_spanning(cap, cap->__last, now, wraps);
+
+		// Periods that do not fit the result read as no capture
+		cap->__period_ticks = (period_ticks > UINT32_MAX) ? 0 : (uint32_t)period_ticks;
+	}
+	if (cap->__num_edges < 2) {
+		cap->__num_edges++;
+	}
+
+	cap->__last = now;
+	cap->__wraps = 0;
+}
+
+// Timer_Capture_Period_Elapsed counts one update event of the timer (CAPTURE_IT and CAPTURE_PWM_INPUT). Call it from
+// HAL_TIM_PeriodElapsedCallback, or register Timer_Capture_Update_Callback on a timer with it_config.en_it
+void Timer_Capture_Period_Elapsed(Capture_st* cap, TIM_HandleTypeDef* htim) {
+	if ((htim != cap->tim->htim) || (cap->mode == CAPTURE_DMA)) {
+		return;
+	}
+
+	// Already counted by Timer_Capture_Callback
+	if (cap->__wrap_early) {
+		cap->__wrap_early = 0;
+		return;
+	}
+
+	// The next captures of a pwm input start over after the overflow
+	if (cap->mode == CAPTURE_PWM_INPUT) {
+		__HAL_TIM_CLEAR_FLAG(htim, (TIM_FLAG_CC1 | TIM_FLAG_CC1OF) << (cap->chan_num - 1));
+	}
+	cap->__wraps++;
+}
+
+// Timer_Capture_Update_Callback is Timer_Capture_Period_Elapsed as a Timer_Callback_ft, context is the Capture_st
+void Timer_Capture_Update_Callback(Timer_st* tim, void* context) {
+	Timer_Capture_Period_Elapsed((Capture_st*)context, tim->htim);
+}
+
+// Timer_Capture_Get_Result returns the latest measurement
+TIM_Ret_et Timer_Capture_Get_Result(Capture_st* cap, Capture_Result_st* result) {
+	// A single word written by the ISR, so reading it cannot tear
+	uint32_t period_ticks = cap->__period_ticks;
+
+	switch(cap->mode) {
+		case(CAPTURE_PWM_INPUT):
+			return pwm_input_result(cap, result);
+		case(CAPTURE_DMA):
+			return dma_result(cap, result);
+		case(CAPTURE_IT):
+		default:
+			break;
+	}
+
+	if ((cap->__num_edges < 2) || (period_ticks == 0)) {
+		return TIM_NO_CAPTURE;
+	}
+
+	fill_result(cap, result, period_ticks, 0);
+
+	return TIM_OK;
+}
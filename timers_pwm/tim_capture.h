@@ -0,0 +1,94 @@
+/*
+ * tim_capture.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIM_CAPTURE_H_
+#define INC_TIM_CAPTURE_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// How captured edges reach the cpu
+typedef enum {
+	// One interrupt per edge, call Timer_Capture_Callback from HAL_TIM_IC_CaptureCallback. Counts the update events
+	// between edges (Timer_Capture_Period_Elapsed), so periods up to 2^32 ticks are measured
+	CAPTURE_IT = 1,
+	// Two channels on one pin, the counter resets on every period edge. Period and high time are held in the
+	// capture registers and read without an interrupt per edge. Inputs slower than the timer period read as no
+	// capture, which needs the update events (Timer_Capture_Period_Elapsed). Channels 1 or 2 of timers 1-5, 8, 9 and
+	// 12 only
+	CAPTURE_PWM_INPUT,
+	// DMA writes every capture into a circular buffer, no interrupt per edge. Periods are taken modulo the timer
+	// period, so the input must be faster than it
+	CAPTURE_DMA,
+}Capture_Mode_et;
+
+// Edge that starts a period
+typedef enum {
+	CAPTURE_RISING = 1,
+	CAPTURE_FALLING,
+}Capture_Edge_et;
+
+// Capture_Result_st is one frequency / duty measurement
+typedef struct {
+	// Counts of the timer clock in one input period
+	uint32_t period_ticks;
+	// Counts the input spent high (CAPTURE_PWM_INPUT only, 0 otherwise)
+	uint32_t high_ticks;
+	// Input frequency in millihertz
+	uint64_t freq_mhz;
+	// High resolution duty cycle (CAPTURE_PWM_INPUT only, 0 otherwise)
+	uint16_t duty_hr;
+}Capture_Result_st;
+
+// Capture_st measures the input on one timer channel. The timer counts at its own prescaled clock. Its period
+// (Timer_Init freq_hz / period_ms) is the longest input period CAPTURE_PWM_INPUT and CAPTURE_DMA can measure, so set
+// it below the slowest input. Capture_Start enables the update interrupt for CAPTURE_IT and CAPTURE_PWM_INPUT, give it
+// the priority of the capture interrupt when the timer has its own update vector
+typedef struct {
+	// Timer which contains the channel. Must be initialized (Timer_Init) without pwm on the capture channels
+	Timer_st* tim;
+	// Channel the input pin is connected to (1-4)
+	uint8_t chan_num;
+	// How edges are captured
+	Capture_Mode_et mode;
+	// Edge that starts a period
+	Capture_Edge_et edge;
+	// Digital input filter (0-15, see ICxF in the reference manual). 0 disables it
+	uint8_t filter;
+	// CAPTURE_DMA only: circular buffer the DMA writes the captures to. Needs a word wide circular DMA stream
+	uint32_t* buffer;
+	// CAPTURE_DMA only: number of entries in the buffer
+	uint16_t buffer_len;
+	// CAPTURE_DMA only: number of input periods averaged per result (0 or 1 for the latest period only)
+	uint16_t avg_periods;
+	// DO NOT WRITE. Timer clock after the prescaler
+	uint32_t __tick_hz;
+	// DO NOT WRITE. CAPTURE_IT: last captured value, latest period and edge count (saturates at 2)
+	uint32_t __last;
+	volatile uint32_t __period_ticks;
+	volatile uint8_t __num_edges;
+	// DO NOT WRITE. Update events counted since the last edge (CAPTURE_IT) or since the start (CAPTURE_PWM_INPUT),
+	// the count at which a whole pwm input period was seen, and an update already counted by the capture callback
+	volatile uint32_t __wraps;
+	uint32_t __wraps_seen;
+	volatile uint8_t __wrap_early;
+}Capture_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timer_Capture_Init(Capture_st* cap);
+TIM_Ret_et Timer_Capture_Start(Capture_st* cap);
+TIM_Ret_et Timer_Capture_Stop(Capture_st* cap);
+void Timer_Capture_Callback(Capture_st* cap, TIM_HandleTypeDef* htim);
+void Timer_Capture_Period_Elapsed(Capture_st* cap, TIM_HandleTypeDef* htim);
+void Timer_Capture_Update_Callback(Timer_st* tim, void* context);
+TIM_Ret_et Timer_Capture_Get_Result(Capture_st* cap, Capture_Result_st* result);
+
+#endif /* INC_TIM_CAPTURE_H_ */
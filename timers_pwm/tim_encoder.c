@@ -0,0 +1,187 @@
+/*
+ * tim_encoder.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Quadrature encoder interface.
+ *
+ *	The timer counts encoder edges in hardware, so position costs nothing per edge. The counter is extended to
+ *	64 bits by adding the signed difference to the previous counter value on every update, which needs no overflow
+ *	interrupt as long as the counter moves less than half its range between two updates.
+ *
+ *	Timer_Encoder_Update is the only writer of the extended position. Readers add the counter movement since
+ *	the last update themselves, so the position they see is exact to the edge.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "tim_encoder.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define MAX_IC_FILTER			(0xFU)
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Timers 1-5 and 8 have the encoder interface
+static uint8_t encoder_supported(Timer_st* tim) {
+	return (tim->tim_num <= 5) || (tim->tim_num == 8);
+}
+
+static uint32_t encoder_mode(Encoder_Mode_et mode) {
+	switch(mode) {
+		case(ENCODER_X2_TI1):
+			return TIM_ENCODERMODE_TI1;
+		case(ENCODER_X2_TI2):
+			return TIM_ENCODERMODE_TI2;
+		case(ENCODER_X4):
+		default:
+			return TIM_ENCODERMODE_TI12;
+	}
+}
+
+// Signed movement between two counter values, the shortest way around the counter range
+static int64_t count_delta(Encoder_st* enc, uint32_t from, uint32_t to) {
+	uint64_t range = (uint64_t)enc->tim->htim->Instance->ARR + 1;
+	int64_t delta = (int64_t)(((uint64_t)to + range - from) % range);
+
+	if ((uint64_t)delta >= (range / 2)) {
+		delta -= (int64_t)range;
+	}
+
+	return enc->is_inverted ? -delta : delta;
+}
+
+// Claims the channel A and B inputs
+static TIM_Ret_et claim_channels(Encoder_st* enc) {
+	if (Timer_Claim_Channel(enc->tim, 1, enc) != TIM_OK) { return TIM_CH_IN_USE; }
+	if (Timer_Claim_Channel(enc->tim, 2, enc) != TIM_OK) {
+		Timer_Release_Channel(enc->tim, 1, enc);
+		return TIM_CH_IN_USE;
+	}
+
+	return TIM_OK;
+}
+
+// Frees the channel A and B inputs
+static void release_channels(Encoder_st* enc) {
+	Timer_Release_Channel(enc->tim, 1, enc);
+	Timer_Release_Channel(enc->tim, 2, enc);
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timer_Encoder_Init switches the timer to encoder mode with the full counter range
+TIM_Ret_et Timer_Encoder_Init(Encoder_st* enc) {
+	TIM_Encoder_InitTypeDef sConfig = {0};
+	TIM_HandleTypeDef* htim = enc->tim->htim;
+
+	if (!enc->tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (!encoder_supported(enc->tim)) { return TIM_ENCODER_UNSUPPORTED; }
+	if (enc->update_hz == 0) { return TIM_FREQ_ZERO; }
+
+	if (claim_channels(enc) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	// Every edge counts and the whole counter range is used before wrapping
+	htim->Init.Prescaler = 0;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim->Init.Period = (uint32_t)(IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? (MAX_COUNTING_PERIOD_32BIT - 1) : (MAX_COUNTING_PERIOD_16BIT - 1));
+	htim->Init.RepetitionCounter = 0;
+
+	sConfig.EncoderMode = encoder_mode(enc->mode);
+	sConfig.IC1Polarity = TIM_ICPOLARITY_RISING;
+	sConfig.IC1Selection = TIM_ICSELECTION_DIRECTTI;
+	sConfig.IC1Prescaler = TIM_ICPSC_DIV1;
+	sConfig.IC1Filter = enc->filter & MAX_IC_FILTER;
+	sConfig.IC2Polarity = TIM_ICPOLARITY_RISING;
+	sConfig.IC2Selection = TIM_ICSELECTION_DIRECTTI;
+	sConfig.IC2Prescaler = TIM_ICPSC_DIV1;
+	sConfig.IC2Filter = enc->filter & MAX_IC_FILTER;
+	if (HAL_TIM_Encoder_Init(htim, &sConfig) != HAL_OK) {
+		release_channels(enc);
+		return TIM_ENCODER_CONFIG_FAIL;
+	}
+
+	Timer_Encoder_Set_Position(enc, 0);
+
+	return TIM_OK;
+}
+
+// Timer_Encoder_Start starts counting edges
+TIM_Ret_et Timer_Encoder_Start(Encoder_st* enc) {
+	// Timer_Encoder_Stop gave the inputs back
+	if (claim_channels(enc) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	if (HAL_TIM_Encoder_Start(enc->tim->htim, TIM_CHANNEL_ALL) != HAL_OK) { return TIM_ENCODER_START_FAIL; }
+
+	return TIM_OK;
+}
+
+// Timer_Encoder_Stop stops counting edges and frees the inputs, the position is kept
+TIM_Ret_et Timer_Encoder_Stop(Encoder_st* enc) {
+	if (HAL_TIM_Encoder_Stop(enc->tim->htim, TIM_CHANNEL_ALL) != HAL_OK) { return TIM_ENCODER_STOP_FAIL; }
+
+	release_channels(enc);
+
+	return TIM_OK;
+}
+
+// Timer_Encoder_Update extends the position and refreshes the velocity. Call it at update_hz from a timer interrupt
+void Timer_Encoder_Update(Encoder_st* enc) {
+	uint32_t count = enc->tim->htim->Instance->CNT;
+	uint16_t window = (enc->velocity_updates > 1) ? enc->velocity_updates : 1;
+	int64_t position = enc->__position + count_delta(enc, enc->__last_count, count);
+
+	// Odd sequence number while the position is being written. The barriers keep the 64 bit store between the increments
+	enc->__seq++;
+	__DMB();
+	enc->__position = position;
+	enc->__last_count = count;
+	__DMB();
+	enc->__seq++;
+
+	enc->__window_updates++;
+	if (enc->__window_updates >= window) {
+		enc->__velocity = (int32_t)(((position - enc->__window_start) * (int64_t)enc->update_hz) / window);
+		enc->__window_start = position;
+		enc->__window_updates = 0;
+	}
+}
+
+// Timer_Encoder_Get_Position returns the position in counts, including edges since the last update
+int64_t Timer_Encoder_Get_Position(Encoder_st* enc) {
+	uint32_t seq;
+	int64_t position;
+	uint32_t last_count;
+
+	// Retry if the update ran while the position was being copied
+	do {
+		seq = enc->__seq;
+		__DMB();
+		position = enc->__position;
+		last_count = enc->__last_count;
+		__DMB();
+	} while ((seq & 1U) || (seq != enc->__seq));
+
+	return position + count_delta(enc, last_count, enc->tim->htim->Instance->CNT);
+}
+
+// Timer_Encoder_Get_Velocity returns the velocity in counts per second measured by the last velocity window
+int32_t Timer_Encoder_Get_Velocity(Encoder_st* enc) {
+	return enc->__velocity;
+}
+
+// Timer_Encoder_Set_Position sets the current position (e.g. on an index pulse or homing switch). Must not be
+// interrupted by Timer_Encoder_Update
+void Timer_Encoder_Set_Position(Encoder_st* enc, int64_t position) {
+	enc->__seq++;
+	__DMB();
+	enc->__last_count = enc->tim->htim->Instance->CNT;
+	enc->__position = position;
+	__DMB();
+	enc->__seq++;
+
+	enc->__window_start = position;
+	enc->__window_updates = 0;
+	enc->__velocity = 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * tim_encoder.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIM_ENCODER_H_
+#define INC_TIM_ENCODER_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// Which encoder edges are counted
+typedef enum {
+	// Both edges of channel A (TI1), 2 counts per encoder line
+	ENCODER_X2_TI1 = 1,
+	// Both edges of channel B (TI2), 2 counts per encoder line
+	ENCODER_X2_TI2,
+	// Both edges of both channels, 4 counts per encoder line
+	ENCODER_X4,
+}Encoder_Mode_et;
+
+// Encoder_st counts a quadrature encoder on channels 1 (A) and 2 (B) of a timer in hardware
+typedef struct {
+	// Timer the encoder is wired to (1-5 or 8). Must be initialized (Timer_Init) without pwm or interrupts,
+	// the encoder takes over its prescaler and period
+	Timer_st* tim;
+	// Edges counted
+	Encoder_Mode_et mode;
+	// Digital input filter on both channels (0-15, see ICxF in the reference manual). 0 disables it
+	uint8_t filter;
+	// Reverses the counting direction
+	uint8_t is_inverted;
+	// Rate in Hz at which Timer_Encoder_Update is called. The counter must move less than half its range
+	// (32768 counts on 16 bit timers) between two updates
+	uint32_t update_hz;
+	// Number of updates the velocity is measured over (0 or 1 for every update). Longer gives finer low speed velocity
+	uint16_t velocity_updates;
+	// DO NOT WRITE. Position at the last update, 64 bit so it never wraps
+	int64_t __position;
+	// DO NOT WRITE. Counter value at the last update
+	uint32_t __last_count;
+	// DO NOT WRITE. Position at the start of the current velocity window and updates since then
+	int64_t __window_start;
+	uint16_t __window_updates;
+	// DO NOT WRITE. Latest velocity in counts per second
+	volatile int32_t __velocity;
+	// DO NOT WRITE. Incremented twice per update so readers can detect a torn copy
+	volatile uint32_t __seq;
+}Encoder_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timer_Encoder_Init(Encoder_st* enc);
+TIM_Ret_et Timer_Encoder_Start(Encoder_st* enc);
+TIM_Ret_et Timer_Encoder_Stop(Encoder_st* enc);
+void Timer_Encoder_Update(Encoder_st* enc);
+int64_t Timer_Encoder_Get_Position(Encoder_st* enc);
+int32_t Timer_Encoder_Get_Velocity(Encoder_st* enc);
+void Timer_Encoder_Set_Position(Encoder_st* enc, int64_t position);
+
+#endif /* INC_TIM_ENCODER_H_ */
@@ -0,0 +1,293 @@
+/*
+ * tim_profile.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Interrupt latency and jitter profiler.
+ *
+ *	The hardware event (update event, or the compare that triggered an adc conversion) happens at a known counter
+ *	value, so the counter latched at the start of the handler is the time since the event, however long the CPU took
+ *	to get there. Hardware events are exactly periodic, so the difference between the latencies of two consecutive
+ *	interrupts is the deviation of the interrupt period from the hardware period (period jitter) and no second
+ *	timer is needed.
+ *
+ *	Center aligned counters pass every count twice per period, the direction bit tells which pass it is. A compare
+ *	event happens on one pass only (the one where the trigger reference rises) and so does the update event when
+ *	an odd repetition counter skips every other end of the count. The latency is measured from that pass, or from
+ *	the last of the two when both interrupt.
+ *
+ *	Profiles live in a static buffer of TIM_PROFILE_MAX slots with TIM_PROFILE_BINS bins per histogram. Percentiles
+ *	resolve to the upper edge of a bin. Reading a profile while its interrupt runs may mix two consecutive records.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "tim_profile.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NS_PER_S				(1000000000ULL)
+#define PERMILLE				(1000U)
+#define CNT_UIFCPY				(1UL << 31)		// UIF copy in CNT while UIFREMAP is set
+
+/*----------PRIVATE VARIABLES----------*/
+
+static Tim_Profile_st profiles[TIM_PROFILE_MAX];
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Counts from the event at pos to the counter position p, both in [0, period)
+static uint64_t counts_since(uint64_t p, uint64_t pos, uint64_t period) {
+	return (p >= pos) ? (p - pos) : (p + period - pos);
+}
+
+// Adds a value to a histogram, the last bin also counts everything above the range
+static void hist_add(uint32_t hist[], uint32_t bin_ns, uint32_t ns) {
+	uint32_t bin = ns / bin_ns;
+
+	if (bin >= TIM_PROFILE_BINS) {
+		bin = TIM_PROFILE_BINS - 1;
+	}
+	hist[bin]++;
+}
+
+// Pass of a center aligned counter the event of config happens on
+static Tim_Profile_Edge_et event_edge(const Tim_Profile_Config_st* config) {
+	TIM_TypeDef* regs = config->tim->htim->Instance;
+	uint32_t mode;
+
+	if (config->edge != PROFILE_EDGE_AUTO) {
+		return config->edge;
+	}
+
+	if (config->event_chan == 0) {
+		// The repetition counter counts both ends from the bottom, an even number of them ends at the bottom again
+		if (IS_TIM_REPETITION_COUNTER_INSTANCE(regs) && ((regs->RCR & 1U) != 0)) {
+			return PROFILE_EDGE_DOWN;
+		}
+		return PROFILE_EDGE_BOTH;
+	}
+
+	// Pwm mode 1 is active below the compare so its reference rises counting down, pwm mode 2 counting up
+	mode = Timer_Get_OC_Mode(config->tim, config->event_chan);
+	if (mode == TIM_OCMODE_PWM1) {
+		return PROFILE_EDGE_DOWN;
+	}
+	if (mode == TIM_OCMODE_PWM2) {
+		return PROFILE_EDGE_UP;
+	}
+	return PROFILE_EDGE_BOTH;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timer_Profile_Attach takes a slot of the static profile buffer for an interrupt. Call it again after the timer
+// is retuned
+TIM_Ret_et Timer_Profile_Attach(const Tim_Profile_Config_st* config, Tim_Profile_st** profile) {
+	Tim_Profile_st* slot = NULL;
+	TIM_TypeDef* regs;
+	uint64_t arr;
+	uint32_t clk_hz;
+	uint8_t center;
+
+	if (!config->tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+	regs = config->tim->htim->Instance;
+	arr = regs->ARR;
+	clk_hz = Timer_Get_Clock_Freq(config->tim);
+	if ((clk_hz == 0) || (arr == 0) || (config->event_count > arr)) { return TIM_ERROR; }
+	if (config->event_chan > config->tim->__metadata.num_channels) { return TIM_CH_INVALID; }
+
+	for (uint8_t i = 0; i < TIM_PROFILE_MAX; i++) {
+		if (!profiles[i].__in_use) {
+			slot = &profiles[i];
+			break;
+		}
+	}
+	if (slot == NULL) { return TIM_PROFILE_FULL; }
+
+	slot->config = *config;
+	if (slot->config.bin_ns == 0) {
+		slot->config.bin_ns = TIM_PROFILE_DEFAULT_BIN_NS;
+	}
+	slot->__regs = regs;
+	slot->__ns_per_count_q16 = (((uint64_t)regs->PSC + 1) * NS_PER_S << 16) / clk_hz;
+
+	// Positions counted from the start of the period: the bottom of the count, or the top when counting down
+	center = ((regs->CR1 & TIM_CR1_CMS) != 0);
+	if (center) {
+		uint64_t up;
+		uint64_t down;
+
+		slot->__period_counts = 2 * arr;
+		if (config->event_chan == 0) {
+			// Update events: the top ends the way up, the bottom the way down
+			up = arr;
+			down = 0;
+		}
+		else {
+			up = config->event_count;
+			down = (config->event_count == 0) ? 0 : ((2 * arr) - config->event_count);
+		}
+
+		switch (event_edge(config)) {
+			case(PROFILE_EDGE_UP):
+				slot->__event_pos[0] = up;
+				slot->__event_pos[1] = up;
+				break;
+			case(PROFILE_EDGE_DOWN):
+				slot->__event_pos[0] = down;
+				slot->__event_pos[1] = down;
+				break;
+			case(PROFILE_EDGE_BOTH):
+			default:
+				slot->__event_pos[0] = up;
+				slot->__event_pos[1] = down;
+				break;
+		}
+	}
+	else {
+		slot->__period_counts = arr + 1;
+		if ((regs->CR1 & TIM_CR1_DIR) && (config->event_count != 0)) {
+			slot->__event_pos[0] = arr - config->event_count;
+		}
+		else {
+			slot->__event_pos[0] = config->event_count;
+		}
+		slot->__event_pos[1] = slot->__event_pos[0];
+	}
+
+	Timer_Profile_Reset(slot);
+	slot->__in_use = 1;
+	*profile = slot;
+
+	return TIM_OK;
+}
+
+// Timer_Profile_Detach frees the slot of a profile
+void Timer_Profile_Detach(Tim_Profile_st* profile) {
+	profile->__in_use = 0;
+}
+
+// Timer_Profile_Find returns the profile attached for a Timer_st / ADC_st, or NULL
+Tim_Profile_st* Timer_Profile_Find(const void* source) {
+	for (uint8_t i = 0; i < TIM_PROFILE_MAX; i++) {
+		if (profiles[i].__in_use && (profiles[i].config.source == source)) {
+			return &profiles[i];
+		}
+	}
+	return NULL;
+}
+
+// Timer_Profile_Entry records one interrupt. Call it first in the handler (TIM_PROFILE_ENTRY), everything before
+// the counter read adds to the measured latency
+void Timer_Profile_Entry(Tim_Profile_st* profile) {
+	TIM_TypeDef* regs = profile->__regs;
+	uint64_t cnt = regs->CNT;
+	uint32_t cr1 = regs->CR1;
+	uint64_t p;
+	uint64_t since_0;
+	uint64_t since_1;
+	uint64_t ns;
+	uint32_t latency;
+	uint32_t jitter;
+
+	if (cr1 & TIM_CR1_UIFREMAP) {
+		cnt &= ~CNT_UIFCPY;
+	}
+
+	// Position in the period, center aligned counters count the way down from 2 * ARR
+	p = cnt;
+	if (cr1 & TIM_CR1_DIR) {
+		p = (cr1 & TIM_CR1_CMS) ? (profile->__period_counts - cnt) : (profile->__period_counts - 1 - cnt);
+	}
+	if (p >= profile->__period_counts) {
+		p = 0;
+	}
+
+	// Both positions are the same unless both passes of a center aligned counter interrupt
+	since_0 = counts_since(p, profile->__event_pos[0], profile->__period_counts);
+	since_1 = counts_since(p, profile->__event_pos[1], profile->__period_counts);
+	ns = (((since_0 < since_1) ? since_0 : since_1) * profile->__ns_per_count_q16) >> 16;
+	latency = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+
+	hist_add(profile->__latency_hist, profile->config.bin_ns, latency);
+	if (latency < profile->__min_ns) {
+		profile->__min_ns = latency;
+	}
+	if (latency > profile->__max_ns) {
+		profile->__max_ns = latency;
+	}
+	profile->__sum_ns += latency;
+
+	if (profile->__count != 0) {
+		jitter = (latency > profile->__prev_ns) ? (latency - profile->__prev_ns) : (profile->__prev_ns - latency);
+		hist_add(profile->__jitter_hist, profile->config.bin_ns, jitter);
+		if (jitter > profile->__max_jitter_ns) {
+			profile->__max_jitter_ns = jitter;
+		}
+	}
+
+	profile->__prev_ns = latency;
+	profile->__count++;
+}
+
+// Timer_Profile_Reset clears the histograms and extremes of a profile
+void Timer_Profile_Reset(Tim_Profile_st* profile) {
+	for (uint16_t b = 0; b < TIM_PROFILE_BINS; b++) {
+		profile->__latency_hist[b] = 0;
+		profile->__jitter_hist[b] = 0;
+	}
+
+	profile->__prev_ns = 0;
+	profile->__min_ns = UINT32_MAX;
+	profile->__max_ns = 0;
+	profile->__max_jitter_ns = 0;
+	profile->__sum_ns = 0;
+	profile->__count = 0;
+}
+
+// Timer_Profile_Percentile returns the latency or jitter in nanoseconds that permille / 1000 of the interrupts stay
+// within (e.g. 990 for the 99th percentile). 0 if nothing was recorded
+uint32_t Timer_Profile_Percentile(Tim_Profile_st* profile, Tim_Profile_Hist_et hist, uint16_t permille) {
+	const uint32_t* bins = (hist == PROFILE_JITTER) ? profile->__jitter_hist : profile->__latency_hist;
+	uint32_t max_ns = (hist == PROFILE_JITTER) ? profile->__max_jitter_ns : profile->__max_ns;
+	uint64_t total = 0;
+	uint64_t target;
+	uint64_t sum = 0;
+
+	for (uint16_t b = 0; b < TIM_PROFILE_BINS; b++) {
+		total += bins[b];
+	}
+	if (total == 0) { return 0; }
+
+	if (permille > PERMILLE) {
+		permille = PERMILLE;
+	}
+	target = ((total * permille) + (PERMILLE - 1)) / PERMILLE;
+	if (target == 0) {
+		target = 1;
+	}
+
+	for (uint16_t b = 0; b < TIM_PROFILE_BINS; b++) {
+		sum += bins[b];
+		if (sum >= target) {
+			// The last bin is open ended, and no bin edge is above the largest value seen
+			if ((b == (TIM_PROFILE_BINS - 1)) || (((uint64_t)(b + 1) * profile->config.bin_ns) > max_ns)) {
+				return max_ns;
+			}
+			return (b + 1) * profile->config.bin_ns;
+		}
+	}
+
+	return max_ns;
+}
+
+// Timer_Profile_Get_Stats summarizes a profile
+void Timer_Profile_Get_Stats(Tim_Profile_st* profile, Tim_Profile_Stats_st* stats) {
+	stats->count = profile->__count;
+	stats->min_latency_ns = (stats->count != 0) ? profile->__min_ns : 0;
+	stats->mean_latency_ns = (stats->count != 0) ? (uint32_t)(profile->__sum_ns / stats->count) : 0;
+	stats->max_latency_ns = profile->__max_ns;
+	stats->max_jitter_ns = profile->__max_jitter_ns;
+}
@@ -0,0 +1,129 @@
+/*
+ * tim_profile.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIM_PROFILE_H_
+#define INC_TIM_PROFILE_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------MACROS & DEFINES------------*/
+
+// Set to 1 to compile TIM_PROFILE_ENTRY into the interrupt handlers
+#ifndef TIM_PROFILE_ENABLE
+#define TIM_PROFILE_ENABLE				(0U)
+#endif
+
+// Number of profiles in the static buffer
+#ifndef TIM_PROFILE_MAX
+#define TIM_PROFILE_MAX					(4U)
+#endif
+
+// Histogram bins per profile, the last bin also counts everything above the range
+#ifndef TIM_PROFILE_BINS
+#define TIM_PROFILE_BINS				(32U)
+#endif
+
+#define TIM_PROFILE_DEFAULT_BIN_NS		(100U)
+
+// First statement of a profiled interrupt handler. Compiles to nothing unless TIM_PROFILE_ENABLE is set
+#if TIM_PROFILE_ENABLE
+#define TIM_PROFILE_ENTRY(PROFILE)		Timer_Profile_Entry(PROFILE)
+#else
+#define TIM_PROFILE_ENTRY(PROFILE)		((void)0)
+#endif
+
+/*----------TYPEDEFS----------*/
+
+// Histogram of a profile
+typedef enum {
+	// Time from the hardware event to the profile entry
+	PROFILE_LATENCY = 1,
+	// Difference between the latencies of consecutive interrupts, the deviation of the interrupt period from the
+	// hardware period
+	PROFILE_JITTER,
+}Tim_Profile_Hist_et;
+
+// Pass of a center aligned counter on which the hardware event happens. Edge aligned counters pass once per period
+typedef enum {
+	// From the timer: the pwm mode of event_chan for a compare, the repetition counter for the update event
+	PROFILE_EDGE_AUTO = 0,
+	// Counting up: a compare in pwm mode 2 rising, the update event at the top of the count
+	PROFILE_EDGE_UP,
+	// Counting down: a compare in pwm mode 1 rising, the update event at the bottom of the count
+	PROFILE_EDGE_DOWN,
+	// Both passes interrupt, the latency is measured from the last one
+	PROFILE_EDGE_BOTH,
+}Tim_Profile_Edge_et;
+
+// Tim_Profile_Config_st describes the interrupt to profile
+typedef struct {
+	// Timer whose counter times the hardware event: the interrupting timer for update interrupts, the trigger timer
+	// for adc end of conversion interrupts. Must be initialized (Timer_Init) and keep its timing while profiled
+	Timer_st* tim;
+	// Owner of the interrupt (the Timer_st or ADC_st) used by Timer_Profile_Find
+	const void* source;
+	// Counter value of the hardware event. 0 is the update event. For adc conversions the trigger compare value
+	// (ADC_Sync_st __compare), the latency then includes the sampling and conversion time
+	uint32_t event_count;
+	// Channel whose compare is the hardware event (ADC_Sync_st trigger_chan), 0 for the update event
+	uint8_t event_chan;
+	// Pass of a center aligned counter the event happens on. With PROFILE_EDGE_AUTO the update event is at the
+	// bottom when the repetition counter is odd (Timer_Init with it_config), at both ends otherwise
+	Tim_Profile_Edge_et edge;
+	// Width of one histogram bin in nanoseconds (0 for TIM_PROFILE_DEFAULT_BIN_NS)
+	uint32_t bin_ns;
+}Tim_Profile_Config_st;
+
+// Tim_Profile_st is one slot of the static profile buffer
+typedef struct {
+	// Configuration given to Timer_Profile_Attach
+	Tim_Profile_Config_st config;
+	// DO NOT WRITE. Histograms
+	uint32_t __latency_hist[TIM_PROFILE_BINS];
+	uint32_t __jitter_hist[TIM_PROFILE_BINS];
+	// DO NOT WRITE. Counter registers, counts per hardware period, positions of the event in the period (the same
+	// twice unless both passes of a center aligned counter interrupt) and nanoseconds per count (Q16)
+	TIM_TypeDef* __regs;
+	uint64_t __period_counts;
+	uint64_t __event_pos[2];
+	uint64_t __ns_per_count_q16;
+	// DO NOT WRITE. Previous latency, extremes and running sum in nanoseconds
+	uint32_t __prev_ns;
+	uint32_t __min_ns;
+	uint32_t __max_ns;
+	uint32_t __max_jitter_ns;
+	uint64_t __sum_ns;
+	// DO NOT WRITE. Number of interrupts recorded
+	volatile uint32_t __count;
+	uint8_t __in_use;
+}Tim_Profile_st;
+
+// Tim_Profile_Stats_st summarizes a profile
+typedef struct {
+	// Number of interrupts recorded
+	uint32_t count;
+	// Smallest, mean and largest latency in nanoseconds
+	uint32_t min_latency_ns;
+	uint32_t mean_latency_ns;
+	uint32_t max_latency_ns;
+	// Largest jitter in nanoseconds
+	uint32_t max_jitter_ns;
+}Tim_Profile_Stats_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timer_Profile_Attach(const Tim_Profile_Config_st* config, Tim_Profile_st** profile);
+void Timer_Profile_Detach(Tim_Profile_st* profile);
+Tim_Profile_st* Timer_Profile_Find(const void* source);
+void Timer_Profile_Entry(Tim_Profile_st* profile);
+void Timer_Profile_Reset(Tim_Profile_st* profile);
+uint32_t Timer_Profile_Percentile(Tim_Profile_st* profile, Tim_Profile_Hist_et hist, uint16_t permille);
+void Timer_Profile_Get_Stats(Tim_Profile_st* profile, Tim_Profile_Stats_st* stats);
+
+#endif /* INC_TIM_PROFILE_H_ */
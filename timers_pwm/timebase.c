@@ -0,0 +1,116 @@
+/*
+ * timebase.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	64 bit monotonic timebase.
+ *
+ *	The update interrupt counts counter wraps. With UIFREMAP set, bit 31 of CNT is a copy of the update flag,
+ *	so one register read returns the counter together with a wrap that happened but has not been handled yet
+ *	(interrupts masked, or the reader running at the same priority as the timer interrupt). The wrap count is
+ *	read before and after the counter and the read is repeated if the interrupt ran in between, so readers never
+ *	lock, never write and never see time go backwards.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "timebase.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define US_PER_S				(1000000U)
+#define CNT_BITS_32BIT			(31U)		// bit 31 holds the UIF copy
+#define CNT_BITS_16BIT			(16U)
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timebase_Init sets the timer to count at tick_hz over its full range with the update flag copied into CNT
+TIM_Ret_et Timebase_Init(Timebase_st* tb) {
+	TIM_HandleTypeDef* htim = tb->tim->htim;
+	uint32_t clk_hz;
+
+	if (!tb->tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (tb->tim->__metadata.tim_type == BASIC_TIMER) { return TIM_ERROR; }
+
+	if (tb->tick_hz == 0) {
+		tb->tick_hz = TIMEBASE_DEFAULT_TICK_HZ;
+	}
+
+	// Whole ticks per microsecond and an exact prescaler keep the conversion to microseconds exact
+	clk_hz = Timer_Get_Clock_Freq(tb->tim);
+	if (((tb->tick_hz % US_PER_S) != 0) || (tb->tick_hz > clk_hz) || ((clk_hz % tb->tick_hz) != 0) ||
+		((clk_hz / tb->tick_hz) > MAX_PRESCALER)) {
+		return TIM_FREQ_INVALID;
+	}
+
+	tb->__bits = IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? CNT_BITS_32BIT : CNT_BITS_16BIT;
+	tb->__ticks_per_us = tb->tick_hz / US_PER_S;
+	tb->__wraps = 0;
+
+	htim->Init.Prescaler = (clk_hz / tb->tick_hz) - 1;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	// Also seen by the update interrupt dispatch, which skips every other update of center aligned timers
+	tb->tim->count_mode = COUNT_UP;
+	htim->Init.Period = (uint32_t)((1ULL << tb->__bits) - 1);
+	htim->Init.RepetitionCounter = 0;
+	htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(htim) != HAL_OK) { return TIM_BASE_INIT_FAIL; }
+
+	__HAL_TIM_UIFREMAP_ENABLE(htim);
+
+	return TIM_OK;
+}
+
+// Timebase_Start starts counting from 0
+TIM_Ret_et Timebase_Start(Timebase_st* tb) {
+	tb->tim->htim->Instance->CNT = 0;
+	tb->__wraps = 0;
+	// The update event of the base init left UIF set, it would count a wrap as soon as the interrupt is enabled
+	__HAL_TIM_CLEAR_FLAG(tb->tim->htim, TIM_FLAG_UPDATE);
+
+	if (HAL_TIM_Base_Start_IT(tb->tim->htim) != HAL_OK) { return TIM_BASE_START_IT_FAIL; }
+
+	return TIM_OK;
+}
+
+// Timebase_Now_Ticks returns the ticks since Timebase_Start. Safe from any context at or below the timer priority
+uint64_t Timebase_Now_Ticks(Timebase_st* tb) {
+	uint64_t wraps;
+	uint32_t cnt;
+
+	// The 64 bit wrap count takes two loads, an interrupt between them (or between it and the counter read) changes
+	// it and the read is repeated. Wraps are far apart so the second read is always consistent
+	do {
+		wraps = tb->__wraps;
+		cnt = tb->tim->htim->Instance->CNT;
+	} while (wraps != tb->__wraps);
+
+	// A pending update flag is a wrap the interrupt has not counted yet
+	if (cnt & TIM_CNT_UIFCPY) {
+		wraps++;
+	}
+	cnt &= (uint32_t)((1ULL << tb->__bits) - 1);
+
+	return (wraps << tb->__bits) | cnt;
+}
+
+// Timebase_Now_Us returns the microseconds since Timebase_Start
+uint64_t Timebase_Now_Us(Timebase_st* tb) {
+	uint64_t ticks = Timebase_Now_Ticks(tb);
+
+	return (tb->__ticks_per_us == 1) ? ticks : (ticks / tb->__ticks_per_us);
+}
+
+// Timebase_Period_Elapsed counts one wrap. Called from the update interrupt of tb->tim
+void Timebase_Period_Elapsed(Timebase_st* tb, TIM_HandleTypeDef* htim) {
+	if (htim != tb->tim->htim) {
+		return;
+	}
+
+	tb->__wraps++;
+}
+
+// Timebase_Callback is Timebase_Period_Elapsed as a Timer_Callback_ft, context is the Timebase_st
+void Timebase_Callback(Timer_st* tim, void* context) {
+	Timebase_Period_Elapsed((Timebase_st*)context, tim->htim);
+}
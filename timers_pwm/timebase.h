@@ -0,0 +1,48 @@
+/*
+ * timebase.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------MACROS & DEFINES------------*/
+
+#define TIMEBASE_DEFAULT_TICK_HZ		(1000000U)	// 1 tick = 1 us, Timebase_Now_Us is then a plain read
+
+/*----------TYPEDEFS----------*/
+
+// Timebase_st extends a free running timer to a 64 bit monotonic time. The timer interrupt must have the highest
+// priority of all code reading the time (readers at the same or lower priority are always safe)
+typedef struct {
+	// Free running timer, 32 bit timers (2 and 5) interrupt the least. Must be initialized (Timer_Init) without pwm and
+	// with it_config.en_it, the timebase takes over its prescaler, period and update interrupt. Register
+	// Timebase_Callback on it (Timer_Register_Callback) after Timebase_Init
+	Timer_st* tim;
+	// Tick rate in Hz, a whole number of MHz that divides the timer clock (0 for TIMEBASE_DEFAULT_TICK_HZ)
+	uint32_t tick_hz;
+	// DO NOT WRITE. Number of counter wraps handled by the interrupt. 64 bit so 16 bit timers do not run out after
+	// 2^32 wraps, read by Timebase_Now_Ticks without masking interrupts
+	volatile uint64_t __wraps;
+	// DO NOT WRITE. Counter bits below the UIF copy (31 for 32 bit timers, 16 otherwise)
+	uint8_t __bits;
+	// DO NOT WRITE. Ticks per microsecond
+	uint32_t __ticks_per_us;
+}Timebase_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timebase_Init(Timebase_st* tb);
+TIM_Ret_et Timebase_Start(Timebase_st* tb);
+uint64_t Timebase_Now_Ticks(Timebase_st* tb);
+uint64_t Timebase_Now_Us(Timebase_st* tb);
+void Timebase_Period_Elapsed(Timebase_st* tb, TIM_HandleTypeDef* htim);
+void Timebase_Callback(Timer_st* tim, void* context);
+
+#endif /* INC_TIMEBASE_H_ */
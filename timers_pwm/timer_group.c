@@ -0,0 +1,228 @@
+/*
+ * timer_group.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Master / slave timer groups.
+ *
+ *	The master drives its trigger output (TRGO) and every slave selects the internal trigger line (ITRx) that is
+ *	wired to the master. Starting the group only sets the master's enable bit, the slaves start from the trigger
+ *	in hardware so all counters begin on the same timer clock cycle.
+ *
+ *	Internal trigger connections (RM0385, TIMx internal trigger connection):
+ *		slave	ITR0	ITR1	ITR2	ITR3
+ *		tim1	tim5	tim2	tim3	tim4
+ *		tim2	tim1	tim8	tim3	tim4
+ *		tim3	tim1	tim2	tim5	tim4
+ *		tim4	tim1	tim2	tim3	tim8
+ *		tim5	tim2	tim3	tim4	tim8
+ *		tim8	tim1	tim2	tim4	tim5
+ *		tim9	tim2	tim3	-		-
+ *		tim12	tim4	tim5	-		-
+ *	(ITR2/ITR3 of tim9 and tim12 come from the compare outputs of tim10/11 and tim13/14, not from TRGO)
+*/
+
+/*----------INCLUDES----------*/
+
+#include "timer_group.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define NUM_ITR					(4U)
+
+/*----------PRIVATE VARIABLES----------*/
+
+// Master timer number on each ITRx line of every slave timer, 0 if not connected
+static const uint8_t itr_masters[MAX_TIM_NUM + 1][NUM_ITR] = {
+	[1] = { 5, 2, 3, 4 },
+	[2] = { 1, 8, 3, 4 },
+	[3] = { 1, 2, 5, 4 },
+	[4] = { 1, 2, 3, 8 },
+	[5] = { 2, 3, 4, 8 },
+	[8] = { 1, 2, 4, 5 },
+	[9] = { 2, 3, 0, 0 },
+	[12] = { 4, 5, 0, 0 },
+};
+
+static const uint32_t itr_trigger[NUM_ITR] = { TIM_TS_ITR0, TIM_TS_ITR1, TIM_TS_ITR2, TIM_TS_ITR3 };
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// Finds the internal trigger of the slave that is wired to the master
+static TIM_Ret_et find_itr(uint8_t slave_num, uint8_t master_num, uint32_t* input_trigger) {
+	if ((slave_num == 0) || (slave_num > MAX_TIM_NUM)) {
+		return TIM_NUM_INVALID;
+	}
+
+	for (uint8_t i = 0; i < NUM_ITR; i++) {
+		if (itr_masters[slave_num][i] == master_num) {
+			*input_trigger = itr_trigger[i];
+			return TIM_OK;
+		}
+	}
+
+	return TIM_SYNC_UNSUPPORTED;
+}
+
+// Master trigger output needed by each slave mode
+static uint32_t master_trigger(Tim_Slave_Mode_et mode) {
+	switch(mode) {
+		case(SLAVE_TRIGGER):
+			return TIM_TRGO_ENABLE;
+		case(SLAVE_GATED):
+			return TIM_TRGO_OC1REF;
+		case(SLAVE_RESET):
+		case(SLAVE_CASCADE):
+		default:
+			return TIM_TRGO_UPDATE;
+	}
+}
+
+// Slave mode register setting for each slave mode
+static uint32_t slave_mode(Tim_Slave_Mode_et mode) {
+	switch(mode) {
+		case(SLAVE_RESET):
+			// Start on the first trigger, then reset on every following one
+			return TIM_SLAVEMODE_COMBINED_RESETTRIGGER;
+		case(SLAVE_GATED):
+			return TIM_SLAVEMODE_GATED;
+		case(SLAVE_CASCADE):
+			// Master update events clock the slave counter
+			return TIM_SLAVEMODE_EXTERNAL1;
+		case(SLAVE_TRIGGER):
+		default:
+			return TIM_SLAVEMODE_TRIGGER;
+	}
+}
+
+// Loads a stopped counter. The prescaler and repetition counters restart too (update event without an interrupt),
+// and a center aligned counter gets its direction reset to up, which can only be written while edge aligned
+static void counter_load(TIM_TypeDef* regs, uint32_t count) {
+	uint32_t urs = regs->CR1 & TIM_CR1_URS;
+	uint32_t cms = regs->CR1 & TIM_CR1_CMS;
+
+	regs->CR1 |= TIM_CR1_URS;
+	regs->EGR = TIM_EGR_UG;
+	regs->CR1 = (regs->CR1 & ~TIM_CR1_URS) | urs;
+
+	if (cms != 0) {
+		regs->CR1 &= ~(TIM_CR1_CMS | TIM_CR1_DIR);
+		regs->CR1 |= cms;
+	}
+
+	regs->CNT = count;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timer_Group_Init connects every slave to the master. The counters are stopped until Timer_Group_Start
+TIM_Ret_et Timer_Group_Init(Timer_Group_st* group) {
+	TIM_MasterConfigTypeDef sMasterConfig = {0};
+	TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+	uint32_t input_trigger = 0;
+	TIM_Ret_et ret;
+
+	if (!group->master->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if ((group->mode == SLAVE_CASCADE) && (group->master->htim->Init.CounterMode != TIM_COUNTERMODE_UP)) {
+		return TIM_COUNT_MODE_UNSUPPORTED;
+	}
+
+	// Check every slave before anything is changed
+	for (uint8_t i = 0; i < group->num_slaves; i++) {
+		if (!group->slaves[i]->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+		ret = find_itr(group->slaves[i]->tim_num, group->master->tim_num, &input_trigger);
+		if (ret != TIM_OK) {
+			return ret;
+		}
+	}
+
+	Timer_Group_Stop(group);
+
+	// Master / slave mode delays the master by the trigger latency so it stays in step with its slaves
+	sMasterConfig.MasterOutputTrigger = master_trigger(group->mode);
+	sMasterConfig.MasterOutputTrigger2 = TIM_TRGO2_RESET;
+	sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_ENABLE;
+	if (HAL_TIMEx_MasterConfigSynchronization(group->master->htim, &sMasterConfig) != HAL_OK) { return TIM_MASTER_CONFIG_FAIL; }
+
+	sSlaveConfig.SlaveMode = slave_mode(group->mode);
+	sSlaveConfig.TriggerPolarity = TIM_TRIGGERPOLARITY_NONINVERTED;
+	sSlaveConfig.TriggerPrescaler = TIM_TRIGGERPRESCALER_DIV1;
+	sSlaveConfig.TriggerFilter = 0;
+
+	for (uint8_t i = 0; i < group->num_slaves; i++) {
+		TIM_HandleTypeDef* htim = group->slaves[i]->htim;
+
+		find_itr(group->slaves[i]->tim_num, group->master->tim_num, &input_trigger);
+		sSlaveConfig.InputTrigger = input_trigger;
+		if (HAL_TIM_SlaveConfigSynchro(htim, &sSlaveConfig) != HAL_OK) { return TIM_SLAVE_CONFIG_FAIL; }
+
+		// A cascaded slave counts master periods one by one over its whole range
+		if (group->mode == SLAVE_CASCADE) {
+			htim->Init.Prescaler = 0;
+			htim->Init.Period = (uint32_t)(IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? (MAX_COUNTING_PERIOD_32BIT - 1) : (MAX_COUNTING_PERIOD_16BIT - 1));
+			__HAL_TIM_SET_PRESCALER(htim, htim->Init.Prescaler);
+			__HAL_TIM_SET_AUTORELOAD(htim, htim->Init.Period);
+			// Load the prescaler now without raising an update interrupt
+			__HAL_TIM_URS_ENABLE(htim);
+			htim->Instance->EGR = TIM_EGR_UG;
+		}
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Group_Start loads every counter (0 or start_counts) and starts the group. Slaves started by the trigger begin on the same
+// timer clock cycle as the master. Gated and cascaded slaves are enabled first and only count once the master runs
+TIM_Ret_et Timer_Group_Start(Timer_Group_st* group) {
+	TIM_TypeDef* master = group->master->htim->Instance;
+
+	if (!group->master->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+	Timer_Group_Stop(group);
+
+	counter_load(master, 0);
+	for (uint8_t i = 0; i < group->num_slaves; i++) {
+		counter_load(group->slaves[i]->htim->Instance, (group->start_counts != NULL) ? group->start_counts[i] : 0);
+
+		if ((group->mode == SLAVE_GATED) || (group->mode == SLAVE_CASCADE)) {
+			__HAL_TIM_ENABLE(group->slaves[i]->htim);
+		}
+	}
+
+	// Trigger mode slaves see the enable directly, reset mode slaves need an update event to start
+	master->CR1 |= TIM_CR1_CEN;
+	if (group->mode == SLAVE_RESET) {
+		master->EGR = TIM_EGR_UG;
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Group_Stop stops the counters of the master and every slave. Outputs keep their current level
+TIM_Ret_et Timer_Group_Stop(Timer_Group_st* group) {
+	__HAL_TIM_DISABLE(group->master->htim);
+
+	for (uint8_t i = 0; i < group->num_slaves; i++) {
+		__HAL_TIM_DISABLE(group->slaves[i]->htim);
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Group_Read_Cascade returns the combined count of the master and a cascaded slave in master timer ticks
+uint64_t Timer_Group_Read_Cascade(Timer_Group_st* group, uint8_t slave_index) {
+	TIM_TypeDef* master = group->master->htim->Instance;
+	TIM_TypeDef* slave = group->slaves[slave_index]->htim->Instance;
+	uint64_t counting_period = (uint64_t)master->ARR + 1;
+	uint32_t high;
+	uint32_t low;
+
+	// Re-read if the master wrapped between the two reads
+	do {
+		high = slave->CNT;
+		low = master->CNT;
+	} while (high != slave->CNT);
+
+	return ((uint64_t)high * counting_period) + low;
+}
@@ -0,0 +1,50 @@
+/*
+ * timer_group.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIMER_GROUP_H_
+#define INC_TIMER_GROUP_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------TYPEDEFS----------*/
+
+// How the slaves of a group follow the master (through the internal ITRx trigger lines)
+typedef enum {
+	// Slaves start on the same clock cycle as the master. Phase stays locked as long as the periods are related
+	SLAVE_TRIGGER = 1,
+	// Slaves start with the master and their counters are reset at every master update, correcting any drift
+	SLAVE_RESET,
+	// Slaves only count while the master's channel 1 reference (OC1REF) is high
+	SLAVE_GATED,
+	// Slaves count master update events, extending the master into a 32 bit (or wider) counter
+	SLAVE_CASCADE,
+}Tim_Slave_Mode_et;
+
+// Timer_Group_st chains slave timers to one master timer
+typedef struct {
+	// Master timer. Must be initialized (Timer_Init) and count up for SLAVE_CASCADE
+	Timer_st* master;
+	// Array of slave timers. Must be initialized (Timer_Init). Basic timers (6 and 7) cannot be slaves
+	Timer_st** slaves;
+	// Number of slaves in the array
+	uint8_t num_slaves;
+	// How every slave follows the master
+	Tim_Slave_Mode_et mode;
+	// Optional counter value of each slave when the group starts, offsetting its phase. NULL starts every slave at 0
+	const uint32_t* start_counts;
+}Timer_Group_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timer_Group_Init(Timer_Group_st* group);
+TIM_Ret_et Timer_Group_Start(Timer_Group_st* group);
+TIM_Ret_et Timer_Group_Stop(Timer_Group_st* group);
+uint64_t Timer_Group_Read_Cascade(Timer_Group_st* group, uint8_t slave_index);
+
+#endif /* INC_TIMER_GROUP_H_ */
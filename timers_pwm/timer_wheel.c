@@ -0,0 +1,351 @@
+/*
+ * timer_wheel.c
+ *
+ *  Created on: October 18, 2026
+ *
+ *	Hierarchical timer wheel on one hardware timer.
+ *
+ *	Level L of the wheel has 64 slots of 64^L ticks each. An event goes into the lowest level whose span covers
+ *	its delay, and higher level slots are moved down a level ("cascaded") when their time comes, so adding,
+ *	cancelling and expiring an event are all O(1). A 64 bit word per level marks the busy slots, so the next
+ *	deadline is found with one count-trailing-zeros per level.
+ *
+ *	The wheel is tickless: the compare register is set to the next deadline (at most half the counter range
+ *	ahead, so elapsed time can always be recovered from the counter) and the interrupt only runs when an event
+ *	is due or a slot has to be cascaded.
+*/
+
+/*----------INCLUDES----------*/
+
+#include "timer_wheel.h"
+
+/*----------PRIVATE MACROS----------*/
+
+#define LEVEL_SHIFT(LEVEL)		((LEVEL) * TIMER_WHEEL_SLOT_BITS)
+#define SLOT_MASK				(TIMER_WHEEL_SLOTS - 1U)
+// Longest delay the wheel can place directly, longer ones are parked in the top level and placed again later
+#define WHEEL_SPAN				(1ULL << LEVEL_SHIFT(TIMER_WHEEL_LEVELS))
+#define NO_DEADLINE				(UINT64_MAX)
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const uint32_t it_sources[4] = { TIM_IT_CC1, TIM_IT_CC2, TIM_IT_CC3, TIM_IT_CC4 };
+static const uint32_t cc_events[4] = { TIM_EVENTSOURCE_CC1, TIM_EVENTSOURCE_CC2, TIM_EVENTSOURCE_CC3, TIM_EVENTSOURCE_CC4 };
+static const HAL_TIM_ActiveChannel active_channels[4] = {
+	HAL_TIM_ACTIVE_CHANNEL_1, HAL_TIM_ACTIVE_CHANNEL_2, HAL_TIM_ACTIVE_CHANNEL_3, HAL_TIM_ACTIVE_CHANNEL_4
+};
+
+/*----------PRIVATE FUNCTION DEFINITIONS----------*/
+
+// The slot lists are shared with the compare interrupt, mask it while they change
+static void wheel_lock(Timer_Wheel_st* wheel) {
+	__HAL_TIM_DISABLE_IT(wheel->tim->htim, it_sources[wheel->chan_num - 1]);
+}
+
+static void wheel_unlock(Timer_Wheel_st* wheel) {
+	__HAL_TIM_ENABLE_IT(wheel->tim->htim, it_sources[wheel->chan_num - 1]);
+}
+
+static uint64_t rotate_right(uint64_t x, uint32_t n) {
+	n &= 63U;
+	return (n == 0) ? x : ((x >> n) | (x << (64U - n)));
+}
+
+// Ticks since __last_count, the counter wraps at most once in between
+static uint32_t ticks_elapsed(Timer_Wheel_st* wheel) {
+	uint64_t range = (uint64_t)wheel->tim->htim->Instance->ARR + 1;
+
+	return (uint32_t)(((uint64_t)wheel->tim->htim->Instance->CNT + range - wheel->__last_count) % range);
+}
+
+// Links an event into the slot of the lowest level that covers its delay from __now
+static void insert(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event) {
+	uint64_t delta = event->__expires - wheel->__now;
+	uint64_t place = event->__expires;
+	uint8_t level = 0;
+	uint8_t slot;
+
+	if (delta >= WHEEL_SPAN) {
+		place = wheel->__now + WHEEL_SPAN - 1;
+		delta = WHEEL_SPAN - 1;
+	}
+	while ((level < (TIMER_WHEEL_LEVELS - 1)) && (delta >= (1ULL << LEVEL_SHIFT(level + 1)))) {
+		level++;
+	}
+	slot = (uint8_t)((place >> LEVEL_SHIFT(level)) & SLOT_MASK);
+
+	event->__prev = NULL;
+	event->__next = wheel->__slots[level][slot];
+	if (event->__next != NULL) {
+		event->__next->__prev = event;
+	}
+	wheel->__slots[level][slot] = event;
+	wheel->__busy[level] |= (1ULL << slot);
+
+	event->__level = level;
+	event->__slot = slot;
+	event->__pending = 1;
+}
+
+static void unlink(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event) {
+	if (event->__prev != NULL) {
+		event->__prev->__next = event->__next;
+	}
+	else {
+		wheel->__slots[event->__level][event->__slot] = event->__next;
+	}
+	if (event->__next != NULL) {
+		event->__next->__prev = event->__prev;
+	}
+	if (wheel->__slots[event->__level][event->__slot] == NULL) {
+		wheel->__busy[event->__level] &= ~(1ULL << event->__slot);
+	}
+
+	event->__pending = 0;
+}
+
+// Time at which the next busy slot of a level is due. Level 0 slots hold events expiring at exactly that tick,
+// higher level slots are due when they have to be cascaded (always strictly after __now)
+static uint64_t level_deadline(Timer_Wheel_st* wheel, uint8_t level) {
+	uint32_t shift = LEVEL_SHIFT(level);
+	uint64_t base = wheel->__now >> shift;
+	uint32_t current = (uint32_t)(base & SLOT_MASK);
+
+	if (wheel->__busy[level] == 0) {
+		return NO_DEADLINE;
+	}
+	if (level == 0) {
+		return wheel->__now + (uint64_t)__builtin_ctzll(rotate_right(wheel->__busy[0], current));
+	}
+	return (base + (uint64_t)__builtin_ctzll(rotate_right(wheel->__busy[level], current + 1)) + 1) << shift;
+}
+
+static uint64_t next_deadline(Timer_Wheel_st* wheel) {
+	uint64_t next = NO_DEADLINE;
+
+	for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		uint64_t t = level_deadline(wheel, level);
+
+		if (t < next) {
+			next = t;
+		}
+	}
+	return next;
+}
+
+// Handles every slot due up to target in time order, then moves __now to target
+static void expire_until(Timer_Wheel_st* wheel, uint64_t target) {
+	uint64_t deadlines[TIMER_WHEEL_LEVELS];
+	Timer_Wheel_Event_st* event;
+	uint64_t t;
+
+	wheel->__expiring = 1;
+
+	for (;;) {
+		t = NO_DEADLINE;
+		for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			deadlines[level] = level_deadline(wheel, level);
+			if (deadlines[level] < t) {
+				t = deadlines[level];
+			}
+		}
+		if (t > target) {
+			break;
+		}
+
+		wheel->__now = t;
+
+		// Cascade from the top so events moved down can still expire on this tick
+		for (uint8_t level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+			uint8_t slot = (uint8_t)((t >> LEVEL_SHIFT(level)) & SLOT_MASK);
+
+			if (deadlines[level] != t) {
+				continue;
+			}
+			while ((event = wheel->__slots[level][slot]) != NULL) {
+				unlink(wheel, event);
+				insert(wheel, event);
+			}
+		}
+
+		// Every level 0 event left in this slot expires now. Periodic events are re-armed before the callback
+		// so the callback may cancel them
+		while ((event = wheel->__slots[0][t & SLOT_MASK]) != NULL) {
+			unlink(wheel, event);
+			if (event->period_ticks != 0) {
+				event->__expires += event->period_ticks;
+				insert(wheel, event);
+			}
+			event->callback(event->context);
+		}
+	}
+
+	wheel->__now = target;
+	wheel->__expiring = 0;
+}
+
+// Sets the compare register to the next deadline and returns the delay programmed from __last_count
+static uint32_t program_compare(Timer_Wheel_st* wheel) {
+	TIM_HandleTypeDef* htim = wheel->tim->htim;
+	uint64_t range = (uint64_t)htim->Instance->ARR + 1;
+	uint64_t next = next_deadline(wheel);
+	uint64_t delay = (next == NO_DEADLINE) ? wheel->__max_sleep : (next - wheel->__now);
+
+	if (delay > wheel->__max_sleep) {
+		delay = wheel->__max_sleep;
+	}
+
+	__HAL_TIM_SET_COMPARE(htim, TIM_HAL_CHANNEL(wheel->chan_num), (uint32_t)((wheel->__last_count + delay) % range));
+
+	return (uint32_t)delay;
+}
+
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+
+// Timer_Wheel_Init sets the timer to count at tick_hz over its full range and empties the wheel
+TIM_Ret_et Timer_Wheel_Init(Timer_Wheel_st* wheel) {
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	TIM_HandleTypeDef* htim = wheel->tim->htim;
+	uint32_t clk_hz;
+	uint32_t prescaler;
+
+	if (!wheel->tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if ((wheel->chan_num == 0) || (wheel->chan_num > wheel->tim->__metadata.num_channels)) { return TIM_CH_INVALID; }
+	if (wheel->tick_hz == 0) { return TIM_FREQ_ZERO; }
+
+	clk_hz = Timer_Get_Clock_Freq(wheel->tim);
+	prescaler = clk_hz / wheel->tick_hz;
+	if ((prescaler == 0) || (prescaler > MAX_PRESCALER)) { return TIM_FREQ_INVALID; }
+	if (Timer_Claim_Channel(wheel->tim, wheel->chan_num, wheel) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	htim->Init.Prescaler = prescaler - 1;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim->Init.Period = (uint32_t)(IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? (MAX_COUNTING_PERIOD_32BIT - 1) : (MAX_COUNTING_PERIOD_16BIT - 1));
+	htim->Init.RepetitionCounter = 0;
+	if (HAL_TIM_OC_Init(htim) != HAL_OK) {
+		Timer_Release_Channel(wheel->tim, wheel->chan_num, wheel);
+		return TIM_OC_CONFIG_FAIL;
+	}
+
+	// Compare only raises the interrupt, no pin is driven. No preload so a new deadline applies immediately
+	sConfigOC.OCMode = TIM_OCMODE_TIMING;
+	sConfigOC.Pulse = 0;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	if (HAL_TIM_OC_ConfigChannel(htim, &sConfigOC, TIM_HAL_CHANNEL(wheel->chan_num)) != HAL_OK) {
+		Timer_Release_Channel(wheel->tim, wheel->chan_num, wheel);
+		return TIM_OC_CONFIG_FAIL;
+	}
+
+	wheel->__tick_hz = clk_hz / prescaler;
+	wheel->__max_sleep = (uint32_t)(((uint64_t)htim->Init.Period + 1) / 2);
+	wheel->__now = 0;
+	wheel->__last_count = 0;
+	wheel->__expiring = 0;
+	for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		for (uint8_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+			wheel->__slots[level][slot] = NULL;
+		}
+		wheel->__busy[level] = 0;
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Wheel_Start starts the counter and the deadline interrupt. Events may be added before or after
+TIM_Ret_et Timer_Wheel_Start(Timer_Wheel_st* wheel) {
+	// Timer_Wheel_Stop gave the channel back
+	if (Timer_Claim_Channel(wheel->tim, wheel->chan_num, wheel) != TIM_OK) { return TIM_CH_IN_USE; }
+
+	wheel_lock(wheel);
+	wheel->__last_count = wheel->tim->htim->Instance->CNT;
+	program_compare(wheel);
+	wheel_unlock(wheel);
+
+	if (HAL_TIM_OC_Start_IT(wheel->tim->htim, TIM_HAL_CHANNEL(wheel->chan_num)) != HAL_OK) { return TIM_OC_START_FAIL; }
+
+	return TIM_OK;
+}
+
+// Timer_Wheel_Stop stops the counter and the deadline interrupt and frees the channel. Pending events stay in the
+// wheel but do not expire until Timer_Wheel_Init empties it
+TIM_Ret_et Timer_Wheel_Stop(Timer_Wheel_st* wheel) {
+	if (HAL_TIM_OC_Stop_IT(wheel->tim->htim, TIM_HAL_CHANNEL(wheel->chan_num)) != HAL_OK) { return TIM_OC_STOP_FAIL; }
+
+	Timer_Release_Channel(wheel->tim, wheel->chan_num, wheel);
+
+	return TIM_OK;
+}
+
+// Timer_Wheel_Add (re)schedules an event delay_ticks from now (minimum 1). Called from a callback, the delay
+// counts from the tick the callback was due, so chained events do not drift
+void Timer_Wheel_Add(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event, uint32_t delay_ticks) {
+	uint32_t elapsed;
+
+	if (delay_ticks == 0) {
+		delay_ticks = 1;
+	}
+
+	wheel_lock(wheel);
+
+	if (event->__pending) {
+		unlink(wheel, event);
+	}
+
+	elapsed = wheel->__expiring ? 0 : ticks_elapsed(wheel);
+	event->__expires = wheel->__now + elapsed + delay_ticks;
+	insert(wheel, event);
+
+	// The interrupt reprograms the compare itself once it is done expiring
+	if (!wheel->__expiring) {
+		if (program_compare(wheel) <= (ticks_elapsed(wheel) + 1)) {
+			// Too close to be caught by the compare, raise the interrupt directly
+			wheel->tim->htim->Instance->EGR = cc_events[wheel->chan_num - 1];
+		}
+	}
+
+	wheel_unlock(wheel);
+}
+
+// Timer_Wheel_Cancel removes an event if it is pending
+void Timer_Wheel_Cancel(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event) {
+	wheel_lock(wheel);
+	if (event->__pending) {
+		unlink(wheel, event);
+	}
+	wheel_unlock(wheel);
+}
+
+// Timer_Wheel_Is_Pending returns a boolean to see if an event is still waiting to expire
+uint8_t Timer_Wheel_Is_Pending(Timer_Wheel_Event_st* event) {
+	return event->__pending;
+}
+
+// Timer_Wheel_Now returns the current time in ticks since Timer_Wheel_Init
+uint64_t Timer_Wheel_Now(Timer_Wheel_st* wheel) {
+	uint64_t now;
+
+	wheel_lock(wheel);
+	now = wheel->__now + (wheel->__expiring ? 0 : ticks_elapsed(wheel));
+	wheel_unlock(wheel);
+
+	return now;
+}
+
+// Timer_Wheel_Callback expires every due event. Call it from HAL_TIM_OC_DelayElapsedCallback
+void Timer_Wheel_Callback(Timer_Wheel_st* wheel, TIM_HandleTypeDef* htim) {
+	uint32_t delay;
+
+	if ((htim != wheel->tim->htim) || (htim->Channel != active_channels[wheel->chan_num - 1])) {
+		return;
+	}
+
+	// Go around again if the next deadline already passed while the callbacks ran
+	do {
+		uint32_t elapsed = ticks_elapsed(wheel);
+
+		wheel->__last_count = (uint32_t)((wheel->__last_count + (uint64_t)elapsed) % ((uint64_t)htim->Instance->ARR + 1));
+		expire_until(wheel, wheel->__now + elapsed);
+		delay = program_compare(wheel);
+	} while (ticks_elapsed(wheel) >= delay);
+}
@@ -0,0 +1,85 @@
+/*
+ * timer_wheel.h
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef INC_TIMER_WHEEL_H_
+#define INC_TIMER_WHEEL_H_
+
+/*----------INCLUDES----------*/
+
+#include <stdint.h>
+#include "timers_pwm.h"
+
+/*----------MACROS & DEFINES------------*/
+
+#define TIMER_WHEEL_LEVELS				(4U)
+#define TIMER_WHEEL_SLOT_BITS			(6U)
+#define TIMER_WHEEL_SLOTS				(1U << TIMER_WHEEL_SLOT_BITS)	// 64 slots so one 64 bit word marks the busy ones
+
+// Converts a time in microseconds to wheel ticks
+#define TIMER_WHEEL_US_TO_TICKS(TICK_HZ, US)	((uint32_t)(((uint64_t)(US) * (TICK_HZ)) / 1000000U))
+
+/*----------TYPEDEFS----------*/
+
+typedef void (*Timer_Wheel_Callback_ft)(void* context);
+
+// Timer_Wheel_Event_st is one one-shot or periodic callback. The wheel links the events together, so no memory
+// is allocated and any number of events can be pending
+typedef struct Timer_Wheel_Event_st {
+	// Function called from the timer interrupt when the event expires
+	Timer_Wheel_Callback_ft callback;
+	// Passed to the callback
+	void* context;
+	// Repeat period in ticks, 0 for a one-shot event. Periodic events do not drift, each expiry is one period after the last
+	uint32_t period_ticks;
+	// DO NOT WRITE. Absolute expiry time in ticks
+	uint64_t __expires;
+	// DO NOT WRITE. Slot list links and position
+	struct Timer_Wheel_Event_st* __next;
+	struct Timer_Wheel_Event_st* __prev;
+	uint8_t __level;
+	uint8_t __slot;
+	// DO NOT WRITE. Set while the event is in the wheel
+	uint8_t __pending;
+}Timer_Wheel_Event_st;
+
+// Timer_Wheel_st runs any number of callbacks from one compare channel of one timer. Events are kept in a
+// hierarchical wheel (4 levels of 64 slots), the compare register is set to the next deadline so the interrupt
+// only fires when something is due
+typedef struct {
+	// Timer driving the wheel. Must be initialized (Timer_Init) without pwm or interrupts, the wheel takes over its
+	// prescaler and period. 32 bit timers (2 and 5) can sleep the longest
+	Timer_st* tim;
+	// Compare channel used for the deadline interrupt (1-4). Must not be a pwm channel
+	uint8_t chan_num;
+	// Requested tick rate in Hz, sets the resolution of every delay
+	uint32_t tick_hz;
+	// DO NOT WRITE. Tick rate actually achieved by the prescaler
+	uint32_t __tick_hz;
+	// DO NOT WRITE. Time in ticks up to which all events have been handled
+	uint64_t __now;
+	// DO NOT WRITE. Counter value at __now
+	uint32_t __last_count;
+	// DO NOT WRITE. Longest time between two interrupts, half the counter range so time is never lost
+	uint32_t __max_sleep;
+	// DO NOT WRITE. Set while expired events are being handled
+	uint8_t __expiring;
+	// DO NOT WRITE. Slot lists and one bit per busy slot for every level
+	Timer_Wheel_Event_st* __slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t __busy[TIMER_WHEEL_LEVELS];
+}Timer_Wheel_st;
+
+/*----------PUBLIC FUNCTION DECLARATIONS----------*/
+
+TIM_Ret_et Timer_Wheel_Init(Timer_Wheel_st* wheel);
+TIM_Ret_et Timer_Wheel_Start(Timer_Wheel_st* wheel);
+TIM_Ret_et Timer_Wheel_Stop(Timer_Wheel_st* wheel);
+void Timer_Wheel_Add(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event, uint32_t delay_ticks);
+void Timer_Wheel_Cancel(Timer_Wheel_st* wheel, Timer_Wheel_Event_st* event);
+uint8_t Timer_Wheel_Is_Pending(Timer_Wheel_Event_st* event);
+uint64_t Timer_Wheel_Now(Timer_Wheel_st* wheel);
+void Timer_Wheel_Callback(Timer_Wheel_st* wheel, TIM_HandleTypeDef* htim);
+
+#endif /* INC_TIMER_WHEEL_H_ */
@@ -31,134 +31,334 @@
 
 #include "timers_pwm.h"
 
+/*----------PRIVATE MACROS----------*/
+
+#define TIM_CAP_ENTRY(NUM, INST, TYPE, CHANNELS, BITS, RC, DMA, APB2) \
+	[NUM] = { .instance = INST, .tim_type = TYPE, .num_channels = CHANNELS, .counter_bits = BITS, .has_rc = RC, .has_dma = DMA, .on_apb2 = APB2 },
+
+// Dispatch slot of a timer from its register address. APB1 timers are 0x400 apart from PERIPH_BASE and APB2 timers
+// from PERIPH_BASE + 0x10000, so address bits 10-14 plus the bus bit (16) give every timer instance its own slot
+#define TIM_DISPATCH_SLOTS					(64U)
+#define TIM_DISPATCH_SLOT(INST)				(((((uint32_t)((uintptr_t)(INST) - PERIPH_BASE)) >> 10) & 0x1FU) | \
+											((((uint32_t)((uintptr_t)(INST) - PERIPH_BASE)) >> 11) & 0x20U))
+
+#define PPM									(1000000U)
+
+/*----------PRIVATE TYPEDEFS----------*/
+
+// Period elapsed callback registered on one timer
+typedef struct {
+	Timer_st* tim;
+	Timer_Callback_ft callback;
+	void* context;
+	// Update interrupts per callback and interrupts counted so far
+	uint8_t reps;
+	uint8_t count;
+}tim_dispatch_st;
+
+/*----------PRIVATE VARIABLES----------*/
+
+static const Tim_Capability_st tim_capabilities[MAX_TIM_NUM + 1] = {
+	TIM_CAPABILITY_TABLE(TIM_CAP_ENTRY)
+};
+
+// Timer_st that owns each timer and user of each channel, shared by every module built on the timers
+static Timer_st* tim_owners[MAX_TIM_NUM + 1];
+static const void* chan_owners[MAX_TIM_NUM + 1][4];
+// PWM_st started by PWM_Init on each channel. Retuning recomputes its compare from duty_hr while it owns the channel
+static PWM_st* chan_pwms[MAX_TIM_NUM + 1][4];
+
+// Registered callbacks by timer number, and the timer number of each dispatch slot (0 if none)
+static tim_dispatch_st dispatch[MAX_TIM_NUM + 1];
+static uint8_t dispatch_tim_num[TIM_DISPATCH_SLOTS];
+
 /*----------PRIVATE FUNCTION DEFINITIONS----------*/
 
 // timer_select gets the timer specific information stored in metadata_st and selects the correct timer instance
 static TIM_Ret_et timer_select(Timer_st* tim) {
-	tim_metadata_st m;
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
 
-	switch(tim->tim_num) {
-		case(1):
-			tim->htim->Instance = TIM1;
-			m.tim_type = ADVANCED_TIMER;
-			m.num_channels = 4;
-			break;
-		case(2):
-			tim->htim->Instance = TIM2;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 4;
-			break;
-		case(3):
-			tim->htim->Instance = TIM3;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 4;
-			break;
-		case(4):
-			tim->htim->Instance = TIM4;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 4;
-			break;
-		case(5):
-			tim->htim->Instance = TIM5;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 4;
-			break;
-		case(6):
-			tim->htim->Instance = TIM6;
-			m.tim_type = BASIC_TIMER;
-			m.num_channels = 0;
-			break;
-		case(7):
-			tim->htim->Instance = TIM7;
-			m.tim_type = BASIC_TIMER;
-			m.num_channels = 0;
-			break;
-		case(8):
-			tim->htim->Instance = TIM8;
-			m.tim_type = ADVANCED_TIMER;
-			m.num_channels = 4;
-			break;
-		case(9):
-			tim->htim->Instance = TIM9;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 2;
-			break;
-		case(10):
-			tim->htim->Instance = TIM10;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 1;
-			break;
-		case(11):
-			tim->htim->Instance = TIM11;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 1;
-			break;
-		case(12):
-			tim->htim->Instance = TIM12;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 2;
-			break;
-		case(13):
-			tim->htim->Instance = TIM13;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 1;
-			break;
-		case(14):
-			tim->htim->Instance = TIM14;
-			m.tim_type = GENERAL_TIMER;
-			m.num_channels = 1;
+	if (cap == NULL) {
+		return TIM_NUM_INVALID;
+	}
+
+	// Keep the initialized flag, only the timer specific information is refreshed
+	tim->htim->Instance = cap->instance;
+	tim->__metadata.tim_type = cap->tim_type;
+	tim->__metadata.num_channels = cap->num_channels;
+
+	return TIM_OK;
+}
+
+// Returns the APB prescaler (1 - 16) encoded in a PPREx field of RCC->CFGR
+static uint32_t apb_divider(uint32_t ppre) {
+	// 0xx: not divided, 100: /2, 101: /4, 110: /8, 111: /16
+	return (ppre & 0x4U) ? (1U << ((ppre & 0x3U) + 1)) : 1U;
+}
+
+// Largest counting period (ARR + 1) of the selected timer
+static uint64_t max_counting_period(TIM_HandleTypeDef* htim) {
+	return IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) ? MAX_COUNTING_PERIOD_32BIT : MAX_COUNTING_PERIOD_16BIT;
+}
+
+// Relative error num / den - 1 in parts per million, rounded to the nearest and saturated to the int32_t range
+static int32_t ratio_error_ppm(uint64_t num, uint64_t den) {
+	uint8_t above = (num > den);
+	uint64_t diff = above ? (num - den) : (den - num);
+	uint64_t whole;
+	uint64_t ppm;
+
+	if (den == 0) {
+		return INT32_MAX;
+	}
+	// Keep the remainder times PPM within 64 bits, the dropped low bits are far below 1 ppm
+	while (den > (UINT64_MAX / PPM)) {
+		den >>= 1;
+		diff >>= 1;
+	}
+
+	whole = diff / den;
+	ppm = (whole > (INT32_MAX / PPM)) ? INT32_MAX : ((whole * PPM) + ((((diff % den) * PPM) + (den / 2)) / den));
+	if (ppm > INT32_MAX) {
+		ppm = INT32_MAX;
+	}
+
+	return above ? (int32_t)ppm : -(int32_t)ppm;
+}
+
+// Searches every prescaler from the smallest that fits up to the one that leaves min_count counts for the
+// PSC/ARR pair whose period in timer ticks is closest to num/den. Ties keep the smaller prescaler, i.e. the
+// larger ARR and finer duty steps. Stops early on an exact match
+static TIM_Ret_et solve_counting_period(Timer_st* tim, uint64_t num, uint64_t den, uint32_t min_count, Tim_Timing_st* timing, TIM_Ret_et err) {
+	uint32_t clk = Timer_Get_Clock_Freq(tim);
+	uint64_t max_count = max_counting_period(tim->htim);
+	// A center aligned period is ARR counts up and ARR counts down
+	uint8_t center = Timer_Is_Center_Aligned(tim);
+	uint64_t psc_min;
+	uint64_t psc_max;
+	uint64_t best_psc = 0;
+	uint64_t best_count = 0;
+	uint64_t best_err = UINT64_MAX;
+
+	if (min_count < MIN_COUNTING_PERIOD) {
+		min_count = MIN_COUNTING_PERIOD;
+	}
+	if (center) {
+		// Solve for half a period, where the count is ARR instead of ARR + 1
+		den *= 2;
+		max_count -= 1;
+	}
+
+	// PSC + 1 range that keeps ARR + 1 within [min_count, max_count]
+	psc_min = (num + (den * max_count) - 1) / (den * max_count);
+	psc_max = num / (den * min_count);
+	if (psc_min == 0) {
+		psc_min = 1;
+	}
+	if (psc_max > MAX_PRESCALER) {
+		psc_max = MAX_PRESCALER;
+	}
+	if (psc_min > psc_max) {
+		return err;
+	}
+
+	for (uint64_t psc = psc_min; psc <= psc_max; psc++) {
+		// ARR + 1 rounded to the nearest tick
+		uint64_t count = (num + ((den * psc) / 2)) / (den * psc);
+		uint64_t ticks;
+		uint64_t e;
+
+		if (count > max_count) {
+			count = max_count;
+		}
+		if (count < min_count) {
 			break;
-		default:
-			return TIM_NUM_INVALID;
+		}
+
+		// Error in units of 1/den ticks
+		ticks = psc * count * den;
+		e = (ticks > num) ? (ticks - num) : (num - ticks);
+		if (e < best_err) {
+			best_err = e;
+			best_psc = psc;
+			best_count = count;
+			if (e == 0) {
+				break;
+			}
+		}
+	}
+
+	if (best_count == 0) {
+		return err;
 	}
 
-	tim->__metadata = m;
+	timing->prescaler = (uint32_t)(best_psc - 1);
+	timing->period = (uint32_t)(best_count - 1 + center);
+	timing->clk_hz = clk;
+	timing->achieved_mhz = ((uint64_t)clk * 1000U) / (best_psc * best_count * (center ? 2 : 1));
+	// f_achieved / f_requested - 1 = num / (psc * count * den) - 1
+	timing->error_ppm = ratio_error_ppm(num, best_psc * best_count * den);
 
 	return TIM_OK;
 }
 
+// Minimum counting period used by Timer_Init: at most one bit of duty resolution is traded for accuracy
+static uint32_t init_min_count(Timer_st* tim, uint64_t num, uint64_t den) {
+	uint64_t max_count = max_counting_period(tim->htim);
+	uint64_t psc_min;
+	uint64_t finest;
+
+	if (Timer_Is_Center_Aligned(tim)) {
+		den *= 2;
+	}
+	psc_min = (num + (den * max_count) - 1) / (den * max_count);
+
+	if (psc_min == 0) {
+		psc_min = 1;
+	}
+	finest = num / (den * psc_min);
+
+	return (finest / 2 > MIN_COUNTING_PERIOD) ? (uint32_t)(finest / 2) : MIN_COUNTING_PERIOD;
+}
+
 // Configure the timing parameters with period
-static TIM_Ret_et config_period(TIM_HandleTypeDef* htim, uint32_t period_ms) {
+static TIM_Ret_et config_period(Timer_st* tim, uint32_t period_ms) {
+	uint64_t num = (uint64_t)Timer_Get_Clock_Freq(tim) * period_ms;
+	Tim_Timing_st timing;
+	TIM_Ret_et ret;
+
 	// Timer period cannot be 0
 	if (period_ms == 0) {
 		return TIM_PERIOD_ZERO;
 	}
 
-	//Not to be confused with a time period (count from 0 up to this value)
-	htim->Init.Period = COUNTING_PERIOD_SLOW - 1;
-	// f_timer = f_SysClock / (PSC + 1)
-	htim->Init.Prescaler = (((uint64_t)HAL_RCC_GetPCLK1Freq() * period_ms) / (double)((htim->Init.Period+1) * 1000)) - 1;
+	// ticks = f_clk * period_ms / 1000
+	ret = solve_counting_period(tim, num, 1000U, init_min_count(tim, num, 1000U), &timing, TIM_PERIOD_INVALID);
+	if (ret != TIM_OK) {
+		return ret;
+	}
+
+	tim->htim->Init.Prescaler = timing.prescaler;
+	// Not to be confused with a time period (count from 0 up to this value)
+	tim->htim->Init.Period = timing.period;
 
 	return TIM_OK;
 }
 
 // Configure the timing parameters with frequency
-static TIM_Ret_et config_freq(TIM_HandleTypeDef* htim, uint32_t freq_hz) {
+static TIM_Ret_et config_freq(Timer_st* tim, uint32_t freq_hz) {
+	uint32_t clk = Timer_Get_Clock_Freq(tim);
+	Tim_Timing_st timing;
+	TIM_Ret_et ret;
+
 	// Timer frequency cannot be 0
-	if ((freq_hz == 0) || freq_hz > MAX_TIM_FREQ_FAST(HAL_RCC_GetPCLK1Freq())) {
+	if (freq_hz == 0) {
 		return TIM_FREQ_ZERO;
 	}
-	else if (freq_hz < MAX_TIM_FREQ_SLOW) {
-		// Not to be confused with a time period (count from 0 up to this value)
-		htim->Init.Period = COUNTING_PERIOD_SLOW - 1;
+	// Need at least MIN_COUNTING_PERIOD counts per period
+	if (freq_hz > MAX_TIM_FREQ_FAST(clk)) {
+		return TIM_FREQ_INVALID;
 	}
-	else {
-		// Same as above but larger number to count to
-		htim->Init.Period = COUNTING_PERIOD_FAST - 1;
+
+	// ticks = f_clk / f_timer
+	ret = solve_counting_period(tim, clk, freq_hz, init_min_count(tim, clk, freq_hz), &timing, TIM_FREQ_INVALID);
+	if (ret != TIM_OK) {
+		return ret;
 	}
 
-	// f_Timer = f_SysClock / (PSC + 1)
-	uint64_t f = HAL_RCC_GetSysClockFreq();
-	uint64_t d = freq_hz * ((uint64_t)htim->Init.Period+1);
-	htim->Init.Prescaler = (uint64_t)(f / d)-1;
+	tim->htim->Init.Prescaler = timing.prescaler;
+	// Not to be confused with a time period (count from 0 up to this value)
+	tim->htim->Init.Period = timing.period;
+
+	return TIM_OK;
+}
+
+// Checks that the counting mode and complementary outputs are supported by the selected timer
+static TIM_Ret_et check_timer_modes(Timer_st* tim) {
+	uint8_t up_only = (tim->__metadata.tim_type == BASIC_TIMER) || (tim->tim_num > 8);
+
+	if ((tim->count_mode != 0) && (tim->count_mode != COUNT_UP) && up_only) {
+		return TIM_COUNT_MODE_UNSUPPORTED;
+	}
+	if (tim->complementary.en_complementary && (tim->__metadata.tim_type != ADVANCED_TIMER)) {
+		return TIM_COMPLEMENTARY_UNSUPPORTED;
+	}
+	if ((tim->break_config.brk.en || tim->break_config.brk2.en || tim->break_config.en_software ||
+		(tim->break_config.lock_level != 0)) && (tim->__metadata.tim_type != ADVANCED_TIMER)) {
+		return TIM_BREAK_UNSUPPORTED;
+	}
+	if ((tim->break_config.brk.filter > MAX_BREAK_FILTER) || (tim->break_config.brk2.filter > MAX_BREAK_FILTER) ||
+		(tim->break_config.lock_level > MAX_LOCK_LEVEL)) {
+		return TIM_BREAK_UNSUPPORTED;
+	}
 
 	return TIM_OK;
 }
 
+// Maps the counting mode to the HAL counter mode
+static uint32_t counter_mode(Tim_Count_Mode_et count_mode) {
+	switch(count_mode) {
+		case(COUNT_DOWN):
+			return TIM_COUNTERMODE_DOWN;
+		case(COUNT_CENTER_ALIGNED_1):
+			return TIM_COUNTERMODE_CENTERALIGNED1;
+		case(COUNT_CENTER_ALIGNED_2):
+			return TIM_COUNTERMODE_CENTERALIGNED2;
+		case(COUNT_CENTER_ALIGNED_3):
+			return TIM_COUNTERMODE_CENTERALIGNED3;
+		case(COUNT_UP):
+		default:
+			return TIM_COUNTERMODE_UP;
+	}
+}
+
+// Encodes a dead time in DTS clock ticks into the DTG field of BDTR. Returns 0 if it does not fit
+static uint8_t dead_time_encode(uint32_t ticks, uint8_t* dtg) {
+	if (ticks <= 127) {
+		// DTG[7] = 0: DTG * t_dts
+		*dtg = (uint8_t)ticks;
+	}
+	else if (ticks <= 254) {
+		// DTG[7:6] = 10: (64 + DTG[5:0]) * 2 * t_dts
+		*dtg = (uint8_t)(0x80U | (((ticks + 1) / 2) - 64));
+	}
+	else if (ticks <= 504) {
+		// DTG[7:5] = 110: (32 + DTG[4:0]) * 8 * t_dts
+		*dtg = (uint8_t)(0xC0U | (((ticks + 7) / 8) - 32));
+	}
+	else if (ticks <= 1008) {
+		// DTG[7:5] = 111: (32 + DTG[4:0]) * 16 * t_dts
+		*dtg = (uint8_t)(0xE0U | (((ticks + 15) / 16) - 32));
+	}
+	else {
+		return 0;
+	}
+
+	return 1;
+}
+
+// Converts the requested dead time to a DTG value, slowing the dead time clock (CKD) if it is too long
+static TIM_Ret_et config_dead_time(Timer_st* tim, uint8_t* dtg) {
+	static const uint32_t clock_division[3] = { TIM_CLOCKDIVISION_DIV1, TIM_CLOCKDIVISION_DIV2, TIM_CLOCKDIVISION_DIV4 };
+	// Rounded up so the outputs never overlap
+	uint64_t ticks = (((uint64_t)tim->complementary.dead_time_ns * Timer_Get_Clock_Freq(tim)) + 999999999ULL) / 1000000000ULL;
+
+	for (uint8_t shift = 0; shift < 3; shift++) {
+		uint64_t dts_ticks = (ticks + (1U << shift) - 1) >> shift;
+
+		if ((dts_ticks <= 1008) && dead_time_encode((uint32_t)dts_ticks, dtg)) {
+			tim->htim->Init.ClockDivision = clock_division[shift];
+			return TIM_OK;
+		}
+	}
+
+	return TIM_DEADTIME_INVALID;
+}
+
 // These are the default configurations that do not change based on user input
 static void set_timer_defaults(Timer_st* tim){
-	// CounterMode determines whether we count up or count down
-	tim->htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	// CounterMode determines whether we count up, down or center aligned
+	tim->htim->Init.CounterMode = counter_mode(tim->count_mode);
 	// ClockDivision is a system clock divisor. We use prescaler so this is not needed
 	tim->htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	// AutoReloadPreload determines what to reset the counter to on timer reload.
@@ -229,30 +429,29 @@ static TIM_Ret_et adv_it_config_freq(TIM_HandleTypeDef* htim, uint32_t tim_freq,
 		((tim_freq % it_freq) != 0)) {
 		return TIM_IT_INVALID_FREQ;
 	}
-	// Make sure
-	if (((double)tim_freq / (double)MAX_REP_COUNTER) > MAX_IT_FREQ) {
+	// Timer_freq / interrupt_freq - 1 <= max_rep_counter
+	if (((tim_freq / it_freq) - 1) > MAX_REP_COUNTER) {
 		return TIM_RC_OVERFLOW;
 	}
 
 	htim->Init.RepetitionCounter = (tim_freq / it_freq) - 1;
 
-
 	return TIM_OK;
 }
 
-// TODO
+// Allows a longer interrupt period than the timer period (must be a multiple within tim_period * (max_rc + 1))
 static TIM_Ret_et adv_it_config_period(TIM_HandleTypeDef* htim, uint32_t tim_period, uint32_t it_period) {
 	// This allows us to have a default interrupt period: if the value is not set then it will be timer period
 	if (it_period == 0) {
 		it_period = tim_period;
 	}
-	// Timer interrupt period must be less than timer period and must be a multiple of timer period
-	if 	((it_period > tim_period) ||
+	// Timer interrupt period cannot be shorter than the timer period and must be a multiple of it
+	if 	((it_period < tim_period) ||
 		((it_period % tim_period) != 0)) {
 		return TIM_IT_INVALID_PERIOD;
 	}
-	// timer_period / Interrupt_period <= max_rep_counter
-	if (((double)tim_period / (double)it_period) > MAX_REP_COUNTER) {
+	// Interrupt_period / timer_period - 1 <= max_rep_counter
+	if (((it_period / tim_period) - 1) > MAX_REP_COUNTER) {
 		return TIM_RC_OVERFLOW;
 	}
 
@@ -261,22 +460,64 @@ static TIM_Ret_et adv_it_config_period(TIM_HandleTypeDef* htim, uint32_t tim_per
 	return TIM_OK;
 }
 
+// Checks it_config against a timer frequency (Hz) or period (ms) and sets the repetition counter for it
+static TIM_Ret_et config_it(Timer_st* tim, Timing_Model_et timing, uint32_t value) {
+	TIM_HandleTypeDef* htim = tim->htim;
+	TIM_Ret_et ret;
+
+	if (!tim->it_config.en_it) {
+		return TIM_OK;
+	}
+
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) {
+		if (timing == PERIOD) {
+			return noRC_it_config_period(htim, value, tim->it_config.period_ms);
+		}
+		return noRC_it_config_freq(htim, value, tim->it_config.freq_hz);
+	}
+
+	if (timing == PERIOD) {
+		ret = adv_it_config_period(htim, value, tim->it_config.period_ms);
+	}
+	else {
+		ret = adv_it_config_freq(htim, value, tim->it_config.freq_hz);
+	}
+	if (ret != TIM_OK) {
+		return ret;
+	}
+	// Center aligned counters have an update event at both ends of the period, count both
+	if (Timer_Is_Center_Aligned(tim)) {
+		if (((2 * (htim->Init.RepetitionCounter + 1)) - 1) > MAX_REP_COUNTER) {
+			return TIM_RC_OVERFLOW;
+		}
+		htim->Init.RepetitionCounter = (2 * (htim->Init.RepetitionCounter + 1)) - 1;
+	}
+
+	return TIM_OK;
+}
+
 // adv_tim_init initializes an advanced timer
 static TIM_Ret_et adv_tim_init(Timer_st* tim) {
+	static const uint32_t lock_levels[MAX_LOCK_LEVEL + 1] = { TIM_LOCKLEVEL_OFF, TIM_LOCKLEVEL_1, TIM_LOCKLEVEL_2, TIM_LOCKLEVEL_3 };
 	TIM_ClockConfigTypeDef sClockSourceConfig = {0};
 	TIM_MasterConfigTypeDef sMasterConfig = {0};
 	TIM_OC_InitTypeDef sConfigOC = {0};
 	TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = {0};
-	TIM_Ret_et ret;
+	Tim_Break_Input_st* brk = &tim->break_config.brk;
+	Tim_Break_Input_st* brk2 = &tim->break_config.brk2;
+	uint8_t uses_break = brk->en || brk2->en || tim->break_config.en_software;
+	TIM_Ret_et ret = TIM_OK;
+	uint8_t dtg = 0;
 
 	// Initialize timing parameters for interrupts
-	if (tim->it_config.en_it) {
-		if (tim->timing  == PERIOD) {
-			ret = adv_it_config_period(tim->htim, tim->period_ms, tim->it_config.period_ms);
-		}
-		else if (tim->timing == FREQ) {
-			ret = adv_it_config_freq(tim->htim, tim->freq_hz, tim->it_config.freq_hz);
-		}
+	ret = config_it(tim, tim->timing, (tim->timing == PERIOD) ? tim->period_ms : tim->freq_hz);
+	if (ret != TIM_OK) {
+		return ret;
+	}
+
+	// Dead time also selects the dead time clock, so it must be known before the base init
+	if (tim->complementary.en_complementary) {
+		ret = config_dead_time(tim, &dtg);
 		if (ret != TIM_OK) {
 			return ret;
 		}
@@ -304,18 +545,19 @@ static TIM_Ret_et adv_tim_init(Timer_st* tim) {
 		sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
 		sConfigOC.OCNIdleState = TIM_OCNIDLESTATE_RESET;
 
-		sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
-		sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
-		sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
-		sBreakDeadTimeConfig.DeadTime = 0;
-		sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
-		sBreakDeadTimeConfig.BreakPolarity = TIM_BREAKPOLARITY_HIGH;
-		sBreakDeadTimeConfig.BreakFilter = 0;
-		sBreakDeadTimeConfig.Break2State = TIM_BREAK2_DISABLE;
-		sBreakDeadTimeConfig.Break2Polarity = TIM_BREAK2POLARITY_HIGH;
-		sBreakDeadTimeConfig.Break2Filter = 0;
-		sBreakDeadTimeConfig.AutomaticOutput = TIM_AUTOMATICOUTPUT_DISABLE;
-		if (HAL_TIMEx_ConfigBreakDeadTime(tim->htim, &sBreakDeadTimeConfig) != HAL_OK) { return TIM_CONFIG_DEADTIME_FAIL; }
+		// With breaks in use the outputs are driven to their idle level when shut down instead of being released
+		sBreakDeadTimeConfig.OffStateRunMode = uses_break ? TIM_OSSR_ENABLE : TIM_OSSR_DISABLE;
+		sBreakDeadTimeConfig.OffStateIDLEMode = uses_break ? TIM_OSSI_ENABLE : TIM_OSSI_DISABLE;
+		// LOCK is write once after a reset, it goes in the same write as the fields it freezes
+		sBreakDeadTimeConfig.LockLevel = lock_levels[tim->break_config.lock_level];
+		sBreakDeadTimeConfig.DeadTime = dtg;
+		sBreakDeadTimeConfig.BreakState = brk->en ? TIM_BREAK_ENABLE : TIM_BREAK_DISABLE;
+		sBreakDeadTimeConfig.BreakPolarity = (brk->polarity == BREAK_ACTIVE_LOW) ? TIM_BREAKPOLARITY_LOW : TIM_BREAKPOLARITY_HIGH;
+		sBreakDeadTimeConfig.BreakFilter = brk->filter;
+		sBreakDeadTimeConfig.Break2State = brk2->en ? TIM_BREAK2_ENABLE : TIM_BREAK2_DISABLE;
+		sBreakDeadTimeConfig.Break2Polarity = (brk2->polarity == BREAK_ACTIVE_LOW) ? TIM_BREAK2POLARITY_LOW : TIM_BREAK2POLARITY_HIGH;
+		sBreakDeadTimeConfig.Break2Filter = brk2->filter;
+		sBreakDeadTimeConfig.AutomaticOutput = tim->complementary.en_auto_output ? TIM_AUTOMATICOUTPUT_ENABLE : TIM_AUTOMATICOUTPUT_DISABLE;
 
 		if (tim->channels.en_ch_all) {
 			enable_all_ch(&tim->channels, &tim->__metadata);
@@ -355,6 +597,16 @@ static TIM_Ret_et adv_tim_init(Timer_st* tim) {
 		}
 
 		HAL_TIM_MspPostInit(tim->htim);
+
+		// Single write of the break and dead time register once everything it can lock is configured
+		if (HAL_TIMEx_ConfigBreakDeadTime(tim->htim, &sBreakDeadTimeConfig) != HAL_OK) { return TIM_CONFIG_DEADTIME_FAIL; }
+
+		// Count every break event (Timer_Break_Callback)
+		tim->break_config.__num_faults = 0;
+		if (uses_break) {
+			__HAL_TIM_CLEAR_FLAG(tim->htim, TIM_FLAG_BREAK | TIM_FLAG_BREAK2);
+			__HAL_TIM_ENABLE_IT(tim->htim, TIM_IT_BREAK);
+		}
 	}
 
 	if (tim->it_config.en_it) {
@@ -371,16 +623,9 @@ static TIM_Ret_et gen_tim_init(Timer_st* tim) {
 	TIM_OC_InitTypeDef sConfigOC = {0};
 	TIM_Ret_et ret;
 
-	if (tim->it_config.en_it){
-		if (tim->timing == PERIOD) {
-			ret = noRC_it_config_period(tim->htim, tim->period_ms, tim->it_config.period_ms);
-		}
-		else {
-			ret = noRC_it_config_freq(tim->htim, tim->freq_hz, tim->it_config.freq_hz);
-		}
-		if (ret != TIM_OK) {
-			return ret;
-		}
+	ret = config_it(tim, tim->timing, (tim->timing == PERIOD) ? tim->period_ms : tim->freq_hz);
+	if (ret != TIM_OK) {
+		return ret;
 	}
 
 	if (HAL_TIM_Base_Init(tim->htim) != HAL_OK) { return TIM_BASE_INIT_FAIL; }
@@ -455,16 +700,9 @@ static TIM_Ret_et basic_tim_init(Timer_st* tim) {
 	TIM_MasterConfigTypeDef sMasterConfig = {0};
 	TIM_Ret_et ret;
 
-	if (tim->it_config.en_it){
-		if (tim->timing == PERIOD) {
-			ret = noRC_it_config_period(tim->htim, tim->period_ms, tim->it_config.period_ms);
-		}
-		else {
-			ret = noRC_it_config_freq(tim->htim, tim->freq_hz, tim->it_config.freq_hz);
-		}
-		if (ret != TIM_OK) {
-			return ret;
-		}
+	ret = config_it(tim, tim->timing, (tim->timing == PERIOD) ? tim->period_ms : tim->freq_hz);
+	if (ret != TIM_OK) {
+		return ret;
 	}
 
 	// Basic Timers do not have PWM channels
@@ -486,37 +724,247 @@ static TIM_Ret_et basic_tim_init(Timer_st* tim) {
 	return TIM_OK;
 }
 
+// Counts in one pwm period that the compare value is a fraction of: ARR + 1 counting up or down, ARR center aligned
+static uint64_t duty_counts(Timer_st* tim, uint32_t period) {
+	return Timer_Is_Center_Aligned(tim) ? (uint64_t)period : ((uint64_t)period + 1);
+}
+
+// Precomputes the duty_hr to compare value scale of the counting period in Init, so setting a duty cycle needs no
+// division. counts * 2^32 / PWM_DUTY_HR_MAX with 2^32 = PWM_DUTY_HR_MAX * 65537 + 1, split into parts that cannot
+// overflow even for a full 32 bit counter
+static void update_duty_scale(Timer_st* tim) {
+	uint64_t counts = duty_counts(tim, tim->htim->Init.Period);
+
+	tim->__metadata.duty_scale_q32 = (counts * 65537U) + (counts / PWM_DUTY_HR_MAX);
+}
+
 // Compare is the value the timer will count to before toggling GPIO to create PWM
-static uint32_t calculate_compare_value(uint32_t counting_period, uint8_t duty) {
-	return ((counting_period+1) / MAX_DUTY_CYCLE) * (uint32_t)duty;
+static uint32_t calculate_compare_value(Timer_st* tim, uint16_t duty_hr) {
+	// duty_hr * counts / PWM_DUTY_HR_MAX rounded to the nearest count
+	uint32_t high = PWM_DUTY_TO_COMPARE(duty_hr, tim->__metadata.duty_scale_q32);
+
+	// Counting down the output is also active while CNT equals the compare, so one count less. 0% is not possible
+	if (tim->count_mode == COUNT_DOWN) {
+		return (high == 0) ? 0 : (high - 1);
+	}
+	return high;
 }
 
-/*----------PUBLIC FUNCTION DEFINITIONS----------*/
+// Converts a duty cycle in percent to high resolution units
+static uint16_t duty_to_hr(uint8_t duty) {
+	return (uint16_t)(((uint32_t)duty * PWM_DUTY_HR_MAX) / MAX_DUTY_CYCLE);
+}
 
-// Timer_Init initializes a timer with configurations described in the Timer_st fields
-TIM_Ret_et Timer_Init(Timer_st* tim)
-{
+// Converts a high resolution duty cycle to the nearest percent
+static uint8_t duty_from_hr(uint16_t duty_hr) {
+	return (uint8_t)(((uint32_t)duty_hr * MAX_DUTY_CYCLE + (PWM_DUTY_HR_MAX / 2)) / PWM_DUTY_HR_MAX);
+}
+
+// Finds the HAL channel of a pwm and makes sure it was enabled at the timer level
+static PWM_Ret_et pwm_channel_select(PWM_st* pwm, uint32_t* chan) {
+	switch(pwm->chan_num)
+	{
+		case(1):
+			if (!pwm->tim->channels.en_ch1) { return PWM_CH_NOT_ENABLED; }
+			*chan = TIM_CHANNEL_1;
+			break;
+		case(2):
+			if (!pwm->tim->channels.en_ch2) { return PWM_CH_NOT_ENABLED; }
+			*chan = TIM_CHANNEL_2;
+			break;
+		case(3):
+			if (!pwm->tim->channels.en_ch3) { return PWM_CH_NOT_ENABLED; }
+			*chan = TIM_CHANNEL_3;
+			break;
+		case(4):
+			if (!pwm->tim->channels.en_ch4) { return PWM_CH_NOT_ENABLED; }
+			*chan = TIM_CHANNEL_4;
+			break;
+		default:
+			return PWM_INVALID_CH_NUM;
+	}
+
+	return PWM_OK;
+}
+
+// Writes the compare value for pwm->duty_hr. With output compare preload enabled the value only reaches
+// the active register on the next update event, so the running period is never cut short
+static void pwm_write_compare(PWM_st* pwm, uint32_t chan) {
+	// This value could be different than pwm->duty_hr if pwm->is_inverted is enabled
+	uint16_t duty = pwm->duty_hr;
+
+	if (pwm->is_inverted) {
+		duty = PWM_DUTY_HR_MAX - duty;
+	}
+
+	__HAL_TIM_SET_COMPARE(pwm->tim->htim, chan, calculate_compare_value(pwm->tim, duty));
+}
+
+// Returns a boolean to see if a channel number has been enabled at the timer level
+static uint8_t channel_enabled(Timer_st* tim, uint8_t chan_num) {
+	switch(chan_num) {
+		case(1):
+			return tim->channels.en_ch1;
+		case(2):
+			return tim->channels.en_ch2;
+		case(3):
+			return tim->channels.en_ch3;
+		case(4):
+			return tim->channels.en_ch4;
+		default:
+			return 0;
+	}
+}
+
+// Starts a DMA burst that writes num_chans consecutive CCRx registers from compare[] on every update event
+static PWM_Ret_et waveform_start(Timer_st* tim, uint8_t first_chan, uint8_t num_chans, const uint32_t compare[], uint32_t len, PWM_Waveform_Mode_et mode) {
+	static const uint32_t dma_base[4] = { TIM_DMABASE_CCR1, TIM_DMABASE_CCR2, TIM_DMABASE_CCR3, TIM_DMABASE_CCR4 };
+	static const uint32_t burst_len[4] = { TIM_DMABURSTLENGTH_1TRANSFER, TIM_DMABURSTLENGTH_2TRANSFERS,
+			TIM_DMABURSTLENGTH_3TRANSFERS, TIM_DMABURSTLENGTH_4TRANSFERS };
+	DMA_HandleTypeDef* hdma = tim->htim->hdma[TIM_DMA_ID_UPDATE];
+	uint32_t dma_mode = (mode == WAVEFORM_CIRCULAR) ? DMA_CIRCULAR : DMA_NORMAL;
+
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	if (hdma == NULL) { return PWM_NO_DMA; }
+	if ((len == 0) || (len > MAX_DMA_TRANSFERS) || (compare == NULL)) { return PWM_INVALID_LEN; }
+
+	// The burst writes CCR[first_chan] to CCR[first_chan + num_chans - 1]
+	if ((first_chan == 0) || (num_chans == 0) || ((first_chan + num_chans - 1) > 4)) { return PWM_INVALID_CH_NUM; }
+	if ((first_chan + num_chans - 1) > tim->__metadata.num_channels) { return PWM_CH_UNSUPPORTED; }
+	for (uint8_t c = first_chan; c < first_chan + num_chans; c++) {
+		if (!channel_enabled(tim, c)) { return PWM_CH_NOT_ENABLED; }
+	}
+
+	// One shot / circular is a property of the DMA stream, only re-init it when it changes
+	if (hdma->Init.Mode != dma_mode) {
+		hdma->Init.Mode = dma_mode;
+		if (HAL_DMA_Init(hdma) != HAL_OK) { return PWM_DMA_START_FAIL; }
+	}
+
+	// The HAL only reads the buffer, its prototype just lacks the const
+	if (HAL_TIM_DMABurst_MultiWriteStart(tim->htim, dma_base[first_chan - 1], TIM_DMA_UPDATE, (uint32_t*)compare,
+			burst_len[num_chans - 1], len) != HAL_OK) {
+		return PWM_DMA_START_FAIL;
+	}
+
+	return PWM_OK;
+}
+
+// Blocks update events while several preloaded registers are written, so they all transfer on the same update
+static void updates_hold(Timer_st* tim) {
+	tim->htim->Instance->CR1 |= TIM_CR1_UDIS;
+}
+
+// Re-allows update events and optionally forces one so the batch is applied immediately
+static void updates_release(Timer_st* tim, PWM_Commit_et commit) {
+	tim->htim->Instance->CR1 &= ~TIM_CR1_UDIS;
+
+	if (commit == COMMIT_NOW) {
+		HAL_TIM_GenerateEvent(tim->htim, TIM_EVENTSOURCE_UPDATE);
+	}
+}
+
+// Writes the preloaded output enable (CCxE / CCxNE) and output mode bits of one channel for a commutation step
+static void phase_write(Timer_st* tim, uint8_t chan_num, PWM_Phase_State_et phase) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	// CCER has 4 bits per channel
+	uint32_t ccer_shift = 4U * (chan_num - 1);
+	uint32_t ccer = regs->CCER & ~((TIM_CCER_CC1E | TIM_CCER_CC1NE) << ccer_shift);
+	uint32_t mode = TIM_OCMODE_PWM1;
+
+	switch(phase) {
+		case(PHASE_PWM):
+			ccer |= TIM_CCER_CC1E << ccer_shift;
+			if (tim->complementary.en_complementary) {
+				ccer |= TIM_CCER_CC1NE << ccer_shift;
+			}
+			break;
+		case(PHASE_HIGH_PWM):
+			ccer |= TIM_CCER_CC1E << ccer_shift;
+			break;
+		case(PHASE_LOW_ON):
+			// With CCxE cleared OCxN follows OCxREF instead of its complement, so the reference is forced active.
+			// No dead time is inserted with only one output of the pair enabled
+			ccer |= TIM_CCER_CC1NE << ccer_shift;
+			mode = TIM_OCMODE_FORCED_ACTIVE;
+			break;
+		case(PHASE_OFF):
+		default:
+			break;
+	}
+
+	Timer_Set_OC_Mode(tim, chan_num, mode);
+	regs->CCER = ccer;
+}
+
+// Loads a new prescaler / period and repetition counter (from Init, see config_it) into the preload registers and
+// rewrites the compare values of the running channels so their duty cycles stay the same. Channels of a PWM_st are
+// recomputed from its duty_hr. Other users of a channel (pulses, compares...) have their compare scaled by the ratio
+// of the counting periods, which rounds to the nearest count each time so repeated retunes can drift by a count.
+// Everything is latched by the same update event
+static void apply_timing(Timer_st* tim, uint32_t prescaler, uint32_t period, PWM_Commit_et commit) {
+	TIM_HandleTypeDef* htim = tim->htim;
+	uint64_t old_count = duty_counts(tim, htim->Instance->ARR);
+	uint64_t new_count = duty_counts(tim, period);
+
+	updates_hold(tim);
+
+	// Without auto-reload preload a smaller ARR below the counter would make it run to the end of its range
+	htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+	htim->Instance->CR1 |= TIM_CR1_ARPE;
+
+	htim->Init.Prescaler = prescaler;
+	htim->Init.Period = period;
+	update_duty_scale(tim);
+	__HAL_TIM_SET_PRESCALER(htim, prescaler);
+	__HAL_TIM_SET_AUTORELOAD(htim, period);
+	if (IS_TIM_REPETITION_COUNTER_INSTANCE(htim->Instance)) {
+		htim->Instance->RCR = htim->Init.RepetitionCounter;
+	}
+
+	// Only channels with their output on
+	for (uint8_t c = 1; c <= tim->__metadata.num_channels; c++) {
+		PWM_st* pwm = chan_pwms[tim->tim_num][c - 1];
+		uint64_t compare;
+
+		if (!channel_enabled(tim, c) || !(htim->Instance->CCER & (TIM_CCER_CC1E << TIM_HAL_CHANNEL(c)))) {
+			continue;
+		}
+		if ((pwm != NULL) && (chan_owners[tim->tim_num][c - 1] == pwm)) {
+			pwm_write_compare(pwm, TIM_HAL_CHANNEL(c));
+			continue;
+		}
+		// Same ratio of compare to counting period, rounded to the nearest count
+		compare = (uint64_t)__HAL_TIM_GET_COMPARE(htim, TIM_HAL_CHANNEL(c));
+		__HAL_TIM_SET_COMPARE(htim, TIM_HAL_CHANNEL(c), (uint32_t)(((compare * new_count) + (old_count / 2)) / old_count));
+	}
+
+	updates_release(tim, commit);
+}
+
+// Checks the timer modes, configures the timing and runs the HAL init of the timer type
+static TIM_Ret_et configure_timer(Timer_st* tim) {
 	TIM_Ret_et ret;
 
-	// Gets timer specific information
-	ret = timer_select(tim);
+	ret = check_timer_modes(tim);
 	if (ret != TIM_OK) {
 		return ret;
 	}
 
 	// Configure Timing
 	if (tim->timing == PERIOD) {
-		ret = config_period(tim->htim, tim->period_ms);
+		ret = config_period(tim, tim->period_ms);
 		if (ret != TIM_OK) {
 			return ret;
 		}
 	}
 	else if (tim->timing == FREQ) {
-		ret = config_freq(tim->htim, tim->freq_hz);
+		ret = config_freq(tim, tim->freq_hz);
 		if (ret != TIM_OK) {
 			return ret;
 		}
 	}
+	update_duty_scale(tim);
 
 	// Defaults - these stay the same as the autogen code and generally do not need to be changed
 	set_timer_defaults(tim);
@@ -534,31 +982,535 @@ TIM_Ret_et Timer_Init(Timer_st* tim)
 		break;
 	}
 
-	// Timer is now initialized
-	tim->__metadata.tim_initialized = 1;
-
 	return ret;
 }
 
-// Timer_Stop de-initializes a timer and resets the proper flag
-TIM_Ret_et Timer_Stop(Timer_st* tim) {
-	if (HAL_TIM_Base_DeInit(tim->htim) != HAL_OK) { return TIM_BASE_DEINIT_FAIL; }
-
-	// Reset timer_init flag
-	tim->__metadata.tim_initialized = 0;
+/*----------PUBLIC FUNCTION DEFINITIONS----------*/
 
-	return TIM_OK;
-}
+// Timer_Init initializes a timer with configurations described in the Timer_st fields
+TIM_Ret_et Timer_Init(Timer_st* tim)
+{
+	uint8_t claimed;
+	TIM_Ret_et ret;
 
-//TODO: comment
+	// Gets timer specific information
+	ret = timer_select(tim);
+	if (ret != TIM_OK) {
+		return ret;
+	}
+
+	// Two Timer_st must never configure the same hardware timer
+	if ((tim_owners[tim->tim_num] != NULL) && (tim_owners[tim->tim_num] != tim)) {
+		return TIM_IN_USE;
+	}
+
+	// A failed init leaves the timer free for another Timer_st, unless this one already owned it
+	claimed = (tim_owners[tim->tim_num] == NULL);
+	tim_owners[tim->tim_num] = tim;
+
+	ret = configure_timer(tim);
+	if ((ret != TIM_OK) && claimed) {
+		Timer_Release(tim);
+	}
+
+	// Timer is now initialized
+	tim->__metadata.tim_initialized = 1;
+
+	return ret;
+}
+
+// Timer_Stop de-initializes a timer and resets the proper flag
+TIM_Ret_et Timer_Stop(Timer_st* tim) {
+	if (HAL_TIM_Base_DeInit(tim->htim) != HAL_OK) { return TIM_BASE_DEINIT_FAIL; }
+
+	// Reset timer_init flag
+	tim->__metadata.tim_initialized = 0;
+	Timer_Unregister_Callback(tim);
+	Timer_Release(tim);
+
+	return TIM_OK;
+}
+
+// Timer_Get_Clock_Freq returns the input clock of the timer counter. The timer must have been selected by Timer_Init
+// or its tim_num must be valid. Timers on a divided APB bus run at twice the bus clock (or HCLK with TIMPRE set)
+uint32_t Timer_Get_Clock_Freq(Timer_st* tim) {
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+	uint32_t pclk;
+	uint32_t div;
+
+	if (cap == NULL) {
+		return 0;
+	}
+
+	if (cap->on_apb2) {
+		pclk = HAL_RCC_GetPCLK2Freq();
+		div = apb_divider((RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos);
+	}
+	else {
+		pclk = HAL_RCC_GetPCLK1Freq();
+		div = apb_divider((RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos);
+	}
+
+#ifdef RCC_DCKCFGR1_TIMPRE
+	if (RCC->DCKCFGR1 & RCC_DCKCFGR1_TIMPRE) {
+		return (div <= 4) ? HAL_RCC_GetHCLKFreq() : (4 * pclk);
+	}
+#endif
+
+	return (div == 1) ? pclk : (2 * pclk);
+}
+
+// Timer_Get_Capability returns the capabilities of a timer or NULL if the timer number is invalid. For a constant
+// timer number TIM_CAP gives the same information at compile time
+const Tim_Capability_st* Timer_Get_Capability(uint8_t tim_num) {
+	if ((tim_num == 0) || (tim_num > MAX_TIM_NUM)) {
+		return NULL;
+	}
+	return &tim_capabilities[tim_num];
+}
+
+// Timer_Is_Center_Aligned returns a boolean to see if the timer counts center aligned
+uint8_t Timer_Is_Center_Aligned(Timer_st* tim) {
+	return (tim->count_mode == COUNT_CENTER_ALIGNED_1) ||
+			(tim->count_mode == COUNT_CENTER_ALIGNED_2) ||
+			(tim->count_mode == COUNT_CENTER_ALIGNED_3);
+}
+
+// Timer_Get_OC_Mode reads the output compare mode bits of a channel (TIM_OCMODE_x)
+uint32_t Timer_Get_OC_Mode(Timer_st* tim, uint8_t chan_num) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	// CCMR has 8 bits per channel and 2 channels per register
+	volatile uint32_t* ccmr = (chan_num <= 2) ? &regs->CCMR1 : &regs->CCMR2;
+	uint32_t shift = ((chan_num - 1) % 2) * 8U;
+
+	return (*ccmr >> shift) & TIM_CCMR1_OC1M;
+}
+
+// Timer_Set_OC_Mode writes the output compare mode bits of a channel, the other bits of its CCMR are kept
+void Timer_Set_OC_Mode(Timer_st* tim, uint8_t chan_num, uint32_t mode) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	volatile uint32_t* ccmr = (chan_num <= 2) ? &regs->CCMR1 : &regs->CCMR2;
+	uint32_t shift = ((chan_num - 1) % 2) * 8U;
+
+	*ccmr = (*ccmr & ~(TIM_CCMR1_OC1M << shift)) | (mode << shift);
+}
+
+// Timer_Allocate reserves the least capable free timer that meets req for tim and sets tim->tim_num.
+// Call during start up, allocation is not protected against interrupts
+TIM_Ret_et Timer_Allocate(Timer_st* tim, const Tim_Requirements_st* req) {
+	uint8_t best = 0;
+	uint32_t best_score = UINT32_MAX;
+
+	for (uint8_t n = 1; n <= MAX_TIM_NUM; n++) {
+		const Tim_Capability_st* cap = &tim_capabilities[n];
+		uint32_t score;
+
+		if ((tim_owners[n] != NULL) && (tim_owners[n] != tim)) { continue; }
+		if (cap->num_channels < req->min_channels) { continue; }
+		if (cap->counter_bits < req->min_counter_bits) { continue; }
+		if (req->needs_rc && !cap->has_rc) { continue; }
+		if (req->needs_dma && !cap->has_dma) { continue; }
+
+		// Keep the rare features (repetition counter, 32 bits, dma, channels) free for whoever needs them
+		score = (cap->has_rc * 64U) + cap->counter_bits + (cap->num_channels * 4U) + (cap->has_dma * 2U);
+		if (score < best_score) {
+			best = n;
+			best_score = score;
+		}
+	}
+
+	if (best == 0) {
+		return TIM_NONE_AVAILABLE;
+	}
+
+	tim->tim_num = best;
+	tim_owners[best] = tim;
+
+	return TIM_OK;
+}
+
+// Timer_Release gives up the timer owned by tim and every channel claimed on it
+void Timer_Release(Timer_st* tim) {
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+
+	if ((cap == NULL) || (tim_owners[tim->tim_num] != tim)) {
+		return;
+	}
+
+	tim_owners[tim->tim_num] = NULL;
+	for (uint8_t c = 0; c < 4; c++) {
+		chan_owners[tim->tim_num][c] = NULL;
+		chan_pwms[tim->tim_num][c] = NULL;
+	}
+}
+
+// Timer_Claim_Channel marks a channel as used by owner (a PWM_st, capture, compare...). Claiming a channel again
+// with the same owner is allowed
+TIM_Ret_et Timer_Claim_Channel(Timer_st* tim, uint8_t chan_num, const void* owner) {
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+
+	if ((cap == NULL) || (chan_num == 0) || (chan_num > cap->num_channels)) {
+		return TIM_CH_INVALID;
+	}
+	if ((chan_owners[tim->tim_num][chan_num - 1] != NULL) && (chan_owners[tim->tim_num][chan_num - 1] != owner)) {
+		return TIM_CH_IN_USE;
+	}
+
+	chan_owners[tim->tim_num][chan_num - 1] = owner;
+
+	return TIM_OK;
+}
+
+// Timer_Release_Channel frees a channel claimed by owner
+void Timer_Release_Channel(Timer_st* tim, uint8_t chan_num, const void* owner) {
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+
+	if ((cap == NULL) || (chan_num == 0) || (chan_num > cap->num_channels)) {
+		return;
+	}
+	if (chan_owners[tim->tim_num][chan_num - 1] == owner) {
+		chan_owners[tim->tim_num][chan_num - 1] = NULL;
+	}
+}
+
+// Timer_Register_Callback routes the update interrupt of an initialized timer to callback. A timer has one callback,
+// registering again replaces it. The callback runs once per interrupt period from it_config: advanced timers already
+// skip updates with the repetition counter, center aligned timers without one have two updates per period and the
+// dispatcher skips every other one
+TIM_Ret_et Timer_Register_Callback(Timer_st* tim, Timer_Callback_ft callback, void* context) {
+	const Tim_Capability_st* cap = Timer_Get_Capability(tim->tim_num);
+	tim_dispatch_st* entry;
+
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (!tim->it_config.en_it) { return TIM_IT_DISABLED; }
+	if (callback == NULL) { return TIM_ERROR; }
+
+	entry = &dispatch[tim->tim_num];
+
+	// The update interrupt must not see a half written entry
+	__HAL_TIM_DISABLE_IT(tim->htim, TIM_IT_UPDATE);
+
+	entry->tim = tim;
+	entry->callback = callback;
+	entry->context = context;
+	entry->reps = (Timer_Is_Center_Aligned(tim) && !cap->has_rc) ? 2 : 1;
+	entry->count = 0;
+	dispatch_tim_num[TIM_DISPATCH_SLOT(tim->htim->Instance)] = tim->tim_num;
+
+	__HAL_TIM_ENABLE_IT(tim->htim, TIM_IT_UPDATE);
+
+	return TIM_OK;
+}
+
+// Timer_Unregister_Callback stops routing the update interrupt of a timer
+void Timer_Unregister_Callback(Timer_st* tim) {
+	if ((Timer_Get_Capability(tim->tim_num) == NULL) || (dispatch[tim->tim_num].tim != tim)) {
+		return;
+	}
+
+	dispatch_tim_num[TIM_DISPATCH_SLOT(tim->htim->Instance)] = 0;
+	dispatch[tim->tim_num].tim = NULL;
+	dispatch[tim->tim_num].callback = NULL;
+}
+
+// Timer_Dispatch_Period_Elapsed runs the callback registered on the interrupting timer. Call it from
+// HAL_TIM_PeriodElapsedCallback (or set TIM_DISPATCH_OWN_CALLBACK). One table lookup, whatever the number of timers
+void Timer_Dispatch_Period_Elapsed(TIM_HandleTypeDef* htim) {
+	tim_dispatch_st* entry = &dispatch[dispatch_tim_num[TIM_DISPATCH_SLOT(htim->Instance)]];
+
+	// Timer number 0 is never registered, so unknown timers land on an empty entry
+	if (entry->callback == NULL) {
+		return;
+	}
+
+	if (++entry->count < entry->reps) {
+		return;
+	}
+	entry->count = 0;
+
+	entry->callback(entry->tim, entry->context);
+}
+
+#if TIM_DISPATCH_OWN_CALLBACK
+// Overrides the weak HAL callback so every period elapsed interrupt goes through the dispatch table
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+	Timer_Dispatch_Period_Elapsed(htim);
+}
+#endif
+
+// Timer_Solve_Freq finds the PSC/ARR pair closest to freq_hz with at least min_counting_period counts per period
+TIM_Ret_et Timer_Solve_Freq(Timer_st* tim, uint32_t freq_hz, uint32_t min_counting_period, Tim_Timing_st* timing) {
+	TIM_Ret_et ret;
+
+	if (freq_hz == 0) {
+		return TIM_FREQ_ZERO;
+	}
+
+	// Instance is needed to know the counter width
+	ret = timer_select(tim);
+	if (ret != TIM_OK) {
+		return ret;
+	}
+
+	ret = solve_counting_period(tim, Timer_Get_Clock_Freq(tim), freq_hz, min_counting_period, timing, TIM_FREQ_INVALID);
+	timing->timing = FREQ;
+	timing->value = freq_hz;
+
+	return ret;
+}
+
+// Timer_Solve_Period finds the PSC/ARR pair closest to period_ms with at least min_counting_period counts per period
+TIM_Ret_et Timer_Solve_Period(Timer_st* tim, uint32_t period_ms, uint32_t min_counting_period, Tim_Timing_st* timing) {
+	TIM_Ret_et ret;
+
+	if (period_ms == 0) {
+		return TIM_PERIOD_ZERO;
+	}
+
+	ret = timer_select(tim);
+	if (ret != TIM_OK) {
+		return ret;
+	}
+
+	ret = solve_counting_period(tim, (uint64_t)Timer_Get_Clock_Freq(tim) * period_ms, 1000U, min_counting_period, timing, TIM_PERIOD_INVALID);
+	timing->timing = PERIOD;
+	timing->value = period_ms;
+
+	return ret;
+}
+
+// Timer_Build_Timing_Table solves every frequency of a table ahead of time so that retuning is only a lookup
+TIM_Ret_et Timer_Build_Timing_Table(Timer_st* tim, Tim_Timing_Table_st* table, uint32_t min_counting_period) {
+	TIM_Ret_et ret;
+
+	for (uint16_t i = 0; i < table->len; i++) {
+		// Timer_Lookup_Timing relies on the frequencies being sorted
+		if ((i > 0) && (table->freqs_hz[i] <= table->freqs_hz[i - 1])) {
+			return TIM_FREQ_INVALID;
+		}
+
+		ret = Timer_Solve_Freq(tim, table->freqs_hz[i], min_counting_period, &table->timings[i]);
+		if (ret != TIM_OK) {
+			return ret;
+		}
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Lookup_Timing binary searches a table built by Timer_Build_Timing_Table for freq_hz
+TIM_Ret_et Timer_Lookup_Timing(Tim_Timing_Table_st* table, uint32_t freq_hz, Tim_Timing_st** timing) {
+	uint16_t low = 0;
+	uint16_t high = table->len;
+
+	while (low < high) {
+		uint16_t mid = low + ((high - low) / 2);
+
+		if (table->freqs_hz[mid] == freq_hz) {
+			*timing = &table->timings[mid];
+			return TIM_OK;
+		}
+		else if (table->freqs_hz[mid] < freq_hz) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	return TIM_FREQ_INVALID;
+}
+
+// Records a new timing request on a running timer and loads it. it_config is checked against the request the same
+// way Timer_Init does, the interrupt keeps its period (or follows the timer with the default 0)
+static TIM_Ret_et retune(Timer_st* tim, Timing_Model_et timing, uint32_t value, const Tim_Timing_st* solution,
+		PWM_Commit_et commit) {
+	TIM_Base_InitTypeDef init = tim->htim->Init;
+	TIM_Ret_et ret;
+
+	// The interrupt checks divide by the request
+	if (value == 0) {
+		return (timing == PERIOD) ? TIM_PERIOD_ZERO : TIM_FREQ_ZERO;
+	}
+
+	ret = config_it(tim, timing, value);
+	if ((ret == TIM_OK) && (solution == NULL)) {
+		ret = (timing == PERIOD) ? config_period(tim, value) : config_freq(tim, value);
+	}
+	// Leaves Init untouched on failure
+	if (ret != TIM_OK) {
+		tim->htim->Init = init;
+		return ret;
+	}
+
+	if (solution != NULL) {
+		apply_timing(tim, solution->prescaler, solution->period, commit);
+	}
+	else {
+		apply_timing(tim, tim->htim->Init.Prescaler, tim->htim->Init.Period, commit);
+	}
+	tim->timing = timing;
+	if (timing == PERIOD) {
+		tim->period_ms = value;
+	}
+	else {
+		tim->freq_hz = value;
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Set_Freq retunes a running timer without re-initializing it. The new frequency, repetition counter and
+// recomputed compare values take effect together at the next update event, or immediately with COMMIT_NOW
+TIM_Ret_et Timer_Set_Freq(Timer_st* tim, uint32_t freq_hz, PWM_Commit_et commit) {
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+	return retune(tim, FREQ, freq_hz, NULL, commit);
+}
+
+// Timer_Set_Period retunes a running timer to a new period in milliseconds, see Timer_Set_Freq
+TIM_Ret_et Timer_Set_Period(Timer_st* tim, uint32_t period_ms, PWM_Commit_et commit) {
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+	return retune(tim, PERIOD, period_ms, NULL, commit);
+}
+
+// Timer_Set_Timing applies a precomputed solution (Timer_Solve_Freq / Timer_Lookup_Timing) the same way. Nothing is
+// solved here, so it is cheap enough for a control loop
+TIM_Ret_et Timer_Set_Timing(Timer_st* tim, const Tim_Timing_st* timing, PWM_Commit_et commit) {
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (timing->clk_hz != Timer_Get_Clock_Freq(tim)) { return TIM_FREQ_INVALID; }
+
+	return retune(tim, timing->timing, timing->value, timing, commit);
+}
+
+// Timer_Get_Achieved reads back the frequency the timer registers actually produce and its error against the
+// request, so timing can be checked without a scope. Values written with COMMIT_NEXT_UPDATE show up immediately
+TIM_Ret_et Timer_Get_Achieved(Timer_st* tim, Tim_Achieved_st* achieved) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+	uint64_t clk_mhz = (uint64_t)Timer_Get_Clock_Freq(tim) * 1000U;
+	uint64_t psc = (uint64_t)regs->PSC + 1;
+	uint64_t updates;
+	uint64_t update_ticks;
+
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+
+	// Center aligned counters count ARR up and ARR down, with an update at both ends
+	if (Timer_Is_Center_Aligned(tim)) {
+		achieved->ticks = psc * 2 * regs->ARR;
+		update_ticks = psc * regs->ARR;
+	}
+	else {
+		achieved->ticks = psc * ((uint64_t)regs->ARR + 1);
+		update_ticks = achieved->ticks;
+	}
+	if (achieved->ticks == 0) { return TIM_ERROR; }
+
+	// The interrupt fires once every RCR + 1 update events
+	updates = (Timer_Get_Capability(tim->tim_num)->has_rc ? (uint64_t)regs->RCR : 0) + 1;
+	achieved->freq_mhz = clk_mhz / achieved->ticks;
+	achieved->it_freq_mhz = clk_mhz / (update_ticks * updates);
+
+	// Exact ratio of the achieved to the requested frequency: f_clk / (ticks * freq_hz), or f_clk * period_ms / (ticks * 1000)
+	if ((tim->timing == PERIOD) && (tim->period_ms != 0)) {
+		achieved->error_ppm = ratio_error_ppm((uint64_t)Timer_Get_Clock_Freq(tim) * tim->period_ms, achieved->ticks * 1000U);
+	}
+	else if ((tim->timing == FREQ) && (tim->freq_hz != 0)) {
+		achieved->error_ppm = ratio_error_ppm(Timer_Get_Clock_Freq(tim), achieved->ticks * tim->freq_hz);
+	}
+	else {
+		achieved->error_ppm = 0;
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Break_Arm prepares a timer without break inputs for Timer_Break_Trigger: shut down outputs are driven to
+// their idle level and break events are counted, as with break.en_software at init. Fails with
+// TIM_BREAK_UNSUPPORTED when lock level 2 or 3 froze the off state bits before they were set
+TIM_Ret_et Timer_Break_Arm(Timer_st* tim) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return TIM_BREAK_UNSUPPORTED; }
+
+	regs->BDTR |= TIM_BDTR_OSSR | TIM_BDTR_OSSI;
+	if ((regs->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI)) != (TIM_BDTR_OSSR | TIM_BDTR_OSSI)) { return TIM_BREAK_UNSUPPORTED; }
+
+	tim->break_config.en_software = 1;
+	__HAL_TIM_CLEAR_FLAG(tim->htim, TIM_FLAG_BREAK | TIM_FLAG_BREAK2);
+	__HAL_TIM_ENABLE_IT(tim->htim, TIM_IT_BREAK);
+
+	return TIM_OK;
+}
+
+// Timer_Break_Trigger shuts the outputs down through the break logic from software, e.g. from an adc watchdog
+// interrupt. Same safe state and rearm as a break input
+TIM_Ret_et Timer_Break_Trigger(Timer_st* tim) {
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return TIM_BREAK_UNSUPPORTED; }
+
+	// Without Timer_Break_Arm the outputs are still shut down, only released instead of driven to their idle level
+	if (!tim->break_config.en_software) {
+		Timer_Break_Arm(tim);
+	}
+	tim->htim->Instance->EGR = TIM_EGR_BG;
+
+	return TIM_OK;
+}
+
+// Timer_Break_Rearm turns the outputs back on after a break. Fails with TIM_BREAK_ACTIVE while a break input is
+// still at its active level, the hardware then keeps the main output enable cleared
+TIM_Ret_et Timer_Break_Rearm(Timer_st* tim) {
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return TIM_BREAK_UNSUPPORTED; }
+
+	__HAL_TIM_CLEAR_FLAG(tim->htim, TIM_FLAG_BREAK | TIM_FLAG_BREAK2);
+	__HAL_TIM_MOE_ENABLE(tim->htim);
+
+	if (!(tim->htim->Instance->BDTR & TIM_BDTR_MOE)) { return TIM_BREAK_ACTIVE; }
+
+	if (tim->break_config.brk.en || tim->break_config.brk2.en || tim->break_config.en_software) {
+		__HAL_TIM_CLEAR_FLAG(tim->htim, TIM_FLAG_BREAK | TIM_FLAG_BREAK2);
+		__HAL_TIM_ENABLE_IT(tim->htim, TIM_IT_BREAK);
+	}
+
+	return TIM_OK;
+}
+
+// Timer_Break_Get_Status reads whether the outputs are shut down, the break flags and the fault counter
+TIM_Ret_et Timer_Break_Get_Status(Timer_st* tim, Tim_Break_Status_st* status) {
+	TIM_TypeDef* regs = tim->htim->Instance;
+
+	if (!tim->__metadata.tim_initialized) { return TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return TIM_BREAK_UNSUPPORTED; }
+
+	status->tripped = !(regs->BDTR & TIM_BDTR_MOE);
+	status->brk_flag = ((regs->SR & TIM_SR_BIF) != 0);
+	status->brk2_flag = ((regs->SR & TIM_SR_B2IF) != 0);
+	status->num_faults = tim->break_config.__num_faults;
+
+	return TIM_OK;
+}
+
+// Timer_Break_Callback counts a break event. Call it from HAL_TIMEx_BreakCallback (and HAL_TIMEx_Break2Callback).
+// The outputs are already off when it runs, it only does the bookkeeping
+void Timer_Break_Callback(Timer_st* tim, TIM_HandleTypeDef* htim) {
+	if (htim != tim->htim) {
+		return;
+	}
+
+	tim->break_config.__num_faults++;
+	// The flag sets again for as long as the input stays active, Timer_Break_Rearm turns the interrupt back on
+	__HAL_TIM_DISABLE_IT(htim, TIM_IT_BREAK);
+}
+
+// PWM_Init starts a pwm channel at pwm->duty
 PWM_Ret_et PWM_Init(PWM_st* pwm)
 {
-	// Differs from the simple channel number, see enum types in the switch case statement
+	// Differs from the simple channel number, see enum types in pwm_channel_select
 	uint32_t chan;
-	// This is the value that the timer will count to before shutting making the PWM line low
-	uint32_t compare;
-	// This value could be different than pwm->duty if pwm->is_inverted is enabled
-	uint8_t duty;
+	PWM_Ret_et ret;
 
 	// Make sure all pwm fields are valid
 	if (pwm->duty > MAX_DUTY_CYCLE) { return PWM_INVALID_DUTY; }
@@ -569,70 +1521,208 @@ PWM_Ret_et PWM_Init(PWM_st* pwm)
 	// Make sure the correct timer has been initialized
 	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
 
-
-	duty = pwm->duty;
-	if (pwm->is_inverted) {
-		duty = MAX_DUTY_CYCLE - duty;
+	// Find desired channel
+	ret = pwm_channel_select(pwm, &chan);
+	if (ret != PWM_OK) {
+		return ret;
 	}
 
-	compare = calculate_compare_value(pwm->tim->htim->Init.Period, duty);
+	if (Timer_Claim_Channel(pwm->tim, pwm->chan_num, pwm) != TIM_OK) { return PWM_CH_IN_USE; }
+	chan_pwms[pwm->tim->tim_num][pwm->chan_num - 1] = pwm;
 
-	// Find desired channel
-	switch(pwm->chan_num)
-	{
-		case(1):
-			if (!pwm->tim->channels.en_ch1) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_1;
-			break;
-		case(2):
-			if (!pwm->tim->channels.en_ch2) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_2;
-			break;
-		case(3):
-			if (!pwm->tim->channels.en_ch3) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_3;
-			break;
-		case(4):
-			if (!pwm->tim->channels.en_ch4) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_4;
-			break;
-	}
+	// Preload the compare register so later duty changes are latched on the update event
+	__HAL_TIM_ENABLE_OCxPRELOAD(pwm->tim->htim, chan);
+	pwm->duty_hr = duty_to_hr(pwm->duty);
+	pwm_write_compare(pwm, chan);
 
-	// Initiate the PWM and desired duty cycle
-	if (HAL_TIM_PWM_Start(pwm->tim->htim, chan) != HAL_OK) { return PWM_START_FAIL; }
-	__HAL_TIM_SET_COMPARE(pwm->tim->htim, chan, compare);
+	// Initiate the PWM
+	if (HAL_TIM_PWM_Start(pwm->tim->htim, chan) != HAL_OK) {
+		Timer_Release_Channel(pwm->tim, pwm->chan_num, pwm);
+		return PWM_START_FAIL;
+	}
+	if (pwm->tim->complementary.en_complementary) {
+		if (HAL_TIMEx_PWMN_Start(pwm->tim->htim, chan) != HAL_OK) {
+			Timer_Release_Channel(pwm->tim, pwm->chan_num, pwm);
+			return PWM_START_FAIL;
+		}
+	}
 
 	return PWM_OK;
 }
 
-//TODO: comment
+// PWM_Stop stops the output of a pwm channel
 PWM_Ret_et PWM_Stop(PWM_st* pwm) {
-	// Differs from the simple channel number, see enum types in the switch case statement
+	// Differs from the simple channel number, see enum types in pwm_channel_select
 	uint32_t chan;
+	PWM_Ret_et ret;
 
 	// Find desired channel
-	switch(pwm->chan_num)
-	{
-		case(1):
-			if (!pwm->tim->channels.en_ch1) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_1;
-			break;
-		case(2):
-			if (!pwm->tim->channels.en_ch2) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_2;
-			break;
-		case(3):
-				if (!pwm->tim->channels.en_ch3) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_3;
-			break;
-		case(4):
-				if (!pwm->tim->channels.en_ch4) { return PWM_CH_NOT_ENABLED; }
-			chan = TIM_CHANNEL_4;
-			break;
+	ret = pwm_channel_select(pwm, &chan);
+	if (ret != PWM_OK) {
+		return ret;
 	}
 
+	if (pwm->tim->complementary.en_complementary) {
+		if (HAL_TIMEx_PWMN_Stop(pwm->tim->htim, chan) != HAL_OK) { return PWM_STOP_FAIL; }
+	}
 	if (HAL_TIM_PWM_Stop(pwm->tim->htim, chan) != HAL_OK) { return PWM_STOP_FAIL; };
 
+	Timer_Release_Channel(pwm->tim, pwm->chan_num, pwm);
+
+	return PWM_OK;
+}
+
+// PWM_Set_Duty changes the duty cycle of a running pwm by writing only the compare register.
+// The new duty takes effect at the next update event without stopping the channel
+PWM_Ret_et PWM_Set_Duty(PWM_st* pwm, uint8_t duty) {
+	uint32_t chan;
+	PWM_Ret_et ret;
+
+	if (duty > MAX_DUTY_CYCLE) { return PWM_INVALID_DUTY; }
+	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	ret = pwm_channel_select(pwm, &chan);
+	if (ret != PWM_OK) {
+		return ret;
+	}
+
+	pwm->duty = duty;
+	pwm->duty_hr = duty_to_hr(duty);
+	pwm_write_compare(pwm, chan);
+
+	return PWM_OK;
+}
+
+// PWM_Set_Duty_HR is PWM_Set_Duty with a duty cycle from 0 to PWM_DUTY_HR_MAX. The usable resolution is
+// the counting period picked by Timer_Init, which is as large as the timer frequency allows
+PWM_Ret_et PWM_Set_Duty_HR(PWM_st* pwm, uint16_t duty_hr) {
+	uint32_t chan;
+	PWM_Ret_et ret;
+
+	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	ret = pwm_channel_select(pwm, &chan);
+	if (ret != PWM_OK) {
+		return ret;
+	}
+
+	pwm->duty_hr = duty_hr;
+	pwm->duty = duty_from_hr(duty_hr);
+	pwm_write_compare(pwm, chan);
+
+	return PWM_OK;
+}
+
+// PWM_Get_Duty_Counts returns the number of counts in one pwm period that compare values are a fraction of
+uint64_t PWM_Get_Duty_Counts(Timer_st* tim) {
+	return duty_counts(tim, tim->htim->Init.Period);
+}
+
+// PWM_Get_Achieved_Duty_HR reads back the duty cycle the compare register produces, after rounding to whole counts
+PWM_Ret_et PWM_Get_Achieved_Duty_HR(PWM_st* pwm, uint16_t* duty_hr) {
+	TIM_TypeDef* regs = pwm->tim->htim->Instance;
+	uint64_t count = duty_counts(pwm->tim, regs->ARR);
+	uint64_t high;
+	uint64_t duty;
+	uint32_t chan;
+	PWM_Ret_et ret;
+
+	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	ret = pwm_channel_select(pwm, &chan);
+	if (ret != PWM_OK) {
+		return ret;
+	}
+	if (count == 0) { return PWM_ERROR; }
+
+	high = __HAL_TIM_GET_COMPARE(pwm->tim->htim, chan);
+	if (pwm->tim->count_mode == COUNT_DOWN) {
+		high++;
+	}
+	duty = ((high * PWM_DUTY_HR_MAX) + (count / 2)) / count;
+	if (duty > PWM_DUTY_HR_MAX) {
+		duty = PWM_DUTY_HR_MAX;
+	}
+	*duty_hr = pwm->is_inverted ? (uint16_t)(PWM_DUTY_HR_MAX - duty) : (uint16_t)duty;
+
+	return PWM_OK;
+}
+
+// PWM_Set_Duties writes the duties of several channels of the same timer so that they all change on the same
+// update event. Update events are held off during the few cycles the writes take; an update that falls in that
+// window is skipped (the period still completes, its interrupt is lost)
+PWM_Ret_et PWM_Set_Duties(PWM_st* pwms[], const uint16_t duty_hr[], uint8_t num_pwms, PWM_Commit_et commit) {
+	uint32_t chan[4];
+	Timer_st* tim;
+	PWM_Ret_et ret;
+
+	if ((num_pwms == 0) || (num_pwms > 4)) { return PWM_INVALID_LEN; }
+
+	tim = pwms[0]->tim;
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	// Validate everything first so a batch is never half applied
+	for (uint8_t i = 0; i < num_pwms; i++) {
+		if (pwms[i]->tim != tim) { return PWM_TIM_MISMATCH; }
+
+		ret = pwm_channel_select(pwms[i], &chan[i]);
+		if (ret != PWM_OK) {
+			return ret;
+		}
+	}
+
+	updates_hold(tim);
+	for (uint8_t i = 0; i < num_pwms; i++) {
+		pwms[i]->duty_hr = duty_hr[i];
+		pwms[i]->duty = duty_from_hr(duty_hr[i]);
+		pwm_write_compare(pwms[i], chan[i]);
+	}
+	updates_release(tim, commit);
+
+	return PWM_OK;
+}
+
+// PWM_Commutation_Init preloads the output enable and mode bits of an advanced timer so PWM_Commutate can switch
+// all phases at once. input_trigger is TIM_TS_NONE for software commutation or the TIM_TS_ITRx that fires it
+PWM_Ret_et PWM_Commutation_Init(Timer_st* tim, uint32_t input_trigger) {
+	uint32_t source = (input_trigger == TIM_TS_NONE) ? TIM_COMMUTATION_SOFTWARE : TIM_COMMUTATION_TRGI;
+
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return PWM_COMMUTATION_UNSUPPORTED; }
+
+	if (HAL_TIMEx_ConfigCommutEvent(tim->htim, input_trigger, source) != HAL_OK) { return PWM_COMMUTATION_FAIL; }
+
+	return PWM_OK;
+}
+
+// PWM_Commutate loads the next commutation step. With software commutation the outputs switch immediately (COM
+// event) and the new duty follows the commit setting; with trigger commutation they switch on the next trigger
+PWM_Ret_et PWM_Commutate(Timer_st* tim, const PWM_Commutation_Step_st* step, PWM_Commit_et commit) {
+	uint32_t compare;
+
+	if (!tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+	if (tim->__metadata.tim_type != ADVANCED_TIMER) { return PWM_COMMUTATION_UNSUPPORTED; }
+
+	for (uint8_t c = 1; c <= tim->__metadata.num_channels; c++) {
+		if ((step->phase[c - 1] != PHASE_OFF) && !channel_enabled(tim, c)) { return PWM_CH_NOT_ENABLED; }
+	}
+
+	compare = calculate_compare_value(tim, step->duty_hr);
+
+	updates_hold(tim);
+	for (uint8_t c = 1; c <= tim->__metadata.num_channels; c++) {
+		phase_write(tim, c, step->phase[c - 1]);
+		if ((step->phase[c - 1] == PHASE_PWM) || (step->phase[c - 1] == PHASE_HIGH_PWM)) {
+			__HAL_TIM_SET_COMPARE(tim->htim, TIM_HAL_CHANNEL(c), compare);
+		}
+	}
+	updates_release(tim, commit);
+
+	// Software commutation applies the preloaded output bits right away
+	if (!(tim->htim->Instance->CR2 & TIM_CR2_CCUS)) {
+		HAL_TIM_GenerateEvent(tim->htim, TIM_EVENTSOURCE_COM);
+	}
+
 	return PWM_OK;
 }
 
@@ -649,8 +1739,8 @@ PWM_Ret_et PWM_Move_Towards_Target(PWM_st* pwm)
 	}
 
 	else if(pwm->duty > pwm->target_duty) {
-		// Make sure duty does not go below min
-		step = 	((pwm->duty - pwm->target_duty) > pwm->duty_step_size) ?
+		// Make sure duty does not go below target
+		step = 	((pwm->duty - pwm->target_duty) < pwm->duty_step_size) ?
 				(pwm->duty - pwm->target_duty) :
 				(pwm->duty_step_size);
 
@@ -658,25 +1748,21 @@ PWM_Ret_et PWM_Move_Towards_Target(PWM_st* pwm)
 		pwm->duty -= step;
 	}
 	else if(pwm->duty < pwm->target_duty) {
-		//make sure duty does not go above max
-		step = 	((pwm->target_duty - pwm->duty) > pwm->duty_step_size) ?
+		// Make sure duty does not go above target
+		step = 	((pwm->target_duty - pwm->duty) < pwm->duty_step_size) ?
 				 (pwm->target_duty - pwm->duty) :
 				 (pwm->duty_step_size);
 
 		// Update the duty cycle
-		pwm->duty -= step;
+		pwm->duty += step;
 	}
 
 	// These errors should never happen
 	if (pwm->target_duty > MAX_DUTY_CYCLE) { return PWM_INVALID_TRGT_DUTY; }
 	if (pwm->duty > MAX_DUTY_CYCLE) { return PWM_INVALID_DUTY; }
 
-	ret = PWM_Stop(pwm);
-	if (ret != PWM_OK) {
-		return ret;
-	}
-
-	ret = PWM_Init(pwm);
+	// Only the compare register changes, the channel keeps running
+	ret = PWM_Set_Duty(pwm, pwm->duty);
 	if (ret != PWM_OK) {
 		return ret;
 	}
@@ -695,3 +1781,39 @@ PWM_Ret_et PWM_Update_Target(PWM_st* pwm, uint8_t new_target)
 
 	return PWM_OK;
 }
+
+// PWM_Waveform_Fill converts a high resolution duty waveform into compare values for PWM_Waveform_Start,
+// taking the counting period and pwm->is_inverted into account
+PWM_Ret_et PWM_Waveform_Fill(PWM_st* pwm, const uint16_t duty_hr[], uint32_t compare[], uint16_t len) {
+	if (!pwm->tim->__metadata.tim_initialized) { return PWM_TIM_UNINIT; }
+
+	for (uint16_t i = 0; i < len; i++) {
+		uint16_t duty = pwm->is_inverted ? (PWM_DUTY_HR_MAX - duty_hr[i]) : duty_hr[i];
+		compare[i] = calculate_compare_value(pwm->tim, duty);
+	}
+
+	return PWM_OK;
+}
+
+// PWM_Waveform_Start streams one compare value per pwm period into the channel through the timer update DMA.
+// The channel must already be running (PWM_Init). Because of compare preload each value is output one period
+// after its update event. compare[] must stay valid until playback ends (or forever in circular mode)
+PWM_Ret_et PWM_Waveform_Start(PWM_st* pwm, const uint32_t compare[], uint16_t len, PWM_Waveform_Mode_et mode) {
+	if (pwm->chan_num == 0 || pwm->chan_num > 4) { return PWM_INVALID_CH_NUM; }
+
+	return waveform_start(pwm->tim, pwm->chan_num, 1, compare, len, mode);
+}
+
+// PWM_Waveform_Start_Burst plays a waveform on num_chans consecutive channels starting at first_chan. compare[] is
+// interleaved per period: {p0_ch1, p0_ch2, ..., p1_ch1, p1_ch2, ...} and holds num_periods * num_chans values, at
+// most MAX_DMA_TRANSFERS
+PWM_Ret_et PWM_Waveform_Start_Burst(Timer_st* tim, uint8_t first_chan, uint8_t num_chans, const uint32_t compare[], uint16_t num_periods, PWM_Waveform_Mode_et mode) {
+	return waveform_start(tim, first_chan, num_chans, compare, (uint32_t)num_periods * num_chans, mode);
+}
+
+// PWM_Waveform_Stop stops waveform playback on a timer. The channels keep the last compare value written
+PWM_Ret_et PWM_Waveform_Stop(Timer_st* tim) {
+	if (HAL_TIM_DMABurst_WriteStop(tim->htim, TIM_DMA_UPDATE) != HAL_OK) { return PWM_DMA_STOP_FAIL; }
+
+	return PWM_OK;
+}
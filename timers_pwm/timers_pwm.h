@@ -37,18 +37,57 @@
 
 /*----------MACROS & DEFINES------------*/
 
-#define COUNTING_PERIOD_SLOW	(1000)
-#define MAX_TIM_FREQ_SLOW					(1000U)		// Max Freq = 1kHz for any clock speed
+#define MIN_COUNTING_PERIOD				(100U)		// At least 100 counts per period so 1% duty steps exist
+#define MAX_TIM_FREQ_FAST(CLOCK_FREQ)		((CLOCK_FREQ) / MIN_COUNTING_PERIOD)
 
-#define COUNTING_PERIOD_FAST				(100U)		// Max Freq = Clk_speed / 100 for any clock speed
-#define MAX_TIM_FREQ_FAST(CLOCK_FREQ)		((CLOCK_FREQ) / COUNTING_PERIOD_FAST)
+#define MAX_COUNTING_PERIOD_16BIT			(0x10000ULL)		// ARR + 1 for 16 bit counters
+#define MAX_COUNTING_PERIOD_32BIT			(0x100000000ULL)	// ARR + 1 for 32 bit counters (tim2, tim5)
+#define MAX_PRESCALER						(0x10000ULL)		// PSC + 1, prescaler is a 16 bit register
 
 #define DEFAULT_IT_FREQ						(0U)
 #define DEFAULT_IT_PERIOD					(0U)
 
 #define MAX_DUTY_CYCLE						(100U)		// 100% duty cycle
+#define PWM_DUTY_HR_MAX						(0xFFFFU)	// 100% duty cycle in high resolution units
+// Compare value of a high resolution duty cycle with the Q32 scale of its timer (__metadata.duty_scale_q32), rounded
+// exactly like duty_hr * counts / PWM_DUTY_HR_MAX: the scale is rounded down, the extra 2^14 makes up for it
+#define PWM_DUTY_TO_COMPARE(DUTY_HR, SCALE_Q32)	((uint32_t)(((((uint64_t)(DUTY_HR) * (SCALE_Q32)) >> 1) + (1ULL << 30) + (1U << 14)) >> 31))
 #define MAX_IT_FREQ 						(1000U)		// This can be modified if needed
 #define MAX_REP_COUNTER 					(0xffffU)	// Rep counter is a 16 bit register
+#define MAX_TIM_NUM							(14U)
+#define MAX_BREAK_FILTER					(15U)		// Break filters are 4 bit fields
+#define MAX_LOCK_LEVEL						(3U)
+#define MAX_DMA_TRANSFERS					(0xffffU)	// DMA stream NDTR is a 16 bit register
+
+// HAL channel of a channel number 1 - 4. TIM_CHANNEL_1 - TIM_CHANNEL_4 are 4 apart, which is also the CCER shift
+#define TIM_HAL_CHANNEL(CHAN_NUM)			(((uint32_t)(CHAN_NUM) - 1U) * 4U)
+
+// Set to 1 to let the library define HAL_TIM_PeriodElapsedCallback and route it with Timer_Dispatch_Period_Elapsed
+#ifndef TIM_DISPATCH_OWN_CALLBACK
+#define TIM_DISPATCH_OWN_CALLBACK			(0U)
+#endif
+
+// Capabilities of every timer, one X(number, instance, type, channels, counter bits, repetition counter, dma, apb2) each
+#define TIM_CAPABILITY_TABLE(X) \
+	X(1,	TIM1,	ADVANCED_TIMER,	4,	16,	1,	1,	1) \
+	X(2,	TIM2,	GENERAL_TIMER,	4,	32,	0,	1,	0) \
+	X(3,	TIM3,	GENERAL_TIMER,	4,	16,	0,	1,	0) \
+	X(4,	TIM4,	GENERAL_TIMER,	4,	16,	0,	1,	0) \
+	X(5,	TIM5,	GENERAL_TIMER,	4,	32,	0,	1,	0) \
+	X(6,	TIM6,	BASIC_TIMER,	0,	16,	0,	1,	0) \
+	X(7,	TIM7,	BASIC_TIMER,	0,	16,	0,	1,	0) \
+	X(8,	TIM8,	ADVANCED_TIMER,	4,	16,	1,	1,	1) \
+	X(9,	TIM9,	GENERAL_TIMER,	2,	16,	0,	0,	1) \
+	X(10,	TIM10,	GENERAL_TIMER,	1,	16,	0,	0,	1) \
+	X(11,	TIM11,	GENERAL_TIMER,	1,	16,	0,	0,	1) \
+	X(12,	TIM12,	GENERAL_TIMER,	2,	16,	0,	0,	0) \
+	X(13,	TIM13,	GENERAL_TIMER,	1,	16,	0,	0,	0) \
+	X(14,	TIM14,	GENERAL_TIMER,	1,	16,	0,	0,	0)
+
+// Compile time capability of a constant timer number, e.g. TIM_CAP(2, BITS) is 32. FIELD is one of
+// TYPE, CHANNELS, BITS, RC, DMA or APB2
+#define TIM_CAP(NUM, FIELD)					TIM_CAP_(NUM, FIELD)
+#define TIM_CAP_(NUM, FIELD)				(TIM##NUM##_CAP_##FIELD)
 
 /*----------TYPEDEFS----------*/
 
@@ -78,6 +117,66 @@ typedef struct {
 	uint16_t freq_hz;
 }Tim_Interrupt_st;
 
+// Counting mode of the timer. Center aligned modes count up to ARR then back down, which makes the pwm symmetric.
+// Down and center aligned counting are only available on timers 1-5 and 8
+typedef enum {
+	COUNT_UP = 1,
+	COUNT_DOWN,
+	// Center aligned, compare interrupt flags set while counting down
+	COUNT_CENTER_ALIGNED_1,
+	// Center aligned, compare interrupt flags set while counting up
+	COUNT_CENTER_ALIGNED_2,
+	// Center aligned, compare interrupt flags set in both directions
+	COUNT_CENTER_ALIGNED_3,
+}Tim_Count_Mode_et;
+
+// Complementary (CHxN) output configuration for driving half bridges. Advanced timers only
+typedef struct {
+	// Enables the complementary output of every enabled pwm channel
+	uint8_t en_complementary;
+	// Time both outputs are held inactive at every switching edge, in nanoseconds. Rounded up to what the hardware allows
+	uint32_t dead_time_ns;
+	// Sets the outputs back on automatically at the next update event after a break
+	uint8_t en_auto_output;
+}Tim_Complementary_st;
+
+// Active level of a break input
+typedef enum {
+	// Outputs are shut down while the input is high
+	BREAK_ACTIVE_HIGH = 1,
+	// Outputs are shut down while the input is low
+	BREAK_ACTIVE_LOW,
+}Tim_Break_Polarity_et;
+
+// One break input of an advanced timer
+typedef struct {
+	// Enables the input
+	uint8_t en;
+	// Active level, active high if left at 0
+	Tim_Break_Polarity_et polarity;
+	// Digital filter (0 - 15), same encoding as the input capture filter. 0 reacts to the input directly
+	uint8_t filter;
+}Tim_Break_Input_st;
+
+// Hardware break configuration (advanced timers only). On a break the outputs go to their idle level (low) within
+// a few timer clock cycles, without the CPU, and stay there until Timer_Break_Rearm (or the next update event after
+// the input is released with complementary.en_auto_output)
+typedef struct {
+	// BKIN input, also fed by the internal system faults (clock failure, lockup, PVD)
+	Tim_Break_Input_st brk;
+	// BKIN2 input
+	Tim_Break_Input_st brk2;
+	// Breaks are also generated in software (Timer_Break_Trigger, ADC_Watchdog_st). Sets the same off state and break
+	// interrupt as a break input. Needed at init with lock level 2 or 3, otherwise Timer_Break_Arm can set it later
+	uint8_t en_software;
+	// Lock level (0 - 3) applied at the end of Timer_Init. Higher levels freeze more of the break, dead time and output
+	// configuration until the next reset. Level 3 also freezes the output compare modes, which PWM_Commutate,
+	// interleaving and adc triggering change at run time
+	uint8_t lock_level;
+	// DO NOT WRITE. Number of break events counted by Timer_Break_Callback
+	volatile uint32_t __num_faults;
+}Tim_Break_st;
+
 // Timer_Type_et distinguishes timer types as different timers have different capabilities
 typedef enum {
 	// Timers 1 and 8: 4 PWM channels and repetition counter. Use for PWM + periodic interrupts or one-shot timer.
@@ -88,6 +187,41 @@ typedef enum {
 	BASIC_TIMER,
 }Tim_Type_et;
 
+#define TIM_CAP_CONSTANTS(NUM, INST, TYPE, CHANNELS, BITS, RC, DMA, APB2) \
+	TIM##NUM##_CAP_TYPE = TYPE, TIM##NUM##_CAP_CHANNELS = CHANNELS, TIM##NUM##_CAP_BITS = BITS, \
+	TIM##NUM##_CAP_RC = RC, TIM##NUM##_CAP_DMA = DMA, TIM##NUM##_CAP_APB2 = APB2,
+enum { TIM_CAPABILITY_TABLE(TIM_CAP_CONSTANTS) };
+
+// Tim_Capability_st is one row of TIM_CAPABILITY_TABLE
+typedef struct {
+	// Register block of the timer
+	TIM_TypeDef* instance;
+	// Timer type (see Tim_Type_et definition)
+	Tim_Type_et tim_type;
+	// Number of channels
+	uint8_t num_channels;
+	// Width of the counter in bits (16 or 32)
+	uint8_t counter_bits;
+	// Has a repetition counter
+	uint8_t has_rc;
+	// Has DMA requests
+	uint8_t has_dma;
+	// Clocked from APB2 (APB1 otherwise)
+	uint8_t on_apb2;
+}Tim_Capability_st;
+
+// Tim_Requirements_st describes the timer Timer_Allocate should hand out. Zero fields are not required
+typedef struct {
+	// Minimum number of channels
+	uint8_t min_channels;
+	// Minimum counter width in bits (16 or 32)
+	uint8_t min_counter_bits;
+	// Needs a repetition counter
+	uint8_t needs_rc;
+	// Needs DMA requests
+	uint8_t needs_dma;
+}Tim_Requirements_st;
+
 // Auto-configured: DO NOT WRITE. Timer_Info_st stores info relevant to the specific timer being initialized
 typedef struct{
 	// Number of PWM channels
@@ -96,6 +230,8 @@ typedef struct{
 	Tim_Type_et tim_type;
 	// Set by Timer_Init and unset by Timer_Stop
 	uint8_t tim_initialized;
+	// duty_hr to compare value scale of the counting period in Q32, updated with the period (see PWM_DUTY_TO_COMPARE)
+	uint64_t duty_scale_q32;
 }tim_metadata_st;
 
 // Timer_st stores the user input to timer functions
@@ -114,10 +250,20 @@ typedef struct {
 	Channel_Config_st channels;
 	// Periodic interrupt configurations
 	Tim_Interrupt_st it_config;
+	// Counting mode, counts up if left at 0. In center aligned mode the pwm frequency is freq_hz and general
+	// timers interrupt twice per period (advanced timers use the repetition counter to interrupt once)
+	Tim_Count_Mode_et count_mode;
+	// Complementary outputs and dead time (advanced timers only)
+	Tim_Complementary_st complementary;
+	// Break inputs (advanced timers only)
+	Tim_Break_st break_config;
 	// DO NOT WRITE. Auto-configured. Stores info about timer type and number of channels
 	tim_metadata_st __metadata;
 }Timer_st;
 
+// Runs from the update interrupt of tim with the context given to Timer_Register_Callback
+typedef void (*Timer_Callback_ft)(Timer_st* tim, void* context);
+
 //TODO: comment
 typedef struct {
 	// Timer which contains the PWM channel
@@ -132,8 +278,95 @@ typedef struct {
 	uint8_t duty_step_size;
 	// Inverted is a boolean which will make it such that the duty cycle will be (100 - duty)
 	uint8_t is_inverted;
+	// High resolution duty cycle (0 - PWM_DUTY_HR_MAX). Kept in sync with duty by PWM_Init, PWM_Set_Duty and PWM_Set_Duty_HR.
+	// Last member so positional initializers written before it existed still fill the same fields
+	uint16_t duty_hr;
 }PWM_st;
 
+// Tim_Timing_st is a prescaler / auto-reload solution for one requested frequency or period
+typedef struct {
+	// Prescaler register value (PSC)
+	uint32_t prescaler;
+	// Auto-reload register value (ARR)
+	uint32_t period;
+	// Timer input clock the solution was computed for
+	uint32_t clk_hz;
+	// Frequency actually produced, in millihertz
+	uint64_t achieved_mhz;
+	// Error of the achieved frequency relative to the request in parts per million, rounded to the nearest
+	int32_t error_ppm;
+	// Request the solution was computed for, a frequency in Hz (FREQ) or a period in ms (PERIOD)
+	Timing_Model_et timing;
+	uint32_t value;
+}Tim_Timing_st;
+
+// Tim_Break_Status_st is the state of the break inputs of a timer
+typedef struct {
+	// Outputs are shut down (main output enable cleared)
+	uint8_t tripped;
+	// Break event flags still set (the HAL clears them when it handles the break interrupt)
+	uint8_t brk_flag;
+	uint8_t brk2_flag;
+	// Number of break events counted by Timer_Break_Callback
+	uint32_t num_faults;
+}Tim_Break_Status_st;
+
+// Tim_Achieved_st is what the prescaler, auto-reload and repetition counter registers of a running timer produce
+typedef struct {
+	// Counter (pwm) frequency in millihertz
+	uint64_t freq_mhz;
+	// Update interrupt frequency in millihertz, after the repetition counter
+	uint64_t it_freq_mhz;
+	// Timer clock ticks per counter period
+	uint64_t ticks;
+	// Error of freq_mhz relative to the freq_hz / period_ms the timer was set to, in parts per million
+	int32_t error_ppm;
+}Tim_Achieved_st;
+
+// Tim_Timing_Table_st holds solutions computed ahead of time for fast retuning
+typedef struct {
+	// Requested frequencies, must be sorted in increasing order
+	const uint32_t* freqs_hz;
+	// Solutions, filled by Timer_Build_Timing_Table. Same length as freqs_hz
+	Tim_Timing_st* timings;
+	// Number of entries
+	uint16_t len;
+}Tim_Timing_Table_st;
+
+// Waveform playback either stops after the last sample or wraps around to the first one
+typedef enum {
+	WAVEFORM_ONE_SHOT = 1,
+	WAVEFORM_CIRCULAR,
+}PWM_Waveform_Mode_et;
+
+// When a batch of compare / output changes reaches the outputs
+typedef enum {
+	// At the next natural update event, the running period is not disturbed
+	COMMIT_NEXT_UPDATE = 1,
+	// Immediately through a software update (UG) event. The counter restarts from 0
+	COMMIT_NOW,
+}PWM_Commit_et;
+
+// Output state of one channel during a commutation step (advanced timers)
+typedef enum {
+	// Both CHx and CHxN disabled
+	PHASE_OFF = 1,
+	// CHx switches at the step duty, CHxN is its complement if complementary outputs are enabled
+	PHASE_PWM,
+	// CHx switches at the step duty, CHxN stays off
+	PHASE_HIGH_PWM,
+	// CHx held off and CHxN held on (low side conducting)
+	PHASE_LOW_ON,
+}PWM_Phase_State_et;
+
+// PWM_Commutation_Step_st describes the outputs of a timer for one commutation step (e.g. one of six BLDC steps)
+typedef struct {
+	// State of channels 1 to 4
+	PWM_Phase_State_et phase[4];
+	// High resolution duty of the PHASE_PWM and PHASE_HIGH_PWM channels
+	uint16_t duty_hr;
+}PWM_Commutation_Step_st;
+
 // TIM_Ret_et shows the status of a timer function
 typedef enum {
 	// TIM_OK indicates that no error within the function
@@ -174,6 +407,62 @@ typedef enum {
 	TIM_BASE_START_IT_FAIL,
 	// TIM_BASE_DEINIT_FAIL indicates that the function "HAL_TIM_Base_DeInit" failed
 	TIM_BASE_DEINIT_FAIL,
+	// TIM_PERIOD_INVALID indicates that the timer cannot be set to the given period
+	TIM_PERIOD_INVALID,
+	// TIM_COUNT_MODE_UNSUPPORTED indicates that the given timer can only count up
+	TIM_COUNT_MODE_UNSUPPORTED,
+	// TIM_COMPLEMENTARY_UNSUPPORTED indicates that complementary outputs need an advanced timer
+	TIM_COMPLEMENTARY_UNSUPPORTED,
+	// TIM_DEADTIME_INVALID indicates that the dead time is too long for the timer clock
+	TIM_DEADTIME_INVALID,
+	// TIM_BREAK_UNSUPPORTED indicates that break inputs need an advanced timer, or a filter / lock level out of range
+	TIM_BREAK_UNSUPPORTED,
+	// TIM_BREAK_ACTIVE indicates that the outputs cannot be rearmed because a break input is still active
+	TIM_BREAK_ACTIVE,
+	// TIM_UNINIT indicates that the timer has not been initialized by Timer_Init
+	TIM_UNINIT,
+	// TIM_SYNC_UNSUPPORTED indicates that the slave timer has no internal trigger line from the master timer
+	TIM_SYNC_UNSUPPORTED,
+	// TIM_SLAVE_CONFIG_FAIL indicates that the function "HAL_TIM_SlaveConfigSynchro" failed
+	TIM_SLAVE_CONFIG_FAIL,
+	// TIM_CH_INVALID indicates that the channel number is not supported by the timer or the requested mode
+	TIM_CH_INVALID,
+	// TIM_CAPTURE_CONFIG_FAIL indicates that the function "HAL_TIM_IC_Init" or "HAL_TIM_IC_ConfigChannel" failed
+	TIM_CAPTURE_CONFIG_FAIL,
+	// TIM_CAPTURE_START_FAIL indicates that the function "HAL_TIM_IC_Start" (or its _IT / _DMA variant) failed
+	TIM_CAPTURE_START_FAIL,
+	// TIM_CAPTURE_STOP_FAIL indicates that the function "HAL_TIM_IC_Stop" (or its _IT / _DMA variant) failed
+	TIM_CAPTURE_STOP_FAIL,
+	// TIM_NO_CAPTURE indicates that not enough edges have been captured yet (or the input stopped)
+	TIM_NO_CAPTURE,
+	// TIM_INVALID_BUFFER indicates that a buffer is missing or too short for the request
+	TIM_INVALID_BUFFER,
+	// TIM_NO_DMA indicates that no DMA stream is linked to the timer request
+	TIM_NO_DMA,
+	// TIM_ENCODER_UNSUPPORTED indicates that the timer has no encoder interface (only timers 1-5 and 8 do)
+	TIM_ENCODER_UNSUPPORTED,
+	// TIM_ENCODER_CONFIG_FAIL indicates that the function "HAL_TIM_Encoder_Init" failed
+	TIM_ENCODER_CONFIG_FAIL,
+	// TIM_ENCODER_START_FAIL indicates that the function "HAL_TIM_Encoder_Start" failed
+	TIM_ENCODER_START_FAIL,
+	// TIM_ENCODER_STOP_FAIL indicates that the function "HAL_TIM_Encoder_Stop" failed
+	TIM_ENCODER_STOP_FAIL,
+	// TIM_OC_CONFIG_FAIL indicates that the function "HAL_TIM_OC_Init" or "HAL_TIM_OC_ConfigChannel" failed
+	TIM_OC_CONFIG_FAIL,
+	// TIM_OC_START_FAIL indicates that the function "HAL_TIM_OC_Start_IT" failed
+	TIM_OC_START_FAIL,
+	// TIM_IN_USE indicates that the timer is already owned by another Timer_st
+	TIM_IN_USE,
+	// TIM_NONE_AVAILABLE indicates that no free timer meets the requirements
+	TIM_NONE_AVAILABLE,
+	// TIM_CH_IN_USE indicates that the channel is already used by another pwm / capture / compare user
+	TIM_CH_IN_USE,
+	// TIM_IT_DISABLED indicates that a callback was registered on a timer without periodic interrupts (it_config.en_it)
+	TIM_IT_DISABLED,
+	// TIM_PROFILE_FULL indicates that every slot of the static interrupt profile buffer is in use (TIM_PROFILE_MAX)
+	TIM_PROFILE_FULL,
+	// TIM_OC_STOP_FAIL indicates that the function "HAL_TIM_OC_Stop_IT" failed
+	TIM_OC_STOP_FAIL,
 	// TIM_ERROR is a general error it does not indicate anything other than it is not PMW_OK
 	TIM_ERROR,
 }TIM_Ret_et;
@@ -198,6 +487,37 @@ typedef enum {
 	PWM_START_FAIL,
 	// PWM_STOP_FAIL indicates that the function "HAL_TIM_PWM_Stop" failed
 	PWM_STOP_FAIL,
+	// PWM_INVALID_LEN indicates that a waveform buffer is empty, does not fit the request or needs more than
+	// MAX_DMA_TRANSFERS words
+	PWM_INVALID_LEN,
+	// PWM_NO_DMA indicates that no DMA stream is linked to the timer update request
+	PWM_NO_DMA,
+	// PWM_DMA_START_FAIL indicates that the function "HAL_TIM_DMABurst_MultiWriteStart" failed
+	PWM_DMA_START_FAIL,
+	// PWM_DMA_STOP_FAIL indicates that the function "HAL_TIM_DMABurst_WriteStop" failed
+	PWM_DMA_STOP_FAIL,
+	// PWM_INVALID_RATE indicates that a ramp rate or tick period is zero
+	PWM_INVALID_RATE,
+	// PWM_RAMP_FULL indicates that the ramp engine has no room for another active ramp
+	PWM_RAMP_FULL,
+	// PWM_TIM_MISMATCH indicates that pwms updated together do not share the same timer
+	PWM_TIM_MISMATCH,
+	// PWM_COMMUTATION_UNSUPPORTED indicates that commutation events need an advanced timer
+	PWM_COMMUTATION_UNSUPPORTED,
+	// PWM_COMMUTATION_FAIL indicates that the function "HAL_TIMEx_ConfigCommutEvent" failed
+	PWM_COMMUTATION_FAIL,
+	// PWM_PULSE_INVALID indicates that the pulse delay / width cannot be produced by the timer
+	PWM_PULSE_INVALID,
+	// PWM_PULSE_CONFIG_FAIL indicates that the one pulse mode configuration of the timer failed
+	PWM_PULSE_CONFIG_FAIL,
+	// PWM_CH_IN_USE indicates that the channel is already used by another pwm / capture / compare user
+	PWM_CH_IN_USE,
+	// PWM_INTERLEAVE_UNSUPPORTED indicates that the phases of an interleaved group cannot be placed on their timers
+	PWM_INTERLEAVE_UNSUPPORTED,
+	// PWM_SYNC_FAIL indicates that the timers of an interleaved group could not be chained together
+	PWM_SYNC_FAIL,
+	// PWM_DITHER_INVALID indicates an invalid dithering or spread spectrum configuration
+	PWM_DITHER_INVALID,
 	// PWM_ERROR is a general error it does not indicate anything other than it is not PMW_OK
 	PWM_ERROR,
 }PWM_Ret_et;
@@ -206,9 +526,45 @@ typedef enum {
 
 TIM_Ret_et Timer_Init(Timer_st* tim);
 TIM_Ret_et Timer_Stop(Timer_st* tim);
+uint32_t Timer_Get_Clock_Freq(Timer_st* tim);
+const Tim_Capability_st* Timer_Get_Capability(uint8_t tim_num);
+uint8_t Timer_Is_Center_Aligned(Timer_st* tim);
+uint32_t Timer_Get_OC_Mode(Timer_st* tim, uint8_t chan_num);
+void Timer_Set_OC_Mode(Timer_st* tim, uint8_t chan_num, uint32_t mode);
+TIM_Ret_et Timer_Allocate(Timer_st* tim, const Tim_Requirements_st* req);
+void Timer_Release(Timer_st* tim);
+TIM_Ret_et Timer_Claim_Channel(Timer_st* tim, uint8_t chan_num, const void* owner);
+void Timer_Release_Channel(Timer_st* tim, uint8_t chan_num, const void* owner);
+TIM_Ret_et Timer_Register_Callback(Timer_st* tim, Timer_Callback_ft callback, void* context);
+void Timer_Unregister_Callback(Timer_st* tim);
+void Timer_Dispatch_Period_Elapsed(TIM_HandleTypeDef* htim);
+TIM_Ret_et Timer_Solve_Freq(Timer_st* tim, uint32_t freq_hz, uint32_t min_counting_period, Tim_Timing_st* timing);
+TIM_Ret_et Timer_Solve_Period(Timer_st* tim, uint32_t period_ms, uint32_t min_counting_period, Tim_Timing_st* timing);
+TIM_Ret_et Timer_Build_Timing_Table(Timer_st* tim, Tim_Timing_Table_st* table, uint32_t min_counting_period);
+TIM_Ret_et Timer_Lookup_Timing(Tim_Timing_Table_st* table, uint32_t freq_hz, Tim_Timing_st** timing);
+TIM_Ret_et Timer_Set_Freq(Timer_st* tim, uint32_t freq_hz, PWM_Commit_et commit);
+TIM_Ret_et Timer_Set_Period(Timer_st* tim, uint32_t period_ms, PWM_Commit_et commit);
+TIM_Ret_et Timer_Set_Timing(Timer_st* tim, const Tim_Timing_st* timing, PWM_Commit_et commit);
+TIM_Ret_et Timer_Get_Achieved(Timer_st* tim, Tim_Achieved_st* achieved);
+TIM_Ret_et Timer_Break_Arm(Timer_st* tim);
+TIM_Ret_et Timer_Break_Trigger(Timer_st* tim);
+TIM_Ret_et Timer_Break_Rearm(Timer_st* tim);
+TIM_Ret_et Timer_Break_Get_Status(Timer_st* tim, Tim_Break_Status_st* status);
+void Timer_Break_Callback(Timer_st* tim, TIM_HandleTypeDef* htim);
 PWM_Ret_et PWM_Init(PWM_st* pwm);
 PWM_Ret_et PWM_Move_Towards_Target(PWM_st* pwm);
 PWM_Ret_et PWM_Update_Target(PWM_st* pwm, uint8_t new_target);
+PWM_Ret_et PWM_Waveform_Fill(PWM_st* pwm, const uint16_t duty_hr[], uint32_t compare[], uint16_t len);
+PWM_Ret_et PWM_Waveform_Start(PWM_st* pwm, const uint32_t compare[], uint16_t len, PWM_Waveform_Mode_et mode);
+PWM_Ret_et PWM_Waveform_Start_Burst(Timer_st* tim, uint8_t first_chan, uint8_t num_chans, const uint32_t compare[], uint16_t num_periods, PWM_Waveform_Mode_et mode);
+PWM_Ret_et PWM_Waveform_Stop(Timer_st* tim);
 PWM_Ret_et PWM_Stop(PWM_st* pwm);
+PWM_Ret_et PWM_Set_Duty(PWM_st* pwm, uint8_t duty);
+PWM_Ret_et PWM_Set_Duty_HR(PWM_st* pwm, uint16_t duty_hr);
+uint64_t PWM_Get_Duty_Counts(Timer_st* tim);
+PWM_Ret_et PWM_Get_Achieved_Duty_HR(PWM_st* pwm, uint16_t* duty_hr);
+PWM_Ret_et PWM_Set_Duties(PWM_st* pwms[], const uint16_t duty_hr[], uint8_t num_pwms, PWM_Commit_et commit);
+PWM_Ret_et PWM_Commutation_Init(Timer_st* tim, uint32_t input_trigger);
+PWM_Ret_et PWM_Commutate(Timer_st* tim, const PWM_Commutation_Step_st* step, PWM_Commit_et commit);
 
 #endif /* INC_TIMERS_PWM_H_ */